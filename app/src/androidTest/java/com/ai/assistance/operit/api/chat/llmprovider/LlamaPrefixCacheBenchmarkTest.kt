@@ -0,0 +1,124 @@
+package com.ai.assistance.operit.api.chat.llmprovider
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import com.ai.assistance.llama.LlamaSession
+import java.io.File
+import org.junit.Assert.assertNotNull
+import org.junit.Assert.assertTrue
+import org.junit.Assume.assumeTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * Time to first token over a 10-turn chat, with the KV prefix of the previous turn reused and
+ * with the cache cleared before every turn. Needs a GGUF model on the device:
+ *
+ *     adb shell am instrument -w -e llamaModelPath /data/local/tmp/model.gguf \
+ *         -e class com.ai.assistance.operit.api.chat.llmprovider.LlamaPrefixCacheBenchmarkTest ...
+ *
+ * Replies use greedy sampling and are cut after a few tokens, so both runs see the same prompts.
+ */
+@RunWith(AndroidJUnit4::class)
+class LlamaPrefixCacheBenchmarkTest {
+
+    private val systemPrompt = buildString {
+        append("You are a helpful assistant running on a phone. Use the tools below when needed.\n")
+        repeat(12) { index ->
+            append("- tool_$index(path: string, limit: int): reads up to limit entries from path and returns them as JSON.\n")
+        }
+    }
+
+    private val userTurns = listOf(
+        "What can you do?",
+        "List the files in my Download folder.",
+        "Which of them are larger than 10 MB?",
+        "Summarize the biggest PDF in one sentence.",
+        "Translate that summary into French.",
+        "Now make it shorter.",
+        "Draft an email sharing the summary with my team.",
+        "Make the tone more formal.",
+        "Add a subject line.",
+        "Thanks, that's all."
+    )
+
+    private class TurnResult(val firstTokenNanos: Long, val reply: String)
+
+    private fun runTurn(session: LlamaSession, prompt: String): TurnResult {
+        val reply = StringBuilder()
+        var tokens = 0
+        var firstTokenAt = 0L
+        val start = System.nanoTime()
+        val ok = session.generateStream(prompt, 24) { token ->
+            if (firstTokenAt == 0L) firstTokenAt = System.nanoTime()
+            reply.append(token)
+            tokens += 1
+            tokens < 24
+        }
+        assertTrue("generation failed", ok)
+        val end = if (firstTokenAt != 0L) firstTokenAt else System.nanoTime()
+        return TurnResult(end - start, reply.toString())
+    }
+
+    private fun runConversation(session: LlamaSession, reuse: Boolean): List<Long> {
+        val roles = mutableListOf("system")
+        val contents = mutableListOf(systemPrompt)
+        val timings = mutableListOf<Long>()
+
+        session.clearPromptCache()
+        userTurns.forEachIndexed { index, turn ->
+            roles += "user"
+            contents += turn
+            val prompt = session.applyChatTemplate(roles, contents, addAssistant = true)
+            assertNotNull("model has no chat template", prompt)
+            if (!reuse) {
+                session.clearPromptCache()
+            }
+
+            val result = runTurn(session, prompt!!)
+            timings += result.firstTokenNanos
+            roles += "assistant"
+            contents += result.reply
+
+            val stats = session.getPromptCacheStats()
+            println(
+                "llama TTFT [${if (reuse) "reuse" else "no reuse"}] turn ${index + 1}: " +
+                    "${result.firstTokenNanos / 1_000_000} ms, prompt=${stats?.lastPromptTokens}, " +
+                    "reused=${stats?.lastReusedTokens}, decoded=${stats?.lastDecodedTokens}"
+            )
+            if (reuse && index > 0 && stats != null) {
+                assertTrue("no prefix reused on turn ${index + 1}", stats.lastReusedTokens > 0)
+            }
+        }
+        return timings
+    }
+
+    @Test
+    fun timeToFirstTokenOverTenTurns() {
+        val modelPath = InstrumentationRegistry.getArguments().getString("llamaModelPath")
+        assumeTrue("pass -e llamaModelPath <gguf> to run", modelPath != null && File(modelPath).isFile)
+        assumeTrue(LlamaSession.getUnavailableReason(), LlamaSession.isAvailable())
+
+        val session = LlamaSession.create(modelPath!!, nThreads = 4, nCtx = 4096)
+        assertNotNull("failed to create llama session", session)
+        try {
+            session!!.setSamplingParams(
+                temperature = 0f,
+                topP = 1f,
+                topK = 1,
+                repetitionPenalty = 1f,
+                frequencyPenalty = 0f,
+                presencePenalty = 0f
+            )
+
+            val cold = runConversation(session, reuse = false)
+            val warm = runConversation(session, reuse = true)
+            println(
+                "llama TTFT over ${userTurns.size} turns: no reuse ${cold.sum() / 1_000_000} ms, " +
+                    "reuse ${warm.sum() / 1_000_000} ms"
+            )
+        } finally {
+            session?.release()
+        }
+    }
+}
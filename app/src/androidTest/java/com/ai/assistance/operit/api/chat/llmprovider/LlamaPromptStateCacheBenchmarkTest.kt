@@ -0,0 +1,106 @@
+package com.ai.assistance.operit.api.chat.llmprovider
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import com.ai.assistance.llama.LlamaSession
+import java.io.File
+import org.junit.Assert.assertNotNull
+import org.junit.Assert.assertTrue
+import org.junit.Assume.assumeTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * Time to first token of the first request in a new session, as after an app restart: with the
+ * system prompt state saved on disk by an earlier session and without it. Needs a GGUF model:
+ *
+ *     adb shell am instrument -w -e llamaModelPath /data/local/tmp/model.gguf \
+ *         -e class com.ai.assistance.operit.api.chat.llmprovider.LlamaPromptStateCacheBenchmarkTest ...
+ */
+@RunWith(AndroidJUnit4::class)
+class LlamaPromptStateCacheBenchmarkTest {
+
+    private val systemPrompt = buildString {
+        append("You are a helpful assistant running on a phone. Use the tools below when needed.\n")
+        repeat(24) { index ->
+            append("- tool_$index(path: string, limit: int): reads up to limit entries from path and returns them as JSON.\n")
+        }
+    }
+
+    private class FirstRequest(val firstTokenNanos: Long, val reply: String, val restoredTokens: Long)
+
+    private fun firstRequest(modelPath: String, cacheDir: File?): FirstRequest {
+        val session = LlamaSession.create(modelPath, nThreads = 4, nCtx = 4096)
+        assertNotNull("failed to create llama session", session)
+        try {
+            session!!.setSamplingParams(
+                temperature = 0f,
+                topP = 1f,
+                topK = 1,
+                repetitionPenalty = 1f,
+                frequencyPenalty = 0f,
+                presencePenalty = 0f
+            )
+            if (cacheDir != null) {
+                assertTrue(session.setPromptStateCache(cacheDir))
+            }
+            val prompt = session.applyChatTemplate(
+                listOf("system", "user"),
+                listOf(systemPrompt, "What can you do?"),
+                addAssistant = true
+            )
+            assertNotNull("model has no chat template", prompt)
+
+            val reply = StringBuilder()
+            var firstTokenAt = 0L
+            val start = System.nanoTime()
+            val ok = session.generateStream(prompt!!, 16) { token ->
+                if (firstTokenAt == 0L) firstTokenAt = System.nanoTime()
+                reply.append(token)
+                reply.length < 64
+            }
+            assertTrue("generation failed", ok)
+            val end = if (firstTokenAt != 0L) firstTokenAt else System.nanoTime()
+            val restored = session.getPromptCacheStats()?.lastRestoredTokens ?: 0L
+            return FirstRequest(end - start, reply.toString(), restored)
+        } finally {
+            session?.release()
+        }
+    }
+
+    @Test
+    fun firstTokenOfNewSession() {
+        val modelPath = InstrumentationRegistry.getArguments().getString("llamaModelPath")
+        assumeTrue("pass -e llamaModelPath <gguf> to run", modelPath != null && File(modelPath).isFile)
+        assumeTrue(LlamaSession.getUnavailableReason(), LlamaSession.isAvailable())
+
+        val cacheDir = File(InstrumentationRegistry.getInstrumentation().targetContext.cacheDir, "llama_prompt_state_bench")
+        cacheDir.deleteRecursively()
+        try {
+            // an earlier session saves the system prompt
+            val warmer = LlamaSession.create(modelPath!!, nThreads = 4, nCtx = 4096)
+            assertNotNull("failed to create llama session", warmer)
+            try {
+                assertTrue(warmer!!.setPromptStateCache(cacheDir))
+                val prefix = warmer.applyChatTemplate(listOf("system"), listOf(systemPrompt), addAssistant = false)
+                assertNotNull("model has no chat template", prefix)
+                val start = System.nanoTime()
+                assertTrue("prewarm failed", warmer.prewarmPromptState(prefix!!))
+                println("llama prompt state prewarm: ${(System.nanoTime() - start) / 1_000_000} ms")
+            } finally {
+                warmer?.release()
+            }
+
+            val cold = firstRequest(modelPath, cacheDir = null)
+            val warm = firstRequest(modelPath, cacheDir)
+            println(
+                "llama new session TTFT: no state ${cold.firstTokenNanos / 1_000_000} ms, " +
+                    "restored state ${warm.firstTokenNanos / 1_000_000} ms (${warm.restoredTokens} tokens)"
+            )
+            println("llama replies: no state \"${cold.reply}\", restored state \"${warm.reply}\"")
+            assertTrue("no prompt state restored", warm.restoredTokens > 0)
+        } finally {
+            cacheDir.deleteRecursively()
+        }
+    }
+}
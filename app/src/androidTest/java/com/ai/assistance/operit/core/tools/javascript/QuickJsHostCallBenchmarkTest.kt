@@ -0,0 +1,66 @@
+package com.ai.assistance.operit.core.tools.javascript
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * Host call throughput of NativeInterface.__call: a JS loop calling a trivial bridge method,
+ * so the numbers are dominated by the JNI crossing (method name, args and result strings).
+ * Prints calls/sec; run on builds before and after a bridge change to compare.
+ */
+@RunWith(AndroidJUnit4::class)
+class QuickJsHostCallBenchmarkTest {
+
+    private class EchoBridge : QuickJsNativeRuntime.HostBridge {
+        var calls = 0
+
+        override fun onCall(method: String, argsJson: String?): String? {
+            calls += 1
+            return when (method) {
+                "Bench.echo" -> argsJson
+                "Bench.ping" -> "pong"
+                else -> null
+            }
+        }
+    }
+
+    private fun measure(runtime: QuickJsNativeRuntime, label: String, body: String, calls: Int): Double {
+        val script = "(function(){ let last = null; for (let i = 0; i < $calls; i++) { $body } return last; })()"
+        // Warm-up pass (JIT of the bridge, interned names, first allocations).
+        assertTrue(runtime.eval(script, "<bench-warmup>").success)
+
+        var best = 0.0
+        repeat(5) {
+            val start = System.nanoTime()
+            val result = runtime.eval(script, "<bench>")
+            val elapsed = System.nanoTime() - start
+            assertTrue(result.errorMessage ?: "bench failed", result.success)
+            best = maxOf(best, calls * 1_000_000_000.0 / elapsed)
+        }
+        println("QuickJS host call [$label]: ${"%.0f".format(best)} calls/sec")
+        return best
+    }
+
+    @Test
+    fun hostCallThroughput() {
+        val bridge = EchoBridge()
+        QuickJsNativeRuntime.create(bridge).use { runtime ->
+            val calls = 20_000
+            measure(runtime, "no args", "last = NativeInterface.__call('Bench.ping', null);", calls)
+            measure(runtime, "small args", "last = NativeInterface.__call('Bench.echo', '{\"i\":' + i + '}');", calls)
+            measure(
+                runtime,
+                "4KB args",
+                "last = NativeInterface.__call('Bench.echo', '\"' + 'x'.repeat(4096) + '\"');",
+                calls / 4
+            )
+
+            val result = runtime.eval("NativeInterface.__call('Bench.echo', '{\"ok\":true}')")
+            assertEquals("\"{\\\"ok\\\":true}\"", result.valueJson)
+            assertTrue(bridge.calls > calls)
+        }
+    }
+}
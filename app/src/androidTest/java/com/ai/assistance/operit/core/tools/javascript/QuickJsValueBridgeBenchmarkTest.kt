@@ -0,0 +1,82 @@
+package com.ai.assistance.operit.core.tools.javascript
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.json.JSONArray
+import org.json.JSONObject
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * Script entry call as JsEngine makes it, with the params carrying a 1 KB, 100 KB or 10 MB
+ * string: JSON arguments through callFunction against binary arguments through
+ * callFunctionValue. Prints the best time of each; includes the Kotlin-side encoding.
+ */
+@RunWith(AndroidJUnit4::class)
+class QuickJsValueBridgeBenchmarkTest {
+
+    private class SilentBridge : QuickJsNativeRuntime.HostBridge {
+        override fun onCall(method: String, argsJson: String?): String? = null
+    }
+
+    private val entryScript =
+        """
+            globalThis.__benchEntry = function(callId, params, scriptText, functionName, timeoutSec, preTimeoutMs) {
+                return params.content.length + scriptText.length;
+            };
+        """.trimIndent()
+
+    private fun content(bytes: Int): String {
+        val line = "    const value = compute(input, \"option\"); // ünïcode\n"
+        return buildString(bytes) {
+            while (length + line.length <= bytes) append(line)
+        }
+    }
+
+    private fun bestMillis(rounds: Int, body: () -> Unit): Double {
+        body()
+        var best = Long.MAX_VALUE
+        repeat(rounds) {
+            val start = System.nanoTime()
+            body()
+            best = minOf(best, System.nanoTime() - start)
+        }
+        return best / 1_000_000.0
+    }
+
+    @Test
+    fun entryCallArguments() {
+        QuickJsNativeRuntime.create(SilentBridge()).use { runtime ->
+            assertTrue(runtime.eval(entryScript, "<bench-setup>").success)
+            val script = "exports.main = function(params) { return params; };"
+
+            for ((label, bytes) in listOf("1KB" to 1024, "100KB" to 100 * 1024, "10MB" to 10 * 1024 * 1024)) {
+                val params = JSONObject().put("path", "/sdcard/Download/notes.txt").put("content", content(bytes))
+                val expected = params.getString("content").length + script.length
+                val rounds = if (bytes > 1024 * 1024) 5 else 50
+
+                val json = bestMillis(rounds) {
+                    val argsJson = JSONArray()
+                        .put("call-1").put(params).put(script).put("main").put(60L).put(15000L)
+                        .toString()
+                    val result = runtime.callFunction("__benchEntry", argsJson)
+                    assertTrue(result.errorMessage ?: "json call failed", result.success)
+                    assertEquals(expected.toString(), result.valueJson)
+                }
+                val binary = bestMillis(rounds) {
+                    val result = runtime.callFunctionValue(
+                        "__benchEntry",
+                        listOf("call-1", params, script, "main", 60L, 15000L)
+                    )
+                    assertTrue(result.failure?.errorMessage ?: "binary call failed", result.success)
+                    assertEquals(expected, result.value)
+                }
+                println(
+                    "QuickJS entry call [$label]: json ${"%.3f".format(json)} ms, " +
+                        "binary ${"%.3f".format(binary)} ms"
+                )
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+package com.ai.assistance.operit.util.streamnative
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.filters.MediumTest
+import com.ai.assistance.operit.util.markdown.MarkdownProcessorType
+import com.ai.assistance.operit.util.stream.Stream
+import com.ai.assistance.operit.util.stream.StreamGroup
+import com.ai.assistance.operit.util.stream.asStream
+import kotlinx.coroutines.runBlocking
+import org.junit.Assert.assertEquals
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/** Table cell/row markers stay inside the TABLE group; only SEG_BREAK closes a group. */
+@RunWith(AndroidJUnit4::class)
+@MediumTest
+class NativeMarkdownStreamOperatorsTest {
+
+    private val table =
+        "| name | size |\n" +
+            "|:-----|-----:|\n" +
+            "| a.txt | 1 |\n" +
+            "| b.txt | 22 |\n" +
+            "| c.txt | 333 |\n"
+
+    private val text = "Files:\n\n$table\nDone.\n"
+
+    private suspend fun contentsOf(groups: Stream<StreamGroup<MarkdownProcessorType?>>): List<Pair<MarkdownProcessorType?, String>> {
+        val collected = mutableListOf<StreamGroup<MarkdownProcessorType?>>()
+        groups.collect { collected.add(it) }
+        return collected.map { group ->
+            val content = StringBuilder()
+            group.stream.collect { content.append(it) }
+            group.tag to content.toString()
+        }
+    }
+
+    private fun assertOneTableGroup(contents: List<Pair<MarkdownProcessorType?, String>>) {
+        val tables = contents.filter { it.first == MarkdownProcessorType.TABLE }
+        assertEquals("table split into ${contents.map { it.first }}", 1, tables.size)
+        assertEquals(table.trimEnd(), tables[0].second.trimEnd())
+        assertEquals(text, contents.joinToString("") { it.second })
+    }
+
+    @Test
+    fun threeRowTableIsOneGroupPerChar() = runBlocking {
+        assertOneTableGroup(contentsOf(text.asSequence().asStream().nativeMarkdownSplitByBlock()))
+    }
+
+    @Test
+    fun threeRowTableIsOneGroupPerLine() = runBlocking {
+        val lines = text.split('\n').dropLast(1).map { "$it\n" }
+        assertOneTableGroup(contentsOf(lines.asSequence().asStream().nativeMarkdownSplitByBlock()))
+    }
+
+    @Test
+    fun threeRowTableIsOneGroupWhenBatched() = runBlocking {
+        assertOneTableGroup(
+            contentsOf(text.asSequence().asStream().nativeMarkdownSplitByBlock(maxDeltaChars = 7))
+        )
+    }
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace streamnative {
+
+// Aho–Corasick automaton over a growing set of delimiters. Patterns are registered once
+// and referred to by id. Transitions are resolved lazily into a goto table indexed by
+// char class, so once warm every char costs one table load no matter how many patterns
+// are registered, and registering a pattern only relinks the trie instead of rebuilding
+// the whole table.
+//
+// Cursors are plain state ints owned by the caller. Registering a pattern invalidates
+// existing cursors, so callers reset theirs to kRootState after addPattern.
+class AhoCorasickMatcher {
+public:
+    static constexpr int kRootState = 0;
+    static constexpr int kNoPattern = -1;
+
+    AhoCorasickMatcher() { clear(); }
+
+    // Returns the id of p, registering it if needed. Empty patterns are rejected.
+    int addPattern(const std::u16string& p) {
+        if (p.empty()) {
+            return kNoPattern;
+        }
+        const int existing = findPattern(p);
+        if (existing != kNoPattern) {
+            return existing;
+        }
+
+        const int id = static_cast<int>(patternNodes_.size());
+        int s = kRootState;
+        for (char16_t c : p) {
+            int child = childOf(s, c);
+            if (child < 0) {
+                child = static_cast<int>(children_.size());
+                children_[static_cast<size_t>(s)].push_back({c, child});
+                children_.emplace_back();
+                terminal_.push_back(kNoPattern);
+                addCharClass(c);
+            }
+            s = child;
+        }
+        terminal_[static_cast<size_t>(s)] = id;
+        patternNodes_.push_back(s);
+        dirty_ = true;
+        return id;
+    }
+
+    int findPattern(const std::u16string& p) const {
+        int s = kRootState;
+        for (char16_t c : p) {
+            s = childOf(s, c);
+            if (s < 0) {
+                return kNoPattern;
+            }
+        }
+        return terminal_[static_cast<size_t>(s)];
+    }
+
+    int patternCount() const { return static_cast<int>(patternNodes_.size()); }
+
+    void clear() {
+        children_.assign(1, {});
+        terminal_.assign(1, kNoPattern);
+        patternNodes_.clear();
+        std::fill(std::begin(asciiClass_), std::end(asciiClass_), static_cast<uint8_t>(0));
+        asciiClassCount_ = 1;
+        wideChars_.clear();
+        dirty_ = true;
+    }
+
+    int step(int state, char16_t c) {
+        if (dirty_) {
+            relink();
+        }
+        int& next = next_[static_cast<size_t>(state) * width_ + static_cast<size_t>(classOf(c))];
+        if (next < 0) {
+            next = resolve(state, c);
+        }
+        return next;
+    }
+
+    // True when pattern id ends at the char that led to state.
+    bool matches(int state, int id) const {
+        for (int s = output_[static_cast<size_t>(state)]; s != kNoPattern;
+             s = output_[static_cast<size_t>(fail_[static_cast<size_t>(s)])]) {
+            if (terminal_[static_cast<size_t>(s)] == id) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Length of the longest suffix of the input that led to state which is a prefix of p,
+    // i.e. how far a single-pattern matcher for p would be. p must be registered.
+    int prefixMatched(int state, const std::u16string& p) const {
+        for (int s = state; s != kRootState; s = fail_[static_cast<size_t>(s)]) {
+            int node = kRootState;
+            int depth = 0;
+            while (depth < static_cast<int>(p.size()) && node != s) {
+                node = childOf(node, p[static_cast<size_t>(depth)]);
+                depth++;
+            }
+            if (node == s) {
+                return depth;
+            }
+        }
+        return 0;
+    }
+
+    // State after reading the first length chars of the registered pattern p.
+    int prefixState(const std::u16string& p, int length) const {
+        int s = kRootState;
+        for (int i = 0; i < length; i++) {
+            s = childOf(s, p[static_cast<size_t>(i)]);
+        }
+        return s;
+    }
+
+private:
+    int childOf(int state, char16_t c) const {
+        for (const auto& edge : children_[static_cast<size_t>(state)]) {
+            if (edge.first == c) {
+                return edge.second;
+            }
+        }
+        return -1;
+    }
+
+    void addCharClass(char16_t c) {
+        if (c < 128) {
+            if (asciiClass_[c] == 0) {
+                asciiClass_[c] = static_cast<uint8_t>(asciiClassCount_++);
+            }
+            return;
+        }
+        const auto it = std::lower_bound(wideChars_.begin(), wideChars_.end(), c);
+        if (it == wideChars_.end() || *it != c) {
+            wideChars_.insert(it, c);
+        }
+    }
+
+    // 0 for chars in no pattern (they always lead back to the root), then one class
+    // per distinct ASCII pattern char, then one per wide pattern char.
+    int classOf(char16_t c) const {
+        if (c < 128) {
+            return asciiClass_[c];
+        }
+        const auto it = std::lower_bound(wideChars_.begin(), wideChars_.end(), c);
+        if (it == wideChars_.end() || *it != c) {
+            return 0;
+        }
+        return asciiClassCount_ + static_cast<int>(it - wideChars_.begin());
+    }
+
+    int resolve(int state, char16_t c) {
+        const int child = childOf(state, c);
+        if (child >= 0) {
+            return child;
+        }
+        if (state == kRootState) {
+            return kRootState;
+        }
+        return step(fail_[static_cast<size_t>(state)], c);
+    }
+
+    // Recomputes failure and output links breadth-first and drops resolved transitions.
+    void relink() {
+        dirty_ = false;
+        const size_t nodes = children_.size();
+        width_ = static_cast<size_t>(asciiClassCount_) + wideChars_.size();
+        next_.assign(nodes * width_, -1);
+        fail_.assign(nodes, kRootState);
+        output_.assign(nodes, kNoPattern);
+
+        queue_.clear();
+        for (const auto& edge : children_[kRootState]) {
+            queue_.push_back(edge.second);
+        }
+        for (size_t qi = 0; qi < queue_.size(); qi++) {
+            const int u = queue_[qi];
+            const int f = fail_[static_cast<size_t>(u)];
+            output_[static_cast<size_t>(u)] = (terminal_[static_cast<size_t>(u)] != kNoPattern)
+                    ? u
+                    : output_[static_cast<size_t>(f)];
+            for (const auto& edge : children_[static_cast<size_t>(u)]) {
+                int g = f;
+                int link = childOf(g, edge.first);
+                while (link < 0 && g != kRootState) {
+                    g = fail_[static_cast<size_t>(g)];
+                    link = childOf(g, edge.first);
+                }
+                fail_[static_cast<size_t>(edge.second)] = (link >= 0) ? link : kRootState;
+                queue_.push_back(edge.second);
+            }
+        }
+    }
+
+    // Trie
+    std::vector<std::vector<std::pair<char16_t, int>>> children_;
+    std::vector<int> terminal_; // pattern id ending exactly at a node
+    std::vector<int> patternNodes_;
+
+    uint8_t asciiClass_[128] = {};
+    int asciiClassCount_ = 1;
+    std::vector<char16_t> wideChars_;
+
+    // Links, rebuilt by relink()
+    bool dirty_ = true;
+    size_t width_ = 1;
+    std::vector<int> next_;
+    std::vector<int> fail_;
+    std::vector<int> output_; // nearest node on the suffix chain that ends a pattern
+    std::vector<int> queue_;
+};
+
+} // namespace streamnative
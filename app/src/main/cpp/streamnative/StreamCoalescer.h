@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "StreamGroup.h"
+#include "StreamSnapshot.h"
+
+namespace streamnative {
+
+// Holds back the segments of consecutive pushes and hands them out as one delta once a
+// budget runs out: maxChars input units pushed, or maxDelayNanos since the first push of
+// the delta, or a SEG_BREAK (the group it closes should render without delay). Runs that
+// continue across pushes (same type, contiguous) are merged, so a token-by-token stream of
+// plain text becomes one segment per delta. A zero budget is not checked; with both zero
+// coalescing is off.
+//
+// Budgets are only checked when a push arrives: a stalled stream keeps its last delta until
+// the owner flushes (end of message, or its own timer).
+template <typename S>
+class SegmentCoalescer {
+public:
+    void configure(int maxChars, int64_t maxDelayNanos) {
+        maxChars_ = maxChars > 0 ? maxChars : 0;
+        maxDelayNanos_ = maxDelayNanos > 0 ? maxDelayNanos : 0;
+    }
+
+    bool enabled() const { return maxChars_ > 0 || maxDelayNanos_ > 0; }
+
+    // Takes the segments of one push of chars input units at time now. Returns true when the
+    // pending delta is due.
+    bool add(const S* segments, size_t count, int chars, int64_t now) {
+        if (pendingChars_ == 0 && pending_.empty()) {
+            firstPushNanos_ = now;
+        }
+        pendingChars_ += chars;
+        bool due = false;
+        for (size_t i = 0; i < count; i++) {
+            const S& s = segments[i];
+            if (s.type == kBreakType) {
+                due = true;
+            } else if (!pending_.empty() && pending_.back().type == s.type && pending_.back().end == s.start) {
+                extend(pending_.back(), s);
+                continue;
+            }
+            pending_.push_back(s);
+        }
+        return due || (maxChars_ > 0 && pendingChars_ >= maxChars_) ||
+               (maxDelayNanos_ > 0 && now - firstPushNanos_ >= maxDelayNanos_);
+    }
+
+    // Appends the pending delta to out and starts a new one.
+    void drain(std::vector<S>& out) {
+        out.insert(out.end(), pending_.begin(), pending_.end());
+        pending_.clear();
+        pendingChars_ = 0;
+    }
+
+    // The pending delta is saved, not its age: after a restore it counts from the next push.
+    void saveState(SnapshotWriter& out) const {
+        out.putUInt(static_cast<uint64_t>(maxChars_));
+        out.putInt(maxDelayNanos_);
+        out.putUInt(static_cast<uint64_t>(pendingChars_));
+        out.putUInt(pending_.size());
+        for (const auto& s : pending_) {
+            put(out, s);
+        }
+    }
+
+    bool restoreState(SnapshotReader& in) {
+        uint32_t maxChars = 0;
+        int64_t maxDelayNanos = 0;
+        uint32_t pendingChars = 0;
+        uint32_t count = 0;
+        if (!in.getUInt(maxChars, INT32_MAX) || !in.getInt(maxDelayNanos) ||
+            !in.getUInt(pendingChars, INT32_MAX) || !in.getUInt(count, static_cast<uint32_t>(in.remaining()))) {
+            return false;
+        }
+        configure(static_cast<int>(maxChars), maxDelayNanos);
+        pendingChars_ = static_cast<int>(pendingChars);
+        pending_.resize(count);
+        for (auto& s : pending_) {
+            if (!get(in, s)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Must match SEG_BREAK in StreamOperators.cpp.
+    static constexpr int kBreakType = -1;
+
+    static void extend(Segment& run, const Segment& next) { run.end = next.end; }
+    static void extend(Utf8Segment& run, const Utf8Segment& next) {
+        run.end = next.end;
+        run.byteEnd = next.byteEnd;
+    }
+
+    static void put(SnapshotWriter& out, const Segment& s) {
+        out.putInt(s.type);
+        out.putInt(s.start);
+        out.putInt(s.end);
+    }
+    static void put(SnapshotWriter& out, const Utf8Segment& s) {
+        out.putInt(s.type);
+        out.putInt(s.start);
+        out.putInt(s.end);
+        out.putInt(s.byteStart);
+        out.putInt(s.byteEnd);
+    }
+
+    static bool get(SnapshotReader& in, Segment& s) {
+        return in.getInt(s.type) && in.getInt(s.start) && in.getInt(s.end);
+    }
+    static bool get(SnapshotReader& in, Utf8Segment& s) {
+        return in.getInt(s.type) && in.getInt(s.start) && in.getInt(s.end) &&
+               in.getInt(s.byteStart) && in.getInt(s.byteEnd);
+    }
+
+    int maxChars_ = 0;
+    int64_t maxDelayNanos_ = 0;
+
+    std::vector<S> pending_;
+    int pendingChars_ = 0;
+    int64_t firstPushNanos_ = 0;
+};
+
+} // namespace streamnative
@@ -10,4 +10,14 @@ struct Segment {
     int end;
 };
 
+// Segment of a UTF-8 stream: start/end in UTF-16 units as in Segment, and the same bounds
+// in bytes of the UTF-8 input.
+struct Utf8Segment {
+    int type;
+    int start;
+    int end;
+    int byteStart;
+    int byteEnd;
+};
+
 } // namespace streamnative
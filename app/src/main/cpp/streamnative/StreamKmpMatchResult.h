@@ -1,11 +0,0 @@
-#pragma once
-
-namespace streamnative {
-
-enum class StreamKmpMatchResult {
-    Match,
-    InProgress,
-    NoMatch,
-};
-
-} // namespace streamnative
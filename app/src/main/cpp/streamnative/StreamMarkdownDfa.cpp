@@ -0,0 +1,492 @@
+#include "StreamMarkdownDfa.h"
+
+#include <array>
+#include <utility>
+
+namespace streamnative {
+
+namespace {
+
+// Char classes distinguished by at least one start automaton.
+enum CharClass : uint8_t {
+    CC_OTHER,
+    CC_NEWLINE,
+    CC_SPACE,
+    CC_TAB,
+    CC_HASH,
+    CC_BACKTICK,
+    CC_GT,
+    CC_LT,
+    CC_DIGIT,
+    CC_DOT,
+    CC_MINUS,
+    CC_PLUS,
+    CC_STAR,
+    CC_UNDERSCORE,
+    CC_DOLLAR,
+    CC_BACKSLASH,
+    CC_LBRACKET,
+    CC_RBRACKET,
+    CC_LPAREN,
+    CC_PIPE,
+    CC_BANG,
+    CC_SLASH,
+    CC_TILDE,
+    CC_LETTER,
+    CC_XML_PUNCT, // StreamXmlPlugin punctuation triggers without a class of their own
+    CC_EMOJI,
+    CC_EMOJI_CONTINUATION,
+    CC_COUNT,
+};
+
+static_assert(CC_COUNT * 2 == MarkdownStartDfa::kInputCount, "kInputCount must cover every class x start-of-line");
+
+constexpr uint8_t kAccept = 0xFF;
+constexpr int kStateBits = 4;
+constexpr uint64_t kStateMask = (1u << kStateBits) - 1u;
+
+constexpr std::array<uint8_t, 128> buildAsciiClasses() {
+    std::array<uint8_t, 128> classes{};
+    for (int c = 0; c < 128; c++) {
+        uint8_t cls = CC_OTHER;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) cls = CC_LETTER;
+        else if (c >= '0' && c <= '9') cls = CC_DIGIT;
+        else if (c == '\n') cls = CC_NEWLINE;
+        else if (c == ' ') cls = CC_SPACE;
+        else if (c == '\t') cls = CC_TAB;
+        else if (c == '#') cls = CC_HASH;
+        else if (c == '`') cls = CC_BACKTICK;
+        else if (c == '>') cls = CC_GT;
+        else if (c == '<') cls = CC_LT;
+        else if (c == '.') cls = CC_DOT;
+        else if (c == '-') cls = CC_MINUS;
+        else if (c == '+') cls = CC_PLUS;
+        else if (c == '*') cls = CC_STAR;
+        else if (c == '_') cls = CC_UNDERSCORE;
+        else if (c == '$') cls = CC_DOLLAR;
+        else if (c == '\\') cls = CC_BACKSLASH;
+        else if (c == '[') cls = CC_LBRACKET;
+        else if (c == ']') cls = CC_RBRACKET;
+        else if (c == '(') cls = CC_LPAREN;
+        else if (c == '|') cls = CC_PIPE;
+        else if (c == '!') cls = CC_BANG;
+        else if (c == '/') cls = CC_SLASH;
+        else if (c == '~') cls = CC_TILDE;
+        else if (c == ',' || c == ':' || c == '?') cls = CC_XML_PUNCT;
+        classes[static_cast<size_t>(c)] = cls;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 128> kAsciiClasses = buildAsciiClasses();
+
+// Must stay in sync with StreamXmlPlugin::isPunctuationTrigger / isEmojiTrigger / isEmojiContinuationChar.
+constexpr uint8_t classOf(char16_t c) {
+    if (c < 0x80) {
+        return kAsciiClasses[c];
+    }
+    switch (c) {
+        case u'\uFF0C': // ，
+        case u'\u3002': // 。
+        case u'\uFF1F': // ？
+        case u'\uFF01': // ！
+        case u'\uFF1A': // ：
+        case u'\uFF08': // （
+        case u'\uFF09': // ）
+        case u'\u3010': // 【
+        case u'\u3011': // 】
+        case u'\u300A': // 《
+        case u'\u300B': // 》
+        case u'\uFF5E': // ～
+        case u'\uFF1E': // ＞
+            return CC_XML_PUNCT;
+        case u'\u200D':
+        case u'\uFE0E':
+        case u'\uFE0F':
+        case u'\u20E3':
+            return CC_EMOJI_CONTINUATION;
+        default:
+            break;
+    }
+    if ((c >= u'\xD800' && c <= u'\xDFFF') ||
+        (c >= u'\x2300' && c <= u'\x23FF') ||
+        (c >= u'\x2600' && c <= u'\x27BF') ||
+        (c >= u'\x2B00' && c <= u'\x2BFF')) {
+        return CC_EMOJI;
+    }
+    return CC_OTHER;
+}
+
+// --- Start automata. State 0 is IDLE; every other state is TRYING. ---
+// Each mirrors the IDLE/TRYING branches of the matching plugin's processChar.
+
+// 1..6: number of '#', 7: more than six.
+constexpr uint8_t stepHeader(int s, int cls, bool sol) {
+    if (s == 0) {
+        return (sol && cls == CC_HASH) ? 1 : 0;
+    }
+    if (cls == CC_HASH) {
+        return static_cast<uint8_t>(s < 7 ? s + 1 : 7);
+    }
+    return (cls == CC_SPACE && s <= 6) ? kAccept : 0;
+}
+
+// 1..3: number of backticks (3 = three or more, rest of the opening line).
+constexpr uint8_t stepFencedCode(int s, int cls, bool /*sol*/) {
+    if (s == 0) {
+        return cls == CC_BACKTICK ? 1 : 0;
+    }
+    if (cls == CC_BACKTICK) {
+        return static_cast<uint8_t>(s < 3 ? s + 1 : 3);
+    }
+    if (cls == CC_NEWLINE) {
+        return s == 3 ? kAccept : 0;
+    }
+    return s == 3 ? 3 : 0;
+}
+
+constexpr uint8_t stepBlockQuote(int s, int cls, bool sol) {
+    if (cls == CC_NEWLINE) return 0;
+    if (s == 0) return (sol && cls == CC_GT) ? 1 : 0;
+    return cls == CC_SPACE ? kAccept : 0;
+}
+
+// 1: digits, 2: digits + '.'
+constexpr uint8_t stepOrderedList(int s, int cls, bool sol) {
+    if (s == 0) return (sol && cls == CC_DIGIT) ? 1 : 0;
+    if (s == 1) return cls == CC_DIGIT ? 1 : (cls == CC_DOT ? 2 : 0);
+    return cls == CC_SPACE ? kAccept : 0;
+}
+
+constexpr uint8_t stepUnorderedList(int s, int cls, bool sol) {
+    if (s == 0) return (sol && (cls == CC_MINUS || cls == CC_PLUS || cls == CC_STAR)) ? 1 : 0;
+    return cls == CC_SPACE ? kAccept : 0;
+}
+
+// 1 + marker * 2 + (count - 1), marker 0:'-' 1:'*' 2:'_', count 1..2.
+constexpr uint8_t stepHorizontalRule(int s, int cls, bool sol) {
+    if (cls == CC_NEWLINE) return 0;
+    if (s == 0) {
+        if (!sol) return 0;
+        if (cls == CC_MINUS) return 1;
+        if (cls == CC_STAR) return 3;
+        if (cls == CC_UNDERSCORE) return 5;
+        return 0;
+    }
+    const int marker = (s - 1) / 2;
+    const int count = (s - 1) % 2 + 1;
+    const int markerCls = marker == 0 ? CC_MINUS : (marker == 1 ? CC_STAR : CC_UNDERSCORE);
+    if (cls == markerCls) return count + 1 >= 3 ? kAccept : static_cast<uint8_t>(s + 1);
+    if (cls == CC_SPACE || cls == CC_TAB) return static_cast<uint8_t>(s);
+    return 0;
+}
+
+constexpr uint8_t stepBlockLaTeX(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_DOLLAR ? 1 : 0;
+    return cls == CC_DOLLAR ? kAccept : 0;
+}
+
+constexpr uint8_t stepBlockBracketLaTeX(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_BACKSLASH ? 1 : 0;
+    return cls == CC_LBRACKET ? kAccept : 0;
+}
+
+constexpr uint8_t stepTable(int /*s*/, int cls, bool sol) {
+    return (sol && cls == CC_PIPE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepImage(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_BANG ? 1 : 0;
+    return cls == CC_LBRACKET ? kAccept : 0;
+}
+
+// Idle states 0..3 encode the start allowance (afterEndTag * 2 + afterPunctuation).
+// Trying states are 4 + afterEndTag * 4 + phase, phase 0:'<' 1:tag name 2:attrs 3:attrs after '/'.
+constexpr uint8_t stepXml(int s, int cls, bool sol) {
+    const bool punct = cls == CC_XML_PUNCT || cls == CC_DOT || cls == CC_BANG || cls == CC_TILDE ||
+                       cls == CC_GT || cls == CC_EMOJI;
+    const uint8_t cleared = punct ? 1 : 0;
+    if (s < 4) {
+        const int endTag = s >> 1;
+        if (!sol) {
+            if (s == 0) return cleared;
+            if (cls == CC_SPACE || cls == CC_TAB || cls == CC_EMOJI_CONTINUATION) return static_cast<uint8_t>(s);
+        }
+        if (cls == CC_LT) return static_cast<uint8_t>(4 + endTag * 4);
+        return cleared;
+    }
+    const int endTag = (s - 4) / 4;
+    const int phase = (s - 4) % 4;
+    const int base = 4 + endTag * 4;
+    if (phase == 0) {
+        return cls == CC_LETTER ? static_cast<uint8_t>(base + 1) : cleared;
+    }
+    if (phase == 1) {
+        if (cls == CC_SPACE) return static_cast<uint8_t>(base + 2);
+        if (cls == CC_GT) return kAccept;
+        if (cls == CC_LETTER || cls == CC_DIGIT || cls == CC_UNDERSCORE) return static_cast<uint8_t>(s);
+        return cleared;
+    }
+    if (cls == CC_GT) {
+        // "<tag .../>" is plain text and keeps the end-tag allowance.
+        return phase == 3 ? static_cast<uint8_t>(endTag * 2) : kAccept;
+    }
+    return static_cast<uint8_t>(cls == CC_SLASH ? base + 3 : base + 2);
+}
+
+// 1: '*', 2: '**'
+constexpr uint8_t stepBold(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_STAR ? 1 : 0;
+    if (s == 1) return cls == CC_STAR ? 2 : 0;
+    return (cls != CC_STAR && cls != CC_NEWLINE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepItalic(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_STAR ? 1 : 0;
+    // "**" drops back to idle without restarting.
+    return (cls != CC_STAR && cls != CC_NEWLINE && cls != CC_SPACE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepInlineCode(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_BACKTICK ? 1 : 0;
+    return (cls != CC_BACKTICK && cls != CC_NEWLINE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepLink(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_LBRACKET ? 1 : 0;
+    if (cls == CC_NEWLINE) return 0;
+    return cls == CC_RBRACKET ? kAccept : 1;
+}
+
+template <int Delimiter>
+constexpr uint8_t stepDoubleDelimiter(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == Delimiter ? 1 : 0;
+    if (s == 1) return cls == Delimiter ? 2 : 0;
+    return (cls != Delimiter && cls != CC_NEWLINE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepInlineLaTeX(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_DOLLAR ? 1 : 0;
+    return (cls != CC_DOLLAR && cls != CC_NEWLINE) ? kAccept : 0;
+}
+
+constexpr uint8_t stepInlineParenLaTeX(int s, int cls, bool /*sol*/) {
+    if (s == 0) return cls == CC_BACKSLASH ? 1 : 0;
+    if (s == 1) return cls == CC_LPAREN ? 2 : 0;
+    return cls != CC_NEWLINE ? kAccept : 0;
+}
+
+using StepFn = uint8_t (*)(int, int, bool);
+
+template <int States, StepFn Step>
+constexpr std::array<uint8_t, States * MarkdownStartDfa::kInputCount> buildTable() {
+    std::array<uint8_t, States * MarkdownStartDfa::kInputCount> table{};
+    for (int s = 0; s < States; s++) {
+        for (int input = 0; input < MarkdownStartDfa::kInputCount; input++) {
+            table[static_cast<size_t>(s * MarkdownStartDfa::kInputCount + input)] =
+                    Step(s, input / 2, (input % 2) != 0);
+        }
+    }
+    return table;
+}
+
+constexpr auto kHeaderTable = buildTable<8, stepHeader>();
+constexpr auto kFencedCodeTable = buildTable<4, stepFencedCode>();
+constexpr auto kBlockQuoteTable = buildTable<2, stepBlockQuote>();
+constexpr auto kOrderedListTable = buildTable<3, stepOrderedList>();
+constexpr auto kUnorderedListTable = buildTable<2, stepUnorderedList>();
+constexpr auto kHorizontalRuleTable = buildTable<7, stepHorizontalRule>();
+constexpr auto kBlockLaTeXTable = buildTable<2, stepBlockLaTeX>();
+constexpr auto kBlockBracketLaTeXTable = buildTable<2, stepBlockBracketLaTeX>();
+constexpr auto kTableTable = buildTable<1, stepTable>();
+constexpr auto kImageTable = buildTable<2, stepImage>();
+constexpr auto kXmlTable = buildTable<12, stepXml>();
+constexpr auto kBoldTable = buildTable<3, stepBold>();
+constexpr auto kItalicTable = buildTable<2, stepItalic>();
+constexpr auto kInlineCodeTable = buildTable<2, stepInlineCode>();
+constexpr auto kLinkTable = buildTable<2, stepLink>();
+constexpr auto kStrikethroughTable = buildTable<3, stepDoubleDelimiter<CC_TILDE>>();
+constexpr auto kUnderlineTable = buildTable<3, stepDoubleDelimiter<CC_UNDERSCORE>>();
+constexpr auto kInlineLaTeXTable = buildTable<2, stepInlineLaTeX>();
+constexpr auto kInlineParenLaTeXTable = buildTable<3, stepInlineParenLaTeX>();
+
+const uint8_t* tableFor(StartAutomaton automaton) {
+    switch (automaton) {
+        case StartAutomaton::Header: return kHeaderTable.data();
+        case StartAutomaton::FencedCodeBlock: return kFencedCodeTable.data();
+        case StartAutomaton::BlockQuote: return kBlockQuoteTable.data();
+        case StartAutomaton::OrderedList: return kOrderedListTable.data();
+        case StartAutomaton::UnorderedList: return kUnorderedListTable.data();
+        case StartAutomaton::HorizontalRule: return kHorizontalRuleTable.data();
+        case StartAutomaton::BlockLaTeX: return kBlockLaTeXTable.data();
+        case StartAutomaton::BlockBracketLaTeX: return kBlockBracketLaTeXTable.data();
+        case StartAutomaton::Table: return kTableTable.data();
+        case StartAutomaton::Image: return kImageTable.data();
+        case StartAutomaton::Xml: return kXmlTable.data();
+        case StartAutomaton::Bold: return kBoldTable.data();
+        case StartAutomaton::Italic: return kItalicTable.data();
+        case StartAutomaton::InlineCode: return kInlineCodeTable.data();
+        case StartAutomaton::Link: return kLinkTable.data();
+        case StartAutomaton::Strikethrough: return kStrikethroughTable.data();
+        case StartAutomaton::Underline: return kUnderlineTable.data();
+        case StartAutomaton::InlineLaTeX: return kInlineLaTeXTable.data();
+        case StartAutomaton::InlineParenLaTeX: return kInlineParenLaTeXTable.data();
+    }
+    return kTableTable.data();
+}
+
+int stateCountFor(StartAutomaton automaton) {
+    constexpr size_t n = MarkdownStartDfa::kInputCount;
+    switch (automaton) {
+        case StartAutomaton::Header: return static_cast<int>(kHeaderTable.size() / n);
+        case StartAutomaton::FencedCodeBlock: return static_cast<int>(kFencedCodeTable.size() / n);
+        case StartAutomaton::BlockQuote: return static_cast<int>(kBlockQuoteTable.size() / n);
+        case StartAutomaton::OrderedList: return static_cast<int>(kOrderedListTable.size() / n);
+        case StartAutomaton::UnorderedList: return static_cast<int>(kUnorderedListTable.size() / n);
+        case StartAutomaton::HorizontalRule: return static_cast<int>(kHorizontalRuleTable.size() / n);
+        case StartAutomaton::BlockLaTeX: return static_cast<int>(kBlockLaTeXTable.size() / n);
+        case StartAutomaton::BlockBracketLaTeX: return static_cast<int>(kBlockBracketLaTeXTable.size() / n);
+        case StartAutomaton::Table: return static_cast<int>(kTableTable.size() / n);
+        case StartAutomaton::Image: return static_cast<int>(kImageTable.size() / n);
+        case StartAutomaton::Xml: return static_cast<int>(kXmlTable.size() / n);
+        case StartAutomaton::Bold: return static_cast<int>(kBoldTable.size() / n);
+        case StartAutomaton::Italic: return static_cast<int>(kItalicTable.size() / n);
+        case StartAutomaton::InlineCode: return static_cast<int>(kInlineCodeTable.size() / n);
+        case StartAutomaton::Link: return static_cast<int>(kLinkTable.size() / n);
+        case StartAutomaton::Strikethrough: return static_cast<int>(kStrikethroughTable.size() / n);
+        case StartAutomaton::Underline: return static_cast<int>(kUnderlineTable.size() / n);
+        case StartAutomaton::InlineLaTeX: return static_cast<int>(kInlineLaTeXTable.size() / n);
+        case StartAutomaton::InlineParenLaTeX: return static_cast<int>(kInlineParenLaTeXTable.size() / n);
+    }
+    return 1;
+}
+
+inline int componentState(uint64_t packed, int index) {
+    return static_cast<int>((packed >> (static_cast<uint64_t>(index) * kStateBits)) & kStateMask);
+}
+
+} // namespace
+
+MarkdownStartDfa::MarkdownStartDfa(std::vector<StartAutomaton> automata)
+        : automata_(std::move(automata)) {
+    for (int i = 0; i < static_cast<int>(automata_.size()); i++) {
+        if (automata_[static_cast<size_t>(i)] == StartAutomaton::Xml) {
+            xmlIndex_ = i;
+        }
+    }
+    packed_.reserve(64);
+    idle_.reserve(64);
+    transitions_.reserve(64 * kInputCount);
+    acceptXml_.reserve(64 * kInputCount);
+}
+
+int MarkdownStartDfa::inputOf(char16_t c, bool atStartOfLine) {
+    return classOf(c) * 2 + (atStartOfLine ? 1 : 0);
+}
+
+int MarkdownStartDfa::idleState(bool xmlAfterEndTag, bool xmlAfterPunctuation) {
+    uint64_t packed = 0;
+    if (xmlIndex_ >= 0) {
+        const uint64_t xml = (xmlAfterEndTag ? 2u : 0u) | (xmlAfterPunctuation ? 1u : 0u);
+        packed = xml << (static_cast<uint64_t>(xmlIndex_) * kStateBits);
+    }
+    return intern(packed);
+}
+
+void MarkdownStartDfa::decodeXml(int s, bool& afterEndTag, bool& afterPunctuation) const {
+    if (s < 4) {
+        afterEndTag = (s & 2) != 0;
+        afterPunctuation = (s & 1) != 0;
+    } else {
+        // TRYING already cleared the punctuation allowance.
+        afterEndTag = (s - 4) / 4 != 0;
+        afterPunctuation = false;
+    }
+}
+
+void MarkdownStartDfa::xmlAllowance(int state, bool& afterEndTag, bool& afterPunctuation) const {
+    afterEndTag = false;
+    afterPunctuation = false;
+    if (xmlIndex_ >= 0) {
+        decodeXml(componentState(packed_[static_cast<size_t>(state)], xmlIndex_), afterEndTag, afterPunctuation);
+    }
+}
+
+void MarkdownStartDfa::xmlAllowanceOnAccept(int state, char16_t c, bool atStartOfLine,
+                                            bool& afterEndTag, bool& afterPunctuation) const {
+    afterEndTag = false;
+    afterPunctuation = false;
+    if (xmlIndex_ >= 0) {
+        const size_t slot = static_cast<size_t>(state) * kInputCount + static_cast<size_t>(inputOf(c, atStartOfLine));
+        decodeXml(acceptXml_[slot], afterEndTag, afterPunctuation);
+    }
+}
+
+int MarkdownStartDfa::stateFromPacked(uint64_t packed) {
+    const auto count = static_cast<uint64_t>(automata_.size());
+    if (count * kStateBits < 64u && (packed >> (count * kStateBits)) != 0u) {
+        return -1;
+    }
+    for (int i = 0; i < static_cast<int>(automata_.size()); i++) {
+        if (componentState(packed, i) >= stateCountFor(automata_[static_cast<size_t>(i)])) {
+            return -1;
+        }
+    }
+    return intern(packed);
+}
+
+int MarkdownStartDfa::intern(uint64_t packed) {
+    auto it = ids_.find(packed);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    const int id = static_cast<int>(packed_.size());
+    ids_.emplace(packed, id);
+    packed_.push_back(packed);
+
+    bool idle = true;
+    for (int i = 0; i < static_cast<int>(automata_.size()); i++) {
+        const int s = componentState(packed, i);
+        if (i == xmlIndex_ ? s >= 4 : s != 0) {
+            idle = false;
+            break;
+        }
+    }
+    idle_.push_back(idle ? 1u : 0u);
+    transitions_.resize(transitions_.size() + kInputCount, kUnknown);
+    acceptXml_.resize(acceptXml_.size() + kInputCount, 0u);
+    return id;
+}
+
+int MarkdownStartDfa::computeTransition(int state, int input) {
+    const uint64_t packed = packed_[static_cast<size_t>(state)];
+    uint64_t next = 0;
+    int winner = -1;
+    for (int i = 0; i < static_cast<int>(automata_.size()); i++) {
+        const int s = componentState(packed, i);
+        const uint8_t r = tableFor(automata_[static_cast<size_t>(i)])[s * kInputCount + input];
+        if (r == kAccept) {
+            if (winner < 0) {
+                winner = i;
+            }
+            continue;
+        }
+        next |= static_cast<uint64_t>(r) << (static_cast<uint64_t>(i) * kStateBits);
+    }
+
+    int code;
+    if (winner >= 0) {
+        code = kAcceptBase - winner;
+        // Accepting steps do not produce a product state, so keep the XML outcome for losers.
+        if (xmlIndex_ >= 0 && xmlIndex_ != winner) {
+            acceptXml_[static_cast<size_t>(state) * kInputCount + static_cast<size_t>(input)] =
+                    static_cast<uint8_t>(componentState(next, xmlIndex_));
+        }
+    } else {
+        code = intern(next);
+    }
+    transitions_[static_cast<size_t>(state) * kInputCount + static_cast<size_t>(input)] = code;
+    return code;
+}
+
+} // namespace streamnative
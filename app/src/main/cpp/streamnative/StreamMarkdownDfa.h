@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace streamnative {
+
+// Start-condition automaton of each markdown plugin class (IDLE/TRYING part only).
+enum class StartAutomaton : uint8_t {
+    Header,
+    FencedCodeBlock,
+    BlockQuote,
+    OrderedList,
+    UnorderedList,
+    HorizontalRule,
+    BlockLaTeX,
+    BlockBracketLaTeX,
+    Table,
+    Image,
+    Xml,
+    Bold,
+    Italic,
+    InlineCode,
+    Link,
+    Strikethrough,
+    Underline,
+    InlineLaTeX,
+    InlineParenLaTeX,
+};
+
+// Product of the start automata of a plugin set.
+// Per-plugin transition tables are built at compile time; their product is
+// determinized lazily (only reachable states, cached per instance), so each char
+// costs one table lookup once a transition has been seen.
+class MarkdownStartDfa {
+public:
+    explicit MarkdownStartDfa(std::vector<StartAutomaton> automata);
+
+    // State at the start of an evaluation. Only the XML automaton keeps state
+    // (its start allowance) between evaluations.
+    int idleState(bool xmlAfterEndTag, bool xmlAfterPunctuation);
+
+    // Returns the next state (>= 0), or an accept code for which isAccept() holds.
+    int advance(int state, char16_t c, bool atStartOfLine) {
+        const int input = inputOf(c, atStartOfLine);
+        const int next = transitions_[static_cast<size_t>(state) * kInputCount + static_cast<size_t>(input)];
+        return next != kUnknown ? next : computeTransition(state, input);
+    }
+
+    static bool isAccept(int code) { return code <= kAcceptBase; }
+
+    // Index (into the automata list) of the first plugin that reached PROCESSING.
+    static int winnerOf(int code) { return kAcceptBase - code; }
+
+    // True when no plugin is TRYING, i.e. the evaluation buffer is plain text.
+    bool isIdle(int state) const { return idle_[static_cast<size_t>(state)] != 0u; }
+
+    // XML start allowance after the chars fed so far, as the plugin would hold it.
+    void xmlAllowance(int state, bool& afterEndTag, bool& afterPunctuation) const;
+
+    // Same, for the chars before `c` plus `c` itself, when feeding `c` in `state` was accepted.
+    void xmlAllowanceOnAccept(int state, char16_t c, bool atStartOfLine,
+                              bool& afterEndTag, bool& afterPunctuation) const;
+
+    // Per-component encoding of a state, stable across instances (used by session snapshots).
+    uint64_t packedState(int state) const { return packed_[static_cast<size_t>(state)]; }
+
+    // Inverse of packedState; -1 when packed is not a state of this product.
+    int stateFromPacked(uint64_t packed);
+
+    static constexpr int kInputCount = 54;
+
+private:
+    static constexpr int kUnknown = -1;
+    static constexpr int kAcceptBase = -2;
+
+    static int inputOf(char16_t c, bool atStartOfLine);
+
+    int intern(uint64_t packed);
+    int computeTransition(int state, int input);
+    void decodeXml(int s, bool& afterEndTag, bool& afterPunctuation) const;
+
+    std::vector<StartAutomaton> automata_;
+    int xmlIndex_ = -1;
+
+    std::unordered_map<uint64_t, int> ids_;
+    std::vector<uint64_t> packed_;
+    std::vector<uint8_t> idle_;
+    std::vector<int> transitions_;
+    std::vector<uint8_t> acceptXml_;
+};
+
+} // namespace streamnative
@@ -1,10 +1,20 @@
 #include "StreamOperators.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <memory>
-
+#include <thread>
+#include <utility>
+
+#include "StreamCoalescer.h"
+#include "StreamMarkdownDfa.h"
+#include "StreamSnapshot.h"
+#include "StreamUtf8.h"
+#include "plugins/StreamJsonPlugin.h"
 #include "plugins/StreamMarkdownPlugin.h"
+#include "plugins/StreamPureJsonPlugin.h"
 #include "plugins/StreamXmlPlugin.h"
 
 namespace streamnative {
@@ -35,11 +45,43 @@ constexpr int MD_PLAIN_TEXT = 17;
 // Kotlin side must treat this as "close current group" and not map it to MarkdownProcessorType.
 constexpr int SEG_BREAK = -1;
 
+// Zero-width table structure markers inside an MD_TABLE group, at the '|' or '\n' that ends
+// a cell or row (see TableBoundary); must match NativeMarkdownSplitter.kt. Like SEG_BREAK
+// they are not MarkdownProcessorType ordinals.
+constexpr int SEG_TABLE_CELL = -2;
+constexpr int SEG_TABLE_CELL_ALIGN_LEFT = -3;
+constexpr int SEG_TABLE_CELL_ALIGN_CENTER = -4;
+constexpr int SEG_TABLE_CELL_ALIGN_RIGHT = -5;
+constexpr int SEG_TABLE_ROW = -6;
+constexpr int SEG_TABLE_HEADER_END = -7;
+
+// JsonSession segment types; must match NativeJsonSplitter.kt.
+constexpr int JSON_TEXT = 0;
+constexpr int JSON_CONTENT = 1;
+constexpr int JSON_KEY_START = 2;
+constexpr int JSON_KEY_END = 3;
+constexpr int JSON_VALUE_START = 4;
+constexpr int JSON_VALUE_END = 5;
+
+// Bumped whenever the MarkdownSession snapshot layout changes.
+constexpr uint64_t kSnapshotVersion = 4;
+
+enum class MarkdownSessionKind : uint8_t {
+    Block,
+    Inline,
+};
+
 struct PluginEntry {
     std::unique_ptr<StreamPlugin> plugin;
     int tag;
+    StartAutomaton automaton;
 };
 
+inline int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 inline void emitIndex(std::vector<Segment>& out, int tag, int index, int& runTag, int& runStart, int& runEnd) {
     if (runStart >= 0 && (runTag != tag || runEnd != index)) {
         out.push_back({runTag, runStart, runEnd});
@@ -55,6 +97,14 @@ inline void emitIndex(std::vector<Segment>& out, int tag, int index, int& runTag
     }
 }
 
+inline void emitRange(std::vector<Segment>& out, int tag, int start, int end, int& runTag, int& runStart, int& runEnd) {
+    if (start >= end) {
+        return;
+    }
+    emitIndex(out, tag, start, runTag, runStart, runEnd);
+    runEnd = end;
+}
+
 inline void flushRun(std::vector<Segment>& out, int& runTag, int& runStart, int& runEnd) {
     if (runStart >= 0) {
         out.push_back({runTag, runStart, runEnd});
@@ -72,16 +122,30 @@ inline void emitBreak(std::vector<Segment>& out, int pos, int& runTag, int& runS
 
 class MarkdownSession {
 public:
-    explicit MarkdownSession(std::vector<PluginEntry> plugins)
-            : plugins_(std::move(plugins)) {
+    MarkdownSession(MarkdownSessionKind kind, std::vector<PluginEntry> plugins, bool tableDriven)
+            : kind_(kind),
+              plugins_(std::move(plugins)) {
+        std::vector<StartAutomaton> automata;
+        automata.reserve(plugins_.size());
         for (auto& e : plugins_) {
             e.plugin->initPlugin();
+            e.plugin->collectTriggers(triggers_);
+            automata.push_back(e.automaton);
+            if (e.automaton == StartAutomaton::Xml) {
+                xmlPlugin_ = static_cast<StreamXmlPlugin*>(e.plugin.get());
+            } else if (e.automaton == StartAutomaton::Table) {
+                tablePlugin_ = static_cast<StreamMarkdownTablePlugin*>(e.plugin.get());
+            }
+        }
+        // A newline makes the next char start-of-line, which every line-anchored plugin must see.
+        triggers_.add(u'\n');
+        if (tableDriven) {
+            startDfa_ = std::make_unique<MarkdownStartDfa>(std::move(automata));
         }
     }
 
-    std::vector<Segment> push(const jchar* chars, int len) {
-        std::vector<Segment> out;
-        out.reserve(64);
+    // Appends the segments produced by chars to out.
+    void push(const jchar* chars, int len, std::vector<Segment>& out) {
 
         int runTag = 0;
         int runStart = -1;
@@ -141,6 +205,9 @@ public:
 
             if (activePlugin_ != nullptr) {
                 const bool shouldEmit = activePlugin_->processChar(c, atStartOfLine);
+                if (activePlugin_ == tablePlugin_) {
+                    emitTableBoundaries(out, globalIndex, runTag, runStart, runEnd);
+                }
                 if (activePlugin_->state() == PluginState::WAITFOR) {
                     // Defer emission decision until next char arrives.
                     waitforActive_ = true;
@@ -161,6 +228,11 @@ public:
                 return;
             }
 
+            if (startDfa_ != nullptr) {
+                evaluateWithDfa(c, atStartOfLine, globalIndex, out, runTag, runStart, runEnd);
+                return;
+            }
+
             // Evaluation mode
             if (evalStartGlobal_ < 0) {
                 evalStartGlobal_ = globalIndex;
@@ -241,6 +313,40 @@ public:
 
         int i = 0;
         while (i < len || !pendingChars_.empty()) {
+            // Fast path: while every plugin is idle, jump straight to the next trigger char
+            // and emit the skipped span as one plain-text run.
+            if (pendingChars_.empty() && !atStartOfLine && isIdle()) {
+                const int next = triggers_.find(chars, i, len);
+                if (next > i) {
+                    const int count = next - i;
+                    const auto* span = reinterpret_cast<const char16_t*>(chars + i);
+                    for (auto& e : plugins_) {
+                        e.plugin->skipIdleRun(span, count);
+                        e.plugin->reset();
+                    }
+                    emitRange(out, MD_PLAIN_TEXT, globalOffset_, globalOffset_ + count, runTag, runStart, runEnd);
+                    globalOffset_ += count;
+                    i = next;
+                    continue;
+                }
+            }
+
+            // Same while a plugin is active: let it consume the chars that cannot end it.
+            if (pendingChars_.empty() && activePlugin_ != nullptr && !waitforActive_) {
+                bool emitRun = false;
+                const auto* span = reinterpret_cast<const char16_t*>(chars + i);
+                const int count = activePlugin_->skipProcessingRun(span, len - i, emitRun);
+                if (count > 0) {
+                    if (emitRun) {
+                        emitRange(out, activeTag_, globalOffset_, globalOffset_ + count, runTag, runStart, runEnd);
+                    }
+                    globalOffset_ += count;
+                    i += count;
+                    atStartOfLine = (chars[i - 1] == u'\n');
+                    continue;
+                }
+            }
+
             char16_t c;
             int forcedIndex = -1;
 
@@ -262,11 +368,279 @@ public:
         atStartOfLine_ = atStartOfLine;
 
         flushRun(out, runTag, runStart, runEnd);
+    }
 
-        return out;
+    // Decodes bytes and pushes the completed chars, translating segment offsets to bytes.
+    void pushUtf8(const uint8_t* bytes, int len, std::vector<Utf8Segment>& out) {
+        if (utf8_.unitCount() != globalOffset_) {
+            utf8_.rebase(globalOffset_);
+        }
+        utf8Units_.clear();
+        utf8_.decode(bytes, len, utf8Units_);
+        if (utf8Units_.empty()) {
+            return;
+        }
+
+        utf8Segments_.clear();
+        push(utf8Units_.data(), static_cast<int>(utf8Units_.size()), utf8Segments_);
+        out.reserve(out.size() + utf8Segments_.size());
+        for (const auto& s : utf8Segments_) {
+            out.push_back({s.type, s.start, s.end, utf8_.byteOffset(s.start), utf8_.byteOffset(s.end)});
+        }
+        utf8_.discardBefore(oldestReferencedIndex());
+    }
+
+    void setCoalescing(int maxChars, int64_t maxDelayNanos) {
+        coalesced_.configure(maxChars, maxDelayNanos);
+        coalescedUtf8_.configure(maxChars, maxDelayNanos);
+    }
+
+    // push/pushUtf8 through the coalescer; out only receives whole deltas.
+    void pushCoalesced(const jchar* chars, int len, std::vector<Segment>& out) {
+        if (!coalesced_.enabled()) {
+            coalesced_.drain(out);
+            push(chars, len, out);
+            return;
+        }
+        coalesceScratch_.clear();
+        push(chars, len, coalesceScratch_);
+        if (coalesced_.add(coalesceScratch_.data(), coalesceScratch_.size(), len, steadyNanos())) {
+            coalesced_.drain(out);
+        }
+    }
+
+    void pushUtf8Coalesced(const uint8_t* bytes, int len, std::vector<Utf8Segment>& out) {
+        if (!coalescedUtf8_.enabled()) {
+            coalescedUtf8_.drain(out);
+            pushUtf8(bytes, len, out);
+            return;
+        }
+        coalesceScratchUtf8_.clear();
+        pushUtf8(bytes, len, coalesceScratchUtf8_);
+        if (coalescedUtf8_.add(coalesceScratchUtf8_.data(), coalesceScratchUtf8_.size(), len, steadyNanos())) {
+            coalescedUtf8_.drain(out);
+        }
+    }
+
+    void flush(std::vector<Segment>& out) { coalesced_.drain(out); }
+    void flushUtf8(std::vector<Utf8Segment>& out) { coalescedUtf8_.drain(out); }
+
+    // Only valid between pushes (pendingChars_ is always drained by push).
+    void saveState(SnapshotWriter& out) const {
+        out.putUInt(kSnapshotVersion);
+        out.putUInt(static_cast<uint64_t>(kind_));
+        out.putBool(startDfa_ != nullptr);
+
+        out.putInt(globalOffset_);
+        out.putBool(atStartOfLine_);
+        out.putInt(activeIndex_);
+
+        out.putInt(evalStartGlobal_);
+        out.putUInt(evaluationBuffer_.size());
+        for (size_t i = 0; i < evaluationBuffer_.size(); i++) {
+            out.putUInt(evaluationBuffer_[i]);
+            if (startDfa_ != nullptr) {
+                out.putBool(evaluationSol_[i] != 0u);
+            } else {
+                out.putUInt(evaluationEmitMask_[i]);
+            }
+        }
+        if (startDfa_ != nullptr && evalStartGlobal_ >= 0) {
+            out.putUInt(startDfa_->packedState(dfaState_));
+        }
+
+        out.putBool(waitforActive_);
+        out.putBool(waitforAtStartOfLine_);
+        out.putUInt(waitforPending_.size());
+        for (const auto& pending : waitforPending_) {
+            out.putInt(pending.globalIndex);
+            out.putBool(pending.shouldEmit);
+        }
+
+        for (const auto& e : plugins_) {
+            e.plugin->saveState(out);
+        }
+        utf8_.saveState(out);
+        coalesced_.saveState(out);
+        coalescedUtf8_.saveState(out);
+    }
+
+    // Expects a session created with the kind and mode the snapshot header names.
+    bool restoreState(SnapshotReader& in) {
+        if (!in.getInt(globalOffset_) || !in.getBool(atStartOfLine_) || !in.getInt(activeIndex_) ||
+            activeIndex_ < -1 || activeIndex_ >= static_cast<int>(plugins_.size())) {
+            return false;
+        }
+        if (activeIndex_ >= 0) {
+            activePlugin_ = plugins_[static_cast<size_t>(activeIndex_)].plugin.get();
+            activeTag_ = plugins_[static_cast<size_t>(activeIndex_)].tag;
+        }
+
+        uint32_t buffered = 0;
+        if (!in.getInt(evalStartGlobal_) || !in.getUInt(buffered, static_cast<uint32_t>(in.remaining()))) {
+            return false;
+        }
+        for (uint32_t i = 0; i < buffered; i++) {
+            char16_t c = 0;
+            if (!in.getChar(c)) {
+                return false;
+            }
+            evaluationBuffer_.push_back(c);
+            if (startDfa_ != nullptr) {
+                bool sol = false;
+                if (!in.getBool(sol)) {
+                    return false;
+                }
+                evaluationSol_.push_back(sol ? 1u : 0u);
+            } else {
+                uint32_t mask = 0;
+                if (!in.getUInt(mask, UINT32_MAX)) {
+                    return false;
+                }
+                evaluationEmitMask_.push_back(mask);
+            }
+        }
+        if (startDfa_ != nullptr && evalStartGlobal_ >= 0) {
+            uint64_t packed = 0;
+            if (!in.getUInt(packed) || (dfaState_ = startDfa_->stateFromPacked(packed)) < 0) {
+                return false;
+            }
+        }
+
+        uint32_t pendingCount = 0;
+        if (!in.getBool(waitforActive_) || !in.getBool(waitforAtStartOfLine_) ||
+            !in.getUInt(pendingCount, static_cast<uint32_t>(in.remaining()))) {
+            return false;
+        }
+        for (uint32_t i = 0; i < pendingCount; i++) {
+            WaitforPending pending{};
+            if (!in.getInt(pending.globalIndex) || !in.getBool(pending.shouldEmit)) {
+                return false;
+            }
+            waitforPending_.push_back(pending);
+        }
+        if (waitforActive_ && activePlugin_ == nullptr) {
+            return false;
+        }
+
+        for (auto& e : plugins_) {
+            if (!e.plugin->restoreState(in)) {
+                return false;
+            }
+        }
+        return utf8_.restoreState(in) && coalesced_.restoreState(in) && coalescedUtf8_.restoreState(in) &&
+               in.atEnd();
     }
 
 private:
+    bool isIdle() const {
+        return activePlugin_ == nullptr && !waitforActive_ && evaluationBuffer_.empty();
+    }
+
+    // Lowest index a later push can still emit: buffered evaluation or WAITFOR chars.
+    int oldestReferencedIndex() const {
+        int oldest = globalOffset_;
+        if (evalStartGlobal_ >= 0) {
+            oldest = std::min(oldest, evalStartGlobal_);
+        }
+        if (!waitforPending_.empty()) {
+            oldest = std::min(oldest, waitforPending_.front().globalIndex);
+        }
+        return oldest;
+    }
+
+    // Evaluation mode driven by the start DFA: plugins are not fed while they would only
+    // be IDLE/TRYING. Once a plugin is known to reach PROCESSING, the buffered chars are
+    // replayed into that plugin alone, which yields the same emit flags and state as
+    // feeding every plugin char by char.
+    void evaluateWithDfa(char16_t c, bool atStartOfLine, int globalIndex,
+                         std::vector<Segment>& out, int& runTag, int& runStart, int& runEnd) {
+        if (evalStartGlobal_ < 0) {
+            evalStartGlobal_ = globalIndex;
+            dfaState_ = (xmlPlugin_ != nullptr)
+                    ? startDfa_->idleState(xmlPlugin_->allowsStartAfterEndTag(), xmlPlugin_->allowsStartAfterPunctuation())
+                    : startDfa_->idleState(false, false);
+        }
+
+        evaluationBuffer_.push_back(c);
+        evaluationSol_.push_back(atStartOfLine ? 1u : 0u);
+
+        const int next = startDfa_->advance(dfaState_, c, atStartOfLine);
+        bool afterEndTag = false;
+        bool afterPunctuation = false;
+
+        if (MarkdownStartDfa::isAccept(next)) {
+            const int successful = MarkdownStartDfa::winnerOf(next);
+            startDfa_->xmlAllowanceOnAccept(dfaState_, c, atStartOfLine, afterEndTag, afterPunctuation);
+
+            activeIndex_ = successful;
+            activePlugin_ = plugins_[successful].plugin.get();
+            activeTag_ = plugins_[successful].tag;
+
+            // Ensure a new group boundary even if previous group had the same tag.
+            flushRun(out, runTag, runStart, runEnd);
+
+            for (int bi = 0; bi < static_cast<int>(evaluationBuffer_.size()); bi++) {
+                const bool sol = evaluationSol_[static_cast<size_t>(bi)] != 0u;
+                if (activePlugin_->processChar(evaluationBuffer_[static_cast<size_t>(bi)], sol)) {
+                    emitIndex(out, activeTag_, evalStartGlobal_ + bi, runTag, runStart, runEnd);
+                }
+            }
+
+            evaluationBuffer_.clear();
+            evaluationSol_.clear();
+            evalStartGlobal_ = -1;
+
+            for (int pi = 0; pi < static_cast<int>(plugins_.size()); pi++) {
+                if (pi != successful) {
+                    plugins_[pi].plugin->reset();
+                }
+            }
+            if (xmlPlugin_ != nullptr && xmlPlugin_ != activePlugin_) {
+                xmlPlugin_->setStartAllowance(afterEndTag, afterPunctuation);
+            }
+            return;
+        }
+
+        dfaState_ = next;
+        if (!startDfa_->isIdle(next)) {
+            return;
+        }
+
+        emitRange(out, MD_PLAIN_TEXT, evalStartGlobal_, evalStartGlobal_ + static_cast<int>(evaluationBuffer_.size()),
+                  runTag, runStart, runEnd);
+        evaluationBuffer_.clear();
+        evaluationSol_.clear();
+        evalStartGlobal_ = -1;
+        for (auto& e : plugins_) {
+            e.plugin->reset();
+        }
+        if (xmlPlugin_ != nullptr) {
+            startDfa_->xmlAllowance(next, afterEndTag, afterPunctuation);
+            xmlPlugin_->setStartAllowance(afterEndTag, afterPunctuation);
+        }
+    }
+
+    // A table starts at its first char, so its boundaries only come from the active plugin.
+    void emitTableBoundaries(std::vector<Segment>& out, int globalIndex, int& runTag, int& runStart, int& runEnd) const {
+        for (int b = 0; b < tablePlugin_->boundaryCount(); b++) {
+            flushRun(out, runTag, runStart, runEnd);
+            out.push_back({tableBoundarySegmentType(tablePlugin_->boundary(b)), globalIndex, globalIndex});
+        }
+    }
+
+    static int tableBoundarySegmentType(TableBoundary boundary) {
+        switch (boundary) {
+            case TableBoundary::Cell: return SEG_TABLE_CELL;
+            case TableBoundary::CellAlignLeft: return SEG_TABLE_CELL_ALIGN_LEFT;
+            case TableBoundary::CellAlignCenter: return SEG_TABLE_CELL_ALIGN_CENTER;
+            case TableBoundary::CellAlignRight: return SEG_TABLE_CELL_ALIGN_RIGHT;
+            case TableBoundary::Row: return SEG_TABLE_ROW;
+            case TableBoundary::HeaderEnd: return SEG_TABLE_HEADER_END;
+        }
+        return SEG_TABLE_CELL;
+    }
+
     struct WaitforPending {
         int globalIndex;
         bool shouldEmit;
@@ -277,7 +651,16 @@ private:
         int globalIndex;
     };
 
+    MarkdownSessionKind kind_;
     std::vector<PluginEntry> plugins_;
+    TriggerSet triggers_;
+    StreamXmlPlugin* xmlPlugin_ = nullptr;
+    StreamMarkdownTablePlugin* tablePlugin_ = nullptr;
+
+    // Table-driven evaluation (null for the per-plugin evaluation loop)
+    std::unique_ptr<MarkdownStartDfa> startDfa_;
+    int dfaState_ = 0;
+    std::vector<uint8_t> evaluationSol_;
 
     int globalOffset_ = 0;
     bool atStartOfLine_ = true;
@@ -297,126 +680,449 @@ private:
     bool waitforAtStartOfLine_ = false;
     std::vector<WaitforPending> waitforPending_;
     std::deque<PendingChar> pendingChars_;
+
+    // UTF-8 input (pushUtf8)
+    Utf8StreamDecoder utf8_;
+    std::vector<jchar> utf8Units_;
+    std::vector<Segment> utf8Segments_;
+
+    // Coalescing mode (pushCoalesced/pushUtf8Coalesced)
+    SegmentCoalescer<Segment> coalesced_;
+    SegmentCoalescer<Utf8Segment> coalescedUtf8_;
+    std::vector<Segment> coalesceScratch_;
+    std::vector<Utf8Segment> coalesceScratchUtf8_;
 };
 
-MarkdownSession* createMarkdownBlockSession() {
+MarkdownSession* createMarkdownBlockSession(bool tableDriven) {
     std::vector<PluginEntry> plugins;
     plugins.reserve(16);
     // Order must match NestedMarkdownProcessor.getBlockPlugins()
-    plugins.push_back({std::make_unique<StreamMarkdownHeaderPlugin>(true), MD_HEADER});
-    plugins.push_back({std::make_unique<StreamMarkdownFencedCodeBlockPlugin>(true), MD_CODE_BLOCK});
-    plugins.push_back({std::make_unique<StreamMarkdownBlockQuotePlugin>(false), MD_BLOCK_QUOTE});
-    plugins.push_back({std::make_unique<StreamMarkdownOrderedListPlugin>(true), MD_ORDERED_LIST});
-    plugins.push_back({std::make_unique<StreamMarkdownUnorderedListPlugin>(false), MD_UNORDERED_LIST});
-    plugins.push_back({std::make_unique<StreamMarkdownHorizontalRulePlugin>(true), MD_HORIZONTAL_RULE});
-    plugins.push_back({std::make_unique<StreamMarkdownBlockLaTeXPlugin>(false), MD_BLOCK_LATEX});
+    plugins.push_back({std::make_unique<StreamMarkdownHeaderPlugin>(true), MD_HEADER, StartAutomaton::Header});
+    plugins.push_back({std::make_unique<StreamMarkdownFencedCodeBlockPlugin>(true), MD_CODE_BLOCK, StartAutomaton::FencedCodeBlock});
+    plugins.push_back({std::make_unique<StreamMarkdownBlockQuotePlugin>(false), MD_BLOCK_QUOTE, StartAutomaton::BlockQuote});
+    plugins.push_back({std::make_unique<StreamMarkdownOrderedListPlugin>(true), MD_ORDERED_LIST, StartAutomaton::OrderedList});
+    plugins.push_back({std::make_unique<StreamMarkdownUnorderedListPlugin>(false), MD_UNORDERED_LIST, StartAutomaton::UnorderedList});
+    plugins.push_back({std::make_unique<StreamMarkdownHorizontalRulePlugin>(true), MD_HORIZONTAL_RULE, StartAutomaton::HorizontalRule});
+    plugins.push_back({std::make_unique<StreamMarkdownBlockLaTeXPlugin>(false), MD_BLOCK_LATEX, StartAutomaton::BlockLaTeX});
     // Keep delimiters for \[...\] to avoid swallowing '\' in failed end-matcher branches.
     // Delimiters are removed later by extractLatexContent().
-    plugins.push_back({std::make_unique<StreamMarkdownBlockBracketLaTeXPlugin>(true), MD_BLOCK_LATEX});
-    plugins.push_back({std::make_unique<StreamMarkdownTablePlugin>(true), MD_TABLE});
-    plugins.push_back({std::make_unique<StreamMarkdownImagePlugin>(true), MD_IMAGE});
-    plugins.push_back({std::make_unique<StreamXmlPlugin>(true), MD_XML_BLOCK});
-    return new MarkdownSession(std::move(plugins));
+    plugins.push_back({std::make_unique<StreamMarkdownBlockBracketLaTeXPlugin>(true), MD_BLOCK_LATEX, StartAutomaton::BlockBracketLaTeX});
+    plugins.push_back({std::make_unique<StreamMarkdownTablePlugin>(true), MD_TABLE, StartAutomaton::Table});
+    plugins.push_back({std::make_unique<StreamMarkdownImagePlugin>(true), MD_IMAGE, StartAutomaton::Image});
+    plugins.push_back({std::make_unique<StreamXmlPlugin>(true), MD_XML_BLOCK, StartAutomaton::Xml});
+    return new MarkdownSession(MarkdownSessionKind::Block, std::move(plugins), tableDriven);
 }
 
-MarkdownSession* createMarkdownInlineSession() {
+MarkdownSession* createMarkdownInlineSession(bool tableDriven) {
     std::vector<PluginEntry> plugins;
     plugins.reserve(16);
     // Order must match NestedMarkdownProcessor.getInlinePlugins()
-    plugins.push_back({std::make_unique<StreamMarkdownBoldPlugin>(false), MD_BOLD});
-    plugins.push_back({std::make_unique<StreamMarkdownItalicPlugin>(false), MD_ITALIC});
-    plugins.push_back({std::make_unique<StreamMarkdownInlineCodePlugin>(false), MD_INLINE_CODE});
-    plugins.push_back({std::make_unique<StreamMarkdownLinkPlugin>(), MD_LINK});
-    plugins.push_back({std::make_unique<StreamMarkdownStrikethroughPlugin>(false), MD_STRIKETHROUGH});
-    plugins.push_back({std::make_unique<StreamMarkdownUnderlinePlugin>(true), MD_UNDERLINE});
-    plugins.push_back({std::make_unique<StreamMarkdownInlineLaTeXPlugin>(false), MD_INLINE_LATEX});
+    plugins.push_back({std::make_unique<StreamMarkdownBoldPlugin>(false), MD_BOLD, StartAutomaton::Bold});
+    plugins.push_back({std::make_unique<StreamMarkdownItalicPlugin>(false), MD_ITALIC, StartAutomaton::Italic});
+    plugins.push_back({std::make_unique<StreamMarkdownInlineCodePlugin>(false), MD_INLINE_CODE, StartAutomaton::InlineCode});
+    plugins.push_back({std::make_unique<StreamMarkdownLinkPlugin>(), MD_LINK, StartAutomaton::Link});
+    plugins.push_back({std::make_unique<StreamMarkdownStrikethroughPlugin>(false), MD_STRIKETHROUGH, StartAutomaton::Strikethrough});
+    plugins.push_back({std::make_unique<StreamMarkdownUnderlinePlugin>(true), MD_UNDERLINE, StartAutomaton::Underline});
+    plugins.push_back({std::make_unique<StreamMarkdownInlineLaTeXPlugin>(false), MD_INLINE_LATEX, StartAutomaton::InlineLaTeX});
     // Keep delimiters for \(...\) to avoid swallowing '\' in failed end-matcher branches.
     // Delimiters are removed later by extractLatexContent().
-    plugins.push_back({std::make_unique<StreamMarkdownInlineParenLaTeXPlugin>(true), MD_INLINE_LATEX});
-    return new MarkdownSession(std::move(plugins));
+    plugins.push_back({std::make_unique<StreamMarkdownInlineParenLaTeXPlugin>(true), MD_INLINE_LATEX, StartAutomaton::InlineParenLaTeX});
+    return new MarkdownSession(MarkdownSessionKind::Inline, std::move(plugins), tableDriven);
 }
 
 void destroyMarkdownSession(MarkdownSession* session) {
     delete session;
 }
 
+std::vector<uint8_t> markdownSessionSnapshot(const MarkdownSession* session) {
+    std::vector<uint8_t> bytes;
+    if (session == nullptr) {
+        return bytes;
+    }
+    bytes.reserve(64);
+    SnapshotWriter out(bytes);
+    session->saveState(out);
+    return bytes;
+}
+
+MarkdownSession* restoreMarkdownSession(const uint8_t* data, size_t len) {
+    if (data == nullptr) {
+        return nullptr;
+    }
+    SnapshotReader in(data, len);
+    uint64_t version = 0;
+    uint32_t kind = 0;
+    bool tableDriven = false;
+    if (!in.getUInt(version) || version != kSnapshotVersion ||
+        !in.getUInt(kind, static_cast<uint32_t>(MarkdownSessionKind::Inline)) ||
+        !in.getBool(tableDriven)) {
+        return nullptr;
+    }
+    MarkdownSession* session = (static_cast<MarkdownSessionKind>(kind) == MarkdownSessionKind::Block)
+            ? createMarkdownBlockSession(tableDriven)
+            : createMarkdownInlineSession(tableDriven);
+    if (!session->restoreState(in)) {
+        delete session;
+        return nullptr;
+    }
+    return session;
+}
+
 std::vector<Segment> markdownSessionPush(MarkdownSession* session, const jchar* chars, int len) {
+    std::vector<Segment> out;
+    out.reserve(64);
+    markdownSessionPush(session, chars, len, out);
+    return out;
+}
+
+void markdownSessionPush(MarkdownSession* session, const jchar* chars, int len, std::vector<Segment>& out) {
     if (session == nullptr || chars == nullptr || len <= 0) {
-        return {};
+        return;
     }
-    return session->push(chars, len);
+    session->pushCoalesced(chars, len, out);
 }
 
-std::vector<Segment> splitByXml(const jchar* chars, int len) {
-    std::vector<Segment> segments;
-    segments.reserve(32);
+void markdownSessionPushUtf8(MarkdownSession* session, const uint8_t* bytes, int len, std::vector<Utf8Segment>& out) {
+    if (session == nullptr || bytes == nullptr || len <= 0) {
+        return;
+    }
+    session->pushUtf8Coalesced(bytes, len, out);
+}
 
-    StreamXmlPlugin xmlPlugin(true);
-    xmlPlugin.initPlugin();
+void markdownSessionSetCoalescing(MarkdownSession* session, int maxChars, int maxDelayMillis) {
+    if (session == nullptr) {
+        return;
+    }
+    session->setCoalescing(maxChars, static_cast<int64_t>(maxDelayMillis) * 1000000);
+}
 
-    StreamPlugin* activePlugin = nullptr;
-    int activeStart = -1;
-    int defaultStart = 0;
+void markdownSessionFlush(MarkdownSession* session, std::vector<Segment>& out) {
+    if (session != nullptr) {
+        session->flush(out);
+    }
+}
 
-    int evalStart = -1;
-    bool atStartOfLine = true;
+void markdownSessionFlushUtf8(MarkdownSession* session, std::vector<Utf8Segment>& out) {
+    if (session != nullptr) {
+        session->flushUtf8(out);
+    }
+}
 
-    auto flushDefaultIfNeeded = [&](int endExclusive) {
-        if (defaultStart < endExclusive) {
-            segments.push_back({0, defaultStart, endExclusive});
+class JsonSession {
+public:
+    explicit JsonSession(bool pureContent) {
+        if (pureContent) {
+            plugin_ = std::make_unique<StreamPureJsonPlugin>();
+        } else {
+            plugin_ = std::make_unique<StreamJsonPlugin>();
         }
-        defaultStart = endExclusive;
-    };
+        plugin_->initPlugin();
+    }
 
-    auto openActive = [&](int start) {
-        activePlugin = &xmlPlugin;
-        activeStart = start;
-    };
+    void push(const jchar* chars, int len, std::vector<Segment>& out) {
+        int runTag = JSON_TEXT;
+        int runStart = -1;
+        int runEnd = -1;
+
+        for (int i = 0; i < len; i++) {
+            const auto c = static_cast<char16_t>(chars[i]);
+            const int globalIndex = globalOffset_;
+            globalOffset_ += 1;
+            const bool sol = atStartOfLine_;
+            atStartOfLine_ = (c == u'\n');
+
+            const bool wasIdle = plugin_->state() == PluginState::IDLE;
+            const bool shouldEmit = plugin_->processChar(c, sol);
+            const bool started = wasIdle && plugin_->eventCount() > 0;
+            if (wasIdle && !started) {
+                emitIndex(out, JSON_TEXT, globalIndex, runTag, runStart, runEnd);
+                continue;
+            }
+            if (started) {
+                flushRun(out, runTag, runStart, runEnd);
+                jsonStart_ = globalIndex;
+            }
 
-    auto closeActive = [&](int endExclusive) {
-        if (activePlugin != nullptr && activeStart >= 0 && activeStart < endExclusive) {
-            segments.push_back({1, activeStart, endExclusive});
+            // Keep segments ordered by position: start markers and spans ending before this
+            // char go ahead of it, spans closed by this char (brackets, quotes) after it.
+            emitEvents(out, globalIndex, false, runTag, runStart, runEnd);
+            if (shouldEmit) {
+                emitIndex(out, JSON_CONTENT, globalIndex, runTag, runStart, runEnd);
+            }
+            emitEvents(out, globalIndex, true, runTag, runStart, runEnd);
+            if (plugin_->state() != PluginState::PROCESSING) {
+                emitBreak(out, globalIndex + 1, runTag, runStart, runEnd);
+            }
         }
-        activePlugin = nullptr;
-        activeStart = -1;
-    };
 
-    for (int i = 0; i < len; i++) {
-        const jchar c = chars[i];
-        const bool isAtStartForCurrent = atStartOfLine;
-        atStartOfLine = (c == '\n');
+        flushRun(out, runTag, runStart, runEnd);
+    }
 
-        if (activePlugin != nullptr) {
-            (void)activePlugin->processChar(static_cast<char16_t>(c), isAtStartForCurrent);
-            if (activePlugin->state() != PluginState::PROCESSING) {
-                closeActive(i + 1);
-                defaultStart = i + 1;
+private:
+    void emitEvents(std::vector<Segment>& out, int globalIndex, bool includesCurrent,
+                    int& runTag, int& runStart, int& runEnd) const {
+        for (int e = 0; e < plugin_->eventCount(); e++) {
+            const JsonEvent& ev = plugin_->event(e);
+            const int end = jsonStart_ + ev.end;
+            if ((end > globalIndex) != includesCurrent) {
+                continue;
             }
-            continue;
+            flushRun(out, runTag, runStart, runEnd);
+            out.push_back({jsonEventSegmentType(ev.type), jsonStart_ + ev.start, end});
         }
+    }
 
-        if (evalStart == -1) {
-            evalStart = i;
+    static int jsonEventSegmentType(JsonEventType type) {
+        switch (type) {
+            case JsonEventType::KEY_START: return JSON_KEY_START;
+            case JsonEventType::KEY_END: return JSON_KEY_END;
+            case JsonEventType::VALUE_START: return JSON_VALUE_START;
+            case JsonEventType::VALUE_END: return JSON_VALUE_END;
         }
+        return JSON_VALUE_END;
+    }
+
+    std::unique_ptr<BaseJsonPlugin> plugin_;
+    int globalOffset_ = 0;
+    int jsonStart_ = 0;
+    bool atStartOfLine_ = true;
+};
+
+JsonSession* createJsonSession(bool pureContent) {
+    return new JsonSession(pureContent);
+}
 
-        (void)xmlPlugin.processChar(static_cast<char16_t>(c), isAtStartForCurrent);
+void destroyJsonSession(JsonSession* session) {
+    delete session;
+}
+
+std::vector<Segment> jsonSessionPush(JsonSession* session, const jchar* chars, int len) {
+    std::vector<Segment> out;
+    if (session == nullptr || chars == nullptr || len <= 0) {
+        return out;
+    }
+    out.reserve(32);
+    session->push(chars, len, out);
+    return out;
+}
+
+namespace {
+
+// Inputs shorter than this per worker are split sequentially.
+constexpr int kXmlParallelMinChunk = 128 * 1024;
+constexpr int kXmlParallelMaxThreads = 8;
+
+// Resumable splitByXml scan. It records the XML groups as spans; text segments are their
+// complement, so chunk results can be stitched together by offset.
+struct XmlScan {
+    StreamXmlPlugin plugin{true};
+    bool active = false;
+    int activeStart = -1;
+    int evalStart = -1;
+    bool atStartOfLine = true;
+    std::vector<std::pair<int, int>> spans;
 
-        if (xmlPlugin.state() == PluginState::PROCESSING) {
-            flushDefaultIfNeeded(evalStart);
-            openActive(evalStart);
-            evalStart = -1;
-        } else if (xmlPlugin.state() != PluginState::TRYING) {
-            evalStart = -1;
+    // Offsets right after a '\n' at which the scan was at rest, recorded for chunks scanned
+    // speculatively so the fix-up pass can tell where a corrected scan rejoins them.
+    bool recordSyncPoints = false;
+    std::vector<int> syncPoints;
+
+    XmlScan() { plugin.initPlugin(); }
+
+    // Nothing is carried over: what follows scans exactly as from a fresh line start.
+    bool atRest() const {
+        return !active && evalStart < 0 && plugin.isAtRest();
+    }
+
+    // Scans [from, to). With syncWith, stops right after the first '\n' at which both this
+    // scan and syncWith were at rest and returns that offset; otherwise returns to.
+    int scan(const jchar* chars, int from, int to, const XmlScan* syncWith = nullptr) {
+        size_t nextSync = 0;
+        for (int i = from; i < to; i++) {
+            if (active) {
+                bool emitRun = false;
+                const int count = plugin.skipProcessingRun(reinterpret_cast<const char16_t*>(chars + i), to - i, emitRun);
+                if (count > 0) {
+                    i += count - 1;
+                    atStartOfLine = (chars[i] == '\n');
+                    continue;
+                }
+            }
+
+            const jchar c = chars[i];
+            const bool isAtStartForCurrent = atStartOfLine;
+            atStartOfLine = (c == '\n');
+
+            if (active) {
+                (void)plugin.processChar(static_cast<char16_t>(c), isAtStartForCurrent);
+                if (plugin.state() != PluginState::PROCESSING) {
+                    spans.push_back({activeStart, i + 1});
+                    active = false;
+                    activeStart = -1;
+                }
+                continue;
+            }
+
+            if (evalStart == -1) {
+                evalStart = i;
+            }
+
+            (void)plugin.processChar(static_cast<char16_t>(c), isAtStartForCurrent);
+
+            if (plugin.state() == PluginState::PROCESSING) {
+                active = true;
+                activeStart = evalStart;
+                evalStart = -1;
+            } else if (plugin.state() != PluginState::TRYING) {
+                evalStart = -1;
+            }
+
+            if (c != '\n' || (!recordSyncPoints && syncWith == nullptr) || !atRest()) {
+                continue;
+            }
+            if (recordSyncPoints) {
+                syncPoints.push_back(i + 1);
+            }
+            if (syncWith != nullptr) {
+                const auto& points = syncWith->syncPoints;
+                while (nextSync < points.size() && points[nextSync] < i + 1) {
+                    nextSync++;
+                }
+                if (nextSync < points.size() && points[nextSync] == i + 1) {
+                    return i + 1;
+                }
+            }
         }
+        return to;
     }
 
-    if (activePlugin != nullptr) {
-        closeActive(len);
-        defaultStart = len;
+    // Moves the spans starting at or after from into out.
+    void takeSpans(std::vector<std::pair<int, int>>& out, int from) {
+        for (const auto& span : spans) {
+            if (span.first >= from) {
+                out.push_back(span);
+            }
+        }
+        spans.clear();
     }
+};
 
-    flushDefaultIfNeeded(len);
+std::vector<Segment> xmlSpansToSegments(const std::vector<std::pair<int, int>>& spans, int len) {
+    std::vector<Segment> segments;
+    segments.reserve(spans.size() * 2 + 1);
+    int textStart = 0;
+    for (const auto& span : spans) {
+        if (textStart < span.first) {
+            segments.push_back({0, textStart, span.first});
+        }
+        segments.push_back({1, span.first, span.second});
+        textStart = span.second;
+    }
+    if (textStart < len) {
+        segments.push_back({0, textStart, len});
+    }
     return segments;
 }
 
+// Chunk boundaries for a parallel split: roughly equal slices, each starting right after
+// a '\n' so a speculative scan can assume a fresh line start.
+std::vector<int> xmlChunkBounds(const jchar* chars, int len, int threads) {
+    std::vector<int> bounds;
+    bounds.push_back(0);
+    for (int k = 1; k < threads; k++) {
+        int at = static_cast<int>(static_cast<int64_t>(len) * k / threads);
+        at = std::max(at, bounds.back());
+        while (at < len && chars[at - 1] != '\n') {
+            at++;
+        }
+        if (at > bounds.back() && at < len) {
+            bounds.push_back(at);
+        }
+    }
+    bounds.push_back(len);
+    return bounds;
+}
+
+} // namespace
+
+std::vector<Segment> splitByXml(const jchar* chars, int len, int threads) {
+    if (chars == nullptr || len <= 0) {
+        return {};
+    }
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = std::min({threads, kXmlParallelMaxThreads, len / kXmlParallelMinChunk});
+    const std::vector<int> bounds = (threads > 1) ? xmlChunkBounds(chars, len, threads) : std::vector<int>{0, len};
+    const int chunks = static_cast<int>(bounds.size()) - 1;
+
+    // Every chunk after the first is scanned from an assumed fresh line start.
+    std::vector<std::unique_ptr<XmlScan>> scans;
+    scans.reserve(static_cast<size_t>(chunks));
+    for (int k = 0; k < chunks; k++) {
+        scans.push_back(std::make_unique<XmlScan>());
+        scans.back()->recordSyncPoints = (k > 0);
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(chunks - 1));
+    for (int k = 1; k < chunks; k++) {
+        XmlScan* scan = scans[static_cast<size_t>(k)].get();
+        const int from = bounds[static_cast<size_t>(k)];
+        const int to = bounds[static_cast<size_t>(k + 1)];
+        workers.emplace_back([scan, chars, from, to]() { scan->scan(chars, from, to); });
+    }
+    scans[0]->scan(chars, 0, bounds[1]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Fix-up: a speculative chunk is right as soon as the true scan reaches its start at
+    // rest. Otherwise the boundary fell inside a tag or an XML group, and the true scan
+    // continues into the chunk until both scans are at rest after the same '\n'.
+    std::vector<std::pair<int, int>> spans;
+    XmlScan* truth = scans[0].get();
+    for (int k = 1; k < chunks; k++) {
+        XmlScan* speculative = scans[static_cast<size_t>(k)].get();
+        if (truth->atRest()) {
+            truth->takeSpans(spans, 0);
+            truth = speculative;
+            continue;
+        }
+        const int to = bounds[static_cast<size_t>(k + 1)];
+        const int sync = truth->scan(chars, bounds[static_cast<size_t>(k)], to, speculative);
+        if (sync < to) {
+            truth->takeSpans(spans, 0);
+            speculative->takeSpans(spans, sync);
+            truth = speculative;
+        }
+    }
+    truth->takeSpans(spans, 0);
+    if (truth->active) {
+        spans.push_back({truth->activeStart, len});
+    }
+
+    return xmlSpansToSegments(spans, len);
+}
+
+std::vector<Utf8Segment> splitByXmlUtf8(const uint8_t* bytes, int len, int threads) {
+    if (bytes == nullptr || len <= 0) {
+        return {};
+    }
+
+    Utf8StreamDecoder decoder;
+    std::vector<jchar> units;
+    units.reserve(static_cast<size_t>(len));
+    decoder.decode(bytes, len, units);
+    decoder.finish(units);
+
+    const std::vector<Segment> segments = splitByXml(units.data(), static_cast<int>(units.size()), threads);
+    std::vector<Utf8Segment> out;
+    out.reserve(segments.size());
+    for (const auto& s : segments) {
+        out.push_back({s.type, s.start, s.end, decoder.byteOffset(s.start), decoder.byteOffset(s.end)});
+    }
+    return out;
+}
+
 } // namespace streamnative
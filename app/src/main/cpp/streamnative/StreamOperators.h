@@ -1,20 +1,63 @@
 #pragma once
 
 #include <jni.h>
+
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "StreamGroup.h"
 
 namespace streamnative {
 
-std::vector<Segment> splitByXml(const jchar* chars, int len);
+// Splits chars into text (0) and XML group (1) segments. With threads > 1 (or 0 for one per
+// core) large inputs are scanned in newline-aligned chunks in parallel; the result is
+// identical to the sequential scan.
+std::vector<Segment> splitByXml(const jchar* chars, int len, int threads = 1);
+
+// Same split for UTF-8 input (malformed bytes read as U+FFFD), with offsets in both units.
+std::vector<Utf8Segment> splitByXmlUtf8(const uint8_t* bytes, int len, int threads = 1);
 
 class MarkdownSession;
 
-MarkdownSession* createMarkdownBlockSession();
-MarkdownSession* createMarkdownInlineSession();
+// tableDriven selects the MarkdownStartDfa evaluation path; segments are identical either way.
+MarkdownSession* createMarkdownBlockSession(bool tableDriven = false);
+MarkdownSession* createMarkdownInlineSession(bool tableDriven = false);
 void destroyMarkdownSession(MarkdownSession* session);
 
+// Compact binary checkpoint of a session between pushes. restoreMarkdownSession builds a
+// session that continues exactly where the snapshot was taken (null for malformed bytes).
+std::vector<uint8_t> markdownSessionSnapshot(const MarkdownSession* session);
+MarkdownSession* restoreMarkdownSession(const uint8_t* data, size_t len);
+
 std::vector<Segment> markdownSessionPush(MarkdownSession* session, const jchar* chars, int len);
+// Same as above, appending to out so callers can reuse its storage across pushes.
+void markdownSessionPush(MarkdownSession* session, const jchar* chars, int len, std::vector<Segment>& out);
+
+// Pushes UTF-8 bytes, e.g. detokenized model output, without a round trip through UTF-16
+// strings. A char split across pushes is completed by the next push. Offsets count the
+// UTF-8 bytes and the UTF-16 units pushed so far; a session is fed through one of the two
+// push functions, not both.
+void markdownSessionPushUtf8(MarkdownSession* session, const uint8_t* bytes, int len, std::vector<Utf8Segment>& out);
+
+// Coalescing mode, off by default: pushes return nothing until maxChars input units were
+// pushed since the last delta, maxDelayMillis passed since its first push, or a SEG_BREAK
+// was produced; then they return the whole delta with runs continued across pushes merged.
+// A zero budget is not checked; both zero turns coalescing off (the next push returns any
+// held-back delta first). Budgets are checked on push only, so the caller flushes at the end
+// of the stream or when it stalls.
+void markdownSessionSetCoalescing(MarkdownSession* session, int maxChars, int maxDelayMillis);
+void markdownSessionFlush(MarkdownSession* session, std::vector<Segment>& out);
+void markdownSessionFlushUtf8(MarkdownSession* session, std::vector<Utf8Segment>& out);
+
+// Finds top-level JSON objects/arrays in a char stream. Emits runs of plain text (0)
+// and of JSON chars kept by the plugin (1), interleaved with key/value start/end events
+// (2..5), and SEG_BREAK after each closed structure.
+class JsonSession;
+
+JsonSession* createJsonSession(bool pureContent);
+void destroyJsonSession(JsonSession* session);
+
+std::vector<Segment> jsonSessionPush(JsonSession* session, const jchar* chars, int len);
 
 } // namespace streamnative
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "plugins/StreamPlugin.h"
+
+namespace streamnative {
+
+// Byte encoding of session snapshots: unsigned values as LEB128 varints, signed values
+// zigzag-encoded first, so the small counters plugins keep take one byte each.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void putUInt(uint64_t v) {
+        while (v >= 0x80u) {
+            out_.push_back(static_cast<uint8_t>(v | 0x80u));
+            v >>= 7u;
+        }
+        out_.push_back(static_cast<uint8_t>(v));
+    }
+
+    void putInt(int64_t v) {
+        putUInt((static_cast<uint64_t>(v) << 1u) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    void putBool(bool v) { out_.push_back(v ? 1u : 0u); }
+
+    void putState(PluginState state) { putUInt(static_cast<uint64_t>(state)); }
+
+    void putString(const std::u16string& s) {
+        putUInt(s.size());
+        for (char16_t c : s) {
+            putUInt(c);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// Reads what SnapshotWriter wrote. Every getter returns false on truncated or
+// out-of-range input and leaves the reader failed, so restores can chain with &&.
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t len) : data_(data), len_(len) {}
+
+    bool getUInt(uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64u; shift += 7u) {
+            if (pos_ >= len_) {
+                return fail();
+            }
+            const uint8_t b = data_[pos_++];
+            v |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+            if ((b & 0x80u) == 0u) {
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    bool getInt(int64_t& v) {
+        uint64_t u = 0;
+        if (!getUInt(u)) {
+            return false;
+        }
+        v = static_cast<int64_t>(u >> 1u) ^ -static_cast<int64_t>(u & 1u);
+        return true;
+    }
+
+    bool getInt(int& v) {
+        int64_t wide = 0;
+        if (!getInt(wide) || wide < std::numeric_limits<int>::min() || wide > std::numeric_limits<int>::max()) {
+            return fail();
+        }
+        v = static_cast<int>(wide);
+        return true;
+    }
+
+    bool getUInt(uint32_t& v, uint32_t max) {
+        uint64_t wide = 0;
+        if (!getUInt(wide) || wide > max) {
+            return fail();
+        }
+        v = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool getBool(bool& v) {
+        if (pos_ >= len_ || data_[pos_] > 1u) {
+            return fail();
+        }
+        v = data_[pos_++] != 0u;
+        return true;
+    }
+
+    bool getChar(char16_t& c) {
+        uint32_t v = 0;
+        if (!getUInt(v, 0xFFFFu)) {
+            return false;
+        }
+        c = static_cast<char16_t>(v);
+        return true;
+    }
+
+    bool getState(PluginState& state) {
+        uint32_t v = 0;
+        if (!getUInt(v, static_cast<uint32_t>(PluginState::WAITFOR))) {
+            return false;
+        }
+        state = static_cast<PluginState>(v);
+        return true;
+    }
+
+    bool getString(std::u16string& s) {
+        uint32_t n = 0;
+        if (!getUInt(n, static_cast<uint32_t>(remaining()))) {
+            return false;
+        }
+        s.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            if (!getChar(s[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Upper bound for element counts, so corrupt input cannot trigger huge allocations.
+    size_t remaining() const { return len_ - pos_; }
+
+    bool atEnd() const { return ok_ && pos_ == len_; }
+
+private:
+    bool fail() {
+        ok_ = false;
+        pos_ = len_;
+        return false;
+    }
+
+    const uint8_t* data_;
+    size_t len_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace streamnative
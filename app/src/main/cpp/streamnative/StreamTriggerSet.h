@@ -0,0 +1,136 @@
+#pragma once
+
+#include <jni.h>
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace streamnative {
+
+// Set of UTF-16 code units that may wake up an idle plugin.
+// Plugins register their start characters; MarkdownSession uses find() to jump
+// over plain-text runs without dispatching every char to every plugin.
+class TriggerSet {
+public:
+    void add(char16_t c) {
+        const uint16_t u = static_cast<uint16_t>(c);
+        if (contains(c)) {
+            return;
+        }
+        bits_[u >> 6u] |= (1ull << (u & 63u));
+        if (u < 0x80u) {
+            if (asciiCount_ < kMaxAsciiLanes) {
+                ascii_[asciiCount_] = u;
+            }
+            asciiCount_ += 1;
+        } else {
+            hasNonAscii_ = true;
+        }
+    }
+
+    void addRange(char16_t first, char16_t last) {
+        for (uint32_t c = first; c <= static_cast<uint32_t>(last); c++) {
+            add(static_cast<char16_t>(c));
+        }
+    }
+
+    // Adds every trigger of other.
+    void merge(const TriggerSet& other) {
+        for (uint32_t u = 0; u < 0x80u; u++) {
+            if ((other.bits_[u >> 6u] & (1ull << (u & 63u))) != 0u) {
+                add(static_cast<char16_t>(u));
+            }
+        }
+        for (size_t w = 2; w < bits_.size(); w++) {
+            bits_[w] |= other.bits_[w];
+        }
+        hasNonAscii_ = hasNonAscii_ || other.hasNonAscii_;
+        matchAll_ = matchAll_ || other.matchAll_;
+    }
+
+    // Marks every character as a trigger, i.e. disables skipping.
+    void addAll() { matchAll_ = true; }
+
+    bool matchesAll() const { return matchAll_; }
+
+    bool contains(char16_t c) const {
+        const uint16_t u = static_cast<uint16_t>(c);
+        return matchAll_ || (bits_[u >> 6u] & (1ull << (u & 63u))) != 0u;
+    }
+
+    // Returns the index of the first trigger in [from, len), or len if there is none.
+    int find(const jchar* chars, int from, int len) const {
+        if (matchAll_) {
+            return from;
+        }
+        int i = from;
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+        if (asciiCount_ <= kMaxAsciiLanes) {
+            while (i + 8 <= len) {
+                if (blockMayContainTrigger(chars + i)) {
+                    for (int k = 0; k < 8; k++) {
+                        if (contains(static_cast<char16_t>(chars[i + k]))) {
+                            return i + k;
+                        }
+                    }
+                }
+                i += 8;
+            }
+        }
+#endif
+        while (i < len) {
+            if (contains(static_cast<char16_t>(chars[i]))) {
+                return i;
+            }
+            i++;
+        }
+        return len;
+    }
+
+private:
+    static constexpr int kMaxAsciiLanes = 16;
+
+#if defined(__SSE2__)
+    // Coarse filter: true when any of the 8 code units is a registered ASCII trigger,
+    // or is non-ASCII while the set holds non-ASCII triggers.
+    bool blockMayContainTrigger(const jchar* p) const {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_setzero_si128();
+        for (int t = 0; t < asciiCount_; t++) {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi16(v, _mm_set1_epi16(static_cast<short>(ascii_[t]))));
+        }
+        int mask = _mm_movemask_epi8(hit);
+        if (hasNonAscii_) {
+            const __m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));
+            mask |= _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) ^ 0xFFFF;
+        }
+        return mask != 0;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    bool blockMayContainTrigger(const jchar* p) const {
+        const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(p));
+        uint16x8_t hit = vdupq_n_u16(0);
+        for (int t = 0; t < asciiCount_; t++) {
+            hit = vorrq_u16(hit, vceqq_u16(v, vdupq_n_u16(ascii_[t])));
+        }
+        if (hasNonAscii_) {
+            hit = vorrq_u16(hit, vtstq_u16(v, vdupq_n_u16(0xFF80)));
+        }
+        return vmaxvq_u16(hit) != 0;
+    }
+#endif
+
+    std::array<uint64_t, 1024> bits_{};
+    std::array<uint16_t, kMaxAsciiLanes> ascii_{};
+    int asciiCount_ = 0;
+    bool hasNonAscii_ = false;
+    bool matchAll_ = false;
+};
+
+} // namespace streamnative
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "StreamSnapshot.h"
+
+namespace streamnative {
+
+// Incremental UTF-8 to UTF-16 decoder for byte streams (model output as the tokenizer
+// produces it). A sequence cut by a chunk boundary is held back until the next call, and
+// each maximal malformed subsequence decodes to one U+FFFD, as Java's decoder does.
+//
+// Every decoded unit keeps the stream offset of the byte its char started at, so offsets in
+// UTF-16 units can be translated back to bytes. Only a window of that map is kept: callers
+// discard units they will not ask about again.
+class Utf8StreamDecoder {
+public:
+    // Appends the UTF-16 units completed by bytes to out.
+    void decode(const uint8_t* bytes, int len, std::vector<jchar>& out) {
+        for (int i = 0; i < len; i++) {
+            const uint8_t b = bytes[i];
+            if (need_ == 0) {
+                if (b < 0x80u) {
+                    emit(out, b, byteCount_, byteCount_ + 1);
+                } else if (!startSequence(b)) {
+                    emit(out, 0xFFFDu, byteCount_, byteCount_ + 1);
+                }
+                byteCount_++;
+                continue;
+            }
+            if (b < lower_ || b > upper_) {
+                // Malformed: the partial sequence becomes U+FFFD and b starts over.
+                need_ = 0;
+                emit(out, 0xFFFDu, sequenceStart_, byteCount_);
+                i--;
+                continue;
+            }
+            codePoint_ = (codePoint_ << 6u) | (b & 0x3Fu);
+            lower_ = 0x80u;
+            upper_ = 0xBFu;
+            byteCount_++;
+            if (--need_ == 0) {
+                emit(out, codePoint_, sequenceStart_, byteCount_);
+            }
+        }
+    }
+
+    // End of input: a held-back partial sequence becomes U+FFFD.
+    void finish(std::vector<jchar>& out) {
+        if (need_ > 0) {
+            need_ = 0;
+            emit(out, 0xFFFDu, sequenceStart_, byteCount_);
+        }
+    }
+
+    // UTF-16 units decoded so far.
+    int unitCount() const { return windowStart_ + static_cast<int>(offsets_.size()); }
+
+    // Byte offset of unit (a position in the decoded stream, up to unitCount() inclusive,
+    // which maps to the end of the last complete char). Units before the window clamp to it.
+    int byteOffset(int unit) const {
+        const int index = std::max(unit - windowStart_, 0);
+        if (index >= static_cast<int>(offsets_.size())) {
+            return completeBytes_;
+        }
+        return offsets_[static_cast<size_t>(index)];
+    }
+
+    // Forgets the byte offsets of units before unit.
+    void discardBefore(int unit) {
+        const int drop = unit - windowStart_;
+        if (drop <= 0) {
+            return;
+        }
+        if (drop >= static_cast<int>(offsets_.size())) {
+            windowStart_ += static_cast<int>(offsets_.size());
+            offsets_.clear();
+            return;
+        }
+        offsets_.erase(offsets_.begin(), offsets_.begin() + drop);
+        windowStart_ = unit;
+    }
+
+    // Continues unit numbering at unit (used when the owner already consumed UTF-16 input).
+    void rebase(int unit) {
+        offsets_.clear();
+        windowStart_ = unit;
+    }
+
+    void saveState(SnapshotWriter& out) const {
+        out.putUInt(static_cast<uint64_t>(byteCount_));
+        out.putUInt(static_cast<uint64_t>(completeBytes_));
+        out.putUInt(need_);
+        if (need_ > 0) {
+            out.putUInt(codePoint_);
+            out.putUInt(static_cast<uint64_t>(sequenceStart_));
+            out.putUInt(lower_);
+            out.putUInt(upper_);
+        }
+        out.putUInt(static_cast<uint64_t>(windowStart_));
+        out.putUInt(offsets_.size());
+        for (int offset : offsets_) {
+            out.putUInt(static_cast<uint64_t>(offset));
+        }
+    }
+
+    bool restoreState(SnapshotReader& in) {
+        uint32_t byteCount = 0;
+        uint32_t completeBytes = 0;
+        uint32_t windowStart = 0;
+        uint32_t count = 0;
+        constexpr uint32_t kMaxOffset = INT32_MAX;
+        if (!in.getUInt(byteCount, kMaxOffset) || !in.getUInt(completeBytes, byteCount) || !in.getUInt(need_, 3)) {
+            return false;
+        }
+        if (need_ > 0) {
+            uint32_t sequenceStart = 0;
+            if (!in.getUInt(codePoint_, 0x10FFFFu) || !in.getUInt(sequenceStart, byteCount) ||
+                !in.getUInt(lower_, 0xBFu) || !in.getUInt(upper_, 0xBFu)) {
+                return false;
+            }
+            sequenceStart_ = static_cast<int>(sequenceStart);
+        }
+        if (!in.getUInt(windowStart, kMaxOffset) || !in.getUInt(count, static_cast<uint32_t>(in.remaining()))) {
+            return false;
+        }
+        byteCount_ = static_cast<int>(byteCount);
+        completeBytes_ = static_cast<int>(completeBytes);
+        windowStart_ = static_cast<int>(windowStart);
+        offsets_.resize(count);
+        for (auto& offset : offsets_) {
+            uint32_t v = 0;
+            if (!in.getUInt(v, completeBytes)) {
+                return false;
+            }
+            offset = static_cast<int>(v);
+        }
+        return true;
+    }
+
+private:
+    bool startSequence(uint8_t b) {
+        // Lead bytes and the range of the byte after them (excludes overlongs, surrogates
+        // and code points above U+10FFFF).
+        lower_ = 0x80u;
+        upper_ = 0xBFu;
+        if (b >= 0xC2u && b <= 0xDFu) {
+            need_ = 1;
+            codePoint_ = b & 0x1Fu;
+        } else if (b >= 0xE0u && b <= 0xEFu) {
+            need_ = 2;
+            codePoint_ = b & 0x0Fu;
+            lower_ = (b == 0xE0u) ? 0xA0u : 0x80u;
+            upper_ = (b == 0xEDu) ? 0x9Fu : 0xBFu;
+        } else if (b >= 0xF0u && b <= 0xF4u) {
+            need_ = 3;
+            codePoint_ = b & 0x07u;
+            lower_ = (b == 0xF0u) ? 0x90u : 0x80u;
+            upper_ = (b == 0xF4u) ? 0x8Fu : 0xBFu;
+        } else {
+            return false;
+        }
+        sequenceStart_ = byteCount_;
+        return true;
+    }
+
+    void emit(std::vector<jchar>& out, uint32_t codePoint, int byteStart, int byteEnd) {
+        if (codePoint >= 0x10000u) {
+            const uint32_t v = codePoint - 0x10000u;
+            out.push_back(static_cast<jchar>(0xD800u + (v >> 10u)));
+            out.push_back(static_cast<jchar>(0xDC00u + (v & 0x3FFu)));
+            offsets_.push_back(byteStart);
+            offsets_.push_back(byteStart);
+        } else {
+            out.push_back(static_cast<jchar>(codePoint));
+            offsets_.push_back(byteStart);
+        }
+        completeBytes_ = byteEnd;
+    }
+
+    int byteCount_ = 0;     // bytes consumed, including a held-back partial sequence
+    int completeBytes_ = 0; // end of the last decoded char
+    uint32_t need_ = 0;     // continuation bytes still expected
+    uint32_t codePoint_ = 0;
+    int sequenceStart_ = 0;
+    uint32_t lower_ = 0x80u;
+    uint32_t upper_ = 0xBFu;
+
+    int windowStart_ = 0;
+    std::vector<int> offsets_;
+};
+
+} // namespace streamnative
@@ -0,0 +1,189 @@
+#include "JniShim.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+class HostString final : public _jstring {
+public:
+    std::u16string chars;
+};
+
+class HostByteArray final : public _jbyteArray {
+public:
+    std::vector<jbyte> elements;
+};
+
+class HostIntArray final : public _jintArray {
+public:
+    std::vector<jint> elements;
+};
+
+class HostDirectBuffer final : public _jobject {
+public:
+    void* address = nullptr;
+    jlong capacity = 0;
+};
+
+thread_local std::vector<std::unique_ptr<_jobject>> localRefs;
+
+// A JVM would throw; on the host a misuse is a bug in the code under test.
+[[noreturn]] void fatal(const char* what) {
+    std::fprintf(stderr, "jnishim: %s\n", what);
+    std::abort();
+}
+
+template <typename T>
+T* track(T* object) {
+    localRefs.emplace_back(object);
+    return object;
+}
+
+template <typename T, typename Ref>
+T& checked(Ref ref, const char* what) {
+    auto* object = dynamic_cast<T*>(static_cast<_jobject*>(ref));
+    if (object == nullptr) {
+        fatal(what);
+    }
+    return *object;
+}
+
+template <typename E>
+void checkRegion(const std::vector<E>& elements, jsize start, jsize len) {
+    if (start < 0 || len < 0 || static_cast<size_t>(start) + static_cast<size_t>(len) > elements.size()) {
+        fatal("array region out of bounds");
+    }
+}
+
+} // namespace
+
+jstring _JNIEnv::NewString(const jchar* unicode, jsize len) {
+    auto* s = track(new HostString());
+    s->chars.assign(reinterpret_cast<const char16_t*>(unicode), static_cast<size_t>(len));
+    return s;
+}
+
+jsize _JNIEnv::GetStringLength(jstring str) {
+    return static_cast<jsize>(checked<HostString>(str, "GetStringLength on a non-string").chars.size());
+}
+
+const jchar* _JNIEnv::GetStringChars(jstring str, jboolean* isCopy) {
+    if (isCopy != nullptr) {
+        *isCopy = JNI_FALSE;
+    }
+    return reinterpret_cast<const jchar*>(checked<HostString>(str, "GetStringChars on a non-string").chars.data());
+}
+
+void _JNIEnv::ReleaseStringChars(jstring /*str*/, const jchar* /*chars*/) {}
+
+jsize _JNIEnv::GetArrayLength(jarray array) {
+    if (auto* bytes = dynamic_cast<HostByteArray*>(array)) {
+        return static_cast<jsize>(bytes->elements.size());
+    }
+    return static_cast<jsize>(checked<HostIntArray>(array, "GetArrayLength on a non-array").elements.size());
+}
+
+jbyteArray _JNIEnv::NewByteArray(jsize len) {
+    auto* array = track(new HostByteArray());
+    array->elements.assign(static_cast<size_t>(len), 0);
+    return array;
+}
+
+void _JNIEnv::GetByteArrayRegion(jbyteArray array, jsize start, jsize len, jbyte* buf) {
+    auto& elements = checked<HostByteArray>(array, "GetByteArrayRegion on a non-byte[]").elements;
+    checkRegion(elements, start, len);
+    if (len == 0) {
+        return;
+    }
+    std::memcpy(buf, elements.data() + start, static_cast<size_t>(len) * sizeof(jbyte));
+}
+
+void _JNIEnv::SetByteArrayRegion(jbyteArray array, jsize start, jsize len, const jbyte* buf) {
+    auto& elements = checked<HostByteArray>(array, "SetByteArrayRegion on a non-byte[]").elements;
+    checkRegion(elements, start, len);
+    if (len == 0) {
+        return;
+    }
+    std::memcpy(elements.data() + start, buf, static_cast<size_t>(len) * sizeof(jbyte));
+}
+
+jintArray _JNIEnv::NewIntArray(jsize len) {
+    auto* array = track(new HostIntArray());
+    array->elements.assign(static_cast<size_t>(len), 0);
+    return array;
+}
+
+void _JNIEnv::GetIntArrayRegion(jintArray array, jsize start, jsize len, jint* buf) {
+    auto& elements = checked<HostIntArray>(array, "GetIntArrayRegion on a non-int[]").elements;
+    checkRegion(elements, start, len);
+    if (len == 0) {
+        return;
+    }
+    std::memcpy(buf, elements.data() + start, static_cast<size_t>(len) * sizeof(jint));
+}
+
+void _JNIEnv::SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint* buf) {
+    auto& elements = checked<HostIntArray>(array, "SetIntArrayRegion on a non-int[]").elements;
+    checkRegion(elements, start, len);
+    if (len == 0) {
+        return;
+    }
+    std::memcpy(elements.data() + start, buf, static_cast<size_t>(len) * sizeof(jint));
+}
+
+jobject _JNIEnv::NewDirectByteBuffer(void* address, jlong capacity) {
+    auto* buffer = track(new HostDirectBuffer());
+    buffer->address = address;
+    buffer->capacity = capacity;
+    return buffer;
+}
+
+void* _JNIEnv::GetDirectBufferAddress(jobject buf) {
+    return checked<HostDirectBuffer>(buf, "GetDirectBufferAddress on a non-buffer").address;
+}
+
+jlong _JNIEnv::GetDirectBufferCapacity(jobject buf) {
+    return checked<HostDirectBuffer>(buf, "GetDirectBufferCapacity on a non-buffer").capacity;
+}
+
+namespace jnishim {
+
+JNIEnv* env() {
+    thread_local _JNIEnv instance;
+    return &instance;
+}
+
+void releaseLocalRefs() {
+    localRefs.clear();
+}
+
+size_t localRefCount() {
+    return localRefs.size();
+}
+
+jstring newString(const std::u16string& s) {
+    return env()->NewString(reinterpret_cast<const jchar*>(s.data()), static_cast<jsize>(s.size()));
+}
+
+std::vector<jint> intArrayElements(jintArray array) {
+    std::vector<jint> out(static_cast<size_t>(env()->GetArrayLength(array)));
+    env()->GetIntArrayRegion(array, 0, static_cast<jsize>(out.size()), out.data());
+    return out;
+}
+
+std::vector<uint8_t> byteArrayElements(jbyteArray array) {
+    std::vector<uint8_t> out(static_cast<size_t>(env()->GetArrayLength(array)));
+    env()->GetByteArrayRegion(array, 0, static_cast<jsize>(out.size()), reinterpret_cast<jbyte*>(out.data()));
+    return out;
+}
+
+jbyteArray newByteArray(const std::vector<uint8_t>& bytes) {
+    jbyteArray array = env()->NewByteArray(static_cast<jsize>(bytes.size()));
+    env()->SetByteArrayRegion(array, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<const jbyte*>(bytes.data()));
+    return array;
+}
+
+} // namespace jnishim
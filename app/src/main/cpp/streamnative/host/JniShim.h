@@ -0,0 +1,25 @@
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Host-side JNI environment for tests and benchmarks. Objects created through the env are
+// local references owned by the calling thread until releaseLocalRefs(), much like the
+// references a JVM frees when a native method returns.
+namespace jnishim {
+
+JNIEnv* env();
+
+void releaseLocalRefs();
+size_t localRefCount();
+
+jstring newString(const std::u16string& s);
+std::vector<jint> intArrayElements(jintArray array);
+std::vector<uint8_t> byteArrayElements(jbyteArray array);
+jbyteArray newByteArray(const std::vector<uint8_t>& bytes);
+
+} // namespace jnishim
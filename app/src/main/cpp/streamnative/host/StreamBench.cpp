@@ -0,0 +1,355 @@
+#include <jni.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "JniShim.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+
+extern "C" {
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(JNIEnv*, jobject, jboolean);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(JNIEnv*, jobject, jlong);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(JNIEnv*, jobject, jlong);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(JNIEnv*, jobject, jlong);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(JNIEnv*, jobject, jlong, jint);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDrainDirect(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeParseMarkdown(JNIEnv*, jobject, jstring);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeCreateIncrementalParser(JNIEnv*, jobject);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeDestroyIncrementalParser(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeAppendIncremental(JNIEnv*, jobject, jlong, jstring);
+}
+
+// Every heap allocation in the process goes through here, so the benchmark can report
+// allocations per push without an external profiler.
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+} // namespace
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using streamnative::Segment;
+using namespace streamnative::host;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string traceDir = defaultTraceDir();
+    size_t minChars = 4u << 20; // chars replayed per trace and mode
+    size_t chunkChars = 0;      // 0 keeps the recorded chunking
+};
+
+// Per-push samples of one (trace, mode) run.
+struct PushStats {
+    std::vector<int64_t> nanos;
+    uint64_t chars = 0;
+    uint64_t allocations = 0;
+
+    // chunkChars is the chunk length in UTF-16 units, whatever encoding push feeds.
+    template <typename Push>
+    void measure(size_t chunkChars, Push push) {
+        const uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        push();
+        const auto end = Clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+        nanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        chars += chunkChars;
+    }
+
+    int64_t percentile(double p) {
+        if (nanos.empty()) {
+            return 0;
+        }
+        const size_t k = std::min(nanos.size() - 1, static_cast<size_t>(p * static_cast<double>(nanos.size())));
+        std::nth_element(nanos.begin(), nanos.begin() + static_cast<std::ptrdiff_t>(k), nanos.end());
+        return nanos[k];
+    }
+
+    void print(const std::string& trace, const char* mode) {
+        int64_t total = 0;
+        for (int64_t n : nanos) {
+            total += n;
+        }
+        const double mcharsPerSec = total > 0 ? static_cast<double>(chars) * 1e3 / static_cast<double>(total) : 0.0;
+        const double allocsPerPush = nanos.empty() ? 0.0 : static_cast<double>(allocations) / static_cast<double>(nanos.size());
+        const int64_t p50 = percentile(0.50);
+        const int64_t p99 = percentile(0.99);
+        std::printf("%-14s %-14s %9zu %10.2f %9lld %9lld %11.2f\n", trace.c_str(), mode, nanos.size(), mcharsPerSec,
+                    static_cast<long long>(p50), static_cast<long long>(p99), allocsPerPush);
+    }
+};
+
+void printHeader(const char* title) {
+    std::printf("\n%s\n%-14s %-14s %9s %10s %9s %9s %11s\n", title, "trace", "mode", "pushes", "Mchars/s", "p50 ns",
+                "p99 ns", "allocs/push");
+}
+
+// Replays chunks through fresh sessions until at least minChars were pushed.
+template <typename Open, typename Push, typename Close>
+void replay(const std::vector<std::u16string>& chunks, const Options& options, PushStats& stats, Open open,
+            Push push, Close close) {
+    while (stats.chars < options.minChars) {
+        auto session = open();
+        for (size_t i = 0; i < chunks.size(); i++) {
+            stats.measure(chunks[i].size(), [&] { push(session, i); });
+        }
+        close(session);
+    }
+}
+
+void benchMarkdownSessions(const std::vector<Trace>& traces, const Options& options) {
+    printHeader("MarkdownSession push (segments appended to a reused vector)");
+    struct Mode {
+        const char* name;
+        bool block;
+        bool tableDriven;
+    };
+    const Mode modes[] = {
+            {"block", true, false},
+            {"block-dfa", true, true},
+            {"inline", false, false},
+            {"inline-dfa", false, true},
+    };
+
+    for (const auto& trace : traces) {
+        const auto chunks = options.chunkChars > 0 ? rechunk(trace.text(), options.chunkChars) : trace.chunks;
+        for (const Mode& mode : modes) {
+            PushStats stats;
+            std::vector<Segment> out;
+            replay(
+                    chunks, options, stats,
+                    [&] {
+                        return mode.block ? streamnative::createMarkdownBlockSession(mode.tableDriven)
+                                          : streamnative::createMarkdownInlineSession(mode.tableDriven);
+                    },
+                    [&](streamnative::MarkdownSession* session, size_t i) {
+                        out.clear();
+                        streamnative::markdownSessionPush(session, reinterpret_cast<const jchar*>(chunks[i].data()),
+                                                          static_cast<int>(chunks[i].size()), out);
+                    },
+                    [](streamnative::MarkdownSession* session) { streamnative::destroyMarkdownSession(session); });
+            stats.print(trace.name, mode.name);
+        }
+
+        // The same chunks as UTF-8 bytes, as a native token stream would deliver them.
+        {
+            std::vector<std::string> utf8Chunks;
+            for (const auto& chunk : chunks) {
+                utf8Chunks.push_back(utf16ToUtf8(chunk));
+            }
+            PushStats stats;
+            std::vector<streamnative::Utf8Segment> out;
+            replay(
+                    chunks, options, stats, [] { return streamnative::createMarkdownBlockSession(true); },
+                    [&](streamnative::MarkdownSession* session, size_t i) {
+                        out.clear();
+                        streamnative::markdownSessionPushUtf8(session, reinterpret_cast<const uint8_t*>(utf8Chunks[i].data()),
+                                                              static_cast<int>(utf8Chunks[i].size()), out);
+                    },
+                    [](streamnative::MarkdownSession* session) { streamnative::destroyMarkdownSession(session); });
+            stats.print(trace.name, "block-dfa-utf8");
+        }
+
+        // Coalescing with a 256-char / 16 ms budget; deltas/push is the share of pushes that
+        // would invalidate the UI.
+        {
+            PushStats stats;
+            std::vector<Segment> out;
+            uint64_t deltas = 0;
+            replay(
+                    chunks, options, stats,
+                    [] {
+                        auto* session = streamnative::createMarkdownBlockSession(true);
+                        streamnative::markdownSessionSetCoalescing(session, 256, 16);
+                        return session;
+                    },
+                    [&](streamnative::MarkdownSession* session, size_t i) {
+                        out.clear();
+                        streamnative::markdownSessionPush(session, reinterpret_cast<const jchar*>(chunks[i].data()),
+                                                          static_cast<int>(chunks[i].size()), out);
+                        deltas += out.empty() ? 0u : 1u;
+                    },
+                    [](streamnative::MarkdownSession* session) { streamnative::destroyMarkdownSession(session); });
+            stats.print(trace.name, "block-dfa-coal");
+            std::printf("%-14s %-14s deltas/push %.3f\n", "", "", static_cast<double>(deltas) / static_cast<double>(stats.nanos.size()));
+        }
+
+        // The JNI direct transport: chunk copied into the shared input buffer, segments
+        // published into the ring, as NativeMarkdownSplitter.Session.pushDirect does.
+        JNIEnv* env = jnishim::env();
+        PushStats stats;
+        jchar* input = nullptr;
+        replay(
+                chunks, options, stats,
+                [&] {
+                    const jlong handle = Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(
+                            env, nullptr, JNI_FALSE);
+                    input = static_cast<jchar*>(env->GetDirectBufferAddress(
+                            Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(env, nullptr, handle)));
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(env, nullptr, handle);
+                    jnishim::releaseLocalRefs();
+                    return handle;
+                },
+                [&](jlong handle, size_t i) {
+                    std::copy(chunks[i].begin(), chunks[i].end(), input);
+                    jlong published = Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(
+                            env, nullptr, handle, static_cast<jint>(chunks[i].size()));
+                    while ((published & 0x80000000LL) != 0) {
+                        published = Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDrainDirect(
+                                env, nullptr, handle);
+                    }
+                },
+                [&](jlong handle) {
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, handle);
+                });
+        stats.print(trace.name, "block-direct");
+    }
+}
+
+void benchIncrementalParser(const std::vector<Trace>& traces, const Options& options) {
+    printHeader("NativeMarkdownParser.appendIncremental (allocations include the result int[])");
+    JNIEnv* env = jnishim::env();
+    for (const auto& trace : traces) {
+        const auto chunks = options.chunkChars > 0 ? rechunk(trace.text(), options.chunkChars) : trace.chunks;
+        std::vector<jstring> strings;
+        for (const auto& chunk : chunks) {
+            strings.push_back(jnishim::newString(chunk));
+        }
+
+        PushStats stats;
+        replay(
+                chunks, options, stats,
+                [&] {
+                    return Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeCreateIncrementalParser(env, nullptr);
+                },
+                [&](jlong handle, size_t i) {
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeAppendIncremental(
+                            env, nullptr, handle, strings[i]);
+                },
+                [&](jlong handle) {
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeDestroyIncrementalParser(env, nullptr, handle);
+                    // Drop the result arrays but keep the chunk strings.
+                    strings.clear();
+                    jnishim::releaseLocalRefs();
+                    for (const auto& chunk : chunks) {
+                        strings.push_back(jnishim::newString(chunk));
+                    }
+                });
+        stats.print(trace.name, "incremental");
+        jnishim::releaseLocalRefs();
+    }
+}
+
+// Whole-document calls: one "push" is one call over the trace text repeated to about 1M chars.
+template <typename Call>
+void benchWholeText(const std::string& trace, const char* mode, const std::u16string& text, const Options& options,
+                    Call call) {
+    PushStats stats;
+    while (stats.chars < options.minChars) {
+        stats.measure(text.size(), [&] { call(text); });
+    }
+    jnishim::releaseLocalRefs();
+    stats.print(trace, mode);
+}
+
+void benchWholeDocuments(const std::vector<Trace>& traces, const Options& options) {
+    printHeader("Whole documents: splitByXml by thread count, nativeParseMarkdown");
+    JNIEnv* env = jnishim::env();
+    const size_t docChars = std::min<size_t>(options.minChars / 4, 1u << 20);
+    for (const auto& trace : traces) {
+        const std::u16string once = trace.text();
+        std::u16string text;
+        while (text.size() < docChars) {
+            text += once;
+        }
+
+        const struct {
+            const char* name;
+            int threads;
+        } splits[] = {{"xml-1t", 1}, {"xml-2t", 2}, {"xml-4t", 4}, {"xml-auto", 0}};
+        for (const auto& split : splits) {
+            benchWholeText(trace.name, split.name, text, options, [&](const std::u16string& t) {
+                streamnative::splitByXml(reinterpret_cast<const jchar*>(t.data()), static_cast<int>(t.size()), split.threads);
+            });
+        }
+
+        jstring content = jnishim::newString(text);
+        benchWholeText(trace.name, "parse", text, options, [&](const std::u16string&) {
+            Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeParseMarkdown(env, nullptr, content);
+        });
+    }
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: streamnative_bench [--traces=DIR] [--min-chars=N] [--chunk=N] [--quick]\n"
+                 "  --traces     directory of *.trace files (default: the committed traces)\n"
+                 "  --min-chars  chars replayed per trace and mode (default 4194304)\n"
+                 "  --chunk      re-split every trace into N-char chunks instead of the recorded ones\n"
+                 "  --quick      smoke run with --min-chars=20000\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--traces=", 0) == 0) {
+            options.traceDir = arg.substr(9);
+        } else if (arg.rfind("--min-chars=", 0) == 0) {
+            options.minChars = std::strtoull(arg.c_str() + 12, nullptr, 10);
+        } else if (arg.rfind("--chunk=", 0) == 0) {
+            options.chunkChars = std::strtoull(arg.c_str() + 8, nullptr, 10);
+        } else if (arg == "--quick") {
+            options.minChars = 20000;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    const std::vector<Trace> traces = loadTraces(options.traceDir);
+    std::printf("%zu traces from %s, %zu chars per run, %s chunking\n", traces.size(), options.traceDir.c_str(),
+                options.minChars, options.chunkChars > 0 ? std::to_string(options.chunkChars).c_str() : "recorded");
+
+    benchMarkdownSessions(traces, options);
+    benchIncrementalParser(traces, options);
+    benchWholeDocuments(traces, options);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Small gtest-compatible subset (TEST, EXPECT_*, ASSERT_*) so the host suite builds with
+// nothing but a C++17 compiler. TestMain.cpp runs every registered test.
+
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace testing {
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    std::function<void()> body;
+};
+
+std::vector<TestCase>& registry();
+void recordFailure(const char* file, int line, const std::string& message);
+
+struct Registrar {
+    Registrar(const char* suite, const char* name, std::function<void()> body) {
+        registry().push_back({suite, name, std::move(body)});
+    }
+};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct Printable : std::false_type {};
+
+template <typename T>
+struct Printable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>>
+        : std::true_type {};
+
+template <typename T>
+std::string describe(const T& value) {
+    if constexpr (Printable<T>::value) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    } else {
+        return "<" + std::to_string(sizeof(T)) + "-byte object>";
+    }
+}
+
+template <typename T>
+std::string describe(const std::vector<T>& values) {
+    std::string out = "[";
+    for (size_t i = 0; i < values.size() && i < 32; i++) {
+        out += (i == 0 ? "" : " ") + describe(values[i]);
+    }
+    return out + (values.size() > 32 ? " ... " + std::to_string(values.size()) + " items]" : "]");
+}
+
+template <typename A, typename B>
+bool expectEq(const A& a, const B& b, const char* as, const char* bs, const char* file, int line) {
+    if (a == b) {
+        return true;
+    }
+    recordFailure(file, line, std::string("expected ") + as + " == " + bs + "\n    lhs: " + describe(a) +
+                                      "\n    rhs: " + describe(b));
+    return false;
+}
+
+inline bool expectTrue(bool v, const char* expr, const char* file, int line) {
+    if (!v) {
+        recordFailure(file, line, std::string("expected ") + expr);
+    }
+    return v;
+}
+
+} // namespace detail
+} // namespace testing
+
+#define TEST(suite, name)                                                                   \
+    static void suite##_##name##_body();                                                    \
+    static const ::testing::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name##_body); \
+    static void suite##_##name##_body()
+
+#define EXPECT_EQ(a, b) ::testing::detail::expectEq((a), (b), #a, #b, __FILE__, __LINE__)
+#define EXPECT_NE(a, b) ::testing::detail::expectTrue((a) != (b), #a " != " #b, __FILE__, __LINE__)
+#define EXPECT_TRUE(v) ::testing::detail::expectTrue(static_cast<bool>(v), #v, __FILE__, __LINE__)
+#define EXPECT_FALSE(v) ::testing::detail::expectTrue(!(v), "!(" #v ")", __FILE__, __LINE__)
+
+#define ASSERT_EQ(a, b) if (!EXPECT_EQ(a, b)) return
+#define ASSERT_TRUE(v) if (!EXPECT_TRUE(v)) return
+#define ASSERT_FALSE(v) if (!EXPECT_FALSE(v)) return
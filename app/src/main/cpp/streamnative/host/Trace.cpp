@@ -0,0 +1,205 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+
+#ifndef STREAMNATIVE_TRACE_DIR
+#define STREAMNATIVE_TRACE_DIR "traces"
+#endif
+
+namespace streamnative {
+namespace host {
+
+namespace {
+
+bool unescapeLine(const std::string& line, std::string& out) {
+    out.clear();
+    for (size_t i = 1; i < line.size(); i++) {
+        const char c = line[i];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++i == line.size()) {
+            return false;
+        }
+        switch (line[i]) {
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 's': out.push_back(' '); break;
+            case '\\': out.push_back('\\'); break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+std::u16string Trace::text() const {
+    std::u16string out;
+    for (const auto& chunk : chunks) {
+        out += chunk;
+    }
+    return out;
+}
+
+bool loadTrace(const std::string& path, Trace& out, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    const size_t slash = path.find_last_of('/');
+    out.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    if (endsWith(out.name, ".trace")) {
+        out.name.resize(out.name.size() - 6);
+    }
+    out.chunks.clear();
+
+    std::string line;
+    std::string chunk;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] != '|' || !unescapeLine(line, chunk)) {
+            error = path + ":" + std::to_string(lineNumber) + ": malformed chunk line";
+            return false;
+        }
+        out.chunks.push_back(utf8ToUtf16(chunk));
+    }
+    if (out.chunks.empty()) {
+        error = path + ": no chunks";
+        return false;
+    }
+    return true;
+}
+
+std::vector<Trace> loadTraces(const std::string& dir) {
+    std::vector<std::string> paths;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (const dirent* entry = readdir(d)) {
+            const std::string name = entry->d_name;
+            if (endsWith(name, ".trace")) {
+                paths.push_back(dir + "/" + name);
+            }
+        }
+        closedir(d);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<Trace> traces;
+    for (const auto& path : paths) {
+        Trace trace;
+        std::string error;
+        if (!loadTrace(path, trace, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            std::exit(2);
+        }
+        traces.push_back(std::move(trace));
+    }
+    if (traces.empty()) {
+        std::fprintf(stderr, "no .trace files in %s\n", dir.c_str());
+        std::exit(2);
+    }
+    return traces;
+}
+
+std::string defaultTraceDir() {
+    return STREAMNATIVE_TRACE_DIR;
+}
+
+std::vector<std::u16string> rechunk(const std::u16string& text, size_t chunkChars) {
+    std::vector<std::u16string> chunks;
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t end = std::min(text.size(), i + std::max<size_t>(chunkChars, 1));
+        if (end < text.size() && end - i > 1 && text[end - 1] >= 0xD800 && text[end - 1] <= 0xDBFF) {
+            end--;
+        }
+        chunks.push_back(text.substr(i, end - i));
+        i = end;
+    }
+    return chunks;
+}
+
+std::u16string utf8ToUtf16(const std::string& s) {
+    std::u16string out;
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        const auto b = static_cast<unsigned char>(s[i]);
+        uint32_t cp = 0xFFFD;
+        size_t n = 1;
+        if (b < 0x80) {
+            cp = b;
+        } else if ((b >> 5) == 0x6 && i + 1 < s.size()) {
+            cp = ((b & 0x1Fu) << 6) | (static_cast<unsigned char>(s[i + 1]) & 0x3Fu);
+            n = 2;
+        } else if ((b >> 4) == 0xE && i + 2 < s.size()) {
+            cp = ((b & 0x0Fu) << 12) | ((static_cast<unsigned char>(s[i + 1]) & 0x3Fu) << 6) |
+                 (static_cast<unsigned char>(s[i + 2]) & 0x3Fu);
+            n = 3;
+        } else if ((b >> 3) == 0x1E && i + 3 < s.size()) {
+            cp = ((b & 0x07u) << 18) | ((static_cast<unsigned char>(s[i + 1]) & 0x3Fu) << 12) |
+                 ((static_cast<unsigned char>(s[i + 2]) & 0x3Fu) << 6) | (static_cast<unsigned char>(s[i + 3]) & 0x3Fu);
+            n = 4;
+        }
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+            out.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FFu)));
+        } else {
+            out.push_back(static_cast<char16_t>(cp));
+        }
+        i += n;
+    }
+    return out;
+}
+
+std::string utf16ToUtf8(const std::u16string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        uint32_t cp = s[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < s.size() && s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+            i++;
+        }
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+    return out;
+}
+
+} // namespace host
+} // namespace streamnative
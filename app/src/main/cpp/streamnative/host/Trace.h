@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace streamnative {
+namespace host {
+
+// A recorded stream: the chunks a model response arrived in, in order.
+// On disk (traces/*.trace) each chunk is one UTF-8 line prefixed with '|', with
+// \n \r \t \\ escaped and trailing spaces written as \s; lines starting with '#' are comments.
+struct Trace {
+    std::string name;
+    std::vector<std::u16string> chunks;
+
+    std::u16string text() const;
+};
+
+bool loadTrace(const std::string& path, Trace& out, std::string& error);
+
+// Every *.trace file in dir, sorted by name. Exits the process when dir has none.
+std::vector<Trace> loadTraces(const std::string& dir);
+
+// Directory of the committed traces, baked in at configure time.
+std::string defaultTraceDir();
+
+// Same text, re-split into chunks of chunkChars UTF-16 units (never splitting a surrogate pair).
+std::vector<std::u16string> rechunk(const std::u16string& text, size_t chunkChars);
+
+std::u16string utf8ToUtf16(const std::string& s);
+std::string utf16ToUtf8(const std::u16string& s);
+
+} // namespace host
+} // namespace streamnative
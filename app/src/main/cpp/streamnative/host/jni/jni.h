@@ -0,0 +1,63 @@
+#pragma once
+
+// Minimal stand-in for the NDK's <jni.h>, enough to compile the streamnative JNI entry
+// points on a desktop host. Only the JNIEnv calls those files make are declared; they are
+// implemented over std containers in JniShim.cpp.
+
+#include <cstdint>
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {
+public:
+    virtual ~_jobject() = default;
+};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jarray : public _jobject {};
+class _jbyteArray : public _jarray {};
+class _jintArray : public _jarray {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jarray* jarray;
+typedef _jbyteArray* jbyteArray;
+typedef _jintArray* jintArray;
+
+struct _JNIEnv {
+    jstring NewString(const jchar* unicode, jsize len);
+    jsize GetStringLength(jstring str);
+    const jchar* GetStringChars(jstring str, jboolean* isCopy);
+    void ReleaseStringChars(jstring str, const jchar* chars);
+
+    jsize GetArrayLength(jarray array);
+
+    jbyteArray NewByteArray(jsize len);
+    void GetByteArrayRegion(jbyteArray array, jsize start, jsize len, jbyte* buf);
+    void SetByteArrayRegion(jbyteArray array, jsize start, jsize len, const jbyte* buf);
+
+    jintArray NewIntArray(jsize len);
+    void GetIntArrayRegion(jintArray array, jsize start, jsize len, jint* buf);
+    void SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint* buf);
+
+    jobject NewDirectByteBuffer(void* address, jlong capacity);
+    void* GetDirectBufferAddress(jobject buf);
+    jlong GetDirectBufferCapacity(jobject buf);
+};
+
+typedef _JNIEnv JNIEnv;
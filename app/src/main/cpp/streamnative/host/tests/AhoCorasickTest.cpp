@@ -0,0 +1,75 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "streamnative/StreamAhoCorasick.h"
+
+using streamnative::AhoCorasickMatcher;
+
+namespace {
+
+std::u16string randomString(std::mt19937& rng, size_t minLen, size_t maxLen) {
+    // A small alphabet (with one wide char) makes overlapping patterns common.
+    static const char16_t alphabet[] = {u'<', u'/', u'a', u'b', u'>', u'中'};
+    std::uniform_int_distribution<size_t> len(minLen, maxLen);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) / sizeof(alphabet[0]) - 1);
+    std::u16string s(len(rng), u' ');
+    for (auto& c : s) {
+        c = alphabet[pick(rng)];
+    }
+    return s;
+}
+
+bool endsWith(const std::u16string& text, size_t end, const std::u16string& p) {
+    return end >= p.size() && text.compare(end - p.size(), p.size(), p) == 0;
+}
+
+} // namespace
+
+TEST(AhoCorasick, MatchesAgreeWithBruteForce) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 200; round++) {
+        AhoCorasickMatcher matcher;
+        std::vector<std::u16string> patterns;
+        const int patternCount = 1 + round % 12;
+        for (int i = 0; i < patternCount; i++) {
+            patterns.push_back(randomString(rng, 1, 5));
+            matcher.addPattern(patterns.back());
+        }
+
+        const std::u16string text = randomString(rng, 0, 200);
+        int state = AhoCorasickMatcher::kRootState;
+        for (size_t i = 0; i < text.size(); i++) {
+            state = matcher.step(state, text[i]);
+            for (const auto& p : patterns) {
+                ASSERT_EQ(matcher.matches(state, matcher.findPattern(p)), endsWith(text, i + 1, p));
+            }
+        }
+    }
+}
+
+TEST(AhoCorasick, DuplicatePatternsShareAnId) {
+    AhoCorasickMatcher matcher;
+    const int a = matcher.addPattern(u"</tool>");
+    const int b = matcher.addPattern(u"</param>");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(matcher.addPattern(u"</tool>"), a);
+    EXPECT_EQ(matcher.patternCount(), 2);
+    EXPECT_EQ(matcher.addPattern(u""), AhoCorasickMatcher::kNoPattern);
+    EXPECT_EQ(matcher.findPattern(u"</to"), AhoCorasickMatcher::kNoPattern);
+}
+
+TEST(AhoCorasick, PrefixStateRoundTrips) {
+    AhoCorasickMatcher matcher;
+    const std::u16string tool = u"</tool>";
+    matcher.addPattern(tool);
+    matcher.addPattern(u"</tool_result>");
+
+    int state = AhoCorasickMatcher::kRootState;
+    for (char16_t c : std::u16string(u"x</to")) {
+        state = matcher.step(state, c);
+    }
+    EXPECT_EQ(matcher.prefixMatched(state, tool), 4);
+    EXPECT_EQ(matcher.prefixState(tool, 4), state);
+}
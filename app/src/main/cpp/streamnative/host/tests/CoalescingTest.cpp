@@ -0,0 +1,248 @@
+#include <jni.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamCoalescer.h"
+#include "streamnative/StreamOperators.h"
+#include "tests/TestUtil.h"
+
+extern "C" {
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(JNIEnv*, jobject, jboolean);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePush(JNIEnv*, jobject, jlong, jstring);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeSetCoalescing(JNIEnv*, jobject, jlong, jint, jint);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlush(JNIEnv*, jobject, jlong);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(JNIEnv*, jobject, jlong);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(JNIEnv*, jobject, jlong);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(JNIEnv*, jobject, jlong, jint);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlushDirect(JNIEnv*, jobject, jlong);
+}
+
+using streamnative::MarkdownSession;
+using streamnative::Segment;
+using streamnative::SegmentCoalescer;
+using streamnative::Utf8Segment;
+using namespace streamnative::host;
+
+namespace {
+
+struct SessionDeleter {
+    void operator()(MarkdownSession* s) const { streamnative::destroyMarkdownSession(s); }
+};
+using SessionPtr = std::unique_ptr<MarkdownSession, SessionDeleter>;
+
+const std::vector<Trace>& traces() {
+    static const std::vector<Trace> loaded = loadTraces(defaultTraceDir());
+    return loaded;
+}
+
+// Token-sized chunks, the case coalescing is for.
+std::vector<std::u16string> tokens(const Trace& trace) {
+    return rechunk(trace.text(), 3);
+}
+
+bool hasBreak(const std::vector<Segment>& segments) {
+    return std::any_of(segments.begin(), segments.end(), [](const Segment& s) { return s.type == kSegBreak; });
+}
+
+} // namespace
+
+TEST(Coalescing, DeltasAreMergedAndOnlyHandedOutWhenDue) {
+    constexpr int kMaxChars = 64;
+    for (const auto& trace : traces()) {
+        const std::vector<std::u16string> chunks = tokens(trace);
+        SessionPtr plain(streamnative::createMarkdownBlockSession(true));
+        const std::vector<Segment> expected = pushAll(chunks, [&](const jchar* chars, int len) {
+            return streamnative::markdownSessionPush(plain.get(), chars, len);
+        });
+
+        SessionPtr session(streamnative::createMarkdownBlockSession(true));
+        streamnative::markdownSessionSetCoalescing(session.get(), kMaxChars, 0);
+        std::vector<Segment> all;
+        int deltas = 0;
+        int charsSinceDelta = 0;
+        for (const auto& chunk : chunks) {
+            charsSinceDelta += static_cast<int>(chunk.size());
+            const std::vector<Segment> delta = streamnative::markdownSessionPush(
+                    session.get(), reinterpret_cast<const jchar*>(chunk.data()), static_cast<int>(chunk.size()));
+            if (delta.empty()) {
+                continue;
+            }
+            EXPECT_TRUE(charsSinceDelta >= kMaxChars || hasBreak(delta));
+            EXPECT_EQ(mergeRuns(delta), delta);
+            all.insert(all.end(), delta.begin(), delta.end());
+            deltas++;
+            charsSinceDelta = 0;
+        }
+        streamnative::markdownSessionFlush(session.get(), all);
+
+        EXPECT_EQ(mergeRuns(all), mergeRuns(expected));
+        EXPECT_TRUE(deltas * 4 < static_cast<int>(chunks.size()));
+    }
+}
+
+TEST(Coalescing, TimeBudgetCountsFromTheFirstPushOfADelta) {
+    SegmentCoalescer<Segment> coalescer;
+    coalescer.configure(0, 100);
+    const Segment a{17, 0, 1};
+    const Segment b{17, 1, 2};
+    const Segment c{9, 2, 3};
+    EXPECT_FALSE(coalescer.add(&a, 1, 1, 1000));
+    EXPECT_FALSE(coalescer.add(&b, 1, 1, 1099));
+    EXPECT_TRUE(coalescer.add(&c, 1, 1, 1100));
+
+    std::vector<Segment> out;
+    coalescer.drain(out);
+    EXPECT_EQ(out, (std::vector<Segment>{{17, 0, 2}, {9, 2, 3}}));
+
+    // A push without segments still starts the clock.
+    EXPECT_FALSE(coalescer.add(nullptr, 0, 1, 5000));
+    EXPECT_TRUE(coalescer.add(&a, 1, 1, 5100));
+}
+
+TEST(Coalescing, BreakIsHandedOutImmediately) {
+    SegmentCoalescer<Segment> coalescer;
+    coalescer.configure(1 << 20, 0);
+    const std::vector<Segment> push{{8, 0, 4}, {kSegBreak, 4, 4}, {17, 4, 5}};
+    EXPECT_TRUE(coalescer.add(push.data(), push.size(), 5, 0));
+    std::vector<Segment> out;
+    coalescer.drain(out);
+    EXPECT_EQ(out, push);
+}
+
+TEST(Coalescing, TurningItOffReturnsTheHeldBackDeltaFirst) {
+    SessionPtr session(streamnative::createMarkdownBlockSession());
+    streamnative::markdownSessionSetCoalescing(session.get(), 1 << 20, 0);
+    const std::u16string first = toU16("plain text ");
+    const std::u16string second = toU16("and more");
+    EXPECT_TRUE(streamnative::markdownSessionPush(session.get(), reinterpret_cast<const jchar*>(first.data()),
+                                                  static_cast<int>(first.size())).empty());
+
+    streamnative::markdownSessionSetCoalescing(session.get(), 0, 0);
+    const std::vector<Segment> out = streamnative::markdownSessionPush(
+            session.get(), reinterpret_cast<const jchar*>(second.data()), static_cast<int>(second.size()));
+    ASSERT_FALSE(out.empty());
+    EXPECT_EQ(out.front().start, 0);
+    EXPECT_EQ(mergeRuns(out).back().end, static_cast<int>(first.size() + second.size()));
+}
+
+TEST(Coalescing, SnapshotKeepsTheHeldBackDelta) {
+    for (const auto& trace : traces()) {
+        const std::vector<std::u16string> chunks = tokens(trace);
+        SessionPtr session(streamnative::createMarkdownInlineSession());
+        streamnative::markdownSessionSetCoalescing(session.get(), 1 << 20, 0);
+        const size_t half = chunks.size() / 2;
+        std::vector<Segment> before;
+        for (size_t i = 0; i < half; i++) {
+            streamnative::markdownSessionPush(session.get(), reinterpret_cast<const jchar*>(chunks[i].data()),
+                                              static_cast<int>(chunks[i].size()), before);
+        }
+
+        const std::vector<uint8_t> bytes = streamnative::markdownSessionSnapshot(session.get());
+        SessionPtr restored(streamnative::restoreMarkdownSession(bytes.data(), bytes.size()));
+        ASSERT_TRUE(restored != nullptr);
+        std::vector<Segment> fromOriginal = before;
+        std::vector<Segment> fromRestored = before;
+        for (size_t i = half; i < chunks.size(); i++) {
+            const auto* chars = reinterpret_cast<const jchar*>(chunks[i].data());
+            const int len = static_cast<int>(chunks[i].size());
+            streamnative::markdownSessionPush(session.get(), chars, len, fromOriginal);
+            streamnative::markdownSessionPush(restored.get(), chars, len, fromRestored);
+        }
+        streamnative::markdownSessionFlush(session.get(), fromOriginal);
+        streamnative::markdownSessionFlush(restored.get(), fromRestored);
+        EXPECT_EQ(fromRestored, fromOriginal);
+    }
+}
+
+TEST(Coalescing, Utf8DeltasKeepByteOffsets) {
+    for (const auto& trace : traces()) {
+        const std::string utf8 = utf16ToUtf8(trace.text());
+        SessionPtr plain(streamnative::createMarkdownBlockSession());
+        SessionPtr session(streamnative::createMarkdownBlockSession());
+        streamnative::markdownSessionSetCoalescing(session.get(), 128, 0);
+
+        std::vector<Utf8Segment> expected;
+        std::vector<Utf8Segment> coalesced;
+        const auto* bytes = reinterpret_cast<const uint8_t*>(utf8.data());
+        for (size_t i = 0; i < utf8.size(); i += 5) {
+            const int len = static_cast<int>(std::min<size_t>(5, utf8.size() - i));
+            streamnative::markdownSessionPushUtf8(plain.get(), bytes + i, len, expected);
+            streamnative::markdownSessionPushUtf8(session.get(), bytes + i, len, coalesced);
+        }
+        streamnative::markdownSessionFlushUtf8(session.get(), coalesced);
+        EXPECT_TRUE(coalesced.size() < expected.size());
+
+        // Every coalesced segment covers a run of plain segments with the same bounds.
+        size_t next = 0;
+        for (const auto& s : coalesced) {
+            ASSERT_TRUE(next < expected.size());
+            EXPECT_EQ(expected[next].start, s.start);
+            EXPECT_EQ(expected[next].byteStart, s.byteStart);
+            while (next < expected.size() && expected[next].end != s.end) {
+                next++;
+            }
+            ASSERT_TRUE(next < expected.size());
+            EXPECT_EQ(expected[next].byteEnd, s.byteEnd);
+            next++;
+        }
+        EXPECT_EQ(next, expected.size());
+    }
+}
+
+TEST(Coalescing, JniFlushCompletesArrayAndDirectPushes) {
+    JNIEnv* env = jnishim::env();
+    for (const auto& trace : traces()) {
+        const jlong arrayHandle =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(env, nullptr, JNI_FALSE);
+        const jlong directHandle =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(env, nullptr, JNI_FALSE);
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeSetCoalescing(env, nullptr, arrayHandle, 256, 0);
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeSetCoalescing(env, nullptr, directHandle, 256, 0);
+        jobject inputBuffer =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(env, nullptr, directHandle);
+        jobject segmentBuffer =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(env, nullptr, directHandle);
+        auto* input = static_cast<jchar*>(env->GetDirectBufferAddress(inputBuffer));
+        const auto* ring = static_cast<const jint*>(env->GetDirectBufferAddress(segmentBuffer));
+        auto readRing = [ring](jlong published, std::vector<jint>& out) {
+            const jlong offset = (published >> 32) & 0x7FFFFFFF;
+            const jlong count = published & 0x7FFFFFFF;
+            out.insert(out.end(), ring + offset * 3, ring + (offset + count) * 3);
+        };
+
+        std::vector<jint> fromArray;
+        std::vector<jint> fromDirect;
+        for (const auto& chunk : tokens(trace)) {
+            const std::vector<jint> delta = jnishim::intArrayElements(
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePush(
+                            env, nullptr, arrayHandle, jnishim::newString(chunk)));
+            fromArray.insert(fromArray.end(), delta.begin(), delta.end());
+
+            std::copy(chunk.begin(), chunk.end(), input);
+            readRing(Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(
+                             env, nullptr, directHandle, static_cast<jint>(chunk.size())),
+                     fromDirect);
+            jnishim::releaseLocalRefs();
+        }
+        const std::vector<jint> rest = jnishim::intArrayElements(
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlush(env, nullptr, arrayHandle));
+        fromArray.insert(fromArray.end(), rest.begin(), rest.end());
+        readRing(Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlushDirect(env, nullptr, directHandle),
+                 fromDirect);
+
+        EXPECT_EQ(fromDirect, fromArray);
+        ASSERT_FALSE(fromArray.empty());
+        EXPECT_EQ(fromArray[fromArray.size() - 1], static_cast<jint>(trace.text().size()));
+
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, arrayHandle);
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, directHandle);
+        jnishim::releaseLocalRefs();
+    }
+}
@@ -0,0 +1,117 @@
+#include <vector>
+
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+#include "tests/TestUtil.h"
+
+using streamnative::Segment;
+using namespace streamnative::host;
+
+namespace {
+
+constexpr int kText = 0;
+constexpr int kContent = 1;
+constexpr int kKeyStart = 2;
+constexpr int kKeyEnd = 3;
+constexpr int kValueStart = 4;
+constexpr int kValueEnd = 5;
+
+const std::u16string kToolCall =
+        u"call: {\"name\": \"search\", \"args\": {\"q\": \"中文 \\\"quoted\\\"\", \"n\": [1, 2.5, true, null]}} then [3]";
+
+std::vector<Segment> run(bool pureContent, const std::vector<std::u16string>& chunks) {
+    streamnative::JsonSession* session = streamnative::createJsonSession(pureContent);
+    std::vector<Segment> segments = pushAll(chunks, [session](const jchar* chars, int len) {
+        return streamnative::jsonSessionPush(session, chars, len);
+    });
+    streamnative::destroyJsonSession(session);
+    return segments;
+}
+
+// Event segments and breaks only.
+std::vector<Segment> events(const std::vector<Segment>& segments) {
+    std::vector<Segment> out;
+    for (const auto& s : segments) {
+        if (s.type != kText && s.type != kContent) {
+            out.push_back(s);
+        }
+    }
+    return out;
+}
+
+// Text and content runs only, merged across pushes.
+std::vector<Segment> runs(const std::vector<Segment>& segments) {
+    std::vector<Segment> out;
+    for (const auto& s : segments) {
+        if (s.type == kText || s.type == kContent) {
+            out.push_back(s);
+        }
+    }
+    return mergeRuns(out);
+}
+
+int count(const std::vector<Segment>& segments, int type) {
+    int n = 0;
+    for (const auto& s : segments) {
+        n += (s.type == type) ? 1 : 0;
+    }
+    return n;
+}
+
+} // namespace
+
+TEST(JsonSession, OutputDoesNotDependOnChunking) {
+    for (bool pure : {false, true}) {
+        const std::vector<Segment> whole = run(pure, {kToolCall});
+        for (size_t chunkChars : {1, 2, 5, 16}) {
+            const std::vector<Segment> chunked = run(pure, rechunk(kToolCall, chunkChars));
+            EXPECT_EQ(events(chunked), events(whole));
+            EXPECT_EQ(runs(chunked), runs(whole));
+        }
+    }
+}
+
+TEST(JsonSession, StartAndEndEventsPairUp) {
+    const std::vector<Segment> segments = run(false, rechunk(kToolCall, 3));
+    EXPECT_EQ(count(segments, kKeyStart), 4);
+    EXPECT_EQ(count(segments, kKeyEnd), 4);
+    // Both structures, "search", the args object, the string, the array and its 4 items.
+    EXPECT_EQ(count(segments, kValueStart), 11);
+    EXPECT_EQ(count(segments, kValueEnd), 11);
+    EXPECT_EQ(count(segments, kSegBreak), 2);
+
+    std::vector<int> open;
+    for (const auto& s : segments) {
+        if (s.type == kKeyStart || s.type == kValueStart) {
+            EXPECT_EQ(s.start, s.end);
+            open.push_back(s.start);
+        } else if (s.type == kKeyEnd || s.type == kValueEnd) {
+            ASSERT_FALSE(open.empty());
+            EXPECT_EQ(s.start, open.back());
+            open.pop_back();
+        }
+    }
+    EXPECT_TRUE(open.empty());
+}
+
+TEST(JsonSession, RunsTileTheStreamUnlessPure) {
+    const std::vector<Segment> tiled = runs(run(false, rechunk(kToolCall, 4)));
+    int pos = 0;
+    for (const auto& s : tiled) {
+        EXPECT_EQ(s.start, pos);
+        pos = s.end;
+    }
+    EXPECT_EQ(pos, static_cast<int>(kToolCall.size()));
+
+    // Pure content drops every structural char; the test input has none inside strings.
+    for (const auto& s : run(true, rechunk(kToolCall, 4))) {
+        if (s.type != kContent) {
+            continue;
+        }
+        for (int i = s.start; i < s.end; i++) {
+            const char16_t c = kToolCall[static_cast<size_t>(i)];
+            EXPECT_TRUE(c != u'{' && c != u'}' && c != u'[' && c != u']' && c != u',' && c != u':');
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include <jni.h>
+
+#include <vector>
+
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "Trace.h"
+#include "tests/TestUtil.h"
+
+extern "C" {
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeParseMarkdown(JNIEnv*, jobject, jstring);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeCreateIncrementalParser(JNIEnv*, jobject);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeDestroyIncrementalParser(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeAppendIncremental(JNIEnv*, jobject, jlong, jstring);
+}
+
+using namespace streamnative::host;
+
+namespace {
+
+using Block = std::vector<jint>;
+
+// Splits [.., block*] (starting at pos) into blocks:
+//   block  = type, pieceCount, (start, end)*, inlineCount, inline*
+//   inline = type, pieceCount, (start, end)*
+bool readBlocks(const std::vector<jint>& data, size_t pos, size_t count, std::vector<Block>& out) {
+    for (size_t b = 0; b < count; b++) {
+        const size_t start = pos;
+        if (pos + 2 > data.size()) {
+            return false;
+        }
+        pos += 2 + 2 * static_cast<size_t>(data[pos + 1]);
+        if (pos >= data.size()) {
+            return false;
+        }
+        const jint inlines = data[pos++];
+        for (jint i = 0; i < inlines; i++) {
+            if (pos + 2 > data.size()) {
+                return false;
+            }
+            pos += 2 + 2 * static_cast<size_t>(data[pos + 1]);
+        }
+        if (pos > data.size()) {
+            return false;
+        }
+        out.emplace_back(data.begin() + static_cast<std::ptrdiff_t>(start), data.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+    return pos == data.size();
+}
+
+std::vector<Block> parseFull(const std::u16string& text) {
+    JNIEnv* env = jnishim::env();
+    const std::vector<jint> data = jnishim::intArrayElements(
+            Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeParseMarkdown(
+                    env, nullptr, jnishim::newString(text)));
+    std::vector<Block> blocks;
+    if (data.empty() || !readBlocks(data, 1, static_cast<size_t>(data[0]), blocks)) {
+        blocks.clear();
+        blocks.push_back({-1});
+    }
+    return blocks;
+}
+
+} // namespace
+
+TEST(MarkdownParser, BlocksCoverTheDocumentInOrder) {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        const std::u16string text = trace.text();
+        const std::vector<Block> blocks = parseFull(text);
+        ASSERT_FALSE(blocks.empty());
+        ASSERT_TRUE(blocks.front().size() > 1);
+        int last = 0;
+        for (const auto& block : blocks) {
+            for (size_t i = 2; i + 1 < block.size(); i += 2) {
+                if (i >= 2 + 2 * static_cast<size_t>(block[1])) {
+                    break;
+                }
+                EXPECT_TRUE(block[i] >= last && block[i] <= block[i + 1]);
+                EXPECT_TRUE(block[i + 1] <= static_cast<jint>(text.size()));
+                last = block[i];
+            }
+        }
+        jnishim::releaseLocalRefs();
+    }
+}
+
+TEST(MarkdownParser, IncrementalAppendMatchesFullParse) {
+    JNIEnv* env = jnishim::env();
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        for (const auto& chunks : {trace.chunks, rechunk(trace.text(), 13)}) {
+            const jlong handle =
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeCreateIncrementalParser(env, nullptr);
+            std::u16string text;
+            std::vector<Block> blocks;
+            for (const auto& chunk : chunks) {
+                text += chunk;
+                const std::vector<jint> delta = jnishim::intArrayElements(
+                        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeAppendIncremental(
+                                env, nullptr, handle, jnishim::newString(chunk)));
+                ASSERT_TRUE(delta.size() >= 2);
+                ASSERT_TRUE(static_cast<size_t>(delta[0]) <= blocks.size());
+                blocks.resize(static_cast<size_t>(delta[0]));
+                ASSERT_TRUE(readBlocks(delta, 2, static_cast<size_t>(delta[1]), blocks));
+                ASSERT_TRUE(blocks == parseFull(text));
+                jnishim::releaseLocalRefs();
+            }
+            Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeDestroyIncrementalParser(env, nullptr, handle);
+        }
+    }
+}
@@ -0,0 +1,214 @@
+#include <jni.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+#include "tests/TestUtil.h"
+
+extern "C" {
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(JNIEnv*, jobject, jboolean);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePush(JNIEnv*, jobject, jlong, jstring);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(JNIEnv*, jobject, jlong);
+jobject Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(JNIEnv*, jobject, jlong);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(JNIEnv*, jobject, jlong, jint);
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDrainDirect(JNIEnv*, jobject, jlong);
+}
+
+using streamnative::MarkdownSession;
+using streamnative::Segment;
+using namespace streamnative::host;
+
+namespace {
+
+struct SessionDeleter {
+    void operator()(MarkdownSession* s) const { streamnative::destroyMarkdownSession(s); }
+};
+using SessionPtr = std::unique_ptr<MarkdownSession, SessionDeleter>;
+
+SessionPtr newSession(bool block, bool tableDriven) {
+    return SessionPtr(block ? streamnative::createMarkdownBlockSession(tableDriven)
+                            : streamnative::createMarkdownInlineSession(tableDriven));
+}
+
+std::vector<Segment> run(MarkdownSession* session, const std::vector<std::u16string>& chunks) {
+    return pushAll(chunks, [session](const jchar* chars, int len) {
+        return streamnative::markdownSessionPush(session, chars, len);
+    });
+}
+
+std::vector<Segment> run(bool block, bool tableDriven, const std::vector<std::u16string>& chunks) {
+    SessionPtr session = newSession(block, tableDriven);
+    return run(session.get(), chunks);
+}
+
+// Every character a markdown plugin triggers on, plus digits and a few ordinary characters so
+// list markers, links and plain runs form too.
+std::u16string randomMarkdown(std::mt19937& rng, size_t maxLen) {
+    static const char16_t alphabet[] = {u'*', u'_', u'~', u'`', u'#', u'>', u'|', u'$', u'[', u'<', u'\n', u'\\',
+                                        u'0', u'1', u'9', u'.', u' ', u'a', u']', u'(', u')', u'-', u'/'};
+    std::uniform_int_distribution<size_t> len(0, maxLen);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) / sizeof(alphabet[0]) - 1);
+    std::u16string s(len(rng), u' ');
+    for (auto& c : s) {
+        c = alphabet[pick(rng)];
+    }
+    return s;
+}
+
+std::vector<std::u16string> randomChunks(std::mt19937& rng, const std::u16string& text) {
+    std::uniform_int_distribution<size_t> size(1, 12);
+    std::vector<std::u16string> chunks;
+    for (size_t i = 0; i < text.size();) {
+        const size_t n = std::min(text.size() - i, size(rng));
+        chunks.push_back(text.substr(i, n));
+        i += n;
+    }
+    return chunks;
+}
+
+const std::vector<Trace>& traces() {
+    static const std::vector<Trace> loaded = loadTraces(defaultTraceDir());
+    return loaded;
+}
+
+} // namespace
+
+TEST(MarkdownSession, SegmentsStayInsideTheStreamAndInOrder) {
+    for (const auto& trace : traces()) {
+        for (bool block : {true, false}) {
+            const std::vector<Segment> segments = run(block, false, trace.chunks);
+            const int total = static_cast<int>(trace.text().size());
+            int last = 0;
+            for (const auto& s : segments) {
+                EXPECT_TRUE(s.start <= s.end && s.end <= total);
+                // Negative types are zero-width markers (SEG_BREAK, table structure).
+                EXPECT_TRUE(s.type < 0 ? s.start == s.end : s.start < s.end);
+                EXPECT_TRUE(s.start >= last);
+                last = s.end;
+            }
+        }
+    }
+}
+
+TEST(MarkdownSession, RechunkingDoesNotChangeMergedSegments) {
+    for (const auto& trace : traces()) {
+        const std::u16string text = trace.text();
+        for (bool block : {true, false}) {
+            const std::vector<Segment> expected = mergeRuns(run(block, false, {text}));
+            EXPECT_EQ(mergeRuns(run(block, false, trace.chunks)), expected);
+            for (size_t chunkChars : {1, 2, 7, 64}) {
+                EXPECT_EQ(mergeRuns(run(block, false, rechunk(text, chunkChars))), expected);
+            }
+        }
+    }
+}
+
+TEST(MarkdownSession, TableDrivenMatchesPerPluginEvaluation) {
+    for (const auto& trace : traces()) {
+        for (bool block : {true, false}) {
+            EXPECT_EQ(run(block, true, trace.chunks), run(block, false, trace.chunks));
+            EXPECT_EQ(run(block, true, rechunk(trace.text(), 1)), run(block, false, rechunk(trace.text(), 1)));
+        }
+    }
+}
+
+TEST(MarkdownSession, TableDrivenMatchesPerPluginEvaluationOnRandomInput) {
+    std::mt19937 rng(13);
+    for (int round = 0; round < 3000; round++) {
+        const std::u16string text = randomMarkdown(rng, 160);
+        const std::vector<std::u16string> chunks = randomChunks(rng, text);
+        for (bool block : {true, false}) {
+            ASSERT_EQ(run(block, true, chunks), run(block, false, chunks));
+        }
+    }
+}
+
+TEST(MarkdownSession, RestoredSnapshotContinuesIdentically) {
+    for (const auto& trace : traces()) {
+        for (bool block : {true, false}) {
+            const std::vector<Segment> expected = run(block, false, trace.chunks);
+            for (size_t cut = 0; cut <= trace.chunks.size(); cut += 5) {
+                SessionPtr first = newSession(block, false);
+                std::vector<Segment> segments = run(first.get(), {trace.chunks.begin(), trace.chunks.begin() + cut});
+
+                const std::vector<uint8_t> bytes = streamnative::markdownSessionSnapshot(first.get());
+                SessionPtr restored(streamnative::restoreMarkdownSession(bytes.data(), bytes.size()));
+                ASSERT_TRUE(restored != nullptr);
+                EXPECT_EQ(streamnative::markdownSessionSnapshot(restored.get()), bytes);
+
+                const std::vector<Segment> rest = run(restored.get(), {trace.chunks.begin() + cut, trace.chunks.end()});
+                segments.insert(segments.end(), rest.begin(), rest.end());
+                EXPECT_EQ(segments, expected);
+            }
+        }
+    }
+}
+
+TEST(MarkdownSession, CorruptSnapshotsAreRejectedOrUsable) {
+    const Trace& trace = traces().front();
+    SessionPtr session = newSession(true, true);
+    run(session.get(), {trace.chunks.begin(), trace.chunks.begin() + trace.chunks.size() / 2});
+    const std::vector<uint8_t> bytes = streamnative::markdownSessionSnapshot(session.get());
+
+    for (size_t len = 0; len < bytes.size(); len++) {
+        EXPECT_TRUE(streamnative::restoreMarkdownSession(bytes.data(), len) == nullptr);
+    }
+    for (size_t i = 0; i < bytes.size(); i++) {
+        std::vector<uint8_t> flipped = bytes;
+        flipped[i] ^= 0x5Au;
+        SessionPtr restored(streamnative::restoreMarkdownSession(flipped.data(), flipped.size()));
+        if (restored != nullptr) {
+            run(restored.get(), {trace.chunks.back()});
+        }
+    }
+}
+
+TEST(MarkdownSession, JniDirectTransportMatchesArrayPush) {
+    JNIEnv* env = jnishim::env();
+    for (const auto& trace : traces()) {
+        const jlong arrayHandle =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(env, nullptr, JNI_FALSE);
+        const jlong directHandle =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(env, nullptr, JNI_FALSE);
+        jobject inputBuffer =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(env, nullptr, directHandle);
+        jobject segmentBuffer =
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(env, nullptr, directHandle);
+        auto* input = static_cast<jchar*>(env->GetDirectBufferAddress(inputBuffer));
+        const auto* ring = static_cast<const jint*>(env->GetDirectBufferAddress(segmentBuffer));
+
+        for (const auto& chunk : trace.chunks) {
+            const std::vector<jint> expected = jnishim::intArrayElements(
+                    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePush(
+                            env, nullptr, arrayHandle, jnishim::newString(chunk)));
+
+            std::copy(chunk.begin(), chunk.end(), input);
+            std::vector<jint> direct;
+            jlong published = Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(
+                    env, nullptr, directHandle, static_cast<jint>(chunk.size()));
+            while (true) {
+                const jlong offset = (published >> 32) & 0x7FFFFFFF;
+                const jlong count = published & 0x7FFFFFFF;
+                direct.insert(direct.end(), ring + offset * 3, ring + (offset + count) * 3);
+                if ((published & 0x80000000LL) == 0) {
+                    break;
+                }
+                published = Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDrainDirect(
+                        env, nullptr, directHandle);
+            }
+            EXPECT_EQ(direct, expected);
+            jnishim::releaseLocalRefs();
+        }
+
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, arrayHandle);
+        Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, directHandle);
+        jnishim::releaseLocalRefs();
+    }
+}
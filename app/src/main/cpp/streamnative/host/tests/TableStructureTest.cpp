@@ -0,0 +1,194 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+#include "tests/TestUtil.h"
+
+using streamnative::MarkdownSession;
+using streamnative::Segment;
+using namespace streamnative::host;
+
+namespace {
+
+// Mirror the table markers in StreamOperators.cpp.
+constexpr int kMdTable = 7;
+constexpr int kCell = -2;
+constexpr int kCellLeft = -3;
+constexpr int kCellCenter = -4;
+constexpr int kCellRight = -5;
+constexpr int kRow = -6;
+constexpr int kHeaderEnd = -7;
+
+struct SessionDeleter {
+    void operator()(MarkdownSession* s) const { streamnative::destroyMarkdownSession(s); }
+};
+using SessionPtr = std::unique_ptr<MarkdownSession, SessionDeleter>;
+
+std::vector<Segment> run(bool tableDriven, const std::vector<std::u16string>& chunks) {
+    SessionPtr session(streamnative::createMarkdownBlockSession(tableDriven));
+    return pushAll(chunks, [&](const jchar* chars, int len) {
+        return streamnative::markdownSessionPush(session.get(), chars, len);
+    });
+}
+
+struct Table {
+    std::vector<std::vector<std::string>> rows; // trimmed cells of completed rows
+    std::vector<int> aligns;                    // cell markers of the delimiter row
+    bool headerEnded = false;
+};
+
+std::string trimmed(const std::u16string& text, int start, int end) {
+    while (start < end && (text[static_cast<size_t>(start)] == u' ' || text[static_cast<size_t>(start)] == u'\t')) {
+        start++;
+    }
+    while (end > start && (text[static_cast<size_t>(end - 1)] == u' ' || text[static_cast<size_t>(end - 1)] == u'\t')) {
+        end--;
+    }
+    return utf16ToUtf8(text.substr(static_cast<size_t>(start), static_cast<size_t>(end - start)));
+}
+
+// Rebuilds tables from the markers alone, as a renderer appending row by row would.
+std::vector<Table> tablesOf(const std::u16string& text, const std::vector<Segment>& segments) {
+    std::vector<Table> tables;
+    bool inTable = false;
+    int cellStart = 0;
+    std::vector<std::string> row;
+    std::vector<int> aligns;
+    for (const auto& s : segments) {
+        if (s.type == kMdTable && !inTable) {
+            tables.emplace_back();
+            inTable = true;
+            cellStart = s.start + 1; // after the leading pipe
+        } else if (s.type == kCell || s.type == kCellLeft || s.type == kCellCenter || s.type == kCellRight) {
+            EXPECT_TRUE(inTable);
+            row.push_back(trimmed(text, cellStart, s.start));
+            aligns.push_back(s.type);
+            cellStart = s.start + 1;
+        } else if (s.type == kRow || s.type == kHeaderEnd) {
+            EXPECT_TRUE(inTable);
+            if (s.type == kHeaderEnd) {
+                tables.back().headerEnded = true;
+                tables.back().aligns = aligns;
+            } else {
+                tables.back().rows.push_back(row);
+            }
+            row.clear();
+            aligns.clear();
+            cellStart = s.start + 2; // after the newline and the next row's leading pipe
+        } else if (s.type == kSegBreak) {
+            inTable = false;
+            row.clear();
+            aligns.clear();
+        }
+    }
+    return tables;
+}
+
+} // namespace
+
+TEST(TableStructure, CellsRowsAndAlignmentFromMarkers) {
+    const std::u16string text = utf8ToUtf16(
+            "Intro\n"
+            "| Name | Qty | Note |\n"
+            "|:-----|----:|:----:|\n"
+            "| a | 1 | x \\| y |\n"
+            "|b|2\n"
+            "after\n");
+    for (bool tableDriven : {false, true}) {
+        const std::vector<Table> tables = tablesOf(text, run(tableDriven, {text}));
+        ASSERT_EQ(tables.size(), static_cast<size_t>(1));
+        const Table& t = tables[0];
+        EXPECT_TRUE(t.headerEnded);
+        EXPECT_EQ(t.aligns, (std::vector<int>{kCellLeft, kCellRight, kCellCenter}));
+        ASSERT_EQ(t.rows.size(), static_cast<size_t>(3));
+        EXPECT_EQ(t.rows[0], (std::vector<std::string>{"Name", "Qty", "Note"}));
+        EXPECT_EQ(t.rows[1], (std::vector<std::string>{"a", "1", "x \\| y"}));
+        EXPECT_EQ(t.rows[2], (std::vector<std::string>{"b", "2"}));
+    }
+}
+
+TEST(TableStructure, InvalidDelimiterRowHasNoHeaderEnd) {
+    for (const char* delimiter : {"| --- | x |", "| --- |", "| : |", "| -- - | --- |"}) {
+        const std::u16string text = utf8ToUtf16(std::string("| A | B |\n") + delimiter + "\n| 1 | 2 |\n");
+        const std::vector<Table> tables = tablesOf(text, run(true, {text}));
+        ASSERT_EQ(tables.size(), static_cast<size_t>(1));
+        EXPECT_FALSE(tables[0].headerEnded);
+        EXPECT_EQ(tables[0].rows.size(), static_cast<size_t>(3));
+    }
+}
+
+TEST(TableStructure, RowsArriveAsTheyComplete) {
+    std::string source = "| id | value |\n|---|---|\n";
+    for (int i = 0; i < 150; i++) {
+        source += "| " + std::to_string(i) + " | v" + std::to_string(i * 7) + " |\n";
+    }
+    const std::u16string text = utf8ToUtf16(source);
+
+    SessionPtr session(streamnative::createMarkdownBlockSession(true));
+    std::vector<Segment> all;
+    int rows = 0;
+    int newlines = 0;
+    for (const auto& chunk : rechunk(text, 5)) {
+        const std::vector<Segment> segments = streamnative::markdownSessionPush(
+                session.get(), reinterpret_cast<const jchar*>(chunk.data()), static_cast<int>(chunk.size()));
+        all.insert(all.end(), segments.begin(), segments.end());
+        for (const auto& s : segments) {
+            rows += (s.type == kRow || s.type == kHeaderEnd) ? 1 : 0;
+        }
+        for (char16_t c : chunk) {
+            newlines += (c == u'\n') ? 1 : 0;
+        }
+        // A row is reported by the push that delivers its newline.
+        EXPECT_EQ(rows, newlines);
+    }
+
+    const std::vector<Table> tables = tablesOf(text, all);
+    ASSERT_EQ(tables.size(), static_cast<size_t>(1));
+    EXPECT_TRUE(tables[0].headerEnded);
+    ASSERT_EQ(tables[0].rows.size(), static_cast<size_t>(151));
+    EXPECT_EQ(tables[0].rows[150], (std::vector<std::string>{"149", "v1043"}));
+    EXPECT_EQ(mergeRuns(all), mergeRuns(run(false, {text})));
+}
+
+TEST(TableStructure, TracesWithTablesKeepColumnCounts) {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        const std::u16string text = trace.text();
+        for (const Table& t : tablesOf(text, run(true, trace.chunks))) {
+            ASSERT_TRUE(t.headerEnded);
+            ASSERT_FALSE(t.rows.empty());
+            EXPECT_EQ(t.aligns.size(), t.rows[0].size());
+            for (const auto& row : t.rows) {
+                EXPECT_EQ(row.size(), t.rows[0].size());
+            }
+        }
+    }
+}
+
+// Groups as NativeMarkdownStreamOperators builds them: a run opens a group when its type differs
+// from the open one, SEG_BREAK closes it, table markers are skipped.
+TEST(TableStructure, TableMarkersDoNotCloseTheTableGroup) {
+    const std::u16string text = utf8ToUtf16(
+            "Files:\n\n"
+            "| name | size |\n"
+            "|:-----|-----:|\n"
+            "| a.txt | 1 |\n"
+            "| b.txt | 22 |\n"
+            "| c.txt | 333 |\n"
+            "\nDone.\n");
+    for (size_t chunkSize : {static_cast<size_t>(1), static_cast<size_t>(7), text.size()}) {
+        int openType = kSegBreak;
+        int tableGroups = 0;
+        for (const auto& s : run(true, rechunk(text, chunkSize))) {
+            if (s.type == kSegBreak) {
+                openType = kSegBreak;
+            } else if (s.type >= 0 && s.type != openType) {
+                openType = s.type;
+                tableGroups += (s.type == kMdTable) ? 1 : 0;
+            }
+        }
+        EXPECT_EQ(tableGroups, 1);
+    }
+}
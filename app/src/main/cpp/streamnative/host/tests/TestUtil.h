@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "streamnative/StreamOperators.h"
+
+namespace streamnative {
+
+inline bool operator==(const Segment& a, const Segment& b) {
+    return a.type == b.type && a.start == b.start && a.end == b.end;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Segment& s) {
+    return out << '{' << s.type << ',' << s.start << ',' << s.end << '}';
+}
+
+namespace host {
+
+// Mirrors SEG_BREAK in StreamOperators.cpp and the Kotlin splitters.
+constexpr int kSegBreak = -1;
+
+// Pushes chunks one by one, concatenating the segments of every push.
+template <typename Push>
+std::vector<Segment> pushAll(const std::vector<std::u16string>& chunks, Push push) {
+    std::vector<Segment> all;
+    for (const auto& chunk : chunks) {
+        const std::vector<Segment> segments = push(reinterpret_cast<const jchar*>(chunk.data()),
+                                                   static_cast<int>(chunk.size()));
+        all.insert(all.end(), segments.begin(), segments.end());
+    }
+    return all;
+}
+
+// Runs are flushed at the end of every push, so one run may arrive in pieces; merging
+// contiguous pieces of the same type makes the output comparable across chunkings.
+inline std::vector<Segment> mergeRuns(const std::vector<Segment>& segments) {
+    std::vector<Segment> out;
+    for (const auto& s : segments) {
+        if (!out.empty() && s.type != kSegBreak && out.back().type == s.type && out.back().end == s.start) {
+            out.back().end = s.end;
+        } else {
+            out.push_back(s);
+        }
+    }
+    return out;
+}
+
+inline std::u16string toU16(const char* ascii) {
+    return std::u16string(ascii, ascii + std::char_traits<char>::length(ascii));
+}
+
+} // namespace host
+
+} // namespace streamnative
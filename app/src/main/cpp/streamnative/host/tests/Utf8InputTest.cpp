@@ -0,0 +1,227 @@
+#include <jni.h>
+
+#include <memory>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+#include "streamnative/StreamUtf8.h"
+#include "tests/TestUtil.h"
+
+extern "C" {
+jlong Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(JNIEnv*, jobject, jboolean);
+void Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(JNIEnv*, jobject, jlong);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushUtf8(JNIEnv*, jobject, jlong, jbyteArray, jint);
+jintArray Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegmentsUtf8(JNIEnv*, jobject, jbyteArray, jint);
+}
+
+using streamnative::MarkdownSession;
+using streamnative::Segment;
+using streamnative::Utf8Segment;
+using streamnative::Utf8StreamDecoder;
+using namespace streamnative::host;
+
+namespace {
+
+struct SessionDeleter {
+    void operator()(MarkdownSession* s) const { streamnative::destroyMarkdownSession(s); }
+};
+using SessionPtr = std::unique_ptr<MarkdownSession, SessionDeleter>;
+
+std::vector<uint8_t> bytesOf(const std::string& s) {
+    return {s.begin(), s.end()};
+}
+
+// Splits bytes at random points, including inside multi-byte chars.
+std::vector<std::vector<uint8_t>> byteChunks(const std::vector<uint8_t>& bytes, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> size(1, 9);
+    std::vector<std::vector<uint8_t>> chunks;
+    for (size_t i = 0; i < bytes.size();) {
+        const size_t end = std::min(bytes.size(), i + size(rng));
+        chunks.emplace_back(bytes.begin() + static_cast<std::ptrdiff_t>(i), bytes.begin() + static_cast<std::ptrdiff_t>(end));
+        i = end;
+    }
+    return chunks;
+}
+
+std::u16string decodeAll(const std::vector<std::vector<uint8_t>>& chunks) {
+    Utf8StreamDecoder decoder;
+    std::vector<jchar> units;
+    for (const auto& chunk : chunks) {
+        decoder.decode(chunk.data(), static_cast<int>(chunk.size()), units);
+    }
+    decoder.finish(units);
+    return {units.begin(), units.end()};
+}
+
+std::vector<Utf8Segment> pushUtf8(MarkdownSession* session, const std::vector<std::vector<uint8_t>>& chunks) {
+    std::vector<Utf8Segment> out;
+    for (const auto& chunk : chunks) {
+        streamnative::markdownSessionPushUtf8(session, chunk.data(), static_cast<int>(chunk.size()), out);
+    }
+    return out;
+}
+
+std::vector<Segment> unitsOf(const std::vector<Utf8Segment>& segments) {
+    std::vector<Segment> out;
+    for (const auto& s : segments) {
+        out.push_back({s.type, s.start, s.end});
+    }
+    return out;
+}
+
+// Byte offset of every UTF-16 position of text (size + 1 entries).
+std::vector<int> byteOffsets(const std::u16string& text) {
+    std::vector<int> offsets;
+    int bytes = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        offsets.push_back(bytes);
+        const char16_t c = text[i];
+        if (c >= 0xD800 && c <= 0xDBFF) {
+            offsets.push_back(bytes);
+            bytes += 4;
+            i++;
+        } else {
+            bytes += (c < 0x80) ? 1 : (c < 0x800) ? 2 : 3;
+        }
+    }
+    offsets.push_back(bytes);
+    return offsets;
+}
+
+} // namespace
+
+TEST(Utf8Input, DecoderSurvivesArbitraryByteSplits) {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        const std::u16string text = trace.text();
+        const std::vector<uint8_t> bytes = bytesOf(utf16ToUtf8(text));
+        for (unsigned seed : {1u, 2u, 3u}) {
+            EXPECT_TRUE(decodeAll(byteChunks(bytes, seed)) == text);
+        }
+    }
+    // Surrogate pair split after every byte.
+    EXPECT_TRUE(decodeAll({{0xF0}, {0x9F}, {0x98}, {0x8A}, {'!'}}) == std::u16string(u"\U0001F60A!"));
+}
+
+TEST(Utf8Input, MalformedSequencesBecomeReplacementChars) {
+    struct Case {
+        std::vector<uint8_t> bytes;
+        std::u16string expected;
+    };
+    const Case cases[] = {
+            {{0xC3, 'A'}, u"�A"},                          // truncated by an ASCII char
+            {{0xE0, 0x80, 0x80}, u"���"},        // overlong
+            {{0xED, 0xA0, 0x80}, u"���"},        // encoded surrogate
+            {{0xF4, 0x90, 0x80, 0x80}, u"����"}, // above U+10FFFF
+            {{0xE4, 0xB8}, u"�"},                          // cut off by the end of input
+            {{0x80, 0xFF, 'x'}, u"��x"},              // stray continuation, invalid byte
+            {{0xE4, 0xB8, 0xAD, 0xE4, 'x'}, u"中�x"},
+    };
+    for (const auto& c : cases) {
+        EXPECT_TRUE(decodeAll({c.bytes}) == c.expected);
+    }
+}
+
+TEST(Utf8Input, SessionMatchesUtf16PushWithByteOffsets) {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        const std::u16string text = trace.text();
+        const std::vector<int> offsets = byteOffsets(text);
+        const std::vector<uint8_t> bytes = bytesOf(utf16ToUtf8(text));
+
+        for (bool block : {true, false}) {
+            SessionPtr utf16(block ? streamnative::createMarkdownBlockSession() : streamnative::createMarkdownInlineSession());
+            const std::vector<Segment> expected = pushAll(trace.chunks, [&](const jchar* chars, int len) {
+                return streamnative::markdownSessionPush(utf16.get(), chars, len);
+            });
+
+            SessionPtr utf8(block ? streamnative::createMarkdownBlockSession(true) : streamnative::createMarkdownInlineSession(true));
+            const std::vector<Utf8Segment> segments = pushUtf8(utf8.get(), byteChunks(bytes, 11));
+            EXPECT_EQ(mergeRuns(unitsOf(segments)), mergeRuns(expected));
+            for (const auto& s : segments) {
+                ASSERT_TRUE(s.start >= 0 && s.end < static_cast<int>(offsets.size()));
+                EXPECT_EQ(s.byteStart, offsets[static_cast<size_t>(s.start)]);
+                EXPECT_EQ(s.byteEnd, offsets[static_cast<size_t>(s.end)]);
+            }
+        }
+    }
+}
+
+TEST(Utf8Input, SnapshotInsideAMultiByteCharResumes) {
+    const std::vector<uint8_t> bytes = bytesOf(utf16ToUtf8(u"# 标题\n正文 **粗体** 😊 `代码`\n"));
+    const auto chunks = byteChunks(bytes, 5);
+
+    SessionPtr whole(streamnative::createMarkdownBlockSession());
+    const std::vector<Utf8Segment> expected = pushUtf8(whole.get(), chunks);
+
+    for (size_t cut = 0; cut <= chunks.size(); cut++) {
+        SessionPtr first(streamnative::createMarkdownBlockSession());
+        std::vector<Utf8Segment> segments = pushUtf8(first.get(), {chunks.begin(), chunks.begin() + cut});
+        const std::vector<uint8_t> snapshot = streamnative::markdownSessionSnapshot(first.get());
+        SessionPtr restored(streamnative::restoreMarkdownSession(snapshot.data(), snapshot.size()));
+        ASSERT_TRUE(restored != nullptr);
+        const std::vector<Utf8Segment> rest = pushUtf8(restored.get(), {chunks.begin() + cut, chunks.end()});
+        segments.insert(segments.end(), rest.begin(), rest.end());
+
+        ASSERT_EQ(segments.size(), expected.size());
+        for (size_t i = 0; i < segments.size(); i++) {
+            EXPECT_TRUE(std::memcmp(&segments[i], &expected[i], sizeof(Utf8Segment)) == 0);
+        }
+    }
+}
+
+TEST(Utf8Input, XmlSplitMatchesUtf16Split) {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        const std::u16string text = trace.text();
+        const std::vector<int> offsets = byteOffsets(text);
+        const std::vector<uint8_t> bytes = bytesOf(utf16ToUtf8(text));
+
+        const std::vector<Segment> expected =
+                streamnative::splitByXml(reinterpret_cast<const jchar*>(text.data()), static_cast<int>(text.size()));
+        const std::vector<Utf8Segment> segments = streamnative::splitByXmlUtf8(bytes.data(), static_cast<int>(bytes.size()));
+        EXPECT_EQ(unitsOf(segments), expected);
+        for (const auto& s : segments) {
+            EXPECT_EQ(s.byteStart, offsets[static_cast<size_t>(s.start)]);
+            EXPECT_EQ(s.byteEnd, offsets[static_cast<size_t>(s.end)]);
+        }
+
+        const std::vector<jint> flat = jnishim::intArrayElements(
+                Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegmentsUtf8(
+                        jnishim::env(), nullptr, jnishim::newByteArray(bytes), 1));
+        ASSERT_EQ(flat.size(), segments.size() * 5);
+        EXPECT_TRUE(std::memcmp(flat.data(), segments.data(), flat.size() * sizeof(jint)) == 0);
+        jnishim::releaseLocalRefs();
+    }
+}
+
+TEST(Utf8Input, JniPushReturnsFiveIntsPerSegment) {
+    JNIEnv* env = jnishim::env();
+    const std::vector<uint8_t> bytes = bytesOf(utf16ToUtf8(u"前言\n```kotlin\nval 变量 = 1\n```\n"));
+    const auto chunks = byteChunks(bytes, 9);
+
+    SessionPtr reference(streamnative::createMarkdownBlockSession());
+    const std::vector<Utf8Segment> expected = pushUtf8(reference.get(), chunks);
+
+    const jlong handle =
+            Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(env, nullptr, JNI_FALSE);
+    std::vector<jint> flat;
+    for (const auto& chunk : chunks) {
+        // Oversized array, as a reused Kotlin buffer would be.
+        std::vector<uint8_t> padded = chunk;
+        padded.resize(chunk.size() + 7, 0xFF);
+        const std::vector<jint> part = jnishim::intArrayElements(
+                Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushUtf8(
+                        env, nullptr, handle, jnishim::newByteArray(padded), static_cast<jint>(chunk.size())));
+        flat.insert(flat.end(), part.begin(), part.end());
+        jnishim::releaseLocalRefs();
+    }
+    Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDestroySession(env, nullptr, handle);
+
+    ASSERT_EQ(flat.size(), expected.size() * 5);
+    EXPECT_TRUE(std::memcmp(flat.data(), expected.data(), flat.size() * sizeof(jint)) == 0);
+}
@@ -0,0 +1,83 @@
+#include <jni.h>
+
+#include <vector>
+
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "Trace.h"
+#include "streamnative/StreamOperators.h"
+#include "tests/TestUtil.h"
+
+extern "C" jintArray Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegments(
+        JNIEnv*, jobject, jstring, jint);
+
+using streamnative::Segment;
+using namespace streamnative::host;
+
+namespace {
+
+std::vector<Segment> split(const std::u16string& text, int threads) {
+    return streamnative::splitByXml(reinterpret_cast<const jchar*>(text.data()), static_cast<int>(text.size()), threads);
+}
+
+std::u16string toolTranscript() {
+    for (const auto& trace : loadTraces(defaultTraceDir())) {
+        if (trace.name == "tool_xml") {
+            return trace.text();
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+TEST(SplitByXml, SegmentsTileTheInput) {
+    const std::u16string text = toolTranscript();
+    ASSERT_FALSE(text.empty());
+
+    const std::vector<Segment> segments = split(text, 1);
+    int xmlGroups = 0;
+    int pos = 0;
+    for (const auto& s : segments) {
+        EXPECT_EQ(s.start, pos);
+        EXPECT_TRUE(s.start < s.end);
+        if (s.type == 1) {
+            EXPECT_EQ(text[static_cast<size_t>(s.start)], u'<');
+            EXPECT_EQ(text[static_cast<size_t>(s.end - 1)], u'>');
+            xmlGroups++;
+        }
+        pos = s.end;
+    }
+    EXPECT_EQ(pos, static_cast<int>(text.size()));
+    // 5 tool calls, 5 results and the closing status tag.
+    EXPECT_EQ(xmlGroups, 11);
+}
+
+TEST(SplitByXml, ParallelScanMatchesSequential) {
+    const std::u16string transcript = toolTranscript();
+    std::u16string text;
+    while (text.size() < 1024 * 1024) {
+        text += transcript;
+        // Unterminated tags and stray '<' exercise the chunk hand-over.
+        text += toU16("a < b and <tool name=\"x\">\n<param>never closed\n\n");
+    }
+    const std::vector<Segment> expected = split(text, 1);
+    for (int threads : {0, 2, 3, 8}) {
+        EXPECT_EQ(split(text, threads), expected);
+    }
+}
+
+TEST(SplitByXml, JniEntryPointFlattensSegments) {
+    const std::u16string text = toolTranscript();
+    const std::vector<Segment> segments = split(text, 1);
+
+    JNIEnv* env = jnishim::env();
+    const std::vector<jint> flat = jnishim::intArrayElements(
+            Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegments(
+                    env, nullptr, jnishim::newString(text), 0));
+    ASSERT_EQ(flat.size(), segments.size() * 3);
+    for (size_t i = 0; i < segments.size(); i++) {
+        EXPECT_EQ((Segment{flat[i * 3], flat[i * 3 + 1], flat[i * 3 + 2]}), segments[i]);
+    }
+    jnishim::releaseLocalRefs();
+}
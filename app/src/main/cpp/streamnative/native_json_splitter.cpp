@@ -0,0 +1,70 @@
+#include <jni.h>
+
+#include <vector>
+
+#include "streamnative/StreamOperators.h"
+
+namespace {
+
+inline streamnative::JsonSession* fromHandle(jlong handle) {
+    return reinterpret_cast<streamnative::JsonSession*>(handle);
+}
+
+inline jintArray segmentsToJIntArray(JNIEnv* env, const std::vector<streamnative::Segment>& segments) {
+    jintArray out = env->NewIntArray(static_cast<jsize>(segments.size() * 3));
+    if (out == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<jint> flat;
+    flat.reserve(segments.size() * 3);
+    for (const auto& s : segments) {
+        flat.push_back(static_cast<jint>(s.type));
+        flat.push_back(static_cast<jint>(s.start));
+        flat.push_back(static_cast<jint>(s.end));
+    }
+
+    env->SetIntArrayRegion(out, 0, static_cast<jsize>(flat.size()), flat.data());
+    return out;
+}
+
+} // namespace
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeJsonSplitter_nativeCreateSession(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jboolean pureContent
+) {
+    return reinterpret_cast<jlong>(streamnative::createJsonSession(pureContent == JNI_TRUE));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeJsonSplitter_nativeDestroySession(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    streamnative::destroyJsonSession(fromHandle(handle));
+}
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeJsonSplitter_nativePush(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle,
+        jstring chunk
+) {
+    if (handle == 0 || chunk == nullptr) {
+        return env->NewIntArray(0);
+    }
+
+    const jsize len = env->GetStringLength(chunk);
+    const jchar* chars = env->GetStringChars(chunk, nullptr);
+
+    std::vector<streamnative::Segment> segments = streamnative::jsonSessionPush(fromHandle(handle), chars, static_cast<int>(len));
+
+    env->ReleaseStringChars(chunk, chars);
+
+    return segmentsToJIntArray(env, segments);
+}
@@ -1,7 +1,8 @@
 #include <jni.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
-#include <utility>
 #include <vector>
 
 namespace {
@@ -26,20 +27,81 @@ constexpr int MD_UNDERLINE = 15;
 constexpr int MD_INLINE_LATEX = 16;
 constexpr int MD_PLAIN_TEXT = 17;
 
-struct Piece {
-    int start;
-    int end; // exclusive
-};
+// Parse result laid out directly in the wire format returned to Kotlin:
+//   [blockCount, block*]
+//   block  = type, pieceCount, (start, end)*, inlineCount, inline*
+//   inline = type, pieceCount, (start, end)*
+// Blocks are linked by their offset in data, so the arena can be truncated back to
+// any block and handed to JNI with a single copy. Storage is kept across parses.
+struct MarkdownArena {
+    std::vector<jint> data;
+    std::vector<int> blockOffsets;
+    std::vector<int> blockEnds; // exclusive; the next block starts here
+    size_t inlineCountPos = 0;  // inlineCount slot of the block being written
+
+    void clear() {
+        data.assign(1, 0);
+        blockOffsets.clear();
+        blockEnds.clear();
+    }
+
+    size_t blockCount() const { return blockOffsets.size(); }
+
+    int blockType(size_t index) const { return data[static_cast<size_t>(blockOffsets[index])]; }
+
+    // Drops blocks [count, blockCount()).
+    void truncate(size_t count) {
+        if (count >= blockOffsets.size()) {
+            return;
+        }
+        data.resize(static_cast<size_t>(blockOffsets[count]));
+        blockOffsets.resize(count);
+        blockEnds.resize(count);
+        data[0] = static_cast<jint>(count);
+    }
+
+    // Blocks either carry one piece or a list of inline nodes.
+    void beginBlock(int type, int pieceStart = -1, int pieceEnd = -1) {
+        blockOffsets.push_back(static_cast<int>(data.size()));
+        data.push_back(static_cast<jint>(type));
+        if (pieceStart >= 0) {
+            data.push_back(1);
+            data.push_back(static_cast<jint>(pieceStart));
+            data.push_back(static_cast<jint>(pieceEnd));
+        } else {
+            data.push_back(0);
+        }
+        inlineCountPos = data.size();
+        data.push_back(0);
+    }
+
+    void addInline(int type, int start, int end) {
+        data.push_back(static_cast<jint>(type));
+        data.push_back(1);
+        data.push_back(static_cast<jint>(start));
+        data.push_back(static_cast<jint>(end));
+        data[inlineCountPos] += 1;
+    }
 
-struct InlineNode {
-    int type;
-    std::vector<Piece> pieces;
+    int inlineCount() const { return static_cast<int>(data[inlineCountPos]); }
+
+    void clearInlines() {
+        data.resize(inlineCountPos + 1);
+        data[inlineCountPos] = 0;
+    }
+
+    void endBlock(int end) {
+        blockEnds.push_back(end);
+        data[0] += 1;
+    }
 };
 
-struct BlockNode {
-    int type;
-    std::vector<Piece> pieces; // used when inline is empty
-    std::vector<InlineNode> inlineNodes;
+// Parser state kept across appends (see nativeAppendIncremental).
+struct IncrementalParser {
+    std::u16string content;
+    MarkdownArena arena;
+
+    IncrementalParser() { arena.clear(); }
 };
 
 inline bool isStartOfLine(const jchar* chars, int i) {
@@ -76,14 +138,15 @@ static int countRun(const jchar* chars, int len, int i, jchar ch) {
     return j - i;
 }
 
-static int findSubseqNoNewline(const jchar* chars, int start, int end, const std::u16string& pat) {
-    if (pat.empty()) return -1;
-    for (int i = start; i + static_cast<int>(pat.size()) <= end; i++) {
+// Finds `count` consecutive `ch` in [start, end) before any newline.
+static int findRepeatNoNewline(const jchar* chars, int start, int end, jchar ch, int count) {
+    if (count <= 0) return -1;
+    for (int i = start; i + count <= end; i++) {
         bool ok = true;
-        for (int k = 0; k < static_cast<int>(pat.size()); k++) {
+        for (int k = 0; k < count; k++) {
             const jchar c = chars[i + k];
             if (c == u'\n') return -1;
-            if (c != pat[static_cast<size_t>(k)]) {
+            if (c != ch) {
                 ok = false;
                 break;
             }
@@ -93,18 +156,13 @@ static int findSubseqNoNewline(const jchar* chars, int start, int end, const std
     return -1;
 }
 
-static void addPlainInline(std::vector<InlineNode>& out, int start, int end) {
+static void addPlainInline(MarkdownArena& out, int start, int end) {
     if (start >= end) return;
-    InlineNode n;
-    n.type = MD_PLAIN_TEXT;
-    n.pieces.push_back({start, end});
-    out.push_back(std::move(n));
+    out.addInline(MD_PLAIN_TEXT, start, end);
 }
 
-static std::vector<InlineNode> parseInline(const jchar* chars, int start, int end) {
-    std::vector<InlineNode> out;
-    out.reserve(16);
-
+// Appends the inline nodes of chars[start, end) to the block being written.
+static void parseInline(const jchar* chars, int start, int end, MarkdownArena& out) {
     int i = start;
     int plainStart = start;
 
@@ -132,10 +190,7 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
                 }
                 if (closeParen != -1) {
                     addPlainInline(out, plainStart, i);
-                    InlineNode n;
-                    n.type = MD_LINK;
-                    n.pieces.push_back({i, closeParen + 1});
-                    out.push_back(std::move(n));
+                    out.addInline(MD_LINK, i, closeParen + 1);
                     i = closeParen + 1;
                     plainStart = i;
                     continue;
@@ -146,14 +201,10 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
         // Inline code: `code` or ``code`` (strip ticks)
         if (c == u'`') {
             const int tickCount = countRun(chars, end, i, u'`');
-            std::u16string pat(static_cast<size_t>(tickCount), u'`');
-            const int close = findSubseqNoNewline(chars, i + tickCount, end, pat);
+            const int close = findRepeatNoNewline(chars, i + tickCount, end, u'`', tickCount);
             if (close != -1) {
                 addPlainInline(out, plainStart, i);
-                InlineNode n;
-                n.type = MD_INLINE_CODE;
-                n.pieces.push_back({i + tickCount, close});
-                out.push_back(std::move(n));
+                out.addInline(MD_INLINE_CODE, i + tickCount, close);
                 i = close + tickCount;
                 plainStart = i;
                 continue;
@@ -162,13 +213,10 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
 
         // Strikethrough: ~~text~~ (strip delimiters)
         if (c == u'~' && i + 1 < end && chars[i + 1] == u'~') {
-            const int close = findSubseqNoNewline(chars, i + 2, end, u"~~");
+            const int close = findRepeatNoNewline(chars, i + 2, end, u'~', 2);
             if (close != -1) {
                 addPlainInline(out, plainStart, i);
-                InlineNode n;
-                n.type = MD_STRIKETHROUGH;
-                n.pieces.push_back({i + 2, close});
-                out.push_back(std::move(n));
+                out.addInline(MD_STRIKETHROUGH, i + 2, close);
                 i = close + 2;
                 plainStart = i;
                 continue;
@@ -177,13 +225,10 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
 
         // Underline: __text__ (keep delimiters)
         if (c == u'_' && i + 1 < end && chars[i + 1] == u'_') {
-            const int close = findSubseqNoNewline(chars, i + 2, end, u"__");
+            const int close = findRepeatNoNewline(chars, i + 2, end, u'_', 2);
             if (close != -1) {
                 addPlainInline(out, plainStart, i);
-                InlineNode n;
-                n.type = MD_UNDERLINE;
-                n.pieces.push_back({i, close + 2});
-                out.push_back(std::move(n));
+                out.addInline(MD_UNDERLINE, i, close + 2);
                 i = close + 2;
                 plainStart = i;
                 continue;
@@ -192,13 +237,10 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
 
         // Bold: **text** (strip delimiters)
         if (c == u'*' && i + 1 < end && chars[i + 1] == u'*') {
-            const int close = findSubseqNoNewline(chars, i + 2, end, u"**");
+            const int close = findRepeatNoNewline(chars, i + 2, end, u'*', 2);
             if (close != -1) {
                 addPlainInline(out, plainStart, i);
-                InlineNode n;
-                n.type = MD_BOLD;
-                n.pieces.push_back({i + 2, close});
-                out.push_back(std::move(n));
+                out.addInline(MD_BOLD, i + 2, close);
                 i = close + 2;
                 plainStart = i;
                 continue;
@@ -217,10 +259,7 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
             }
             if (close != -1) {
                 addPlainInline(out, plainStart, i);
-                InlineNode n;
-                n.type = MD_ITALIC;
-                n.pieces.push_back({i + 1, close});
-                out.push_back(std::move(n));
+                out.addInline(MD_ITALIC, i + 1, close);
                 i = close + 1;
                 plainStart = i;
                 continue;
@@ -231,7 +270,6 @@ static std::vector<InlineNode> parseInline(const jchar* chars, int start, int en
     }
 
     addPlainInline(out, plainStart, end);
-    return out;
 }
 
 static bool isHorizontalRuleLine(const jchar* chars, int len, int lineStart, int lineEnd) {
@@ -252,22 +290,20 @@ static bool isHorizontalRuleLine(const jchar* chars, int len, int lineStart, int
     return marker != 0 && count >= 3;
 }
 
-static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
-    std::vector<BlockNode> blocks;
-    blocks.reserve(32);
-
-    int i = 0;
-    int plainStart = 0;
+// Parses chars[from, len) and appends the blocks. `from` must be 0 or the end of a
+// previously parsed block: the scan keeps no state besides its position.
+static void parseMarkdownFrom(const jchar* chars, int len, int from, MarkdownArena& arena) {
+    int i = from;
+    int plainStart = from;
 
     auto flushPlainAsBlock = [&](int endExclusive) {
         if (plainStart >= endExclusive) {
             plainStart = endExclusive;
             return;
         }
-        BlockNode b;
-        b.type = MD_PLAIN_TEXT;
-        b.inlineNodes = parseInline(chars, plainStart, endExclusive);
-        blocks.push_back(std::move(b));
+        arena.beginBlock(MD_PLAIN_TEXT);
+        parseInline(chars, plainStart, endExclusive, arena);
+        arena.endBlock(endExclusive);
         plainStart = endExclusive;
     };
 
@@ -308,10 +344,8 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
                 }
 
                 flushPlainAsBlock(i);
-                BlockNode b;
-                b.type = MD_CODE_BLOCK;
-                b.pieces.push_back({i, endPos});
-                blocks.push_back(std::move(b));
+                arena.beginBlock(MD_CODE_BLOCK, i, endPos);
+                arena.endBlock(endPos);
                 i = endPos;
                 plainStart = i;
                 continue;
@@ -329,11 +363,10 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
             if (count >= 1 && count <= 6 && j < len && chars[j] == u' ') {
                 const int le = findLineEnd(chars, len, i);
                 flushPlainAsBlock(i);
-                BlockNode b;
-                b.type = MD_HEADER;
-                b.inlineNodes = parseInline(chars, i, le);
-                blocks.push_back(std::move(b));
+                arena.beginBlock(MD_HEADER);
+                parseInline(chars, i, le, arena);
                 i = (le < len) ? (le + 1) : le;
+                arena.endBlock(i);
                 plainStart = i;
                 continue;
             }
@@ -343,34 +376,26 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
         if (atSol && chars[i] == u'>' && i + 1 < len && chars[i + 1] == u' ') {
             flushPlainAsBlock(i);
 
-            BlockNode b;
-            b.type = MD_BLOCK_QUOTE;
+            arena.beginBlock(MD_BLOCK_QUOTE);
 
             int cur = i;
             while (cur < len) {
                 const int le = findLineEnd(chars, len, cur);
                 const int contentStart = std::min(cur + 2, le);
+                arena.clearInlines();
                 if (contentStart < le) {
-                    b.inlineNodes = parseInline(chars, contentStart, le);
-                } else {
-                    b.inlineNodes.clear();
+                    parseInline(chars, contentStart, le, arena);
                 }
 
                 // Merge as plain text inline nodes per line to preserve content
                 // Represent each line as inline nodes to keep delimiter stripping.
                 // We keep it simple: re-parse inline per line and append.
-                if (b.inlineNodes.empty()) {
-                    InlineNode n;
-                    n.type = MD_PLAIN_TEXT;
-                    n.pieces.push_back({contentStart, le});
-                    b.inlineNodes.push_back(std::move(n));
+                if (arena.inlineCount() == 0) {
+                    arena.addInline(MD_PLAIN_TEXT, contentStart, le);
                 }
 
                 if (le < len) {
-                    InlineNode nl;
-                    nl.type = MD_PLAIN_TEXT;
-                    nl.pieces.push_back({le, le + 1});
-                    b.inlineNodes.push_back(std::move(nl));
+                    arena.addInline(MD_PLAIN_TEXT, le, le + 1);
                 }
 
                 if (le >= len) {
@@ -388,7 +413,7 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
                 break;
             }
 
-            blocks.push_back(std::move(b));
+            arena.endBlock(cur);
             i = cur;
             plainStart = i;
             continue;
@@ -399,11 +424,9 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
             const int le = findLineEnd(chars, len, i);
             if (isHorizontalRuleLine(chars, len, i, le)) {
                 flushPlainAsBlock(i);
-                BlockNode b;
-                b.type = MD_HORIZONTAL_RULE;
-                b.pieces.push_back({i, le});
-                blocks.push_back(std::move(b));
+                arena.beginBlock(MD_HORIZONTAL_RULE, i, le);
                 i = (le < len) ? (le + 1) : le;
+                arena.endBlock(i);
                 plainStart = i;
                 continue;
             }
@@ -413,37 +436,64 @@ static std::vector<BlockNode> parseMarkdown(const jchar* chars, int len) {
     }
 
     flushPlainAsBlock(len);
+}
 
-    return blocks;
+// Parses the whole document into the calling thread's arena, reusing its storage.
+static const MarkdownArena& parseMarkdown(const jchar* chars, int len) {
+    thread_local MarkdownArena arena;
+    arena.clear();
+    parseMarkdownFrom(chars, len, 0, arena);
+    return arena;
 }
 
-static jintArray blocksToIntArray(JNIEnv* env, const std::vector<BlockNode>& blocks) {
-    std::vector<jint> out;
-    out.reserve(1024);
+// Appends chunk and re-parses from the first block that the new chars can affect.
+// Returns the index of the first re-parsed block; blocks before it are unchanged.
+static size_t appendAndReparse(IncrementalParser& parser, const jchar* chunk, int chunkLen) {
+    auto& arena = parser.arena;
+    const int oldLen = static_cast<int>(parser.content.size());
+    parser.content.append(reinterpret_cast<const char16_t*>(chunk), static_cast<size_t>(chunkLen));
+
+    // The last block always runs up to the old end. Every other block examined at
+    // most its own chars plus two more (the "> " continuation check of a block quote),
+    // so it is final once that lookahead lies before oldLen.
+    size_t keep = arena.blockCount() == 0 ? 0 : arena.blockCount() - 1;
+    while (keep > 0 && arena.blockEnds[keep - 1] + 2 > oldLen) {
+        keep--;
+    }
+    // A plain block ends where the next block was detected, and that detection can be
+    // undone by more chars (a "---" line growing into "---x"), so it goes with its successor.
+    if (keep > 0 && arena.blockType(keep - 1) == MD_PLAIN_TEXT) {
+        keep--;
+    }
+    const int from = (keep == 0) ? 0 : arena.blockEnds[keep - 1];
+    arena.truncate(keep);
 
-    out.push_back(static_cast<jint>(blocks.size()));
+    const auto* chars = reinterpret_cast<const jchar*>(parser.content.data());
+    parseMarkdownFrom(chars, static_cast<int>(parser.content.size()), from, arena);
+    return keep;
+}
 
-    for (const auto& b : blocks) {
-        out.push_back(static_cast<jint>(b.type));
-        out.push_back(static_cast<jint>(b.pieces.size()));
-        for (const auto& p : b.pieces) {
-            out.push_back(static_cast<jint>(p.start));
-            out.push_back(static_cast<jint>(p.end));
-        }
-        out.push_back(static_cast<jint>(b.inlineNodes.size()));
-        for (const auto& in : b.inlineNodes) {
-            out.push_back(static_cast<jint>(in.type));
-            out.push_back(static_cast<jint>(in.pieces.size()));
-            for (const auto& p : in.pieces) {
-                out.push_back(static_cast<jint>(p.start));
-                out.push_back(static_cast<jint>(p.end));
-            }
-        }
-    }
+static jintArray blocksToIntArray(JNIEnv* env, const MarkdownArena& arena) {
+    jintArray arr = env->NewIntArray(static_cast<jsize>(arena.data.size()));
+    if (arr == nullptr) return nullptr;
+    env->SetIntArrayRegion(arr, 0, static_cast<jsize>(arena.data.size()), arena.data.data());
+    return arr;
+}
 
-    jintArray arr = env->NewIntArray(static_cast<jsize>(out.size()));
+// [firstChangedBlock, blockCount, blocks from firstChangedBlock on...]
+static jintArray deltaToIntArray(JNIEnv* env, const MarkdownArena& arena, size_t firstChanged) {
+    const size_t from = (firstChanged < arena.blockCount())
+            ? static_cast<size_t>(arena.blockOffsets[firstChanged])
+            : arena.data.size();
+    const jsize tail = static_cast<jsize>(arena.data.size() - from);
+    jintArray arr = env->NewIntArray(2 + tail);
     if (arr == nullptr) return nullptr;
-    env->SetIntArrayRegion(arr, 0, static_cast<jsize>(out.size()), out.data());
+    const jint header[2] = {
+            static_cast<jint>(firstChanged),
+            static_cast<jint>(arena.blockCount() - firstChanged),
+    };
+    env->SetIntArrayRegion(arr, 0, 2, header);
+    env->SetIntArrayRegion(arr, 2, tail, arena.data.data() + from);
     return arr;
 }
 
@@ -462,9 +512,51 @@ Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeParse
     const jsize len = env->GetStringLength(content);
     const jchar* chars = env->GetStringChars(content, nullptr);
 
-    std::vector<BlockNode> blocks = parseMarkdown(chars, static_cast<int>(len));
+    const MarkdownArena& arena = parseMarkdown(chars, static_cast<int>(len));
 
     env->ReleaseStringChars(content, chars);
 
-    return blocksToIntArray(env, blocks);
+    return blocksToIntArray(env, arena);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeCreateIncrementalParser(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/
+) {
+    return reinterpret_cast<jlong>(new IncrementalParser());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeDestroyIncrementalParser(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    delete reinterpret_cast<IncrementalParser*>(handle);
+}
+
+// Returns [firstChangedBlock, blockCount, blocks...]: the blocks from firstChangedBlock
+// on replace the previous ones, in the same encoding as nativeParseMarkdown.
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownParser_nativeAppendIncremental(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle,
+        jstring chunk
+) {
+    if (handle == 0 || chunk == nullptr) {
+        return env->NewIntArray(0);
+    }
+
+    auto* parser = reinterpret_cast<IncrementalParser*>(handle);
+
+    const jsize len = env->GetStringLength(chunk);
+    const jchar* chars = env->GetStringChars(chunk, nullptr);
+
+    const size_t firstChanged = appendAndReparse(*parser, chars, static_cast<int>(len));
+
+    env->ReleaseStringChars(chunk, chars);
+
+    return deltaToIntArray(env, parser->arena, firstChanged);
 }
@@ -1,11 +1,54 @@
 #include <jni.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 #include "streamnative/StreamOperators.h"
 
 namespace {
 
+// Chars per nativePushDirect call; larger chunks are split by the Kotlin side.
+constexpr int kDirectInputChars = 4096;
+// Segments in the direct segment ring; a push producing more is drained in batches.
+constexpr int kDirectSegmentCapacity = 1024;
+constexpr jlong kDirectMoreFlag = 0x80000000LL;
+
+static_assert(sizeof(streamnative::Segment) == 3 * sizeof(jint), "Segment must stay three packed ints");
+static_assert(sizeof(streamnative::Utf8Segment) == 5 * sizeof(jint), "Utf8Segment must stay five packed ints");
+
+// What a session handle points to: the markdown session plus the shared memory
+// behind the direct ByteBuffers used by nativePushDirect.
+struct SplitterSession {
+    streamnative::MarkdownSession* markdown = nullptr;
+
+    std::vector<jchar> input;
+    std::vector<streamnative::Segment> ring;
+    int ringCursor = 0;
+
+    // Segments of the last direct push that are not published in the ring yet.
+    std::vector<streamnative::Segment> pending;
+    size_t pendingRead = 0;
+
+    // Scratch for nativePushUtf8.
+    std::vector<uint8_t> utf8Input;
+    std::vector<streamnative::Utf8Segment> utf8Segments;
+
+    ~SplitterSession() {
+        streamnative::destroyMarkdownSession(markdown);
+    }
+};
+
+inline SplitterSession* fromHandle(jlong handle) {
+    return reinterpret_cast<SplitterSession*>(handle);
+}
+
+inline jlong toHandle(streamnative::MarkdownSession* markdown) {
+    auto* s = new SplitterSession();
+    s->markdown = markdown;
+    return reinterpret_cast<jlong>(s);
+}
+
 inline jintArray segmentsToJIntArray(JNIEnv* env, const std::vector<streamnative::Segment>& segments) {
     jintArray out = env->NewIntArray(static_cast<jsize>(segments.size() * 3));
     if (out == nullptr) {
@@ -24,24 +67,58 @@ inline jintArray segmentsToJIntArray(JNIEnv* env, const std::vector<streamnative
     return out;
 }
 
+inline jintArray utf8SegmentsToJIntArray(JNIEnv* env, const std::vector<streamnative::Utf8Segment>& segments) {
+    const auto ints = static_cast<jsize>(segments.size() * 5);
+    jintArray out = env->NewIntArray(ints);
+    if (out == nullptr) {
+        return nullptr;
+    }
+    env->SetIntArrayRegion(out, 0, ints, reinterpret_cast<const jint*>(segments.data()));
+    return out;
+}
+
+// Copies the next batch of pending segments into the ring, contiguously.
+// Returns (offset in segments << 32) | count, with kDirectMoreFlag set while more remain.
+jlong publishPending(SplitterSession* s) {
+    const size_t remaining = s->pending.size() - s->pendingRead;
+    const int count = static_cast<int>(std::min<size_t>(remaining, static_cast<size_t>(kDirectSegmentCapacity)));
+    if (count > kDirectSegmentCapacity - s->ringCursor) {
+        s->ringCursor = 0;
+    }
+    const int offset = s->ringCursor;
+    std::copy_n(s->pending.begin() + static_cast<std::ptrdiff_t>(s->pendingRead), count,
+                s->ring.begin() + offset);
+    s->ringCursor += count;
+    s->pendingRead += static_cast<size_t>(count);
+
+    jlong result = (static_cast<jlong>(offset) << 32) | static_cast<jlong>(count);
+    if (s->pendingRead < s->pending.size()) {
+        result |= kDirectMoreFlag;
+    } else {
+        s->pending.clear();
+        s->pendingRead = 0;
+    }
+    return result;
+}
+
 } // namespace
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateBlockSession(
         JNIEnv* /*env*/,
-        jobject /*thiz*/
+        jobject /*thiz*/,
+        jboolean tableDriven
 ) {
-    auto* s = streamnative::createMarkdownBlockSession();
-    return reinterpret_cast<jlong>(s);
+    return toHandle(streamnative::createMarkdownBlockSession(tableDriven == JNI_TRUE));
 }
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeCreateInlineSession(
         JNIEnv* /*env*/,
-        jobject /*thiz*/
+        jobject /*thiz*/,
+        jboolean tableDriven
 ) {
-    auto* s = streamnative::createMarkdownInlineSession();
-    return reinterpret_cast<jlong>(s);
+    return toHandle(streamnative::createMarkdownInlineSession(tableDriven == JNI_TRUE));
 }
 
 extern "C" JNIEXPORT void JNICALL
@@ -50,8 +127,7 @@ Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDes
         jobject /*thiz*/,
         jlong handle
 ) {
-    auto* s = reinterpret_cast<streamnative::MarkdownSession*>(handle);
-    streamnative::destroyMarkdownSession(s);
+    delete fromHandle(handle);
 }
 
 extern "C" JNIEXPORT jintArray JNICALL
@@ -65,14 +141,212 @@ Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePus
         return env->NewIntArray(0);
     }
 
-    auto* s = reinterpret_cast<streamnative::MarkdownSession*>(handle);
+    auto* s = fromHandle(handle);
 
     const jsize len = env->GetStringLength(chunk);
     const jchar* chars = env->GetStringChars(chunk, nullptr);
 
-    std::vector<streamnative::Segment> segments = streamnative::markdownSessionPush(s, chars, static_cast<int>(len));
+    std::vector<streamnative::Segment> segments = streamnative::markdownSessionPush(s->markdown, chars, static_cast<int>(len));
 
     env->ReleaseStringChars(chunk, chars);
 
     return segmentsToJIntArray(env, segments);
 }
+
+// Pushes the first len bytes of chunk as UTF-8. Returns (type, start, end, byteStart, byteEnd)
+// per segment, with start/end in UTF-16 units of the decoded stream.
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushUtf8(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle,
+        jbyteArray chunk,
+        jint len
+) {
+    if (handle == 0 || chunk == nullptr || len <= 0 || len > env->GetArrayLength(chunk)) {
+        return env->NewIntArray(0);
+    }
+
+    auto* s = fromHandle(handle);
+    s->utf8Input.resize(static_cast<size_t>(len));
+    env->GetByteArrayRegion(chunk, 0, len, reinterpret_cast<jbyte*>(s->utf8Input.data()));
+
+    s->utf8Segments.clear();
+    streamnative::markdownSessionPushUtf8(s->markdown, s->utf8Input.data(), static_cast<int>(len), s->utf8Segments);
+    return utf8SegmentsToJIntArray(env, s->utf8Segments);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeSetCoalescing(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle,
+        jint maxChars,
+        jint maxDelayMillis
+) {
+    if (handle == 0) {
+        return;
+    }
+    streamnative::markdownSessionSetCoalescing(fromHandle(handle)->markdown, static_cast<int>(maxChars),
+                                               static_cast<int>(maxDelayMillis));
+}
+
+// Returns the delta held back by coalescing, as nativePush would.
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlush(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return env->NewIntArray(0);
+    }
+    std::vector<streamnative::Segment> segments;
+    streamnative::markdownSessionFlush(fromHandle(handle)->markdown, segments);
+    return segmentsToJIntArray(env, segments);
+}
+
+// Same for sessions fed through nativePushUtf8.
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlushUtf8(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return env->NewIntArray(0);
+    }
+    auto* s = fromHandle(handle);
+    s->utf8Segments.clear();
+    streamnative::markdownSessionFlushUtf8(s->markdown, s->utf8Segments);
+    return utf8SegmentsToJIntArray(env, s->utf8Segments);
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeSnapshot(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return env->NewByteArray(0);
+    }
+    const std::vector<uint8_t> bytes = streamnative::markdownSessionSnapshot(fromHandle(handle)->markdown);
+    jbyteArray out = env->NewByteArray(static_cast<jsize>(bytes.size()));
+    if (out == nullptr) {
+        return nullptr;
+    }
+    env->SetByteArrayRegion(out, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<const jbyte*>(bytes.data()));
+    return out;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeRestoreSession(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jbyteArray snapshot
+) {
+    if (snapshot == nullptr) {
+        return 0;
+    }
+    const jsize len = env->GetArrayLength(snapshot);
+    std::vector<uint8_t> bytes(static_cast<size_t>(len));
+    env->GetByteArrayRegion(snapshot, 0, len, reinterpret_cast<jbyte*>(bytes.data()));
+
+    streamnative::MarkdownSession* markdown = streamnative::restoreMarkdownSession(bytes.data(), bytes.size());
+    return markdown != nullptr ? toHandle(markdown) : 0;
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetInputBuffer(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return nullptr;
+    }
+    auto* s = fromHandle(handle);
+    if (s->input.empty()) {
+        s->input.resize(kDirectInputChars);
+    }
+    return env->NewDirectByteBuffer(s->input.data(), static_cast<jlong>(s->input.size() * sizeof(jchar)));
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeGetSegmentBuffer(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return nullptr;
+    }
+    auto* s = fromHandle(handle);
+    if (s->ring.empty()) {
+        s->ring.resize(kDirectSegmentCapacity);
+        s->pending.reserve(64);
+    }
+    return env->NewDirectByteBuffer(s->ring.data(), static_cast<jlong>(s->ring.size() * sizeof(streamnative::Segment)));
+}
+
+// Pushes the first len chars of the input buffer and publishes the resulting
+// segments into the segment buffer (see publishPending for the return value).
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativePushDirect(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle,
+        jint len
+) {
+    if (handle == 0) {
+        return 0;
+    }
+    auto* s = fromHandle(handle);
+    if (s->ring.empty() || len <= 0 || len > static_cast<jint>(s->input.size())) {
+        return 0;
+    }
+
+    // Anything not drained after the previous push is dropped.
+    s->pending.clear();
+    s->pendingRead = 0;
+    streamnative::markdownSessionPush(s->markdown, s->input.data(), static_cast<int>(len), s->pending);
+    return publishPending(s);
+}
+
+// Publishes the delta held back by coalescing, as nativePushDirect would.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeFlushDirect(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return 0;
+    }
+    auto* s = fromHandle(handle);
+    if (s->ring.empty()) {
+        return 0;
+    }
+
+    s->pending.clear();
+    s->pendingRead = 0;
+    streamnative::markdownSessionFlush(s->markdown, s->pending);
+    return publishPending(s);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeMarkdownSplitter_nativeDrainDirect(
+        JNIEnv* /*env*/,
+        jobject /*thiz*/,
+        jlong handle
+) {
+    if (handle == 0) {
+        return 0;
+    }
+    auto* s = fromHandle(handle);
+    if (s->ring.empty() || s->pendingRead >= s->pending.size()) {
+        return 0;
+    }
+    return publishPending(s);
+}
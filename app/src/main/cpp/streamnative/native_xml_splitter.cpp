@@ -1,4 +1,6 @@
 #include <jni.h>
+
+#include <cstdint>
 #include <vector>
 
 #include "streamnative/StreamOperators.h"
@@ -29,7 +31,8 @@ extern "C" JNIEXPORT jintArray JNICALL
 Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegments(
         JNIEnv* env,
         jobject /*thiz*/,
-        jstring content
+        jstring content,
+        jint threads
 ) {
     if (content == nullptr) {
         return env->NewIntArray(0);
@@ -38,9 +41,47 @@ Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXml
     const jsize len = env->GetStringLength(content);
     const jchar* chars = env->GetStringChars(content, nullptr);
 
-    std::vector<streamnative::Segment> segments = streamnative::splitByXml(chars, static_cast<int>(len));
+    std::vector<streamnative::Segment> segments = streamnative::splitByXml(chars, static_cast<int>(len), static_cast<int>(threads));
 
     env->ReleaseStringChars(content, chars);
 
     return segmentsToJIntArray(env, segments);
 }
+
+// Same split over UTF-8 bytes; returns (type, start, end, byteStart, byteEnd) per segment.
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_ai_assistance_operit_util_streamnative_NativeXmlSplitter_nativeSplitXmlSegmentsUtf8(
+        JNIEnv* env,
+        jobject /*thiz*/,
+        jbyteArray content,
+        jint threads
+) {
+    if (content == nullptr) {
+        return env->NewIntArray(0);
+    }
+
+    const jsize len = env->GetArrayLength(content);
+    std::vector<uint8_t> bytes(static_cast<size_t>(len));
+    env->GetByteArrayRegion(content, 0, len, reinterpret_cast<jbyte*>(bytes.data()));
+
+    const std::vector<streamnative::Utf8Segment> segments =
+            streamnative::splitByXmlUtf8(bytes.data(), static_cast<int>(len), static_cast<int>(threads));
+
+    jintArray out = env->NewIntArray(static_cast<jsize>(segments.size() * 5));
+    if (out == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<jint> flat;
+    flat.reserve(segments.size() * 5);
+    for (const auto& s : segments) {
+        flat.push_back(static_cast<jint>(s.type));
+        flat.push_back(static_cast<jint>(s.start));
+        flat.push_back(static_cast<jint>(s.end));
+        flat.push_back(static_cast<jint>(s.byteStart));
+        flat.push_back(static_cast<jint>(s.byteEnd));
+    }
+
+    env->SetIntArrayRegion(out, 0, static_cast<jsize>(flat.size()), flat.data());
+    return out;
+}
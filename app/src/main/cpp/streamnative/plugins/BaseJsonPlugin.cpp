@@ -1 +1,182 @@
 #include "BaseJsonPlugin.h"
+
+#include "../StreamSnapshot.h"
+
+namespace streamnative {
+
+PluginState BaseJsonPlugin::state() const { return state_; }
+
+bool BaseJsonPlugin::initPlugin() {
+    reset();
+    return true;
+}
+
+void BaseJsonPlugin::reset() {
+    // Events of the char that closed the structure stay readable until the next char.
+    state_ = PluginState::IDLE;
+    offset_ = 0;
+    depth_ = 0;
+    objectBits_ = 0;
+    containerStarts_.clear();
+    expectKey_ = false;
+    inString_ = false;
+    escaped_ = false;
+    stringIsKey_ = false;
+    stringStart_ = 0;
+    inScalar_ = false;
+    scalarStart_ = 0;
+}
+
+void BaseJsonPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(offset_);
+    out.putUInt(objectBits_);
+    out.putUInt(containerStarts_.size());
+    for (int start : containerStarts_) {
+        out.putInt(start);
+    }
+    out.putBool(expectKey_);
+    out.putBool(inString_);
+    out.putBool(escaped_);
+    out.putBool(stringIsKey_);
+    out.putInt(stringStart_);
+    out.putBool(inScalar_);
+    out.putInt(scalarStart_);
+}
+
+bool BaseJsonPlugin::restoreState(SnapshotReader& in) {
+    reset();
+    eventCount_ = 0;
+    uint32_t depth = 0;
+    if (!in.getState(state_) || !in.getInt(offset_) || !in.getUInt(objectBits_) ||
+        !in.getUInt(depth, static_cast<uint32_t>(in.remaining()))) {
+        return false;
+    }
+    containerStarts_.resize(depth);
+    for (int& start : containerStarts_) {
+        if (!in.getInt(start)) {
+            return false;
+        }
+    }
+    depth_ = static_cast<int>(depth);
+    return in.getBool(expectKey_) && in.getBool(inString_) && in.getBool(escaped_) &&
+           in.getBool(stringIsKey_) && in.getInt(stringStart_) && in.getBool(inScalar_) &&
+           in.getInt(scalarStart_);
+}
+
+void BaseJsonPlugin::collectTriggers(TriggerSet& triggers) const {
+    triggers.add(u'{');
+    triggers.add(u'[');
+}
+
+bool BaseJsonPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
+    eventCount_ = 0;
+    if (state_ == PluginState::IDLE) {
+        if (c != u'{' && c != u'[') {
+            return false; // Not a JSON starting character
+        }
+        state_ = PluginState::PROCESSING;
+        offset_ = 0;
+    }
+
+    const CharRole role = consume(c);
+    offset_ += 1;
+    const bool emit = shouldEmit(c, role);
+    if (depth_ == 0) {
+        reset();
+    }
+    return emit;
+}
+
+BaseJsonPlugin::CharRole BaseJsonPlugin::consume(char16_t c) {
+    const int pos = offset_;
+
+    if (inString_) {
+        if (escaped_) {
+            escaped_ = false;
+            return CharRole::CONTENT;
+        }
+        if (c == u'\\') {
+            escaped_ = true;
+            return CharRole::ESCAPE;
+        }
+        if (c == u'"') {
+            inString_ = false;
+            addEvent(stringIsKey_ ? JsonEventType::KEY_END : JsonEventType::VALUE_END, stringStart_, pos + 1);
+            return CharRole::QUOTE;
+        }
+        return CharRole::CONTENT;
+    }
+
+    const bool delimiter = isJsonWhitespace(c) || c == u',' || c == u':' || c == u'}' || c == u']';
+    if (inScalar_ && delimiter) {
+        inScalar_ = false;
+        addEvent(JsonEventType::VALUE_END, scalarStart_, pos);
+    }
+
+    switch (c) {
+        case u'"':
+            inString_ = true;
+            stringStart_ = pos;
+            stringIsKey_ = expectKey_ && inObject();
+            addEvent(stringIsKey_ ? JsonEventType::KEY_START : JsonEventType::VALUE_START, pos, pos);
+            return CharRole::QUOTE;
+        case u'{':
+        case u'[':
+            addEvent(JsonEventType::VALUE_START, pos, pos);
+            if (depth_ < kMaxTrackedDepth) {
+                const uint64_t bit = 1ull << static_cast<uint64_t>(depth_);
+                objectBits_ = (c == u'{') ? (objectBits_ | bit) : (objectBits_ & ~bit);
+            }
+            depth_ += 1;
+            containerStarts_.push_back(pos);
+            expectKey_ = (c == u'{');
+            return CharRole::STRUCTURAL;
+        case u'}':
+        case u']':
+            if (depth_ > 0) {
+                depth_ -= 1;
+                addEvent(JsonEventType::VALUE_END, containerStarts_.back(), pos + 1);
+                containerStarts_.pop_back();
+            }
+            expectKey_ = false;
+            return CharRole::STRUCTURAL;
+        case u',':
+            expectKey_ = inObject();
+            return CharRole::STRUCTURAL;
+        case u':':
+            expectKey_ = false;
+            return CharRole::STRUCTURAL;
+        default:
+            break;
+    }
+
+    if (isJsonWhitespace(c)) {
+        return CharRole::WHITESPACE;
+    }
+    if (!inScalar_) {
+        inScalar_ = true;
+        scalarStart_ = pos;
+        addEvent(JsonEventType::VALUE_START, pos, pos);
+    }
+    return CharRole::CONTENT;
+}
+
+bool BaseJsonPlugin::inObject() const {
+    // Containers nested deeper than kMaxTrackedDepth are treated as arrays.
+    return depth_ > 0 && depth_ <= kMaxTrackedDepth &&
+           ((objectBits_ >> static_cast<uint64_t>(depth_ - 1)) & 1ull) != 0u;
+}
+
+void BaseJsonPlugin::addEvent(JsonEventType type, int start, int end) {
+    if (eventCount_ < static_cast<int>(events_.size())) {
+        events_[static_cast<size_t>(eventCount_)] = {type, start, end};
+        eventCount_ += 1;
+    }
+}
+
+bool BaseJsonPlugin::isJsonWhitespace(char16_t c) {
+    return c == u' ' || c == u'\t' || c == u'\n' || c == u'\r';
+}
+
+} // namespace streamnative
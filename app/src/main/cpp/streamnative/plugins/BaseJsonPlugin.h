@@ -1,15 +1,86 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 #include "StreamPlugin.h"
 
 namespace streamnative {
 
+enum class JsonEventType : uint8_t {
+    KEY_START,
+    KEY_END,
+    VALUE_START,
+    VALUE_END,
+};
+
+// Offsets are relative to the opening bracket of the top-level structure.
+// START events have start == end; END events span the whole key or value.
+struct JsonEvent {
+    JsonEventType type;
+    int start;
+    int end;
+};
+
+// Incremental recognizer for one top-level JSON object or array.
+// Non-validating: it tracks containers, strings and escapes with constant work per
+// char and reports PROCESSING from the opening bracket through the matching close.
 class BaseJsonPlugin : public StreamPlugin {
 public:
-    PluginState state() const override { return PluginState::IDLE; }
-    bool processChar(char16_t, bool) override { return true; }
-    bool initPlugin() override { return true; }
-    void reset() override {}
+    PluginState state() const override;
+    bool processChar(char16_t c, bool atStartOfLine) override;
+    bool initPlugin() override;
+    void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
+
+    // Container nesting depth after the last char (0 once the structure closed).
+    int depth() const { return depth_; }
+
+    // Structural events produced by the last processChar call (at most two).
+    int eventCount() const { return eventCount_; }
+    const JsonEvent& event(int index) const { return events_[static_cast<size_t>(index)]; }
+
+protected:
+    enum class CharRole {
+        STRUCTURAL, // {}[],: outside strings
+        QUOTE,      // string delimiter
+        ESCAPE,     // backslash starting an escape sequence
+        WHITESPACE, // outside strings
+        CONTENT,    // string contents and bare scalars
+    };
+
+    virtual bool shouldEmit(char16_t c, CharRole role) const = 0;
+
+private:
+    static constexpr int kMaxTrackedDepth = 64;
+
+    PluginState state_ = PluginState::IDLE;
+    int offset_ = 0;
+
+    int depth_ = 0;
+    uint64_t objectBits_ = 0; // bit d-1 set when the container at depth d is an object
+    std::vector<int> containerStarts_;
+    bool expectKey_ = false;
+
+    bool inString_ = false;
+    bool escaped_ = false;
+    bool stringIsKey_ = false;
+    int stringStart_ = 0;
+
+    bool inScalar_ = false;
+    int scalarStart_ = 0;
+
+    std::array<JsonEvent, 2> events_{};
+    int eventCount_ = 0;
+
+    bool inObject() const;
+    void addEvent(JsonEventType type, int start, int end);
+    CharRole consume(char16_t c);
+
+    static bool isJsonWhitespace(char16_t c);
 };
 
 } // namespace streamnative
@@ -1 +1,13 @@
 #include "StreamJsonPlugin.h"
+
+namespace streamnative {
+
+StreamJsonPlugin::StreamJsonPlugin() {
+    reset();
+}
+
+bool StreamJsonPlugin::shouldEmit(char16_t /*c*/, CharRole /*role*/) const {
+    return true;
+}
+
+} // namespace streamnative
@@ -4,6 +4,13 @@
 
 namespace streamnative {
 
-class StreamJsonPlugin : public BaseJsonPlugin {};
+// Emits every char of the JSON structure, including {}[]",: and whitespace.
+class StreamJsonPlugin final : public BaseJsonPlugin {
+public:
+    StreamJsonPlugin();
+
+protected:
+    bool shouldEmit(char16_t c, CharRole role) const override;
+};
 
 } // namespace streamnative
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "../StreamSnapshot.h"
+
 namespace streamnative {
 
 namespace {
@@ -66,6 +68,22 @@ void StreamMarkdownFencedCodeBlockPlugin::reset() {
     hasStartedMatchingFence_ = false;
 }
 
+void StreamMarkdownFencedCodeBlockPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(fenceLen_);
+    out.putBool(isMatchingEndFence_);
+    out.putBool(hasStartedMatchingFence_);
+}
+
+bool StreamMarkdownFencedCodeBlockPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(fenceLen_) &&
+           in.getBool(isMatchingEndFence_) &&
+           in.getBool(hasStartedMatchingFence_);
+}
+
+void StreamMarkdownFencedCodeBlockPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'`'); }
+
 bool StreamMarkdownFencedCodeBlockPlugin::processChar(char16_t c, bool atStartOfLine) {
     if (state_ == PluginState::PROCESSING) {
         if (atStartOfLine) {
@@ -172,6 +190,20 @@ void StreamMarkdownInlineCodePlugin::reset() {
     endMatch_ = 0;
 }
 
+void StreamMarkdownInlineCodePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(tickLen_);
+    out.putInt(endMatch_);
+}
+
+bool StreamMarkdownInlineCodePlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(tickLen_) &&
+           in.getInt(endMatch_);
+}
+
+void StreamMarkdownInlineCodePlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'`'); }
+
 bool StreamMarkdownInlineCodePlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING && c == u'\n') {
         reset();
@@ -241,6 +273,20 @@ void StreamMarkdownBoldPlugin::reset() {
     endMatch_ = 0;
 }
 
+void StreamMarkdownBoldPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startMatch_);
+    out.putInt(endMatch_);
+}
+
+bool StreamMarkdownBoldPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startMatch_) &&
+           in.getInt(endMatch_);
+}
+
+void StreamMarkdownBoldPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'*'); }
+
 bool StreamMarkdownBoldPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (c == u'*') {
@@ -318,6 +364,24 @@ void StreamMarkdownItalicPlugin::reset() {
     lastChar_ = 0;
 }
 
+void StreamMarkdownItalicPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startMatch_);
+    out.putInt(endMatch_);
+    out.putUInt(lastChar_);
+    out.putBool(hasLastChar_);
+}
+
+bool StreamMarkdownItalicPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startMatch_) &&
+           in.getInt(endMatch_) &&
+           in.getChar(lastChar_) &&
+           in.getBool(hasLastChar_);
+}
+
+void StreamMarkdownItalicPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'*'); }
+
 bool StreamMarkdownItalicPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (hasLastChar_ && lastChar_ == u'*' && c == u'*') {
         // Kotlin special-case to avoid treating ** as italics
@@ -379,6 +443,20 @@ void StreamMarkdownHeaderPlugin::reset() {
     inMatch_ = false;
 }
 
+void StreamMarkdownHeaderPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(hashCount_);
+    out.putBool(inMatch_);
+}
+
+bool StreamMarkdownHeaderPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(hashCount_) &&
+           in.getBool(inMatch_);
+}
+
+void StreamMarkdownHeaderPlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
+
 bool StreamMarkdownHeaderPlugin::processChar(char16_t c, bool atStartOfLine) {
     if (state_ == PluginState::PROCESSING) {
         if (c == u'\n') {
@@ -431,6 +509,18 @@ void StreamMarkdownLinkPlugin::reset() {
     phase_ = 0;
 }
 
+void StreamMarkdownLinkPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(phase_);
+}
+
+bool StreamMarkdownLinkPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(phase_);
+}
+
+void StreamMarkdownLinkPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'['); }
+
 bool StreamMarkdownLinkPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::IDLE) {
         if (c == u'[') {
@@ -491,6 +581,18 @@ void StreamMarkdownBlockQuotePlugin::reset() {
     matchIndex_ = 0;
 }
 
+void StreamMarkdownBlockQuotePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(matchIndex_);
+}
+
+bool StreamMarkdownBlockQuotePlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(matchIndex_);
+}
+
+void StreamMarkdownBlockQuotePlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
+
 bool StreamMarkdownBlockQuotePlugin::processChar(char16_t c, bool atStartOfLine) {
     if (c == u'\n') {
         if (state_ == PluginState::PROCESSING) {
@@ -575,6 +677,22 @@ void StreamMarkdownHorizontalRulePlugin::reset() {
     markerCount_ = 0;
 }
 
+void StreamMarkdownHorizontalRulePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putUInt(currentMarker_);
+    out.putBool(hasMarker_);
+    out.putInt(markerCount_);
+}
+
+bool StreamMarkdownHorizontalRulePlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getChar(currentMarker_) &&
+           in.getBool(hasMarker_) &&
+           in.getInt(markerCount_);
+}
+
+void StreamMarkdownHorizontalRulePlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
+
 bool StreamMarkdownHorizontalRulePlugin::processChar(char16_t c, bool atStartOfLine) {
     if (c == u'\n') {
         const bool isMatch = (state_ == PluginState::TRYING || state_ == PluginState::PROCESSING) && markerCount_ >= 3;
@@ -632,6 +750,18 @@ void StreamMarkdownOrderedListPlugin::reset() {
     matchState_ = 0;
 }
 
+void StreamMarkdownOrderedListPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(matchState_);
+}
+
+bool StreamMarkdownOrderedListPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(matchState_);
+}
+
+void StreamMarkdownOrderedListPlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
+
 bool StreamMarkdownOrderedListPlugin::processChar(char16_t c, bool atStartOfLine) {
     if (state_ == PluginState::PROCESSING) {
         if (c == u'\n') {
@@ -707,6 +837,18 @@ void StreamMarkdownUnorderedListPlugin::reset() {
     matchState_ = 0;
 }
 
+void StreamMarkdownUnorderedListPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(matchState_);
+}
+
+bool StreamMarkdownUnorderedListPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(matchState_);
+}
+
+void StreamMarkdownUnorderedListPlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
+
 bool StreamMarkdownUnorderedListPlugin::processChar(char16_t c, bool atStartOfLine) {
     if (state_ == PluginState::PROCESSING) {
         if (c == u'\n') {
@@ -768,6 +910,20 @@ void StreamMarkdownStrikethroughPlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownStrikethroughPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownStrikethroughPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownStrikethroughPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'~'); }
+
 bool StreamMarkdownStrikethroughPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         // end matcher for "~~"
@@ -844,6 +1000,20 @@ void StreamMarkdownUnderlinePlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownUnderlinePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownUnderlinePlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownUnderlinePlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'_'); }
+
 bool StreamMarkdownUnderlinePlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (endState_ == 0) {
@@ -917,6 +1087,20 @@ void StreamMarkdownInlineLaTeXPlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownInlineLaTeXPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownInlineLaTeXPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownInlineLaTeXPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'$'); }
+
 bool StreamMarkdownInlineLaTeXPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (endState_ == 0) {
@@ -973,6 +1157,20 @@ void StreamMarkdownInlineParenLaTeXPlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownInlineParenLaTeXPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownInlineParenLaTeXPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownInlineParenLaTeXPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'\\'); }
+
 bool StreamMarkdownInlineParenLaTeXPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (endState_ == 0) {
@@ -1046,6 +1244,20 @@ void StreamMarkdownBlockLaTeXPlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownBlockLaTeXPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownBlockLaTeXPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownBlockLaTeXPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'$'); }
+
 bool StreamMarkdownBlockLaTeXPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (endState_ == 0) {
@@ -1109,6 +1321,20 @@ void StreamMarkdownBlockBracketLaTeXPlugin::reset() {
     endState_ = 0;
 }
 
+void StreamMarkdownBlockBracketLaTeXPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(startState_);
+    out.putInt(endState_);
+}
+
+bool StreamMarkdownBlockBracketLaTeXPlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(startState_) &&
+           in.getInt(endState_);
+}
+
+void StreamMarkdownBlockBracketLaTeXPlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'\\'); }
+
 bool StreamMarkdownBlockBracketLaTeXPlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::PROCESSING) {
         if (endState_ == 0) {
@@ -1171,6 +1397,18 @@ void StreamMarkdownImagePlugin::reset() {
     phase_ = 0;
 }
 
+void StreamMarkdownImagePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(phase_);
+}
+
+bool StreamMarkdownImagePlugin::restoreState(SnapshotReader& in) {
+    return in.getState(state_) &&
+           in.getInt(phase_);
+}
+
+void StreamMarkdownImagePlugin::collectTriggers(TriggerSet& triggers) const { triggers.add(u'!'); }
+
 bool StreamMarkdownImagePlugin::processChar(char16_t c, bool /*atStartOfLine*/) {
     if (state_ == PluginState::IDLE) {
         if (c == u'!') {
@@ -1229,7 +1467,15 @@ StreamMarkdownTablePlugin::StreamMarkdownTablePlugin(bool includeDelimiters)
           state_(PluginState::IDLE),
           tableRowCount_(0),
           foundHeaderSeparator_(false),
-          headerSepMatchState_(0) {
+          columnCount_(0),
+          cellCount_(0),
+          cellHasContent_(false),
+          escaped_(false),
+          delimiterRowValid_(false),
+          alignColonStart_(false),
+          alignColonEnd_(false),
+          alignTrailing_(false),
+          alignDashes_(0) {
     reset();
 }
 
@@ -1244,12 +1490,120 @@ void StreamMarkdownTablePlugin::reset() {
     state_ = PluginState::IDLE;
     tableRowCount_ = 0;
     foundHeaderSeparator_ = false;
-    headerSepMatchState_ = 0;
-}
+    columnCount_ = 0;
+    startRow();
+}
+
+void StreamMarkdownTablePlugin::startRow() {
+    cellCount_ = 0;
+    cellHasContent_ = false;
+    escaped_ = false;
+    delimiterRowValid_ = true;
+    alignColonStart_ = false;
+    alignColonEnd_ = false;
+    alignTrailing_ = false;
+    alignDashes_ = 0;
+}
+
+void StreamMarkdownTablePlugin::closeCell() {
+    TableBoundary b = TableBoundary::Cell;
+    if (tableRowCount_ == 2) {
+        if (alignDashes_ <= 0) {
+            delimiterRowValid_ = false;
+        } else if (alignColonStart_ && alignColonEnd_) {
+            b = TableBoundary::CellAlignCenter;
+        } else if (alignColonEnd_) {
+            b = TableBoundary::CellAlignRight;
+        } else if (alignColonStart_) {
+            b = TableBoundary::CellAlignLeft;
+        }
+        alignColonStart_ = false;
+        alignColonEnd_ = false;
+        alignTrailing_ = false;
+        alignDashes_ = 0;
+    }
+    boundaries_[static_cast<size_t>(boundaryCount_++)] = b;
+    cellCount_ += 1;
+    cellHasContent_ = false;
+}
+
+void StreamMarkdownTablePlugin::addDelimiterChar(char16_t c) {
+    if (alignDashes_ < 0) {
+        return;
+    }
+    if (c == u' ' || c == u'\t') {
+        if (alignColonStart_ || alignDashes_ > 0) {
+            alignTrailing_ = true;
+        }
+        return;
+    }
+    if (!alignTrailing_ && !alignColonEnd_) {
+        if (c == u'-') {
+            alignDashes_ += 1;
+            return;
+        }
+        if (c == u':' && alignDashes_ > 0) {
+            alignColonEnd_ = true;
+            return;
+        }
+        if (c == u':' && !alignColonStart_) {
+            alignColonStart_ = true;
+            return;
+        }
+    }
+    alignDashes_ = -1;
+    delimiterRowValid_ = false;
+}
+
+void StreamMarkdownTablePlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putInt(tableRowCount_);
+    out.putBool(foundHeaderSeparator_);
+    out.putInt(columnCount_);
+    out.putInt(cellCount_);
+    out.putBool(cellHasContent_);
+    out.putBool(escaped_);
+    out.putBool(delimiterRowValid_);
+    out.putBool(alignColonStart_);
+    out.putBool(alignColonEnd_);
+    out.putBool(alignTrailing_);
+    out.putInt(alignDashes_);
+}
+
+bool StreamMarkdownTablePlugin::restoreState(SnapshotReader& in) {
+    boundaryCount_ = 0;
+    return in.getState(state_) &&
+           in.getInt(tableRowCount_) &&
+           in.getBool(foundHeaderSeparator_) &&
+           in.getInt(columnCount_) &&
+           in.getInt(cellCount_) &&
+           in.getBool(cellHasContent_) &&
+           in.getBool(escaped_) &&
+           in.getBool(delimiterRowValid_) &&
+           in.getBool(alignColonStart_) &&
+           in.getBool(alignColonEnd_) &&
+           in.getBool(alignTrailing_) &&
+           in.getInt(alignDashes_);
+}
+
+void StreamMarkdownTablePlugin::collectTriggers(TriggerSet& /*triggers*/) const {}
 
 bool StreamMarkdownTablePlugin::processChar(char16_t c, bool atStartOfLine) {
+    boundaryCount_ = 0;
+
     if (c == u'\n') {
         if (state_ == PluginState::PROCESSING) {
+            // A row without a closing pipe ends its last cell here.
+            if (cellHasContent_) {
+                closeCell();
+            }
+            if (tableRowCount_ == 1) {
+                columnCount_ = cellCount_;
+            } else if (tableRowCount_ == 2) {
+                foundHeaderSeparator_ = delimiterRowValid_ && cellCount_ > 0 && cellCount_ == columnCount_;
+            }
+            boundaries_[static_cast<size_t>(boundaryCount_++)] =
+                    (tableRowCount_ == 2 && foundHeaderSeparator_) ? TableBoundary::HeaderEnd : TableBoundary::Row;
             state_ = PluginState::WAITFOR;
         }
         return true;
@@ -1260,7 +1614,7 @@ bool StreamMarkdownTablePlugin::processChar(char16_t c, bool atStartOfLine) {
             if (c == u'|') {
                 state_ = PluginState::PROCESSING;
                 tableRowCount_ += 1;
-                headerSepMatchState_ = 0;
+                startRow();
                 return includeDelimiters_;
             }
             // other starters end table
@@ -1279,10 +1633,11 @@ bool StreamMarkdownTablePlugin::processChar(char16_t c, bool atStartOfLine) {
                 state_ = PluginState::PROCESSING;
                 tableRowCount_ = 1;
                 foundHeaderSeparator_ = false;
+                columnCount_ = 0;
             } else if (state_ == PluginState::PROCESSING) {
                 tableRowCount_ += 1;
             }
-            headerSepMatchState_ = 0;
+            startRow();
             return includeDelimiters_;
         }
         if (state_ == PluginState::PROCESSING) {
@@ -1292,16 +1647,17 @@ bool StreamMarkdownTablePlugin::processChar(char16_t c, bool atStartOfLine) {
     }
 
     if (state_ == PluginState::PROCESSING) {
-        if (tableRowCount_ == 2 && !foundHeaderSeparator_) {
-            // Very lightweight header separator detection: accept only - : space |\t
-            if (headerSepMatchState_ == 0) {
-                // first non-SOL char already processed; keep collecting
-                headerSepMatchState_ = 1;
+        // An unescaped pipe ends the cell before it; \| is a literal pipe inside a cell.
+        const bool delimiter = (c == u'|' && !escaped_);
+        escaped_ = (c == u'\\' && !escaped_);
+        if (delimiter) {
+            closeCell();
+        } else {
+            if (c != u' ' && c != u'\t') {
+                cellHasContent_ = true;
             }
-            if (c == u'|' || c == u'-' || c == u':' || c == u' ' || c == u'\t') {
-                // keep
-            } else {
-                // not a separator line
+            if (tableRowCount_ == 2) {
+                addDelimiterChar(c);
             }
         }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 
 #include "StreamPlugin.h"
@@ -14,6 +16,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeFences_;
@@ -31,6 +36,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeTicks_;
@@ -46,6 +54,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeAsterisks_;
@@ -61,6 +72,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeAsterisks_;
@@ -78,6 +92,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeMarker_;
@@ -93,6 +110,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     PluginState state_;
@@ -106,6 +126,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeMarker_;
@@ -120,6 +143,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeMarker_;
@@ -136,6 +162,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeMarker_;
@@ -150,6 +179,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeMarker_;
@@ -164,6 +196,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -179,6 +214,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -194,6 +232,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -209,6 +250,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -224,6 +268,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -239,6 +286,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -254,6 +304,9 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
 
 private:
     bool includeDelimiters_;
@@ -261,6 +314,19 @@ private:
     int phase_;
 };
 
+// Table structure found at a char: a cell ends before an unescaped '|' (or before the '\n'
+// of a row without a closing pipe), a row ends before its '\n'. Cells of the second row carry
+// the alignment they spell; HeaderEnd replaces Row when that row is a valid delimiter row
+// with one cell per header column.
+enum class TableBoundary : uint8_t {
+    Cell,
+    CellAlignLeft,
+    CellAlignCenter,
+    CellAlignRight,
+    Row,
+    HeaderEnd,
+};
+
 class StreamMarkdownTablePlugin final : public StreamPlugin {
 public:
     explicit StreamMarkdownTablePlugin(bool includeDelimiters = true);
@@ -268,13 +334,41 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
+
+    // Boundaries found at the char of the last processChar call (at most two).
+    int boundaryCount() const { return boundaryCount_; }
+    TableBoundary boundary(int index) const { return boundaries_[static_cast<size_t>(index)]; }
+
+    // Cells in the header row, once it ended (0 before).
+    int columnCount() const { return columnCount_; }
 
 private:
+    void startRow();
+    void closeCell();
+    void addDelimiterChar(char16_t c);
+
     bool includeDelimiters_;
     PluginState state_;
     int tableRowCount_;
     bool foundHeaderSeparator_;
-    int headerSepMatchState_;
+
+    int columnCount_;
+    int cellCount_;         // cells closed in the current row
+    bool cellHasContent_;   // non-blank chars since the last boundary
+    bool escaped_;          // previous char was an unescaped backslash
+
+    // Delimiter row (second row) parsing, per cell: [ws] [:] -+ [:] [ws]
+    bool delimiterRowValid_;
+    bool alignColonStart_;
+    bool alignColonEnd_;
+    bool alignTrailing_;
+    int alignDashes_;
+
+    std::array<TableBoundary, 2> boundaries_{};
+    int boundaryCount_ = 0;
 };
 
 } // namespace streamnative
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "../StreamTriggerSet.h"
+
 namespace streamnative {
 
+class SnapshotReader;
+class SnapshotWriter;
+
 enum class PluginState {
     IDLE,
     TRYING,
@@ -16,6 +21,26 @@ public:
     virtual bool processChar(char16_t c, bool atStartOfLine) = 0;
     virtual bool initPlugin() = 0;
     virtual void reset() = 0;
+
+    // Mutable parse state (not constructor options) for session snapshots. restoreState
+    // reads it back into a plugin built with the same options and returns false on
+    // malformed input.
+    virtual void saveState(SnapshotWriter& out) const = 0;
+    virtual bool restoreState(SnapshotReader& in) = 0;
+
+    // Registers every char that can take the plugin out of IDLE when it is not at the
+    // start of a line. Any other char must leave an idle plugin untouched (modulo
+    // skipIdleRun) and be emitted as-is. The default opts out of plain-text skipping.
+    virtual void collectTriggers(TriggerSet& triggers) const { triggers.addAll(); }
+
+    // Called instead of processChar for a run of non-trigger chars (no '\n', not at
+    // start of line) while the plugin is idle.
+    virtual void skipIdleRun(const char16_t* /*chars*/, int /*len*/) {}
+
+    // Called while the plugin is PROCESSING. Consumes the leading chars that would each
+    // keep it PROCESSING with the same emit flag (stored in shouldEmit), and returns how
+    // many it consumed. The default consumes none.
+    virtual int skipProcessingRun(const char16_t* /*chars*/, int /*len*/, bool& /*shouldEmit*/) { return 0; }
 };
 
 } // namespace streamnative
@@ -1 +1,13 @@
 #include "StreamPureJsonPlugin.h"
+
+namespace streamnative {
+
+StreamPureJsonPlugin::StreamPureJsonPlugin() {
+    reset();
+}
+
+bool StreamPureJsonPlugin::shouldEmit(char16_t /*c*/, CharRole role) const {
+    return role == CharRole::CONTENT;
+}
+
+} // namespace streamnative
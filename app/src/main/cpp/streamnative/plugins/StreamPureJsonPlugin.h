@@ -4,6 +4,14 @@
 
 namespace streamnative {
 
-class StreamPureJsonPlugin : public BaseJsonPlugin {};
+// Emits only keys and values: structural chars, quotes, escape backslashes and
+// whitespace outside strings are dropped.
+class StreamPureJsonPlugin final : public BaseJsonPlugin {
+public:
+    StreamPureJsonPlugin();
+
+protected:
+    bool shouldEmit(char16_t c, CharRole role) const override;
+};
 
 } // namespace streamnative
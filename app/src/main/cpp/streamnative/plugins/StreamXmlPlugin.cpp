@@ -1,7 +1,18 @@
 #include "StreamXmlPlugin.h"
 
+#include <cstdint>
+
+#include "../StreamSnapshot.h"
+
 namespace streamnative {
 
+namespace {
+
+// Bounds the closing-tag automaton when a stream keeps inventing tag names.
+constexpr int kMaxEndTags = 128;
+
+} // namespace
+
 StreamXmlPlugin::StreamXmlPlugin(bool includeTagsInOutput)
         : includeTagsInOutput_(includeTagsInOutput),
           state_(PluginState::IDLE),
@@ -9,6 +20,7 @@ StreamXmlPlugin::StreamXmlPlugin(bool includeTagsInOutput)
           allowStartAfterEndTag_(false),
           allowStartAfterPunctuation_(false),
           haveEndPattern_(false) {
+    endTagTriggers_.add(u'<');
     reset();
 }
 
@@ -25,12 +37,113 @@ void StreamXmlPlugin::reset() {
     state_ = PluginState::IDLE;
     startState_ = StartState::WAIT_LT;
     tagName_.clear();
-    endMatcher_.reset();
-    endPattern_.clear();
+    endTagId_ = AhoCorasickMatcher::kNoPattern;
+    endTagState_ = AhoCorasickMatcher::kRootState;
     haveEndPattern_ = false;
     lastChar_ = 0;
 }
 
+bool StreamXmlPlugin::allowsStartAfterEndTag() const {
+    return allowStartAfterEndTag_;
+}
+
+bool StreamXmlPlugin::allowsStartAfterPunctuation() const {
+    return allowStartAfterPunctuation_;
+}
+
+void StreamXmlPlugin::setStartAllowance(bool afterEndTag, bool afterPunctuation) {
+    allowStartAfterEndTag_ = afterEndTag;
+    allowStartAfterPunctuation_ = afterPunctuation;
+}
+
+void StreamXmlPlugin::saveState(SnapshotWriter& out) const {
+    out.putState(state_);
+    out.putUInt(static_cast<uint64_t>(startState_));
+    out.putBool(allowStartAfterEndTag_);
+    out.putBool(allowStartAfterPunctuation_);
+    out.putString(tagName_);
+    out.putUInt(lastChar_);
+    out.putBool(haveEndPattern_);
+    if (haveEndPattern_) {
+        // The end pattern follows from tagName_; only the matched prefix is kept, since
+        // automaton states are local to this instance.
+        out.putUInt(static_cast<uint64_t>(endTags_.prefixMatched(endTagState_, endPattern_)));
+    }
+}
+
+bool StreamXmlPlugin::restoreState(SnapshotReader& in) {
+    reset();
+    uint32_t startState = 0;
+    if (!in.getState(state_) ||
+        !in.getUInt(startState, static_cast<uint32_t>(StartState::IN_ATTRS)) ||
+        !in.getBool(allowStartAfterEndTag_) ||
+        !in.getBool(allowStartAfterPunctuation_) ||
+        !in.getString(tagName_) ||
+        !in.getChar(lastChar_) ||
+        !in.getBool(haveEndPattern_)) {
+        return false;
+    }
+    startState_ = static_cast<StartState>(startState);
+    if (haveEndPattern_) {
+        uint32_t matched = 0;
+        buildEndPattern();
+        if (!in.getUInt(matched, static_cast<uint32_t>(endPattern_.size() - 1))) {
+            return false;
+        }
+        endTagState_ = endTags_.prefixState(endPattern_, static_cast<int>(matched));
+    }
+    return true;
+}
+
+bool StreamXmlPlugin::isAtRest() const {
+    return state_ == PluginState::IDLE && startState_ == StartState::WAIT_LT &&
+           !allowStartAfterEndTag_ && !allowStartAfterPunctuation_;
+}
+
+void StreamXmlPlugin::collectTriggers(TriggerSet& triggers) const {
+    // Punctuation and emoji arm allowStartAfterPunctuation_, so they must be seen one by one.
+    // The set only depends on the character classes, so the scan runs once per process
+    // rather than once per session.
+    static const TriggerSet kTriggers = [] {
+        TriggerSet set;
+        set.add(u'<');
+        for (uint32_t c = 0; c <= 0xFFFFu; c++) {
+            const auto ch = static_cast<char16_t>(c);
+            if (isPunctuationTrigger(ch) || isEmojiTrigger(ch)) {
+                set.add(ch);
+            }
+        }
+        return set;
+    }();
+    triggers.merge(kTriggers);
+}
+
+void StreamXmlPlugin::skipIdleRun(const char16_t* chars, int len) {
+    // Same effect as feeding the run through processChar: spaces keep the start
+    // allowance, anything else clears it.
+    for (int i = 0; i < len; i++) {
+        const char16_t c = chars[i];
+        if (c != u' ' && c != u'\t' && !isEmojiContinuationChar(c)) {
+            allowStartAfterEndTag_ = false;
+            allowStartAfterPunctuation_ = false;
+            return;
+        }
+    }
+}
+
+int StreamXmlPlugin::skipProcessingRun(const char16_t* chars, int len, bool& shouldEmit) {
+    if (state_ != PluginState::PROCESSING || !haveEndPattern_ || endTagState_ != AhoCorasickMatcher::kRootState) {
+        return 0;
+    }
+    // At the root, anything but '<' leaves the closing-tag automaton where it is.
+    const int run = endTagTriggers_.find(reinterpret_cast<const jchar*>(chars), 0, len);
+    if (run > 0) {
+        lastChar_ = chars[run - 1];
+    }
+    shouldEmit = includeTagsInOutput_;
+    return run;
+}
+
 bool StreamXmlPlugin::isAsciiLetter(char16_t c) {
     return (c >= u'A' && c <= u'Z') || (c >= u'a' && c <= u'z');
 }
@@ -172,7 +285,11 @@ void StreamXmlPlugin::buildEndPattern() {
     endPattern_.push_back(u'/');
     endPattern_.append(tagName_);
     endPattern_.push_back(u'>');
-    endMatcher_.setPattern(endPattern_);
+    if (endTags_.patternCount() >= kMaxEndTags && endTags_.findPattern(endPattern_) == AhoCorasickMatcher::kNoPattern) {
+        endTags_.clear();
+    }
+    endTagId_ = endTags_.addPattern(endPattern_);
+    endTagState_ = AhoCorasickMatcher::kRootState;
     haveEndPattern_ = true;
 }
 
@@ -185,7 +302,8 @@ bool StreamXmlPlugin::processChar(char16_t c, bool atStartOfLine) {
 
     if (state_ == PluginState::PROCESSING) {
         if (haveEndPattern_) {
-            if (endMatcher_.process(c)) {
+            endTagState_ = endTags_.step(endTagState_, c);
+            if (endTags_.matches(endTagState_, endTagId_)) {
                 allowStartAfterEndTag_ = true;
                 allowStartAfterPunctuation_ = false;
                 reset();
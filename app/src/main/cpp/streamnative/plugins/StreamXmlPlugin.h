@@ -2,7 +2,7 @@
 
 #include <string>
 
-#include "../StreamKmpGraph.h"
+#include "../StreamAhoCorasick.h"
 #include "StreamPlugin.h"
 
 namespace streamnative {
@@ -15,6 +15,21 @@ public:
     bool processChar(char16_t c, bool atStartOfLine) override;
     bool initPlugin() override;
     void reset() override;
+    void collectTriggers(TriggerSet& triggers) const override;
+    void skipIdleRun(const char16_t* chars, int len) override;
+    void saveState(SnapshotWriter& out) const override;
+    bool restoreState(SnapshotReader& in) override;
+    int skipProcessingRun(const char16_t* chars, int len, bool& shouldEmit) override;
+
+    // Start allowance carried between evaluations, for engines that track IDLE/TRYING
+    // outside the plugin (MarkdownStartDfa).
+    bool allowsStartAfterEndTag() const;
+    bool allowsStartAfterPunctuation() const;
+    void setStartAllowance(bool afterEndTag, bool afterPunctuation);
+
+    // IDLE with no partial start tag and no start allowance, i.e. indistinguishable from
+    // a freshly reset plugin.
+    bool isAtRest() const;
 
 private:
     enum class StartState {
@@ -34,7 +49,12 @@ private:
     std::u16string tagName_;
     std::u16string endPattern_;
     bool haveEndPattern_;
-    KmpMatcher endMatcher_;
+    // Every closing tag seen by this plugin, so a repeated tag name reuses its pattern.
+    AhoCorasickMatcher endTags_;
+    int endTagId_ = AhoCorasickMatcher::kNoPattern;
+    int endTagState_ = AhoCorasickMatcher::kRootState;
+    // First chars of every closing tag, i.e. the only chars that leave the root state.
+    TriggerSet endTagTriggers_;
     char16_t lastChar_ = 0;
 
     bool handleDefaultCharacter(char16_t c);
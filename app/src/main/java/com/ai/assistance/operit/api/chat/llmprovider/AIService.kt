@@ -92,4 +92,11 @@ interface AIService {
     fun release() {
         // 默认空实现，子类按需覆盖
     }
+
+    /**
+     * 应用启动时的预热
+     * 本地模型（如llama.cpp）可确保上次使用的系统提示词状态已保存，缺失时重建后即释放模型
+     * API服务无需处理，返回false
+     */
+    suspend fun prewarm(): Boolean = false
 }
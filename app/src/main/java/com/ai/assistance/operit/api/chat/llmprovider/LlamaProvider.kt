@@ -35,6 +35,15 @@ class LlamaProvider(
     companion object {
         private const val TAG = "LlamaProvider"
 
+        /** App-private directory of saved llama prompt states (system prompt + tools). */
+        private const val PROMPT_STATE_CACHE_DIR = "llama_prompt_state"
+
+        /**
+         * Next to the saved states: the state file of the system prompt prefix last used with a
+         * model (first line) and the prefix itself, rebuilt at app start if the file is gone.
+         */
+        private const val LAST_SYSTEM_PREFIX_SUFFIX = ".system_prefix"
+
         fun getModelsDir(): File {
             return File(
                 Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_DOWNLOADS),
@@ -56,6 +65,9 @@ class LlamaProvider(
 
     private val sessionLock = Any()
     private var session: LlamaSession? = null
+    // 当前会话已处理过的系统提示词前缀；prewarm会截断KV缓存，每个前缀只做一次
+    @Volatile
+    private var prewarmedSystemPrefix: String? = null
 
     override val inputTokenCount: Int
         get() = _inputTokenCount
@@ -102,6 +114,7 @@ class LlamaProvider(
         synchronized(sessionLock) {
             session?.release()
             session = null
+            prewarmedSystemPrefix = null
         }
     }
 
@@ -271,6 +284,17 @@ class LlamaProvider(
             }.onFailure {
                 AppLogger.w(TAG, "配置llama.cpp原生Tool Call grammar失败", it)
             }
+
+            // 系统提示词与工具定义在各轮对话间不变，其KV状态保存在磁盘上供新会话直接加载
+            kotlin.runCatching {
+                buildSystemPromptPrefix(s, roles, contents, prompt)?.let { prefix ->
+                    if (!prewarmSystemPrefix(s, prefix)) {
+                        AppLogger.w(TAG, "llama.cpp系统提示词状态缓存失败")
+                    }
+                }
+            }.onFailure {
+                AppLogger.w(TAG, "llama.cpp系统提示词状态缓存失败", it)
+            }
         }
 
         _inputTokenCount = kotlin.runCatching { s.countTokens(prompt) }.getOrElse { 0 }
@@ -288,7 +312,21 @@ class LlamaProvider(
         val toolCallOutputBuffer = StringBuilder()
 
         val success = withContext(Dispatchers.IO) {
-            s.generateStream(prompt, requestedMaxNewTokens) { token ->
+            s.generateStream(
+                prompt,
+                requestedMaxNewTokens,
+                onPrefillProgress = { done, total ->
+                    AppLogger.d(TAG, "llama.cpp预填充进度: $done/$total")
+                },
+                onStats = { stats ->
+                    AppLogger.d(
+                        TAG,
+                        "llama.cpp生成统计: tokens=${stats.generatedTokens}, " +
+                            "tokens/s=${"%.1f".format(stats.tokensPerSecond)}, " +
+                            "draft接受率=${"%.0f".format(stats.acceptanceRate * 100)}%"
+                    )
+                }
+            ) { token ->
                 if (isCancelled) {
                     false
                 } else {
@@ -327,6 +365,123 @@ class LlamaProvider(
         }
 
         AppLogger.i(TAG, "llama.cpp推理完成，输出token数: $_outputTokenCount")
+        kotlin.runCatching { s.getPromptCacheStats() }.getOrNull()?.let { stats ->
+            AppLogger.d(
+                TAG,
+                "KV前缀复用: prompt=${stats.lastPromptTokens}, reused=${stats.lastReusedTokens}, " +
+                    "restored=${stats.lastRestoredTokens}, decoded=${stats.lastDecodedTokens}"
+            )
+        }
+    }
+
+    /**
+     * Evaluates the templated system prompt (with the tool call addon when enabled) into the
+     * on-disk prompt state cache, e.g. at app start, so the first request after a restart does
+     * not prefill it. Loads the model if no session exists yet.
+     */
+    suspend fun prewarmSystemPrompt(systemPrompt: String, availableTools: List<ToolPrompt>?): Boolean =
+        withContext(Dispatchers.IO) {
+            kotlin.runCatching {
+                val s = ensureSessionLocked() ?: return@runCatching false
+                val (roles, contents) = buildPromptMessages(
+                    message = "",
+                    chatHistory = listOf("system" to systemPrompt),
+                    availableTools = availableTools,
+                    preserveThinkInHistory = false
+                )
+                val prompt = s.applyChatTemplate(roles, contents, true) ?: return@runCatching false
+                val prefix = buildSystemPromptPrefix(s, roles, contents, prompt) ?: return@runCatching false
+                prewarmSystemPrefix(s, prefix)
+            }.getOrElse {
+                AppLogger.w(TAG, "llama.cpp系统提示词预热失败", it)
+                false
+            }
+        }
+
+    /**
+     * Makes sure the state of the system prompt prefix the last conversation with this model
+     * used is saved, so the first request after app start restores it instead of prefilling it.
+     * Chats keep their own providers and sessions, so this only checks the saved file; when it
+     * is gone (evicted, or the model file changed) the prefix is evaluated in a session that is
+     * released right after. Does nothing when this model has not been used yet.
+     */
+    override suspend fun prewarm(): Boolean =
+        withContext(Dispatchers.IO) {
+            kotlin.runCatching {
+                val recordFile = lastSystemPrefixFile()
+                if (!LlamaSession.isAvailable() || !recordFile.isFile ||
+                    !getModelFile(context, modelName).exists()
+                ) {
+                    return@runCatching false
+                }
+                val record = recordFile.readText()
+                val statePath = record.substringBefore('\n')
+                val prefix = record.substringAfter('\n', "")
+                if (prefix.isBlank()) return@runCatching false
+                if (statePath.isNotEmpty() && File(statePath).isFile) return@runCatching true
+
+                val s = createSession() ?: return@runCatching false
+                try {
+                    s.prewarmPromptState(prefix).also { saved ->
+                        if (saved) recordSystemPrefix(s, prefix)
+                    }
+                } finally {
+                    s.release()
+                }
+            }.getOrElse {
+                AppLogger.w(TAG, "llama.cpp启动预热失败", it)
+                false
+            }
+        }
+
+    /**
+     * Saves the state of [prefix] unless this session already did, and records it for the next
+     * app start. The native session runs prewarms and generations one at a time, so a prewarm
+     * from app start and a request's generation wait for each other instead of sharing the KV cache.
+     */
+    private fun prewarmSystemPrefix(s: LlamaSession, prefix: String): Boolean {
+        synchronized(sessionLock) {
+            if (prefix == prewarmedSystemPrefix) return true
+            prewarmedSystemPrefix = prefix
+        }
+        val saved = s.prewarmPromptState(prefix)
+        if (saved) {
+            recordSystemPrefix(s, prefix)
+        }
+        return saved
+    }
+
+    private fun recordSystemPrefix(s: LlamaSession, prefix: String) {
+        kotlin.runCatching {
+            val statePath = s.getPromptStateFile(prefix)?.absolutePath ?: return
+            val record = statePath + "\n" + prefix
+            val recordFile = lastSystemPrefixFile()
+            if (!recordFile.isFile || recordFile.readText() != record) {
+                recordFile.parentFile?.mkdirs()
+                recordFile.writeText(record)
+            }
+        }.onFailure {
+            AppLogger.w(TAG, "记录llama.cpp系统提示词失败", it)
+        }
+    }
+
+    private fun lastSystemPrefixFile(): File =
+        File(File(context.filesDir, PROMPT_STATE_CACHE_DIR), modelName + LAST_SYSTEM_PREFIX_SUFFIX)
+
+    /**
+     * The templated leading system message, if the template renders it as a text prefix of the
+     * full prompt (templates that fold the system prompt into the first user turn do not).
+     */
+    private fun buildSystemPromptPrefix(
+        s: LlamaSession,
+        roles: List<String>,
+        contents: List<String>,
+        prompt: String
+    ): String? {
+        if (roles.firstOrNull() != "system" || contents.firstOrNull().isNullOrBlank()) return null
+        val prefix = s.applyChatTemplate(listOf("system"), listOf(contents[0]), false)
+        if (prefix.isNullOrBlank() || !prompt.startsWith(prefix)) return null
+        return prefix
     }
 
     private fun shouldUseToolCall(availableTools: List<ToolPrompt>?): Boolean {
@@ -929,15 +1084,27 @@ Use only these tool names: $toolNames
     private fun ensureSessionLocked(): LlamaSession? {
         synchronized(sessionLock) {
             session?.let { return it }
-            val modelFile = getModelFile(context, modelName)
-            val created = LlamaSession.create(
-                pathModel = modelFile.absolutePath,
-                nThreads = threadCount,
-                nCtx = contextSize
-            )
+            val created = createSession()
             session = created
             return created
         }
     }
 
+    private fun createSession(): LlamaSession? {
+        val modelFile = getModelFile(context, modelName)
+        val created = LlamaSession.create(
+            pathModel = modelFile.absolutePath,
+            nThreads = threadCount,
+            nCtx = contextSize
+        )
+        created?.let { s ->
+            kotlin.runCatching {
+                if (!s.setPromptStateCache(File(context.filesDir, PROMPT_STATE_CACHE_DIR))) {
+                    AppLogger.w(TAG, "llama.cpp提示词状态缓存不可用")
+                }
+            }
+        }
+        return created
+    }
+
 }
@@ -22,6 +22,7 @@ import com.ai.assistance.operit.BuildConfig
 import com.ai.assistance.operit.R
 import com.ai.assistance.operit.core.chat.AIMessageManager
 import com.ai.assistance.operit.api.chat.AIForegroundService
+import com.ai.assistance.operit.api.chat.EnhancedAIService
 import com.ai.assistance.operit.plugins.PluginRegistry
 import com.ai.assistance.operit.plugins.lifecycle.AppLifecycleEvent
 import com.ai.assistance.operit.plugins.lifecycle.AppLifecycleHookParams
@@ -34,6 +35,8 @@ import com.ai.assistance.operit.core.workflow.WorkflowSchedulerInitializer
 import com.ai.assistance.operit.data.backup.RoomDatabaseBackupPreferences
 import com.ai.assistance.operit.data.backup.RoomDatabaseBackupScheduler
 import com.ai.assistance.operit.data.db.AppDatabase
+import com.ai.assistance.operit.data.model.ApiProviderType
+import com.ai.assistance.operit.data.model.FunctionType
 import com.ai.assistance.operit.data.preferences.CharacterCardManager
 import com.ai.assistance.operit.data.preferences.ExternalHttpApiPreferences
 import com.ai.assistance.operit.data.preferences.UserPreferencesManager
@@ -313,6 +316,23 @@ class OperitApplication : Application(), ImageLoaderFactory, WorkConfiguration.P
             val toolHandler = AIToolHandler.getInstance(this@OperitApplication)
             toolHandler.registerDefaultTools()
             AppLogger.d(TAG, "【启动计时】AIToolHandler初始化并注册工具完成（异步/串行） - ${System.currentTimeMillis() - toolStartTime}ms")
+
+            // 对话使用本地llama.cpp模型时，提前加载模型并预热上次的系统提示词状态
+            val chatPrewarmStartTime = System.currentTimeMillis()
+            runCatching {
+                val chatConfig = EnhancedAIService.getModelConfigForFunction(this@OperitApplication, FunctionType.CHAT)
+                if (chatConfig.apiProviderType == ApiProviderType.LLAMA_CPP) {
+                    EnhancedAIService.getAIServiceForFunction(this@OperitApplication, FunctionType.CHAT).prewarm()
+                } else {
+                    false
+                }
+            }.onSuccess { prewarmed ->
+                if (prewarmed) {
+                    AppLogger.d(TAG, "【启动计时】本地模型预热完成（异步/串行） - ${System.currentTimeMillis() - chatPrewarmStartTime}ms")
+                }
+            }.onFailure { e ->
+                AppLogger.w(TAG, "本地模型预热失败", e)
+            }
         }
         
         // 初始化工作流调度器（异步）
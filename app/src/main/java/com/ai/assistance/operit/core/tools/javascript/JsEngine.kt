@@ -16,6 +16,8 @@ import com.ai.assistance.operit.util.AppLogger
 import com.ai.assistance.operit.util.ImagePoolManager
 import com.ai.assistance.operit.util.LocaleUtils
 import com.ai.assistance.operit.util.OperitPaths
+import java.io.File
+import java.security.MessageDigest
 import java.util.UUID
 import java.util.concurrent.CompletableFuture
 import java.util.concurrent.ConcurrentHashMap
@@ -32,13 +34,20 @@ import org.json.JSONTokener
 
 /**
  * JavaScript 引擎 - 通过 QuickJS 执行 JavaScript 脚本并提供与 Android 原生代码的交互机制
+ *
+ * @param runtimeCount QuickJS runtimes behind this engine. Each script execution leases a free
+ * one, so up to this many run in parallel; each runtime has its own JS thread.
  */
-class JsEngine(private val context: Context) {
+class JsEngine(private val context: Context, runtimeCount: Int = 1) {
     companion object {
         private const val TAG = "JsEngine"
         private const val TOOLPKG_TAG = "ToolPkg"
         private const val BINARY_DATA_THRESHOLD = 32 * 1024
         private const val BINARY_HANDLE_PREFIX = "@binary_handle:"
+        // Compose DSL actions dispatch to handlers the render left in the runtime's globals.
+        private const val COMPOSE_DSL_AFFINITY_KEY = 0L
+        // Java bridge JS object ids name the runtime holding the object: __java_js_obj_r<index>_<n>
+        private val JS_OBJECT_RUNTIME_PATTERN = Regex("^__java_js_obj_r(\\d+)_")
     }
 
     private val bitmapRegistry = ConcurrentHashMap<String, Bitmap>()
@@ -50,17 +59,25 @@ class JsEngine(private val context: Context) {
     private val packageManager by lazy { PackageManager.getInstance(context, toolHandler) }
     private val toolCallInterface = JsToolCallInterface()
 
-    @Volatile
-    private var quickJsThread: Thread? = null
+    /** Everything run on one runtime is queued on its thread, in order. */
+    private class RuntimeThread(index: Int) {
+        @Volatile
+        var jsThread: Thread? = null
 
-    private val quickJsExecutor = Executors.newSingleThreadExecutor { runnable ->
-        Thread(runnable, "OperitQuickJsEngine").apply {
-            isDaemon = true
-            quickJsThread = this
+        val executor = Executors.newSingleThreadExecutor { runnable ->
+            Thread(runnable, "OperitQuickJsEngine-$index").apply {
+                isDaemon = true
+                jsThread = this
+            }
         }
+        val dispatcher = executor.asCoroutineDispatcher()
+        val scope = CoroutineScope(SupervisorJob() + dispatcher)
     }
-    private val quickJsDispatcher = quickJsExecutor.asCoroutineDispatcher()
-    private val engineScope = CoroutineScope(SupervisorJob() + quickJsDispatcher)
+
+    private val runtimeThreads = List(runtimeCount.coerceAtLeast(1)) { RuntimeThread(it) }
+
+    /** Script keys whose main module factory each runtime has compiled; see [compileScriptFactory]. */
+    private val compiledScriptKeys = List(runtimeThreads.size) { ConcurrentHashMap.newKeySet<String>() }
     private val quickJsInitLock = Any()
 
     @Volatile
@@ -72,7 +89,11 @@ class JsEngine(private val context: Context) {
         val intermediateResultCallback: ((Any?) -> Unit)?,
         val envOverrides: Map<String, String>,
         val toolPkgLogSnapshot: JsToolPkgExecutionContext.LogSnapshot
-    )
+    ) {
+        /** Runtime the call was dispatched to; its cancellation goes there. */
+        @Volatile
+        var runtimeIndex: Int = 0
+    }
 
     private val activeExecutionSessions = ConcurrentHashMap<String, ExecutionSession>()
     private var jsEnvironmentInitialized = false
@@ -118,11 +139,12 @@ class JsEngine(private val context: Context) {
         return externalJavaCodeLoader.getEffectiveClassLoader(getJavaBridgeBaseClassLoader())
     }
 
-    private fun <T> runOnQuickJsThreadBlocking(block: () -> T): T {
-        return if (Thread.currentThread() === quickJsThread) {
+    private fun <T> runOnQuickJsThreadBlocking(runtimeIndex: Int = 0, block: () -> T): T {
+        val runtimeThread = runtimeThreads[runtimeIndex]
+        return if (Thread.currentThread() === runtimeThread.jsThread) {
             block()
         } else {
-            runBlocking(quickJsDispatcher) {
+            runBlocking(runtimeThread.dispatcher) {
                 block()
             }
         }
@@ -138,7 +160,10 @@ class JsEngine(private val context: Context) {
             }
             try {
                 val engine = runOnQuickJsThreadBlocking {
-                    OperitQuickJsEngine().also {
+                    QuickJsNativeRuntime.setBytecodeCacheDirectory(
+                        File(context.codeCacheDir, "quickjs-bytecode")
+                    )
+                    OperitQuickJsEngine(runtimeCount = runtimeThreads.size).also {
                         it.bindNativeInterface(toolCallInterface)
                     }
                 }
@@ -166,20 +191,27 @@ class JsEngine(private val context: Context) {
             } finally {
                 quickJs = null
                 jsEnvironmentInitialized = false
+                compiledScriptKeys.forEach { it.clear() }
             }
         }
     }
 
-    private fun <T> evaluateQuickJsBlocking(script: String, fileName: String = "<eval>"): T? {
+    private fun <T> evaluateQuickJsBlocking(
+        script: String,
+        fileName: String = "<eval>",
+        useBytecodeCache: Boolean = false,
+        runtimeIndex: Int = 0
+    ): T? {
         ensureQuickJs()
         val engine = quickJs ?: return null
-        return if (Thread.currentThread() === quickJsThread) {
+        val runtimeThread = runtimeThreads[runtimeIndex]
+        return if (Thread.currentThread() === runtimeThread.jsThread) {
             runBlocking {
-                engine.evaluate<T>(script, fileName)
+                engine.evaluate<T>(script, fileName, useBytecodeCache, runtimeIndex)
             }
         } else {
-            runBlocking(quickJsDispatcher) {
-                engine.evaluate<T>(script, fileName)
+            runBlocking(runtimeThread.dispatcher) {
+                engine.evaluate<T>(script, fileName, useBytecodeCache, runtimeIndex)
             }
         }
     }
@@ -187,12 +219,13 @@ class JsEngine(private val context: Context) {
     private fun launchQuickJsEvaluation(
         script: String,
         fileName: String = "<eval>",
+        runtimeIndex: Int = 0,
         onError: ((Exception) -> Unit)? = null
     ) {
         val engine = quickJs ?: return
-        engineScope.launch {
+        runtimeThreads[runtimeIndex].scope.launch {
             try {
-                engine.evaluate<Any?>(script, fileName)
+                engine.evaluate<Any?>(script, fileName, runtimeIndex = runtimeIndex)
             } catch (e: Exception) {
                 if (onError != null) {
                     onError(e)
@@ -203,26 +236,76 @@ class JsEngine(private val context: Context) {
         }
     }
 
-    private fun launchQuickJsFunctionCall(
+    /**
+     * Leases a runtime and calls [functionName] on its thread, waiting at most [timeoutMillis]
+     * for both. The lease ends when the call returns; whatever the script left pending (timers,
+     * promises, async host calls) goes on in that runtime, whose index [onLeased] gets first.
+     * [beforeCall] runs on the runtime's thread just before the call.
+     *
+     * @throws java.util.concurrent.TimeoutException when no runtime was free or the call did not
+     * return in time.
+     * @throws java.util.concurrent.ExecutionException when the call failed.
+     */
+    private fun callQuickJsFunctionOnLeasedRuntime(
         functionName: String,
-        argsJson: String,
-        callSite: String = "<call:$functionName>",
-        onError: ((Exception) -> Unit)? = null
+        args: List<Any?>,
+        callSite: String,
+        affinityKey: Long,
+        timeoutMillis: Long,
+        onLeased: (runtimeIndex: Int) -> Unit,
+        beforeCall: ((runtimeIndex: Int) -> Unit)? = null
     ) {
-        val engine = quickJs ?: return
-        engineScope.launch {
-            try {
-                engine.callFunction<Any?>(functionName, argsJson, callSite)
-            } catch (e: Exception) {
-                if (onError != null) {
-                    onError(e)
-                } else {
-                    AppLogger.e(TAG, "QuickJS function call failed: ${e.message}", e)
-                }
-            }
+        val engine = quickJs ?: error("QuickJS runtime is not initialized")
+        val deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeoutMillis)
+        engine.withRuntime(affinityKey, timeoutMillis) { runtimeIndex ->
+            onLeased(runtimeIndex)
+            CompletableFuture.runAsync(
+                {
+                    beforeCall?.invoke(runtimeIndex)
+                    engine.callFunctionValue(functionName, args, callSite, runtimeIndex)
+                },
+                runtimeThreads[runtimeIndex].executor
+            ).get(maxOf(0L, deadline - System.nanoTime()), TimeUnit.NANOSECONDS)
         }
     }
 
+    /**
+     * Key of [script]'s compiled main module factory: the package it belongs to and a hash of
+     * its content, so a changed package gets a new factory.
+     */
+    private fun buildScriptKey(script: String, params: Map<String, Any?>): String {
+        val packageName =
+            params["__operit_package_name"]?.toString()?.trim().orEmpty()
+                .ifBlank { params["packageName"]?.toString()?.trim().orEmpty() }
+                .ifBlank { params["__operit_plugin_id"]?.toString()?.trim().orEmpty() }
+                .ifBlank { "script" }
+        val digest =
+            MessageDigest.getInstance("SHA-256")
+                .digest(script.toByteArray(Charsets.UTF_8))
+                .joinToString(separator = "") { byte -> "%02x".format(byte) }
+        return "$packageName:$digest"
+    }
+
+    /**
+     * Compiles [script] into the factory the entry function runs for [scriptKey], once per
+     * runtime. Goes through the bytecode cache, so the source is parsed once per package version
+     * (also across app starts) rather than on every execution. Runs on the runtime's thread.
+     */
+    private fun compileScriptFactory(scriptKey: String, script: String, runtimeIndex: Int) {
+        val compiled = compiledScriptKeys[runtimeIndex]
+        if (scriptKey in compiled) {
+            return
+        }
+        val engine = quickJs ?: error("QuickJS runtime is not initialized")
+        engine.evaluate<Any?>(
+            buildToolPkgScriptFactoryScript(scriptKey, script),
+            "toolpkg/${scriptKey.substringBeforeLast(':')}.js",
+            useBytecodeCache = true,
+            runtimeIndex = runtimeIndex
+        )
+        compiled.add(scriptKey)
+    }
+
 
     private fun nextExecutionCallId(): String {
         return "operit_call_${UUID.randomUUID().toString().replace("-", "")}" 
@@ -262,12 +345,13 @@ class JsEngine(private val context: Context) {
             }
             cancelExecutionSessionInJs(
                 callId = session.callId,
-                reason = reason
+                reason = reason,
+                runtimeIndex = session.runtimeIndex
             )
         }
     }
 
-    private fun cancelExecutionSessionInJs(callId: String, reason: String) {
+    private fun cancelExecutionSessionInJs(callId: String, reason: String, runtimeIndex: Int) {
         ensureQuickJs()
         val safeCallId = JSONObject.quote(callId)
         val safeReason = JSONObject.quote(reason)
@@ -284,6 +368,7 @@ class JsEngine(private val context: Context) {
                     })();
                 """.trimIndent(),
             fileName = "quickjs/runtime/cancel-call-session.js",
+            runtimeIndex = runtimeIndex,
             onError = { e ->
                 AppLogger.e(TAG, "Error canceling JS execution session $callId: ${e.message}", e)
             }
@@ -310,13 +395,13 @@ class JsEngine(private val context: Context) {
         )
     }
 
-    private fun evaluateBootstrapModule(module: JsBootstrapModule) {
+    private fun evaluateBootstrapModule(module: JsBootstrapModule, runtimeIndex: Int) {
         if (module.source.isBlank()) {
             return
         }
         try {
-            evaluateQuickJsBlocking<Any?>(module.source, module.fileName)
-            exposeBootstrapGlobals(module)
+            evaluateQuickJsBlocking<Any?>(module.source, module.fileName, useBytecodeCache = true, runtimeIndex = runtimeIndex)
+            exposeBootstrapGlobals(module, runtimeIndex)
         } catch (e: Exception) {
             val globalsSummary = module.globals.joinToString(prefix = "[", postfix = "]")
             AppLogger.e(
@@ -350,13 +435,14 @@ class JsEngine(private val context: Context) {
         }
     }
 
-    private fun exposeBootstrapGlobals(module: JsBootstrapModule) {
+    private fun exposeBootstrapGlobals(module: JsBootstrapModule, runtimeIndex: Int) {
         if (module.globals.isEmpty()) {
             return
         }
         evaluateQuickJsBlocking<Any?>(
             buildBootstrapGlobalExposureScript(module.globals),
-            "${module.fileName}#globals"
+            "${module.fileName}#globals",
+            runtimeIndex = runtimeIndex
         )
     }
 
@@ -444,7 +530,8 @@ class JsEngine(private val context: Context) {
             val callbackResult =
                 evaluateQuickJsBlocking<String>(
                     script = callbackScript,
-                    fileName = "quickjs/runtime/java-bridge-callback.js"
+                    fileName = "quickjs/runtime/java-bridge-callback.js",
+                    runtimeIndex = runtimeIndexOfJsObject(jsObjectId)
                 )
             callbackResult ?: JSONObject()
                 .put("success", false)
@@ -492,7 +579,8 @@ class JsEngine(private val context: Context) {
                 val result =
                     evaluateQuickJsBlocking<Any?>(
                         script = releaseScript,
-                        fileName = "quickjs/runtime/java-bridge-release.js"
+                        fileName = "quickjs/runtime/java-bridge-release.js",
+                        runtimeIndex = runtimeIndexOfJsObject(normalizedId)
                     )
             ) {
                 is Boolean -> result
@@ -506,6 +594,11 @@ class JsEngine(private val context: Context) {
         }
     }
 
+    private fun runtimeIndexOfJsObject(jsObjectId: String): Int {
+        val index = JS_OBJECT_RUNTIME_PATTERN.find(jsObjectId.trim())?.groupValues?.get(1)?.toIntOrNull()
+        return if (index != null && index in runtimeThreads.indices) index else 0
+    }
+
     private fun splitBridgeResult(raw: String): Pair<String?, Any?> {
         if (raw.isBlank()) {
             return Pair("empty bridge response", null)
@@ -538,7 +631,15 @@ class JsEngine(private val context: Context) {
 
             ensureQuickJs()
             try {
-                runtimeBootstrapModules().forEach(::evaluateBootstrapModule)
+                val modules = runtimeBootstrapModules()
+                runtimeThreads.indices.forEach { runtimeIndex ->
+                    evaluateQuickJsBlocking<Any?>(
+                        "globalThis.__operitRuntimeIndex = $runtimeIndex;",
+                        "quickjs/runtime/runtime-index.js",
+                        runtimeIndex = runtimeIndex
+                    )
+                    modules.forEach { module -> evaluateBootstrapModule(module, runtimeIndex) }
+                }
                 jsEnvironmentInitialized = true
             } catch (e: Exception) {
                 AppLogger.e(TAG, "Failed to initialize JS environment: ${e.message}", e)
@@ -563,7 +664,8 @@ class JsEngine(private val context: Context) {
             params: Map<String, Any?>,
             envOverrides: Map<String, String> = emptyMap(),
             onIntermediateResult: ((Any?) -> Unit)? = null,
-            timeoutSec: Long = JsTimeoutConfig.MAIN_TIMEOUT_SECONDS.toLong()
+            timeoutSec: Long = JsTimeoutConfig.MAIN_TIMEOUT_SECONDS.toLong(),
+            affinityKey: Long = QuickJsRuntimePool.NO_AFFINITY
     ): Any? {
         val effectiveParams = params.toMutableMap()
         val explicitLanguage = effectiveParams["__operit_package_lang"]?.toString()?.trim().orEmpty()
@@ -629,45 +731,24 @@ class JsEngine(private val context: Context) {
 
         val buildExecutionScriptStartTime = if (shouldLogTiming) messageTimingNow() else 0L
         val paramsObject = JSONObject(effectiveParams)
-        val paramsJson = paramsObject.toString()
         val safeTimeoutSec = if (timeoutSec <= 0L) 1L else timeoutSec
         val preTimeoutMs = JsTimeoutConfig.PRE_TIMEOUT_SECONDS * 1000L
-        val executionArgsJson =
-            JSONArray()
-                .put(callId)
-                .put(paramsObject)
-                .put(script)
-                .put(functionName)
-                .put(safeTimeoutSec)
-                .put(preTimeoutMs)
-                .toString()
+        // the script itself is compiled once per runtime and referred to by key; params go in
+        // binary form rather than as a JSON string
+        val scriptKey = buildScriptKey(script, effectiveParams)
+        val executionArgs =
+            listOf(callId, paramsObject, scriptKey, functionName, safeTimeoutSec, preTimeoutMs)
         if (shouldLogTiming) {
             logMessageTiming(
                 stage = "toolpkg.jsEngine.buildExecutionScript",
                 startTimeMs = buildExecutionScriptStartTime,
-                details = "function=$functionName, plugin=$timingPluginId, scriptLength=${script.length}, paramsLength=${paramsJson.length}, argsLength=${executionArgsJson.length}, directInvoke=true"
+                details = "function=$functionName, plugin=$timingPluginId, scriptLength=${script.length}, paramsCount=${paramsObject.length()}, directInvoke=true"
             )
         }
 
-        launchQuickJsFunctionCall(
-            functionName = TOOLPKG_EXECUTION_ENTRY_FUNCTION,
-            argsJson = executionArgsJson,
-            callSite = "quickjs/runtime/execute-script.call",
-            onError = { e ->
-                AppLogger.e(
-                    TAG,
-                    "Failed to dispatch script execution: callId=$callId, function=$functionName, reason=${e.message}",
-                    e
-                )
-                removeExecutionSession(callId)
-                if (!session.future.isDone) {
-                    session.future.complete("Error: ${e.message ?: "dispatch failed"}")
-                }
-            }
-        )
-
         val preTimeoutTimer = java.util.Timer()
         val waitResultStartTime = if (shouldLogTiming) messageTimingNow() else 0L
+        val deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(safeTimeoutSec)
         return try {
             preTimeoutTimer.schedule(
                 object : java.util.TimerTask() {
@@ -683,7 +764,30 @@ class JsEngine(private val context: Context) {
                 JsTimeoutConfig.PRE_TIMEOUT_SECONDS * 1000
             )
 
-            val result = session.future.get(safeTimeoutSec, TimeUnit.SECONDS)
+            try {
+                callQuickJsFunctionOnLeasedRuntime(
+                    functionName = TOOLPKG_EXECUTION_ENTRY_FUNCTION,
+                    args = executionArgs,
+                    callSite = "quickjs/runtime/execute-script.call",
+                    affinityKey = affinityKey,
+                    timeoutMillis = TimeUnit.SECONDS.toMillis(safeTimeoutSec),
+                    onLeased = { runtimeIndex -> session.runtimeIndex = runtimeIndex },
+                    beforeCall = { runtimeIndex -> compileScriptFactory(scriptKey, script, runtimeIndex) }
+                )
+            } catch (e: java.util.concurrent.ExecutionException) {
+                val cause = e.cause ?: e
+                AppLogger.e(
+                    TAG,
+                    "Failed to dispatch script execution: callId=$callId, function=$functionName, reason=${cause.message}",
+                    cause
+                )
+                removeExecutionSession(callId)
+                if (!session.future.isDone) {
+                    session.future.complete("Error: ${cause.message ?: "dispatch failed"}")
+                }
+            }
+
+            val result = session.future.get(maxOf(0L, deadline - System.nanoTime()), TimeUnit.NANOSECONDS)
             removeExecutionSession(callId)
             if (shouldLogTiming) {
                 logMessageTiming(
@@ -714,7 +818,7 @@ class JsEngine(private val context: Context) {
                 e
             )
             removeExecutionSession(callId)
-            cancelExecutionSessionInJs(callId, failureReason)
+            cancelExecutionSessionInJs(callId, failureReason, session.runtimeIndex)
             if (shouldLogTiming) {
                 logMessageTiming(
                     stage = "toolpkg.jsEngine.waitResult",
@@ -764,7 +868,8 @@ class JsEngine(private val context: Context) {
                 script = buildComposeDslRuntimeWrappedScript(script),
                 functionName = "__operit_render_compose_dsl",
                 params = runtimeOptions,
-                envOverrides = envOverrides
+                envOverrides = envOverrides,
+                affinityKey = COMPOSE_DSL_AFFINITY_KEY
         )
     }
 
@@ -789,7 +894,8 @@ class JsEngine(private val context: Context) {
                 functionName = "__operit_dispatch_compose_dsl_action",
                 params = params,
                 envOverrides = envOverrides,
-                onIntermediateResult = onIntermediateResult
+                onIntermediateResult = onIntermediateResult,
+                affinityKey = COMPOSE_DSL_AFFINITY_KEY
         )
     }
 
@@ -867,23 +973,26 @@ class JsEngine(private val context: Context) {
         binaryDataRegistry.clear()
         javaObjectRegistry.clear()
         if (quickJs != null) {
-            launchQuickJsEvaluation(
-                script =
-                    """
-                        (function() {
-                            var root = typeof globalThis !== 'undefined'
-                                ? globalThis
-                                : (typeof window !== 'undefined' ? window : this);
-                            if (typeof root.__operitClearAllTimers === 'function') {
-                                root.__operitClearAllTimers();
-                            }
-                        })();
-                    """.trimIndent(),
-                fileName = "quickjs/runtime/reset-state.js",
-                onError = { e ->
-                    AppLogger.e(TAG, "Error in QuickJS cleanup: ${e.message}", e)
-                }
-            )
+            runtimeThreads.indices.forEach { runtimeIndex ->
+                launchQuickJsEvaluation(
+                    script =
+                        """
+                            (function() {
+                                var root = typeof globalThis !== 'undefined'
+                                    ? globalThis
+                                    : (typeof window !== 'undefined' ? window : this);
+                                if (typeof root.__operitClearAllTimers === 'function') {
+                                    root.__operitClearAllTimers();
+                                }
+                            })();
+                        """.trimIndent(),
+                    fileName = "quickjs/runtime/reset-state.js",
+                    runtimeIndex = runtimeIndex,
+                    onError = { e ->
+                        AppLogger.e(TAG, "Error in QuickJS cleanup: ${e.message}", e)
+                    }
+                )
+            }
         }
     }
 
@@ -1415,6 +1524,7 @@ class JsEngine(private val context: Context) {
                 toolName: String,
                 paramsJson: String
         ) {
+            val runtimeIndex = quickJs?.callingRuntimeIndex()?.coerceAtLeast(0) ?: 0
             JsNativeInterfaceDelegates.callToolAsync(
                 toolHandler = toolHandler,
                 callbackId = callbackId,
@@ -1425,13 +1535,13 @@ class JsEngine(private val context: Context) {
                 binaryHandlePrefix = BINARY_HANDLE_PREFIX,
                 binaryDataThreshold = BINARY_DATA_THRESHOLD,
                 sendToolResult = { callback, result, isError ->
-                    sendToolResult(callback, result, isError)
+                    sendToolResult(callback, result, isError, runtimeIndex)
                 }
             )
         }
 
         /** 向JavaScript发送工具调用结果 */
-        private fun sendToolResult(callbackId: String, result: String, isError: Boolean) {
+        private fun sendToolResult(callbackId: String, result: String, isError: Boolean, runtimeIndex: Int) {
             ensureQuickJs()
             try {
                 val jsCode =
@@ -1442,6 +1552,7 @@ class JsEngine(private val context: Context) {
                     )
                 launchQuickJsEvaluation(
                     script = jsCode,
+                    runtimeIndex = runtimeIndex,
                     onError = { e ->
                         AppLogger.e(TAG, "Error sending tool result to JavaScript: ${e.message}", e)
                     }
@@ -1648,10 +1759,12 @@ class JsEngine(private val context: Context) {
                 AppLogger.e(TAG, "Error closing QuickJS: ${e.message}", e)
             }
             quickJs = null
-            quickJsThread = null
             jsEnvironmentInitialized = false
-            quickJsDispatcher.close()
-            quickJsExecutor.shutdownNow()
+            runtimeThreads.forEach { runtimeThread ->
+                runtimeThread.jsThread = null
+                runtimeThread.dispatcher.close()
+                runtimeThread.executor.shutdownNow()
+            }
         } catch (e: Exception) {
             AppLogger.e(TAG, "Error during JsEngine destruction: ${e.message}", e)
         }
@@ -4,6 +4,9 @@ import org.json.JSONObject
 
 internal const val TOOLPKG_EXECUTION_ENTRY_FUNCTION = "__operitExecuteScriptFunction"
 
+/** Global holding the compiled main module factory of each script, by script key. */
+private const val TOOLPKG_SCRIPT_FACTORIES = "__operitScriptFactories"
+
 private fun buildExecutionPreludeSource(): String {
     return """
         function __operitGetActiveCallRuntime() {
@@ -318,7 +321,7 @@ internal fun buildExecutionRuntimeBridgeScript(): String {
             root.$TOOLPKG_EXECUTION_ENTRY_FUNCTION = function(
                 callId,
                 params,
-                scriptText,
+                scriptKey,
                 targetFunctionName,
                 timeoutSec,
                 preTimeoutMs
@@ -640,7 +643,7 @@ internal fun buildExecutionRuntimeBridgeScript(): String {
                 try {
                     markFunction(targetFunctionName);
                     var mainModuleIdentity = packageTarget + ':' + (screenPath || '<root>');
-                    var mainModuleKey = buildModuleInstanceKey('main', mainModuleIdentity, scriptText);
+                    var mainModuleKey = ['instance', 'main', mainModuleIdentity, text(scriptKey)].join(':');
                     var module = moduleCache[mainModuleKey];
                     var exports = module && module.exports ? module.exports : null;
                     var require = function(moduleName) {
@@ -654,7 +657,11 @@ internal fun buildExecutionRuntimeBridgeScript(): String {
                         moduleCache[mainModuleKey] = module;
                         exports = module.exports;
                         markStage('compile_main_script');
-                        var mainFactory = getFactory('main', packageTarget + ':' + screenPath, scriptText);
+                        var scriptFactories = root.$TOOLPKG_SCRIPT_FACTORIES;
+                        var mainFactory = scriptFactories ? scriptFactories[scriptKey] : undefined;
+                        if (typeof mainFactory !== 'function') {
+                            throw new Error('Script "' + text(scriptKey) + '" has not been compiled in this runtime');
+                        }
                         markStage('execute_main_script');
                         var previousActiveModule = root.__operitActiveModule;
                         var previousActiveExports = root.__operitActiveModuleExports;
@@ -740,3 +747,21 @@ internal fun buildExecutionRuntimeBridgeScript(): String {
         })();
     """.trimIndent()
 }
+
+/**
+ * Script that compiles [source] into the main module factory of [scriptKey] for
+ * [TOOLPKG_EXECUTION_ENTRY_FUNCTION]. The factory is a global-scope function with the same
+ * parameters and prelude the entry function used to build with `new Function`, so evaluating
+ * this through the bytecode cache parses each package version once instead of per call.
+ */
+internal fun buildToolPkgScriptFactoryScript(scriptKey: String, source: String): String {
+    val factories = "globalThis.$TOOLPKG_SCRIPT_FACTORIES"
+    return buildString(source.length + 4096) {
+        append(factories).append(" = ").append(factories).append(" || Object.create(null);\n")
+        append(factories).append('[').append(JSONObject.quote(scriptKey)).append("] = ")
+        append("function(module, exports, require, __operit_call_runtime) {\n")
+        append(buildExecutionPreludeSource()).append('\n')
+        append(source)
+        append("\n};\n")
+    }
+}
@@ -56,7 +56,9 @@ internal fun buildJavaClassBridgeDefinition(): String {
 
             function registerJsObject(value) {
                 __javaBridgeJsObjectCounter += 1;
-                var id = '__java_js_obj_' + __javaBridgeJsObjectCounter;
+                // the runtime index routes Java callbacks back to the runtime holding the object
+                var runtimeIndex = Number(globalThis.__operitRuntimeIndex) || 0;
+                var id = '__java_js_obj_r' + runtimeIndex + '_' + __javaBridgeJsObjectCounter;
                 __javaBridgeJsObjectStore[id] = value;
                 return id;
             }
@@ -6,10 +6,8 @@ import com.ai.assistance.operit.core.tools.packTool.PackageManager
 import com.ai.assistance.operit.data.model.AITool
 import com.ai.assistance.operit.data.model.ToolResult
 import com.ai.assistance.operit.util.AppLogger
-import kotlinx.coroutines.channels.Channel
 import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.channelFlow
-import kotlinx.coroutines.runBlocking
 import kotlinx.coroutines.withTimeout
 
 class JsToolManager private constructor(
@@ -19,7 +17,7 @@ class JsToolManager private constructor(
 
     companion object {
         private const val TAG = "JsToolManager"
-        private const val MAX_CONCURRENT_ENGINES = 4
+        private const val MAX_CONCURRENT_RUNTIMES = 4
 
         @Volatile
         private var instance: JsToolManager? = null
@@ -35,25 +33,10 @@ class JsToolManager private constructor(
         }
     }
 
-    private val engines = List(MAX_CONCURRENT_ENGINES) { JsEngine(context) }
-    private val enginePool = Channel<JsEngine>(capacity = MAX_CONCURRENT_ENGINES).also { pool ->
-        engines.forEach(pool::trySend)
-    }
-
-    private suspend fun <T> withEngine(block: suspend (JsEngine) -> T): T {
-        val engine = enginePool.receive()
-        return try {
-            block(engine)
-        } finally {
-            enginePool.trySend(engine)
-        }
-    }
+    // Scripts lease one of the engine's runtimes, so up to MAX_CONCURRENT_RUNTIMES run in parallel.
+    private val engine = JsEngine(context, runtimeCount = MAX_CONCURRENT_RUNTIMES)
 
-    private fun <T> withEngineBlocking(block: (JsEngine) -> T): T {
-        return runBlocking {
-            withEngine { engine -> block(engine) }
-        }
-    }
+    private inline fun <T> withEngine(block: (JsEngine) -> T): T = block(engine)
 
     private fun parseDotCall(toolName: String): Pair<String, String>? {
         val separatorIndex = toolName.lastIndexOf('.')
@@ -177,7 +160,7 @@ class JsToolManager private constructor(
         val script = packageManager.getPackageScript(packageName)
             ?: return "Package not found: $packageName"
 
-        return withEngineBlocking { engine ->
+        return withEngine { engine ->
             try {
                 val runtimeParams = buildRuntimeParams(
                     packageName = packageName,
@@ -279,7 +262,7 @@ class JsToolManager private constructor(
             }
         }
 
-        return withEngineBlocking { engine ->
+        return withEngine { engine ->
             try {
                 engine.executeComposeDslScript(
                     script = script,
@@ -294,7 +277,6 @@ class JsToolManager private constructor(
     }
 
     fun destroy() {
-        enginePool.close()
-        engines.forEach(JsEngine::destroy)
+        engine.destroy()
     }
 }
@@ -0,0 +1,47 @@
+package com.ai.assistance.operit.util.streamnative
+
+/**
+ * Streaming recognizer for top-level JSON objects/arrays embedded in model output.
+ *
+ * [Session.push] returns flat (type, start, end) triples with offsets into the whole stream.
+ * Text and content runs tile the stream; event segments are interleaved by position, and
+ * [SEG_BREAK] follows every structure once its closing bracket is seen.
+ */
+object NativeJsonSplitter {
+
+    init {
+        System.loadLibrary("streamnative")
+    }
+
+    /** Chars outside any JSON structure. */
+    const val SEG_TEXT = 0
+    /** JSON chars kept by the recognizer (all of them, or only string/scalar content when pure). */
+    const val SEG_CONTENT = 1
+    /** Zero-length marker at a key's opening quote. */
+    const val SEG_KEY_START = 2
+    /** Key span including its quotes. */
+    const val SEG_KEY_END = 3
+    /** Zero-length marker at the first char of a value. */
+    const val SEG_VALUE_START = 4
+    /** Value span; for containers, from the opening to the closing bracket. */
+    const val SEG_VALUE_END = 5
+    const val SEG_BREAK = -1
+
+    private external fun nativeCreateSession(pureContent: Boolean): Long
+    private external fun nativeDestroySession(handle: Long)
+    private external fun nativePush(handle: Long, chunk: String): IntArray
+
+    class Session internal constructor(
+        private val handle: Long,
+    ) {
+        fun push(chunk: String): IntArray = nativePush(handle, chunk)
+
+        fun destroy() = nativeDestroySession(handle)
+    }
+
+    /**
+     * @param pureContent keep only the chars inside strings and scalars as [SEG_CONTENT],
+     * dropping brackets, separators, quotes and whitespace.
+     */
+    fun createSession(pureContent: Boolean = false): Session = Session(nativeCreateSession(pureContent))
+}
@@ -10,13 +10,63 @@ object NativeMarkdownParser {
     }
 
     private external fun nativeParseMarkdown(content: String): IntArray
+    private external fun nativeCreateIncrementalParser(): Long
+    private external fun nativeDestroyIncrementalParser(handle: Long)
+    private external fun nativeAppendIncremental(handle: Long, chunk: String): IntArray
 
     fun parseToNodes(content: String): List<MarkdownNode> {
         val data = nativeParseMarkdown(content)
         if (data.isEmpty()) return emptyList()
 
-        var idx = 0
-        val blockCount = data[idx++]
+        return decodeBlocks(data, 1, data[0], content)
+    }
+
+    /**
+     * Blocks from [firstChangedIndex] on replace the previously returned ones;
+     * earlier blocks are unchanged.
+     */
+    data class Delta(
+        val firstChangedIndex: Int,
+        val blocks: List<MarkdownNode>,
+    )
+
+    /**
+     * Parser for content that only grows (e.g. a streaming answer). Each [append] re-parses
+     * from the first block the new text can affect instead of the whole document.
+     */
+    class IncrementalParser {
+        private var handle: Long = nativeCreateIncrementalParser()
+        private val content = StringBuilder()
+        private val nodes = ArrayList<MarkdownNode>()
+
+        /** Current blocks of the whole document. */
+        val blocks: List<MarkdownNode>
+            get() = nodes
+
+        fun append(chunk: String): Delta {
+            if (handle == 0L || chunk.isEmpty()) return Delta(nodes.size, emptyList())
+
+            content.append(chunk)
+            val data = nativeAppendIncremental(handle, chunk)
+            if (data.size < 2) return Delta(nodes.size, emptyList())
+
+            val firstChanged = data[0].coerceIn(0, nodes.size)
+            val changed = decodeBlocks(data, 2, data[1], content)
+            nodes.subList(firstChanged, nodes.size).clear()
+            nodes.addAll(changed)
+            return Delta(firstChanged, changed)
+        }
+
+        fun destroy() {
+            if (handle != 0L) {
+                nativeDestroyIncrementalParser(handle)
+                handle = 0L
+            }
+        }
+    }
+
+    private fun decodeBlocks(data: IntArray, offset: Int, blockCount: Int, content: CharSequence): List<MarkdownNode> {
+        var idx = offset
         val nodes = ArrayList<MarkdownNode>(blockCount)
 
         repeat(blockCount) {
@@ -40,7 +90,7 @@ object NativeMarkdownParser {
                 val start = data[idx++]
                 val end = data[idx++]
                 if (start >= 0 && end >= start && end <= content.length) {
-                    node.content + content.substring(start, end)
+                    node.content + content.subSequence(start, end).toString()
                 }
             }
 
@@ -67,7 +117,7 @@ object NativeMarkdownParser {
                     val start = data[idx++]
                     val end = data[idx++]
                     if (start >= 0 && end >= start && end <= content.length) {
-                        val s = content.substring(start, end)
+                        val s = content.subSequence(start, end).toString()
                         child.content + s
                         node.content + s
                         hasAnyPiece = true
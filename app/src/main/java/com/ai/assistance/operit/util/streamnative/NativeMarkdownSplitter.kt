@@ -1,23 +1,183 @@
 package com.ai.assistance.operit.util.streamnative
 
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.CharBuffer
+import java.nio.IntBuffer
+
 object NativeMarkdownSplitter {
 
     init {
         System.loadLibrary("streamnative")
     }
 
-    private external fun nativeCreateBlockSession(): Long
-    private external fun nativeCreateInlineSession(): Long
+    /** Closes the current group; like the table markers below it is not a MarkdownProcessorType ordinal. */
+    const val SEG_BREAK = -1
+
+    // Zero-length table markers inside a TABLE group, so a growing table can be appended row by
+    // row instead of re-split. A cell marker sits on the '|' ending the cell (or on the '\n' of a
+    // row without a closing pipe), the row marker on the row's '\n'; cell text is the span since
+    // the previous pipe. Cells of the delimiter row carry its alignment, and that row ends with
+    // SEG_TABLE_HEADER_END instead of SEG_TABLE_ROW when it has one valid cell per header column.
+    const val SEG_TABLE_CELL = -2
+    const val SEG_TABLE_CELL_ALIGN_LEFT = -3
+    const val SEG_TABLE_CELL_ALIGN_CENTER = -4
+    const val SEG_TABLE_CELL_ALIGN_RIGHT = -5
+    const val SEG_TABLE_ROW = -6
+    const val SEG_TABLE_HEADER_END = -7
+
+    private external fun nativeCreateBlockSession(tableDriven: Boolean): Long
+    private external fun nativeCreateInlineSession(tableDriven: Boolean): Long
     private external fun nativeDestroySession(handle: Long)
     private external fun nativePush(handle: Long, chunk: String): IntArray
+    private external fun nativePushUtf8(handle: Long, chunk: ByteArray, len: Int): IntArray
+    private external fun nativeSetCoalescing(handle: Long, maxChars: Int, maxDelayMillis: Int)
+    private external fun nativeFlush(handle: Long): IntArray
+    private external fun nativeFlushUtf8(handle: Long): IntArray
+    private external fun nativeSnapshot(handle: Long): ByteArray
+    private external fun nativeRestoreSession(snapshot: ByteArray): Long
+
+    private external fun nativeGetInputBuffer(handle: Long): ByteBuffer?
+    private external fun nativeGetSegmentBuffer(handle: Long): ByteBuffer?
+    private external fun nativePushDirect(handle: Long, len: Int): Long
+    private external fun nativeDrainDirect(handle: Long): Long
+    private external fun nativeFlushDirect(handle: Long): Long
+
+    private const val DIRECT_MORE_FLAG = 0x80000000L
+
+    /** Receives the (type, start, end) triples that [Session.push] would return. */
+    fun interface SegmentSink {
+        fun onSegment(type: Int, start: Int, end: Int)
+    }
+
+    /** Growable flat segment list meant to be reused across pushes. */
+    class SegmentBuffer : SegmentSink {
+        private var data = IntArray(48)
+
+        /** Number of ints, i.e. three per segment. */
+        var size: Int = 0
+            private set
+
+        operator fun get(index: Int): Int = data[index]
+
+        fun isEmpty(): Boolean = size == 0
+
+        fun clear() {
+            size = 0
+        }
+
+        override fun onSegment(type: Int, start: Int, end: Int) {
+            if (size + 3 > data.size) {
+                data = data.copyOf(data.size * 2)
+            }
+            data[size] = type
+            data[size + 1] = start
+            data[size + 2] = end
+            size += 3
+        }
+    }
 
     class Session internal constructor(
         private val handle: Long,
     ) {
+        private var inputBuffer: CharBuffer? = null
+        private var segmentBuffer: IntBuffer? = null
+
         fun push(chunk: String): IntArray = nativePush(handle, chunk)
+
+        /**
+         * Pushes the first [length] bytes of [chunk] as UTF-8, e.g. raw tokenizer output; a char
+         * split between chunks is completed by the next push. Returns five ints per segment:
+         * (type, start, end, byteStart, byteEnd), with start/end in UTF-16 units of the decoded
+         * stream and byteStart/byteEnd in bytes pushed so far. Do not mix with [push] on one session.
+         */
+        fun pushUtf8(chunk: ByteArray, length: Int = chunk.size): IntArray = nativePushUtf8(handle, chunk, length)
+
+        /**
+         * Same segments as [push], but the chunk is written into session-owned native memory and
+         * segments are read back from a native ring, so no Java arrays are allocated per push.
+         * Not thread-safe; pushes on one session must be serialized.
+         */
+        fun pushDirect(chunk: CharSequence, sink: SegmentSink) {
+            val input = inputBuffer ?: nativeGetInputBuffer(handle)!!
+                .order(ByteOrder.nativeOrder())
+                .asCharBuffer()
+                .also { inputBuffer = it }
+            val segments = segmentBuffer ?: nativeGetSegmentBuffer(handle)!!
+                .order(ByteOrder.nativeOrder())
+                .asIntBuffer()
+                .also { segmentBuffer = it }
+
+            var offset = 0
+            while (offset < chunk.length) {
+                val len = minOf(input.capacity(), chunk.length - offset)
+                input.clear()
+                input.append(chunk, offset, offset + len)
+                offset += len
+
+                readPublished(nativePushDirect(handle, len), segments, sink)
+            }
+        }
+
+        /**
+         * Coalescing mode, off by default. Pushes then return nothing (an empty array, or no
+         * [SegmentSink] calls) until [maxChars] chars (bytes for [pushUtf8]) were pushed since the
+         * last delta, [maxDelayMillis] passed since its first push, or a group closed (SEG_BREAK);
+         * then they return the whole delta, with runs continued across pushes merged into one
+         * segment. This keeps fast generation from invalidating the UI on every token.
+         *
+         * A zero budget is not checked; both zero turns coalescing off. Budgets are checked on push
+         * only, so call [flush] (or [flushUtf8]/[flushDirect]) at the end of the message or when
+         * the stream stalls.
+         */
+        fun setCoalescing(maxChars: Int, maxDelayMillis: Int) = nativeSetCoalescing(handle, maxChars, maxDelayMillis)
+
+        /** Returns the delta held back by coalescing, in the format of [push]. */
+        fun flush(): IntArray = nativeFlush(handle)
+
+        /** Returns the delta held back by coalescing, in the format of [pushUtf8]. */
+        fun flushUtf8(): IntArray = nativeFlushUtf8(handle)
+
+        /** Hands the delta held back by coalescing to [sink], as [pushDirect] would. */
+        fun flushDirect(sink: SegmentSink) {
+            val segments = segmentBuffer ?: return
+            readPublished(nativeFlushDirect(handle), segments, sink)
+        }
+
+        private fun readPublished(first: Long, segments: IntBuffer, sink: SegmentSink) {
+            var published = first
+            while (true) {
+                val count = (published and 0x7FFFFFFFL).toInt()
+                var at = (published ushr 32).toInt() * 3
+                repeat(count) {
+                    sink.onSegment(segments.get(at), segments.get(at + 1), segments.get(at + 2))
+                    at += 3
+                }
+                if ((published and DIRECT_MORE_FLAG) == 0L) break
+                published = nativeDrainDirect(handle)
+            }
+        }
+
+        /**
+         * Compact checkpoint of everything pushed so far. [restoreSession] turns it into a session
+         * that continues exactly where this one is, so a re-bound view can resume from the last
+         * checkpoint instead of re-pushing the whole message.
+         */
+        fun snapshot(): ByteArray = nativeSnapshot(handle)
+
         fun destroy() = nativeDestroySession(handle)
     }
 
-    fun createBlockSession(): Session = Session(nativeCreateBlockSession())
-    fun createInlineSession(): Session = Session(nativeCreateInlineSession())
+    /** Returns null when [snapshot] is malformed or from an incompatible version. */
+    fun restoreSession(snapshot: ByteArray): Session? {
+        val handle = nativeRestoreSession(snapshot)
+        return if (handle != 0L) Session(handle) else null
+    }
+
+    /**
+     * @param tableDriven evaluate block/inline starts with the native start DFA instead of
+     * feeding every plugin per char. Segments are identical either way.
+     */
+    fun createBlockSession(tableDriven: Boolean = false): Session = Session(nativeCreateBlockSession(tableDriven))
+    fun createInlineSession(tableDriven: Boolean = false): Session = Session(nativeCreateInlineSession(tableDriven))
 }
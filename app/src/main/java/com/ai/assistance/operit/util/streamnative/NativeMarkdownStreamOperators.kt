@@ -48,6 +48,7 @@ private fun Stream<Char>.nativeMarkdownSplitBySession(
 
                     val mutex = Mutex()
                     val flushMutex = Mutex()
+                    val segments = NativeMarkdownSplitter.SegmentBuffer()
 
                     var defaultTextChannel: Channel<Char>? = null
                     var activePluginChannel: Channel<Char>? = null
@@ -91,7 +92,8 @@ private fun Stream<Char>.nativeMarkdownSplitBySession(
                                 }
                             } ?: return
 
-                            val segments = session.push(delta)
+                            segments.clear()
+                            session.pushDirect(delta, segments)
                             if (segments.isEmpty()) return
 
                             data class Action(val type: MarkdownProcessorType?, val text: String?)
@@ -105,10 +107,14 @@ private fun Stream<Char>.nativeMarkdownSplitBySession(
                                     val end = segments[i + 2]
                                     i += 3
 
-                                    if (typeOrdinal < 0) {
+                                    if (typeOrdinal == NativeMarkdownSplitter.SEG_BREAK) {
                                         actions.add(Action(type = null, text = null))
                                         continue
                                     }
+                                    if (typeOrdinal < 0) {
+                                        // zero-width table cell/row markers: structure inside the current TABLE group
+                                        continue
+                                    }
 
                                     val type = typeOrdinal.toMarkdownTypeOrNull() ?: MarkdownProcessorType.PLAIN_TEXT
                                     if (start < 0 || end < 0 || start > end || end > fullContent.length) {
@@ -239,6 +245,7 @@ private fun Stream<String>.nativeMarkdownSplitBySessionString(
 
                     val mutex = Mutex()
                     val flushMutex = Mutex()
+                    val segments = NativeMarkdownSplitter.SegmentBuffer()
 
                     var defaultTextChannel: Channel<Char>? = null
                     var activePluginChannel: Channel<Char>? = null
@@ -282,7 +289,8 @@ private fun Stream<String>.nativeMarkdownSplitBySessionString(
                                 }
                             } ?: return
 
-                            val segments = session.push(delta)
+                            segments.clear()
+                            session.pushDirect(delta, segments)
                             if (segments.isEmpty()) return
 
                             data class Action(val type: MarkdownProcessorType?, val text: String?)
@@ -296,10 +304,14 @@ private fun Stream<String>.nativeMarkdownSplitBySessionString(
                                     val end = segments[i + 2]
                                     i += 3
 
-                                    if (typeOrdinal < 0) {
+                                    if (typeOrdinal == NativeMarkdownSplitter.SEG_BREAK) {
                                         actions.add(Action(type = null, text = null))
                                         continue
                                     }
+                                    if (typeOrdinal < 0) {
+                                        // zero-width table cell/row markers: structure inside the current TABLE group
+                                        continue
+                                    }
 
                                     val type = typeOrdinal.toMarkdownTypeOrNull() ?: MarkdownProcessorType.PLAIN_TEXT
                                     if (start < 0 || end < 0 || start > end || end > fullContent.length) {
@@ -405,7 +417,7 @@ fun Stream<Char>.nativeMarkdownSplitByBlock(
     maxDeltaChars: Int? = null,
 ): Stream<StreamGroup<MarkdownProcessorType?>> =
     nativeMarkdownSplitBySession(
-        sessionFactory = { NativeMarkdownSplitter.createBlockSession() },
+        sessionFactory = { NativeMarkdownSplitter.createBlockSession(tableDriven = true) },
         debugTag = "NativeMarkdownBlockSplitBy",
         flushIntervalMs = flushIntervalMs,
         maxDeltaChars = maxDeltaChars,
@@ -416,7 +428,7 @@ fun Stream<Char>.nativeMarkdownSplitByInline(
     maxDeltaChars: Int? = null,
 ): Stream<StreamGroup<MarkdownProcessorType?>> =
     nativeMarkdownSplitBySession(
-        sessionFactory = { NativeMarkdownSplitter.createInlineSession() },
+        sessionFactory = { NativeMarkdownSplitter.createInlineSession(tableDriven = true) },
         debugTag = "NativeMarkdownInlineSplitBy",
         flushIntervalMs = flushIntervalMs,
         maxDeltaChars = maxDeltaChars,
@@ -428,7 +440,7 @@ fun Stream<String>.nativeMarkdownSplitByBlock(
     maxDeltaChars: Int? = null,
 ): Stream<StreamGroup<MarkdownProcessorType?>> =
     nativeMarkdownSplitBySessionString(
-        sessionFactory = { NativeMarkdownSplitter.createBlockSession() },
+        sessionFactory = { NativeMarkdownSplitter.createBlockSession(tableDriven = true) },
         debugTag = "NativeMarkdownBlockSplitBy",
         flushIntervalMs = flushIntervalMs,
         maxDeltaChars = maxDeltaChars,
@@ -440,7 +452,7 @@ fun Stream<String>.nativeMarkdownSplitByInline(
     maxDeltaChars: Int? = null,
 ): Stream<StreamGroup<MarkdownProcessorType?>> =
     nativeMarkdownSplitBySessionString(
-        sessionFactory = { NativeMarkdownSplitter.createInlineSession() },
+        sessionFactory = { NativeMarkdownSplitter.createInlineSession(tableDriven = true) },
         debugTag = "NativeMarkdownInlineSplitBy",
         flushIntervalMs = flushIntervalMs,
         maxDeltaChars = maxDeltaChars,
@@ -6,12 +6,25 @@ object NativeXmlSplitter {
         System.loadLibrary("streamnative")
     }
 
-    private external fun nativeSplitXmlSegments(content: String): IntArray
-
-    fun splitXmlTag(content: String): List<List<String>> {
+    private external fun nativeSplitXmlSegments(content: String, threads: Int): IntArray
+    private external fun nativeSplitXmlSegmentsUtf8(content: ByteArray, threads: Int): IntArray
+
+    /**
+     * Splits UTF-8 [content] without decoding it to a String first. Returns five ints per
+     * segment: (type, start, end, byteStart, byteEnd), type 1 for XML groups and 0 for text,
+     * start/end in UTF-16 units and byteStart/byteEnd in bytes of [content].
+     */
+    fun splitXmlSegmentsUtf8(content: ByteArray, threads: Int = 0): IntArray =
+        nativeSplitXmlSegmentsUtf8(content, threads)
+
+    /**
+     * @param threads worker threads for large inputs; 0 picks one per core, 1 forces a
+     * sequential scan. The result does not depend on it.
+     */
+    fun splitXmlTag(content: String, threads: Int = 0): List<List<String>> {
         val results = mutableListOf<List<String>>()
 
-        val segments = nativeSplitXmlSegments(content)
+        val segments = nativeSplitXmlSegments(content, threads)
         if (segments.isEmpty()) return results
 
         var i = 0
@@ -0,0 +1,180 @@
+// Host benchmark for the per-token text cost of the llama streaming loop: the previous form
+// (llama_detokenize over every generated token so far, then a prefix compare against the last
+// text to find the delta) against llamajni::IncrementalDetokenizer, which only appends the new
+// token's piece. The vocabulary is synthetic: ASCII words plus CJK characters and emoji whose
+// UTF-8 bytes are split over byte-fallback tokens, as small vocabularies do. Prints the cost
+// per token for each block of 512 tokens, which grows with position for the old form only.
+//   build-llama/llama_detokenize_bench [tokens]
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../llama_incremental_detokenizer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kBlock = 512;
+
+struct Vocab {
+    std::vector<std::string> pieces;
+};
+
+Vocab buildVocab() {
+    Vocab vocab;
+    const char * words[] = {
+        " the", " model", " token", " stream", " of", " and", " a", " to", " in", " is",
+        "ing", "ed", ",", ".", "\n", " JSON", " {", "}", " \"", "\":",
+    };
+    for (const char * word : words) {
+        vocab.pieces.emplace_back(word);
+    }
+    // Whole characters and byte-fallback tokens for the same characters.
+    const char * wide[] = {"中", "文", "模", "型", "流", "式", "输", "出", "😀", "🚀"};
+    for (const char * ch : wide) {
+        vocab.pieces.emplace_back(ch);
+    }
+    for (int byte = 0x80; byte <= 0xFF; byte++) {
+        vocab.pieces.emplace_back(1, static_cast<char>(byte));
+    }
+    return vocab;
+}
+
+// Token ids whose pieces concatenate to valid UTF-8, with wide characters sometimes spelled
+// as their single bytes.
+std::vector<int32_t> buildTokens(const Vocab & vocab, size_t count) {
+    const int32_t nWords = 20;
+    const int32_t nWide = 10;
+    const int32_t byteBase = nWords + nWide;
+    uint32_t state = 12345;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    };
+
+    std::vector<int32_t> tokens;
+    tokens.reserve(count + 4);
+    while (tokens.size() < count) {
+        const uint32_t r = next() % 10;
+        if (r < 6) {
+            tokens.push_back(static_cast<int32_t>(next() % nWords));
+        } else {
+            const int32_t wide = nWords + static_cast<int32_t>(next() % nWide);
+            if (r < 8) {
+                tokens.push_back(wide);
+            } else {
+                for (char c : vocab.pieces[static_cast<size_t>(wide)]) {
+                    tokens.push_back(byteBase + (static_cast<unsigned char>(c) - 0x80));
+                }
+            }
+        }
+    }
+    tokens.resize(count);
+    return tokens;
+}
+
+// What llama_detokenize does for a token run: one piece copy per token.
+size_t detokenizeAll(const Vocab & vocab, const std::vector<int32_t> & tokens, size_t n, std::vector<char> & buf) {
+    size_t length = 0;
+    for (size_t i = 0; i < n; i++) {
+        const std::string & piece = vocab.pieces[static_cast<size_t>(tokens[i])];
+        if (buf.size() < length + piece.size()) {
+            buf.resize((length + piece.size()) * 2);
+        }
+        std::copy(piece.begin(), piece.end(), buf.begin() + static_cast<std::ptrdiff_t>(length));
+        length += piece.size();
+    }
+    return length;
+}
+
+struct Run {
+    std::vector<double> nsPerToken;
+    std::string text;
+    bool deltasComplete = true;
+};
+
+Run runPrevious(const Vocab & vocab, const std::vector<int32_t> & tokens) {
+    Run run;
+    std::vector<char> buf;
+    std::string prevDecoded;
+    for (size_t block = 0; block < tokens.size(); block += kBlock) {
+        const auto start = Clock::now();
+        const size_t end = std::min(tokens.size(), block + kBlock);
+        for (size_t i = block; i < end; i++) {
+            const size_t n = detokenizeAll(vocab, tokens, i + 1, buf);
+            std::string decodedNow(buf.data(), n);
+            std::string delta;
+            if (!prevDecoded.empty() && decodedNow.rfind(prevDecoded, 0) == 0) {
+                delta = decodedNow.substr(prevDecoded.size());
+            } else {
+                delta = decodedNow;
+            }
+            prevDecoded = decodedNow;
+            run.text += delta;
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        run.nsPerToken.push_back(elapsed / static_cast<double>(end - block));
+    }
+    return run;
+}
+
+Run runIncremental(const Vocab & vocab, const std::vector<int32_t> & tokens) {
+    Run run;
+    llamajni::IncrementalDetokenizer detokenizer;
+    std::string delta;
+    for (size_t block = 0; block < tokens.size(); block += kBlock) {
+        const auto start = Clock::now();
+        const size_t end = std::min(tokens.size(), block + kBlock);
+        for (size_t i = block; i < end; i++) {
+            const std::string & piece = vocab.pieces[static_cast<size_t>(tokens[i])];
+            detokenizer.push(piece.data(), piece.size(), delta);
+            if (llamajni::completeUtf8Length(delta.data(), delta.size()) != delta.size()) {
+                run.deltasComplete = false;
+            }
+            run.text += delta;
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        run.nsPerToken.push_back(elapsed / static_cast<double>(end - block));
+    }
+    detokenizer.flush(delta);
+    run.text += delta;
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+    const size_t count = argc > 1 ? static_cast<size_t>(strtoul(argv[1], nullptr, 10)) : 4096;
+    const Vocab vocab = buildVocab();
+    const std::vector<int32_t> tokens = buildTokens(vocab, count);
+
+    // Warm-up.
+    (void) runIncremental(vocab, tokens);
+
+    const Run previous = runPrevious(vocab, tokens);
+    const Run incremental = runIncremental(vocab, tokens);
+    if (previous.text != incremental.text) {
+        fprintf(stderr, "text mismatch: %zu vs %zu bytes\n", previous.text.size(), incremental.text.size());
+        return 1;
+    }
+    if (!incremental.deltasComplete) {
+        fprintf(stderr, "incremental delta ended inside a UTF-8 sequence\n");
+        return 1;
+    }
+
+    printf("%zu tokens, %zu bytes of text\n", count, incremental.text.size());
+    printf("%-14s %18s %18s\n", "tokens", "previous ns/tok", "incremental ns/tok");
+    for (size_t i = 0; i < incremental.nsPerToken.size(); i++) {
+        const size_t from = i * kBlock;
+        const size_t to = std::min(count, from + kBlock);
+        printf("%5zu-%-8zu %18.1f %18.1f\n", from, to, previous.nsPerToken[i], incremental.nsPerToken[i]);
+    }
+    return 0;
+}
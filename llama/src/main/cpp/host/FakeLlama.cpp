@@ -0,0 +1,431 @@
+#include "FakeLlama.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+uint64_t samplerState = 0;
+std::atomic<int64_t> restores {0};
+
+// Stands in for every sampler stage; the chain owns nothing, so freeing a stage is a no-op.
+llama_sampler * sharedStage();
+
+// A misuse of the API is a bug in the code under test.
+void check(bool ok, const char * what) {
+    if (!ok) {
+        std::fprintf(stderr, "fake llama: %s\n", what);
+        std::abort();
+    }
+}
+
+std::string pieceOf(llama_token token) {
+    if (token < fakellama::kByteBase || token >= fakellama::kVocabSize) {
+        return "";
+    }
+    return std::string(1, static_cast<char>(token - fakellama::kByteBase));
+}
+
+llama_token byteToken(unsigned char byte) {
+    return static_cast<llama_token>(byte) + fakellama::kByteBase;
+}
+
+// The model: a hash of cells[0, length) picks the next token.
+llama_token nextToken(const llama_context * ctx, size_t length) {
+    const std::vector<llama_token> & cells = ctx->memory.cells;
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint64_t>(cells[i]);
+        hash *= 1099511628211ull;
+    }
+    const llama_model * model = ctx->model;
+    if (model->draftOutOfVocab) {
+        return fakellama::kVocabSize + 100;
+    }
+    if (model->draftNoise == 0 && samplerState != 0) {
+        samplerState = samplerState * 6364136223846793005ull + 1442695040888963407ull;
+        hash ^= (samplerState >> 33) % 2;
+    }
+    if (model->draftNoise > 0 && (hash >> 7) % static_cast<uint64_t>(model->draftNoise) == 0) {
+        return byteToken('q');
+    }
+    // 0xC3 is always followed by 0xA9: "é" split over two byte tokens
+    if (length > 0 && cells[length - 1] == byteToken(0xC3)) {
+        return byteToken(0xA9);
+    }
+    static const char alphabet[] = "abcdefghij klmnop\xC3";
+    return byteToken(static_cast<unsigned char>(alphabet[hash % (sizeof(alphabet) - 1)]));
+}
+
+} // namespace
+
+namespace fakellama {
+
+void setSamplerSeed(uint64_t seed) {
+    samplerState = seed;
+}
+
+int64_t stateRestores() {
+    return restores.load();
+}
+
+} // namespace fakellama
+
+struct llama_vocab {};
+
+struct llama_sampler {
+    bool chain = false;
+};
+
+namespace {
+
+llama_sampler * sharedStage() {
+    static llama_sampler stage;
+    return &stage;
+}
+
+const llama_vocab * theVocab() {
+    static llama_vocab instance;
+    return &instance;
+}
+
+} // namespace
+
+extern "C" {
+
+void llama_backend_init(void) {}
+
+llama_model_params llama_model_default_params(void) {
+    return {};
+}
+
+llama_context_params llama_context_default_params(void) {
+    return {};
+}
+
+llama_sampler_chain_params llama_sampler_chain_default_params(void) {
+    return {};
+}
+
+llama_model * llama_model_load_from_file(const char * path_model, llama_model_params) {
+    auto * model = new llama_model();
+    if (const char * draft = std::strstr(path_model, "draft")) {
+        const char * colon = std::strchr(draft, ':');
+        model->draftNoise = colon != nullptr ? std::atoi(colon + 1) : 3;
+        model->draftOutOfVocab = std::strstr(draft, "bad") != nullptr;
+    }
+    return model;
+}
+
+void llama_model_free(llama_model * model) {
+    delete model;
+}
+
+llama_context * llama_init_from_model(llama_model * model, llama_context_params params) {
+    auto * ctx = new llama_context();
+    ctx->model = model;
+    ctx->params = params;
+    return ctx;
+}
+
+void llama_free(llama_context * ctx) {
+    delete ctx;
+}
+
+int32_t llama_model_n_ctx_train(const llama_model *) {
+    return 4096;
+}
+
+bool llama_model_has_encoder(const llama_model *) {
+    return false;
+}
+
+bool llama_model_is_recurrent(const llama_model * model) {
+    return model->recurrent;
+}
+
+llama_token llama_model_decoder_start_token(const llama_model *) {
+    return -1;
+}
+
+const char * llama_model_chat_template(const llama_model *, const char *) {
+    return nullptr;
+}
+
+const llama_vocab * llama_model_get_vocab(const llama_model *) {
+    return theVocab();
+}
+
+uint32_t llama_n_ctx(const llama_context * ctx) {
+    return ctx->params.n_ctx;
+}
+
+uint32_t llama_n_batch(const llama_context * ctx) {
+    return ctx->params.n_batch;
+}
+
+void llama_set_n_threads(llama_context * ctx, int32_t n_threads, int32_t n_threads_batch) {
+    ctx->params.n_threads = n_threads;
+    ctx->params.n_threads_batch = n_threads_batch;
+}
+
+int32_t llama_n_threads(llama_context * ctx) {
+    return ctx->params.n_threads;
+}
+
+int32_t llama_n_threads_batch(llama_context * ctx) {
+    return ctx->params.n_threads_batch;
+}
+
+llama_memory_t llama_get_memory(const llama_context * ctx) {
+    return const_cast<llama_memory_i *>(&ctx->memory);
+}
+
+void llama_memory_clear(llama_memory_t mem, bool) {
+    mem->cells.clear();
+}
+
+bool llama_memory_seq_rm(llama_memory_t mem, llama_seq_id, llama_pos p0, llama_pos p1) {
+    check(p1 == -1, "seq_rm is only used to drop a tail");
+    if (!mem->allowPartialRemove && p0 > 0) {
+        return false;
+    }
+    const size_t keep = p0 < 0 ? 0 : static_cast<size_t>(p0);
+    if (keep < mem->cells.size()) {
+        mem->cells.resize(keep);
+    }
+    return true;
+}
+
+int32_t llama_tokenize(
+    const llama_vocab *, const char * text, int32_t text_len, llama_token * tokens,
+    int32_t n_tokens_max, bool add_special, bool) {
+    const int32_t needed = text_len + (add_special ? 1 : 0);
+    if (needed > n_tokens_max) {
+        return -needed;
+    }
+    int32_t n = 0;
+    if (add_special) {
+        tokens[n++] = fakellama::kBos;
+    }
+    for (int32_t i = 0; i < text_len; i++) {
+        tokens[n++] = byteToken(static_cast<unsigned char>(text[i]));
+    }
+    return n;
+}
+
+int32_t llama_token_to_piece(const llama_vocab *, llama_token token, char * buf, int32_t length, int32_t, bool) {
+    const std::string piece = pieceOf(token);
+    if (static_cast<int32_t>(piece.size()) > length) {
+        return -static_cast<int32_t>(piece.size());
+    }
+    std::memcpy(buf, piece.data(), piece.size());
+    return static_cast<int32_t>(piece.size());
+}
+
+int32_t llama_detokenize(
+    const llama_vocab *, const llama_token * tokens, int32_t n_tokens, char * text,
+    int32_t text_len_max, bool, bool) {
+    std::string out;
+    for (int32_t i = 0; i < n_tokens; i++) {
+        out += pieceOf(tokens[i]);
+    }
+    if (static_cast<int32_t>(out.size()) > text_len_max) {
+        return -static_cast<int32_t>(out.size());
+    }
+    std::memcpy(text, out.data(), out.size());
+    return static_cast<int32_t>(out.size());
+}
+
+enum llama_vocab_type llama_vocab_type(const llama_vocab *) {
+    return LLAMA_VOCAB_TYPE_BPE;
+}
+
+int32_t llama_vocab_n_tokens(const llama_vocab *) {
+    return fakellama::kVocabSize;
+}
+
+const char * llama_vocab_get_text(const llama_vocab *, llama_token) {
+    return "";
+}
+
+bool llama_vocab_is_eog(const llama_vocab *, llama_token token) {
+    return token == fakellama::kEog;
+}
+
+llama_token llama_vocab_bos(const llama_vocab *) {
+    return fakellama::kBos;
+}
+
+llama_token llama_vocab_eos(const llama_vocab *) {
+    return fakellama::kEog;
+}
+
+llama_batch llama_batch_get_one(llama_token * tokens, int32_t n_tokens) {
+    llama_batch batch {};
+    batch.n_tokens = n_tokens;
+    batch.token = tokens;
+    return batch;
+}
+
+llama_batch llama_batch_init(int32_t n_tokens, int32_t, int32_t) {
+    llama_batch batch {};
+    batch.token = new llama_token[n_tokens];
+    batch.pos = new llama_pos[n_tokens];
+    batch.n_seq_id = new int32_t[n_tokens];
+    // null-terminated, as llama.cpp does, so llama_batch_free finds the end
+    batch.seq_id = new llama_seq_id *[n_tokens + 1];
+    for (int32_t i = 0; i < n_tokens; i++) {
+        batch.seq_id[i] = new llama_seq_id[1];
+    }
+    batch.seq_id[n_tokens] = nullptr;
+    batch.logits = new int8_t[n_tokens];
+    return batch;
+}
+
+void llama_batch_free(llama_batch batch) {
+    for (int32_t i = 0; batch.seq_id[i] != nullptr; i++) {
+        delete[] batch.seq_id[i];
+    }
+    delete[] batch.seq_id;
+    delete[] batch.token;
+    delete[] batch.pos;
+    delete[] batch.n_seq_id;
+    delete[] batch.logits;
+}
+
+int32_t llama_encode(llama_context *, llama_batch) {
+    return -1;
+}
+
+int32_t llama_decode(llama_context * ctx, llama_batch batch) {
+    if (ctx->failAfterDecodes == 0) {
+        return -1;
+    }
+    if (ctx->failAfterDecodes > 0) {
+        ctx->failAfterDecodes--;
+    }
+    if (ctx->params.abort_callback != nullptr && ctx->params.abort_callback(ctx->params.abort_callback_data)) {
+        return 2;
+    }
+    check(batch.n_tokens > 0 && static_cast<uint32_t>(batch.n_tokens) <= ctx->params.n_batch, "batch larger than n_batch");
+    std::vector<llama_token> & cells = ctx->memory.cells;
+    check(cells.size() + static_cast<size_t>(batch.n_tokens) <= ctx->params.n_ctx, "decode past n_ctx");
+    for (int32_t i = 0; i < batch.n_tokens; i++) {
+        if (batch.pos != nullptr) {
+            check(batch.pos[i] == static_cast<llama_pos>(cells.size()), "batch position is not the next KV cell");
+        }
+        cells.push_back(batch.token[i]);
+    }
+    ctx->outputs.clear();
+    for (int32_t i = 0; i < batch.n_tokens; i++) {
+        const bool output = batch.logits != nullptr ? batch.logits[i] != 0 : i == batch.n_tokens - 1;
+        if (output) {
+            ctx->outputs.push_back(cells.size() - static_cast<size_t>(batch.n_tokens - i) + 1);
+        }
+    }
+    ctx->decodedTokens += batch.n_tokens;
+    return 0;
+}
+
+// State layout: magic, cell count, then the cells.
+size_t llama_state_seq_get_size(llama_context * ctx, llama_seq_id) {
+    return 8 + ctx->memory.cells.size() * sizeof(llama_token);
+}
+
+size_t llama_state_seq_get_data(llama_context * ctx, uint8_t * dst, size_t size, llama_seq_id seq_id) {
+    const size_t needed = llama_state_seq_get_size(ctx, seq_id);
+    if (size < needed) {
+        return 0;
+    }
+    const uint32_t magic = 0x5EED;
+    const auto n = static_cast<uint32_t>(ctx->memory.cells.size());
+    std::memcpy(dst, &magic, 4);
+    std::memcpy(dst + 4, &n, 4);
+    std::memcpy(dst + 8, ctx->memory.cells.data(), n * sizeof(llama_token));
+    return needed;
+}
+
+size_t llama_state_seq_set_data(llama_context * ctx, const uint8_t * src, size_t size, llama_seq_id) {
+    uint32_t magic = 0;
+    uint32_t n = 0;
+    if (size < 8) {
+        return 0;
+    }
+    std::memcpy(&magic, src, 4);
+    std::memcpy(&n, src + 4, 4);
+    if (magic != 0x5EED || size != 8 + static_cast<size_t>(n) * sizeof(llama_token)) {
+        return 0;
+    }
+    check(ctx->memory.cells.empty(), "state restored over a non-empty sequence");
+    ctx->memory.cells.resize(n);
+    std::memcpy(ctx->memory.cells.data(), src + 8, n * sizeof(llama_token));
+    restores++;
+    return size;
+}
+
+llama_sampler * llama_sampler_chain_init(llama_sampler_chain_params) {
+    auto * chain = new llama_sampler();
+    chain->chain = true;
+    return chain;
+}
+
+void llama_sampler_chain_add(llama_sampler *, llama_sampler *) {}
+
+llama_sampler * llama_sampler_init_penalties(int32_t, float, float, float) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_top_k(int32_t) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_top_p(float, size_t) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_temp(float) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_dist(uint32_t) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_greedy(void) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_grammar(const llama_vocab *, const char *, const char *) {
+    return sharedStage();
+}
+
+llama_sampler * llama_sampler_init_grammar_lazy_patterns(
+    const llama_vocab *, const char *, const char *, const char **, size_t, const llama_token *, size_t) {
+    return sharedStage();
+}
+
+void llama_sampler_free(llama_sampler * smpl) {
+    if (smpl != nullptr && smpl->chain) {
+        delete smpl;
+    }
+}
+
+void llama_sampler_reset(llama_sampler *) {}
+
+void llama_sampler_accept(llama_sampler *, llama_token) {}
+
+llama_token llama_sampler_sample(llama_sampler *, llama_context * ctx, int32_t idx) {
+    check(!ctx->outputs.empty(), "sampled without outputs");
+    const size_t length = idx < 0 ? ctx->outputs.back() : ctx->outputs.at(static_cast<size_t>(idx));
+    return nextToken(ctx, length);
+}
+
+int32_t llama_chat_apply_template(const char *, const llama_chat_message *, size_t, bool, char *, int32_t) {
+    return -1;
+}
+
+} // extern "C"
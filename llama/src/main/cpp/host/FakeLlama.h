@@ -0,0 +1,56 @@
+#pragma once
+
+// Deterministic toy model behind fake_llama/llama.h, for host tests of llama_jni_stub.cpp.
+// Text tokenizes to BOS plus one token per byte (id = byte + kByteBase). The next token is
+// picked from a hash of everything in the KV cache up to the position sampled, so two runs that
+// put the same tokens in the cache generate the same text, however they got there: with or
+// without KV reuse, in one prefill batch or many, verified from a draft model or restored from a
+// saved state. The tests compare exactly that.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "llama.h"
+
+struct llama_model {
+    // 0 for the target model. A draft model ("draft:<n>" in the path) disagrees with the target
+    // on about one token in n; "draft-bad" drafts a token outside the vocabulary.
+    int draftNoise = 0;
+    bool draftOutOfVocab = false;
+    bool recurrent = false;
+};
+
+struct llama_memory_i {
+    // token at each position of sequence 0
+    std::vector<llama_token> cells;
+    // false: like recurrent memory, seq_rm can only clear the whole sequence
+    bool allowPartialRemove = true;
+};
+
+struct llama_context {
+    llama_model * model = nullptr;
+    llama_context_params params {};
+    llama_memory_i memory;
+    // for each output of the last decode, the KV length its logits were computed at
+    std::vector<size_t> outputs;
+    int64_t decodedTokens = 0;
+    // >= 0: that many more decodes succeed, then every decode fails
+    int failAfterDecodes = -1;
+};
+
+namespace fakellama {
+
+constexpr llama_token kBos = 1;
+constexpr llama_token kEog = 2;
+constexpr llama_token kByteBase = 10;
+constexpr int32_t kVocabSize = kByteBase + 256;
+
+// Nonzero: target models mix a stream seeded with this into each choice, the way a dist
+// sampler draws. Reseed before each run whose output is compared. Not thread-safe.
+void setSamplerSeed(uint64_t seed);
+
+// llama_state_seq_set_data calls that restored a state, over the whole process.
+int64_t stateRestores();
+
+} // namespace fakellama
@@ -0,0 +1,243 @@
+#include "JniShim.h"
+
+#include <android/log.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+struct _jmethodID {
+    const char* name;
+};
+
+namespace {
+
+class HostString final : public _jstring {
+public:
+    std::string utf8;
+};
+
+class HostLongArray final : public _jlongArray {
+public:
+    std::vector<jlong> elements;
+};
+
+class HostObjectArray final : public _jobjectArray {
+public:
+    std::vector<jobject> elements;
+};
+
+_jclass callbackClass;
+_jmethodID onTokenMethod {"onToken"};
+_jmethodID onPrefillProgressMethod {"onPrefillProgress"};
+_jmethodID onGenerationStatsMethod {"onGenerationStats"};
+
+thread_local std::vector<std::unique_ptr<_jobject>> localRefs;
+
+// A JVM would throw; on the host a misuse is a bug in the code under test.
+[[noreturn]] void fatal(const char* what) {
+    std::fprintf(stderr, "jnishim: %s\n", what);
+    std::abort();
+}
+
+template <typename T>
+T* track(T* object) {
+    localRefs.emplace_back(object);
+    return object;
+}
+
+template <typename T, typename Ref>
+T& checked(Ref ref, const char* what) {
+    auto* object = dynamic_cast<T*>(static_cast<_jobject*>(ref));
+    if (object == nullptr) {
+        fatal(what);
+    }
+    return *object;
+}
+
+void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+jstring _JNIEnv::NewString(const jchar* unicode, jsize len) {
+    auto* string = track(new HostString());
+    for (jsize i = 0; i < len; i++) {
+        uint32_t cp = unicode[i];
+        if (cp >= 0xD800 && cp < 0xDC00 && i + 1 < len && unicode[i + 1] >= 0xDC00 && unicode[i + 1] < 0xE000) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (unicode[i + 1] - 0xDC00);
+            i++;
+        }
+        appendUtf8(string->utf8, cp);
+    }
+    return string;
+}
+
+jstring _JNIEnv::NewStringUTF(const char* bytes) {
+    auto* string = track(new HostString());
+    string->utf8 = bytes;
+    return string;
+}
+
+const char* _JNIEnv::GetStringUTFChars(jstring str, jboolean* isCopy) {
+    if (isCopy != nullptr) {
+        *isCopy = JNI_FALSE;
+    }
+    return checked<HostString>(str, "GetStringUTFChars on a non-string").utf8.c_str();
+}
+
+void _JNIEnv::ReleaseStringUTFChars(jstring, const char*) {}
+
+jsize _JNIEnv::GetArrayLength(jarray array) {
+    auto* object = static_cast<_jobject*>(array);
+    if (auto* longs = dynamic_cast<HostLongArray*>(object)) {
+        return static_cast<jsize>(longs->elements.size());
+    }
+    return static_cast<jsize>(checked<HostObjectArray>(array, "GetArrayLength on a non-array").elements.size());
+}
+
+jobject _JNIEnv::GetObjectArrayElement(jobjectArray array, jsize index) {
+    auto& elements = checked<HostObjectArray>(array, "GetObjectArrayElement on a non-object array").elements;
+    if (index < 0 || static_cast<size_t>(index) >= elements.size()) {
+        fatal("object array index out of bounds");
+    }
+    return elements[static_cast<size_t>(index)];
+}
+
+jlongArray _JNIEnv::NewLongArray(jsize len) {
+    auto* array = track(new HostLongArray());
+    array->elements.resize(static_cast<size_t>(len));
+    return array;
+}
+
+void _JNIEnv::SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong* buf) {
+    auto& elements = checked<HostLongArray>(array, "SetLongArrayRegion on a non-long array").elements;
+    if (start < 0 || len < 0 || static_cast<size_t>(start) + static_cast<size_t>(len) > elements.size()) {
+        fatal("array region out of bounds");
+    }
+    std::memcpy(elements.data() + start, buf, static_cast<size_t>(len) * sizeof(jlong));
+}
+
+jclass _JNIEnv::GetObjectClass(jobject obj) {
+    checked<jnishim::GenerationCallback>(obj, "GetObjectClass on an object other than a callback");
+    return &callbackClass;
+}
+
+jmethodID _JNIEnv::GetMethodID(jclass, const char* name, const char*) {
+    for (_jmethodID* method : {&onTokenMethod, &onPrefillProgressMethod, &onGenerationStatsMethod}) {
+        if (std::strcmp(method->name, name) == 0) {
+            return method;
+        }
+    }
+    return nullptr;
+}
+
+jboolean _JNIEnv::CallBooleanMethod(jobject obj, jmethodID methodID, ...) {
+    auto& callback = checked<jnishim::GenerationCallback>(obj, "CallBooleanMethod on a non-callback");
+    if (methodID != &onTokenMethod) {
+        fatal("CallBooleanMethod on a method other than onToken");
+    }
+    va_list args;
+    va_start(args, methodID);
+    jstring token = va_arg(args, jstring);
+    va_end(args);
+    callback.text += checked<HostString>(token, "onToken without a string").utf8;
+    callback.tokenCalls++;
+    if (callback.onToken) {
+        callback.onToken();
+    }
+    return callback.stopAfter >= 0 && callback.tokenCalls >= callback.stopAfter ? JNI_FALSE : JNI_TRUE;
+}
+
+void _JNIEnv::CallVoidMethod(jobject obj, jmethodID methodID, ...) {
+    auto& callback = checked<jnishim::GenerationCallback>(obj, "CallVoidMethod on a non-callback");
+    va_list args;
+    va_start(args, methodID);
+    if (methodID == &onPrefillProgressMethod) {
+        const jint done = va_arg(args, jint);
+        const jint total = va_arg(args, jint);
+        va_end(args);
+        callback.prefillProgress.emplace_back(done, total);
+        if (callback.onPrefillProgress) {
+            callback.onPrefillProgress();
+        }
+        return;
+    }
+    if (methodID == &onGenerationStatsMethod) {
+        callback.generatedTokens = va_arg(args, jint);
+        callback.draftedTokens = va_arg(args, jint);
+        callback.acceptedDraftTokens = va_arg(args, jint);
+        callback.elapsedNanos = va_arg(args, jlong);
+        va_end(args);
+        callback.statsReported = true;
+        return;
+    }
+    va_end(args);
+    fatal("CallVoidMethod on an unknown method");
+}
+
+jboolean _JNIEnv::ExceptionCheck() {
+    return JNI_FALSE;
+}
+
+void _JNIEnv::ExceptionClear() {}
+
+void _JNIEnv::DeleteLocalRef(jobject ref) {
+    for (auto it = localRefs.rbegin(); it != localRefs.rend(); ++it) {
+        if (it->get() == ref) {
+            localRefs.erase(std::next(it).base());
+            return;
+        }
+    }
+}
+
+extern "C" int __android_log_print(int, const char* tag, const char* fmt, ...) {
+    if (std::getenv("LLAMA_HOST_LOG") == nullptr) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    std::fprintf(stderr, "%s: ", tag);
+    const int written = std::vfprintf(stderr, fmt, args);
+    std::fputc('\n', stderr);
+    va_end(args);
+    return written;
+}
+
+namespace jnishim {
+
+JNIEnv* env() {
+    static JNIEnv instance;
+    return &instance;
+}
+
+void releaseLocalRefs() {
+    localRefs.clear();
+}
+
+jstring newString(const std::string& utf8) {
+    return env()->NewStringUTF(utf8.c_str());
+}
+
+std::vector<jlong> longArrayElements(jlongArray array) {
+    return checked<HostLongArray>(array, "not a long array").elements;
+}
+
+} // namespace jnishim
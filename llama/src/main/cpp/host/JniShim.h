@@ -0,0 +1,42 @@
+#pragma once
+
+#include <jni.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host-side JNI environment for the llama session tests. Objects created through the env are
+// local references owned by the calling thread until releaseLocalRefs(), much like the
+// references a JVM frees when a native method returns.
+namespace jnishim {
+
+JNIEnv* env();
+
+void releaseLocalRefs();
+
+jstring newString(const std::string& utf8);
+std::vector<jlong> longArrayElements(jlongArray array);
+
+// Stands in for the LlamaNative.GenerationCallback passed to nativeGenerateStream and records
+// what it receives. Owned by the test, not a local reference.
+class GenerationCallback : public _jobject {
+public:
+    std::string text;
+    int tokenCalls = 0;
+    // onToken returns false from this call on, stopping the generation; -1 never
+    int stopAfter = -1;
+    std::function<void()> onToken;
+
+    std::vector<std::pair<jint, jint>> prefillProgress;
+    std::function<void()> onPrefillProgress;
+
+    bool statsReported = false;
+    jint generatedTokens = 0;
+    jint draftedTokens = 0;
+    jint acceptedDraftTokens = 0;
+    jlong elapsedNanos = 0;
+};
+
+} // namespace jnishim
@@ -0,0 +1,64 @@
+#include "TestHarness.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace testing {
+
+namespace {
+
+int failuresInCurrentTest = 0;
+
+} // namespace
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void recordFailure(const char* file, int line, const std::string& message) {
+    failuresInCurrentTest++;
+    std::printf("%s:%d: Failure\n  %s\n", file, line, message.c_str());
+}
+
+} // namespace testing
+
+// Usage: llama_jni_tests [--filter=<substring of Suite.Name>]
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        }
+    }
+
+    int run = 0;
+    std::vector<std::string> failed;
+    for (const auto& test : testing::registry()) {
+        const std::string fullName = std::string(test.suite) + "." + test.name;
+        if (filter != nullptr && fullName.find(filter) == std::string::npos) {
+            continue;
+        }
+        std::printf("[ RUN      ] %s\n", fullName.c_str());
+        std::fflush(stdout);
+        testing::failuresInCurrentTest = 0;
+        const auto start = std::chrono::steady_clock::now();
+        test.body();
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        run++;
+        if (testing::failuresInCurrentTest == 0) {
+            std::printf("[       OK ] %s (%lld ms)\n", fullName.c_str(), static_cast<long long>(ms));
+        } else {
+            std::printf("[  FAILED  ] %s (%lld ms)\n", fullName.c_str(), static_cast<long long>(ms));
+            failed.push_back(fullName);
+        }
+    }
+
+    std::printf("[==========] %d tests ran\n", run);
+    std::printf("[  PASSED  ] %d tests\n", run - static_cast<int>(failed.size()));
+    for (const auto& name : failed) {
+        std::printf("[  FAILED  ] %s\n", name.c_str());
+    }
+    return failed.empty() && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+// The part of llama.cpp's llama.h that llama_jni_stub.cpp uses, with the same signatures.
+// FakeLlama.cpp implements it over a deterministic toy model; FakeLlama.h defines the opaque
+// types so tests can look inside them.
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+
+typedef int32_t llama_token;
+typedef int32_t llama_pos;
+typedef int32_t llama_seq_id;
+
+struct llama_model;
+struct llama_context;
+struct llama_vocab;
+struct llama_sampler;
+struct llama_memory_i;
+typedef struct llama_memory_i * llama_memory_t;
+
+typedef bool (*ggml_abort_callback)(void * data);
+
+enum llama_vocab_type {
+    LLAMA_VOCAB_TYPE_NONE = 0,
+    LLAMA_VOCAB_TYPE_SPM = 1,
+    LLAMA_VOCAB_TYPE_BPE = 2,
+};
+
+struct llama_batch {
+    int32_t n_tokens;
+    llama_token * token;
+    float * embd;
+    llama_pos * pos;
+    int32_t * n_seq_id;
+    llama_seq_id ** seq_id;
+    int8_t * logits;
+};
+
+struct llama_model_params {
+    int32_t n_gpu_layers;
+    bool use_mmap;
+    bool use_mlock;
+};
+
+struct llama_context_params {
+    uint32_t n_ctx;
+    uint32_t n_batch;
+    uint32_t n_ubatch;
+    uint32_t n_seq_max;
+    int32_t n_threads;
+    int32_t n_threads_batch;
+    ggml_abort_callback abort_callback;
+    void * abort_callback_data;
+    bool embeddings;
+    bool no_perf;
+};
+
+struct llama_sampler_chain_params {
+    bool no_perf;
+};
+
+struct llama_chat_message {
+    const char * role;
+    const char * content;
+};
+
+void llama_backend_init(void);
+
+llama_model_params llama_model_default_params(void);
+llama_context_params llama_context_default_params(void);
+llama_sampler_chain_params llama_sampler_chain_default_params(void);
+
+llama_model * llama_model_load_from_file(const char * path_model, llama_model_params params);
+void llama_model_free(llama_model * model);
+llama_context * llama_init_from_model(llama_model * model, llama_context_params params);
+void llama_free(llama_context * ctx);
+
+int32_t llama_model_n_ctx_train(const llama_model * model);
+bool llama_model_has_encoder(const llama_model * model);
+bool llama_model_is_recurrent(const llama_model * model);
+llama_token llama_model_decoder_start_token(const llama_model * model);
+const char * llama_model_chat_template(const llama_model * model, const char * name);
+const llama_vocab * llama_model_get_vocab(const llama_model * model);
+
+uint32_t llama_n_ctx(const llama_context * ctx);
+uint32_t llama_n_batch(const llama_context * ctx);
+void llama_set_n_threads(llama_context * ctx, int32_t n_threads, int32_t n_threads_batch);
+int32_t llama_n_threads(llama_context * ctx);
+int32_t llama_n_threads_batch(llama_context * ctx);
+
+llama_memory_t llama_get_memory(const llama_context * ctx);
+void llama_memory_clear(llama_memory_t mem, bool data);
+bool llama_memory_seq_rm(llama_memory_t mem, llama_seq_id seq_id, llama_pos p0, llama_pos p1);
+
+int32_t llama_tokenize(
+    const llama_vocab * vocab, const char * text, int32_t text_len, llama_token * tokens,
+    int32_t n_tokens_max, bool add_special, bool parse_special);
+int32_t llama_token_to_piece(
+    const llama_vocab * vocab, llama_token token, char * buf, int32_t length, int32_t lstrip,
+    bool special);
+int32_t llama_detokenize(
+    const llama_vocab * vocab, const llama_token * tokens, int32_t n_tokens, char * text,
+    int32_t text_len_max, bool remove_special, bool unparse_special);
+
+enum llama_vocab_type llama_vocab_type(const llama_vocab * vocab);
+int32_t llama_vocab_n_tokens(const llama_vocab * vocab);
+const char * llama_vocab_get_text(const llama_vocab * vocab, llama_token token);
+bool llama_vocab_is_eog(const llama_vocab * vocab, llama_token token);
+llama_token llama_vocab_bos(const llama_vocab * vocab);
+llama_token llama_vocab_eos(const llama_vocab * vocab);
+
+llama_batch llama_batch_get_one(llama_token * tokens, int32_t n_tokens);
+llama_batch llama_batch_init(int32_t n_tokens, int32_t embd, int32_t n_seq_max);
+void llama_batch_free(llama_batch batch);
+
+int32_t llama_encode(llama_context * ctx, llama_batch batch);
+int32_t llama_decode(llama_context * ctx, llama_batch batch);
+
+size_t llama_state_seq_get_size(llama_context * ctx, llama_seq_id seq_id);
+size_t llama_state_seq_get_data(llama_context * ctx, uint8_t * dst, size_t size, llama_seq_id seq_id);
+size_t llama_state_seq_set_data(llama_context * ctx, const uint8_t * src, size_t size, llama_seq_id dest_seq_id);
+
+llama_sampler * llama_sampler_chain_init(llama_sampler_chain_params params);
+void llama_sampler_chain_add(llama_sampler * chain, llama_sampler * smpl);
+llama_sampler * llama_sampler_init_penalties(
+    int32_t penalty_last_n, float penalty_repeat, float penalty_freq, float penalty_present);
+llama_sampler * llama_sampler_init_top_k(int32_t k);
+llama_sampler * llama_sampler_init_top_p(float p, size_t min_keep);
+llama_sampler * llama_sampler_init_temp(float t);
+llama_sampler * llama_sampler_init_dist(uint32_t seed);
+llama_sampler * llama_sampler_init_greedy(void);
+llama_sampler * llama_sampler_init_grammar(
+    const llama_vocab * vocab, const char * grammar_str, const char * grammar_root);
+llama_sampler * llama_sampler_init_grammar_lazy_patterns(
+    const llama_vocab * vocab, const char * grammar_str, const char * grammar_root,
+    const char ** trigger_patterns, size_t num_trigger_patterns, const llama_token * trigger_tokens,
+    size_t num_trigger_tokens);
+void llama_sampler_free(llama_sampler * smpl);
+void llama_sampler_reset(llama_sampler * smpl);
+void llama_sampler_accept(llama_sampler * smpl, llama_token token);
+llama_token llama_sampler_sample(llama_sampler * smpl, llama_context * ctx, int32_t idx);
+
+int32_t llama_chat_apply_template(
+    const char * tmpl, const llama_chat_message * chat, size_t n_msg, bool add_ass, char * buf,
+    int32_t length);
+
+} // extern "C"
@@ -0,0 +1,13 @@
+#pragma once
+
+// Stand-in for the NDK's <android/log.h>; JniShim.cpp prints to stderr when LLAMA_HOST_LOG is
+// set and drops the message otherwise.
+
+enum {
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6,
+};
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...);
@@ -0,0 +1,67 @@
+#pragma once
+
+// Minimal stand-in for the NDK's <jni.h>, enough to compile llama_jni_stub.cpp on a desktop
+// host. Only the JNIEnv calls that file makes are declared; they are implemented over std
+// containers in JniShim.cpp.
+
+#include <cstdint>
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {
+public:
+    virtual ~_jobject() = default;
+};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jarray : public _jobject {};
+class _jobjectArray : public _jarray {};
+class _jlongArray : public _jarray {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jarray* jarray;
+typedef _jobjectArray* jobjectArray;
+typedef _jlongArray* jlongArray;
+
+struct _jmethodID;
+typedef _jmethodID* jmethodID;
+
+struct _JNIEnv {
+    jstring NewString(const jchar* unicode, jsize len);
+    jstring NewStringUTF(const char* bytes);
+    const char* GetStringUTFChars(jstring str, jboolean* isCopy);
+    void ReleaseStringUTFChars(jstring str, const char* chars);
+
+    jsize GetArrayLength(jarray array);
+    jobject GetObjectArrayElement(jobjectArray array, jsize index);
+
+    jlongArray NewLongArray(jsize len);
+    void SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong* buf);
+
+    jclass GetObjectClass(jobject obj);
+    jmethodID GetMethodID(jclass clazz, const char* name, const char* sig);
+    jboolean CallBooleanMethod(jobject obj, jmethodID methodID, ...);
+    void CallVoidMethod(jobject obj, jmethodID methodID, ...);
+
+    jboolean ExceptionCheck();
+    void ExceptionClear();
+    void DeleteLocalRef(jobject ref);
+};
+
+typedef _JNIEnv JNIEnv;
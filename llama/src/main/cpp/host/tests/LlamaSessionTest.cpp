@@ -0,0 +1,571 @@
+// The session tests look inside LlamaSessionNative (its KV bookkeeping, cancel flag and draft
+// model), so the JNI layer is compiled into this translation unit rather than linked.
+#include "llama_jni_stub.cpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "FakeLlama.h"
+#include "JniShim.h"
+#include "TestHarness.h"
+#include "tests/TestUtil.h"
+
+using jnishim::GenerationCallback;
+using jnishim::env;
+using jnishim::newString;
+using namespace llamajni::host;
+
+namespace {
+
+struct CacheStats {
+    jlong promptTokens;
+    jlong reused;
+    jlong decoded;
+    jlong restored;
+};
+
+// One LlamaNative session, released when it goes out of scope. Every call frees the local
+// references it created, as returning to the JVM would.
+class Session {
+public:
+    Session(const std::string& modelPath, int nCtx, int nBatch)
+        : ptr(Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(env(), nullptr, newString(modelPath), 4, nCtx, nBatch)) {
+        jnishim::releaseLocalRefs();
+    }
+
+    ~Session() {
+        Java_com_ai_assistance_llama_LlamaNative_nativeReleaseSession(env(), nullptr, ptr);
+    }
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    LlamaSessionNative* operator->() const { return reinterpret_cast<LlamaSessionNative*>(ptr); }
+
+    bool generate(const std::string& prompt, int maxTokens, GenerationCallback& callback) const {
+        const jboolean ok = Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(
+            env(), nullptr, ptr, newString(prompt), maxTokens, &callback);
+        jnishim::releaseLocalRefs();
+        return ok == JNI_TRUE;
+    }
+
+    bool prewarm(const std::string& prefix) const {
+        const jboolean ok = Java_com_ai_assistance_llama_LlamaNative_nativePrewarmPromptState(env(), nullptr, ptr, newString(prefix));
+        jnishim::releaseLocalRefs();
+        return ok == JNI_TRUE;
+    }
+
+    bool setPromptStateCache(const std::string& dir, jlong maxBytes) const {
+        const jboolean ok = Java_com_ai_assistance_llama_LlamaNative_nativeSetPromptStateCache(env(), nullptr, ptr, newString(dir), maxBytes);
+        jnishim::releaseLocalRefs();
+        return ok == JNI_TRUE;
+    }
+
+    bool setDraftModel(const std::string& path, int nDraft) const {
+        const jboolean ok = Java_com_ai_assistance_llama_LlamaNative_nativeSetDraftModel(env(), nullptr, ptr, newString(path), nDraft);
+        jnishim::releaseLocalRefs();
+        return ok == JNI_TRUE;
+    }
+
+    void clearDraftModel() const { Java_com_ai_assistance_llama_LlamaNative_nativeClearDraftModel(env(), nullptr, ptr); }
+    void clearPromptCache() const { Java_com_ai_assistance_llama_LlamaNative_nativeClearPromptCache(env(), nullptr, ptr); }
+    void cancel() const { Java_com_ai_assistance_llama_LlamaNative_nativeCancel(env(), nullptr, ptr); }
+    void beginRelease() const { Java_com_ai_assistance_llama_LlamaNative_nativeBeginRelease(env(), nullptr, ptr); }
+
+    CacheStats stats() const {
+        const std::vector<jlong> values = jnishim::longArrayElements(
+            Java_com_ai_assistance_llama_LlamaNative_nativeGetPromptCacheStats(env(), nullptr, ptr));
+        jnishim::releaseLocalRefs();
+        return {values.at(0), values.at(1), values.at(2), values.at(5)};
+    }
+
+    // The session's record of what is in the KV cache matches the cache itself.
+    bool kvMatchesCache() const { return (*this)->cachedTokens == (*this)->ctx->memory.cells; }
+
+private:
+    jlong ptr;
+};
+
+// What the fake model's byte tokens spell.
+std::string textOf(const std::vector<llama_token>& tokens, size_t from) {
+    std::string text;
+    for (size_t i = from; i < tokens.size(); i++) {
+        if (tokens[i] >= fakellama::kByteBase && tokens[i] < fakellama::kVocabSize) {
+            text += static_cast<char>(tokens[i] - fakellama::kByteBase);
+        }
+    }
+    return text;
+}
+
+// A model file and a second, different one, plus an empty prompt state directory.
+struct PromptStateFixture {
+    TempDir models;
+    TempDir cache;
+    std::string model = models.file("model.gguf");
+    std::string otherModel = models.file("other.gguf");
+
+    PromptStateFixture() {
+        writeFile(model, "model");
+        writeFile(otherModel, "other model");
+    }
+};
+
+const std::string kSystemPrompt = "<sys>You are helpful. tools:" + std::string(900, 't') + "</sys>";
+const std::string kPrompt = kSystemPrompt + "<user>hello<asst>";
+
+} // namespace
+
+TEST(LlamaSession, KvReuseMatchesFullDecode) {
+    std::mt19937 rng(7);
+    for (int trial = 0; trial < 100; trial++) {
+        const int nCtx = 256 + (trial % 3) * 256;
+        Session reusing("model", nCtx, 0);
+        Session fresh("model", nCtx, 0);
+        if (trial % 7 == 3) {
+            reusing->ctx->memory.allowPartialRemove = false;
+        }
+        std::string history = "<sys>tools..." + std::string(rng() % 50, 'x');
+        for (int turn = 0; turn < 10; turn++) {
+            history += "<user>q" + std::to_string(rng() % 1000) + "<asst>";
+            // now and then an edit to earlier history, so the prompts diverge in the middle
+            if (rng() % 5 == 0 && history.size() > 20) {
+                history[rng() % history.size()] = 'Z';
+            }
+            const int maxTokens = 1 + static_cast<int>(rng() % 40);
+            GenerationCallback a;
+            GenerationCallback b;
+            if (rng() % 4 == 0) {
+                a.stopAfter = b.stopAfter = 1 + static_cast<int>(rng() % 5);
+            }
+            fresh.clearPromptCache();
+            if (rng() % 10 == 0) {
+                reusing.clearPromptCache();
+            }
+            const bool failing = rng() % 25 == 0;
+            if (failing) {
+                reusing->ctx->failAfterDecodes = static_cast<int>(rng() % 3);
+            }
+            const bool reusedOk = reusing.generate(history, maxTokens, a);
+            const bool freshOk = fresh.generate(history, maxTokens, b);
+            reusing->ctx->failAfterDecodes = -1;
+            if (!failing) {
+                EXPECT_EQ(reusedOk, freshOk);
+                EXPECT_EQ(a.text, b.text);
+                const CacheStats stats = reusing.stats();
+                EXPECT_EQ(stats.reused + stats.decoded, stats.promptTokens);
+                EXPECT_TRUE(stats.decoded >= 1);
+            }
+            // after a failed decode the session forgets the KV rather than trusting it
+            if (!reusing->cachedTokens.empty()) {
+                EXPECT_TRUE(reusing.kvMatchesCache());
+            }
+            EXPECT_TRUE(fresh.kvMatchesCache());
+            history += a.text;
+        }
+    }
+}
+
+TEST(LlamaSession, KvReuseDecodesOnlyTheNewTurn) {
+    Session session("model", 4096, 0);
+    std::string history = "<sys>" + std::string(1500, 't');
+    jlong previousPrompt = 0;
+    for (int turn = 0; turn < 10; turn++) {
+        history += "<user>turn " + std::to_string(turn) + "<asst>";
+        GenerationCallback callback;
+        ASSERT_TRUE(session.generate(history, 16, callback));
+        const CacheStats stats = session.stats();
+        EXPECT_EQ(stats.reused + stats.decoded, stats.promptTokens);
+        EXPECT_TRUE(stats.reused >= previousPrompt);
+        previousPrompt = stats.promptTokens;
+        history += callback.text;
+    }
+}
+
+TEST(LlamaSession, StreamedTextIsCompleteUtf8) {
+    std::mt19937 rng(3);
+    int splitCharacters = 0;
+    for (int trial = 0; trial < 500; trial++) {
+        Session session("model", 512, 0);
+        const std::string prompt = "p" + std::to_string(rng());
+        const int maxTokens = 1 + static_cast<int>(rng() % 60);
+        GenerationCallback callback;
+        ASSERT_TRUE(session.generate(prompt, maxTokens, callback));
+
+        // everything decoded after the prompt (BOS + one token per byte), cut back to whole
+        // characters, must have been streamed; beyond that only the last sampled token
+        std::string decoded = textOf(session->ctx->memory.cells, prompt.size() + 1);
+        decoded.resize(llamajni::completeUtf8Length(decoded.data(), decoded.size()));
+        EXPECT_EQ(callback.text.compare(0, decoded.size(), decoded), 0);
+        EXPECT_TRUE(callback.text.size() <= decoded.size() + 3);
+        EXPECT_EQ(llamajni::completeUtf8Length(callback.text.data(), callback.text.size()), callback.text.size());
+        if (callback.text.find("\xC3\xA9") != std::string::npos) {
+            splitCharacters++;
+        }
+    }
+    // "é" arrives as two byte tokens; make sure that case was exercised
+    EXPECT_TRUE(splitCharacters > 0);
+}
+
+TEST(LlamaSession, ChunkedPrefillMatchesUnchunked) {
+    std::mt19937 rng(5);
+    for (int trial = 0; trial < 150; trial++) {
+        const int chunk = 1 + static_cast<int>(rng() % 300);
+        Session chunked("model", 2048, chunk);
+        Session whole("model", 2048, 100000);
+        ASSERT_EQ(static_cast<int>(llama_n_batch(chunked->ctx)), std::min(chunk, 2048));
+        std::string history(rng() % 1500, 'h');
+        for (int turn = 0; turn < 4; turn++) {
+            history += "<u>" + std::to_string(rng()) + "<a>";
+            GenerationCallback a;
+            GenerationCallback b;
+            const bool cancelling = rng() % 6 == 0;
+            const size_t cancelAfter = rng() % 3;
+            if (cancelling) {
+                a.onPrefillProgress = [&]() {
+                    if (a.prefillProgress.size() > cancelAfter) {
+                        chunked.cancel();
+                    }
+                };
+            }
+            const bool chunkedOk = chunked.generate(history, 20, a);
+            const bool wholeOk = whole.generate(history, 20, b);
+
+            // progress only moves forward, by at most one chunk, towards a fixed total
+            int done = 0;
+            for (const auto& progress : a.prefillProgress) {
+                EXPECT_TRUE(progress.first > done && progress.first - done <= chunk);
+                EXPECT_EQ(progress.second, a.prefillProgress.front().second);
+                done = progress.first;
+            }
+            if (cancelling && a.prefillProgress.size() > cancelAfter && done < a.prefillProgress.front().second) {
+                // cancelled mid-prefill: nothing generated and no half-filled KV kept; the next
+                // turn starts over
+                EXPECT_FALSE(chunkedOk);
+                EXPECT_TRUE(chunked->cachedTokens.empty());
+                EXPECT_TRUE(a.text.empty());
+                continue;
+            }
+            if (chunked->cancel.load()) {
+                // cancelled after the last chunk: the prompt is in the KV but nothing generated
+                EXPECT_TRUE(chunkedOk);
+                EXPECT_TRUE(a.text.empty());
+                EXPECT_TRUE(chunked.kvMatchesCache());
+                continue;
+            }
+            EXPECT_EQ(chunkedOk, wholeOk);
+            EXPECT_EQ(a.text, b.text);
+            ASSERT_FALSE(a.prefillProgress.empty());
+            EXPECT_EQ(done, a.prefillProgress.front().second);
+            EXPECT_EQ(static_cast<jlong>(done), chunked.stats().decoded);
+            EXPECT_TRUE(chunked.kvMatchesCache());
+            history += a.text;
+        }
+    }
+}
+
+TEST(LlamaSession, DraftModelNeedsSupportAndBatchRoom) {
+    {
+        Session session("model", 512, 0);
+        EXPECT_TRUE(session.setDraftModel("draft:3", 4));
+        session->model->recurrent = true;
+        EXPECT_FALSE(session.setDraftModel("draft:3", 4));
+    }
+    {
+        // a verify batch holds the drafts plus the token before them
+        Session session("model", 512, 8);
+        ASSERT_TRUE(session.setDraftModel("draft:3", 100000));
+        EXPECT_EQ(session->draft->nDraft, 7);
+        GenerationCallback callback;
+        EXPECT_TRUE(session.generate("<u>hi<a>", 60, callback));
+    }
+    {
+        Session session("model", 512, 1);
+        EXPECT_FALSE(session.setDraftModel("draft:3", 4));
+    }
+}
+
+TEST(LlamaSession, SpeculativeMatchesPlain) {
+    std::mt19937 rng(11);
+    int64_t drafted = 0;
+    int64_t accepted = 0;
+    for (int trial = 0; trial < 150; trial++) {
+        const int nCtx = 256 + static_cast<int>(rng() % 4) * 256;
+        const int chunk = 1 + static_cast<int>(rng() % 200);
+        Session plain("model", nCtx, chunk);
+        Session speculative("model", nCtx, chunk);
+        // "draft-bad" drafts token ids outside the vocabulary
+        const std::string draftPath = trial % 37 == 5 ? "draft-bad" : "draft:" + std::to_string(2 + rng() % 6);
+        EXPECT_EQ(speculative.setDraftModel(draftPath, 1 + static_cast<int>(rng() % 8)), chunk > 1);
+        const bool sampled = rng() % 2 == 0;
+        std::string history(rng() % 300, 's');
+        for (int turn = 0; turn < 5; turn++) {
+            history += "<u>" + std::to_string(rng() % 100) + "<a>";
+            const int maxTokens = 1 + static_cast<int>(rng() % 120);
+            GenerationCallback a;
+            GenerationCallback b;
+            if (rng() % 5 == 0) {
+                a.stopAfter = b.stopAfter = 1 + static_cast<int>(rng() % 10);
+            }
+            const uint64_t seed = sampled ? 1 + rng() : 0;
+            fakellama::setSamplerSeed(seed);
+            const bool plainOk = plain.generate(history, maxTokens, a);
+            fakellama::setSamplerSeed(seed);
+            const bool speculativeOk = speculative.generate(history, maxTokens, b);
+
+            EXPECT_EQ(plainOk, speculativeOk);
+            EXPECT_EQ(a.text, b.text);
+            ASSERT_TRUE(a.statsReported && b.statsReported);
+            EXPECT_EQ(a.draftedTokens, 0);
+            EXPECT_EQ(a.generatedTokens, b.generatedTokens);
+            EXPECT_TRUE(b.acceptedDraftTokens <= b.draftedTokens);
+            EXPECT_TRUE(speculative.kvMatchesCache());
+            drafted += b.draftedTokens;
+            accepted += b.acceptedDraftTokens;
+            history += a.text;
+        }
+    }
+    fakellama::setSamplerSeed(0);
+    // both accepted and rejected drafts were exercised
+    EXPECT_TRUE(accepted > 0 && accepted < drafted);
+}
+
+TEST(LlamaSession, DraftModelSwapWaitsForGeneration) {
+    Session session("model", 2048, 64);
+    std::atomic_bool stop {false};
+    std::thread swapper([&] {
+        for (int i = 0; !stop.load(); i++) {
+            if (i % 2 != 0) {
+                session.clearDraftModel();
+            } else {
+                session.setDraftModel("draft:3", 1 + i % 9);
+            }
+        }
+    });
+    for (int i = 0; i < 100; i++) {
+        GenerationCallback callback;
+        EXPECT_TRUE(session.generate("<u>" + std::to_string(i) + "<a>", 40, callback));
+        EXPECT_TRUE(session.kvMatchesCache());
+    }
+    stop.store(true);
+    swapper.join();
+}
+
+TEST(LlamaSession, PromptStateNeedsAnExistingDirectory) {
+    PromptStateFixture fixture;
+    Session session(fixture.model, 4096, 64);
+    EXPECT_FALSE(session.prewarm(kSystemPrompt));
+    EXPECT_FALSE(session.setPromptStateCache(fixture.cache.file("missing"), 0));
+    EXPECT_FALSE(session.prewarm(kSystemPrompt));
+    // an empty directory turns the cache off
+    EXPECT_TRUE(session.setPromptStateCache("", 0));
+    EXPECT_TRUE(fixture.cache.entries().empty());
+}
+
+TEST(LlamaSession, PromptStateRestoreMatchesUncached) {
+    PromptStateFixture fixture;
+    GenerationCallback reference;
+    {
+        Session uncached(fixture.model, 4096, 64);
+        ASSERT_TRUE(uncached.generate(kPrompt, 20, reference));
+    }
+
+    // prewarm saves all but the last token of the prefix (BOS + one token per byte)
+    const size_t saved = kSystemPrompt.size();
+    {
+        Session session(fixture.model, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        ASSERT_TRUE(session.prewarm(kSystemPrompt));
+        EXPECT_EQ(fixture.cache.entries().size(), 1u);
+        EXPECT_EQ(session->cachedTokens.size(), saved);
+        EXPECT_TRUE(session.kvMatchesCache());
+        // already saved: nothing decoded again
+        const int64_t decoded = session->ctx->decodedTokens;
+        EXPECT_TRUE(session.prewarm(kSystemPrompt));
+        EXPECT_EQ(session->ctx->decodedTokens, decoded);
+    }
+
+    // a new session, as after a restart, restores the prefix from disk
+    Session session(fixture.model, 4096, 64);
+    ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+    const int64_t restoresBefore = fakellama::stateRestores();
+    GenerationCallback restored;
+    ASSERT_TRUE(session.generate(kPrompt, 20, restored));
+    EXPECT_EQ(restored.text, reference.text);
+    EXPECT_EQ(fakellama::stateRestores(), restoresBefore + 1);
+    CacheStats stats = session.stats();
+    EXPECT_EQ(stats.restored, static_cast<jlong>(saved));
+    EXPECT_EQ(stats.reused, static_cast<jlong>(saved));
+    EXPECT_EQ(stats.decoded, stats.promptTokens - static_cast<jlong>(saved));
+    EXPECT_TRUE(session.kvMatchesCache());
+
+    // prewarming the saved prefix mid-conversation leaves the longer KV alone
+    const std::vector<llama_token> kv = session->ctx->memory.cells;
+    EXPECT_TRUE(session.prewarm(kSystemPrompt));
+    EXPECT_EQ(session->ctx->memory.cells, kv);
+
+    // the next turn reuses the KV in memory, not the file
+    GenerationCallback next;
+    ASSERT_TRUE(session.generate(kPrompt + restored.text + "<user>more<asst>", 20, next));
+    stats = session.stats();
+    EXPECT_EQ(stats.restored, 0);
+    EXPECT_TRUE(stats.reused > static_cast<jlong>(saved));
+}
+
+TEST(LlamaSession, ForeignOrCorruptPromptStateIsIgnored) {
+    PromptStateFixture fixture;
+    GenerationCallback reference;
+    {
+        Session session(fixture.model, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        ASSERT_TRUE(session.prewarm(kSystemPrompt));
+        ASSERT_TRUE(session.generate(kPrompt, 20, reference));
+    }
+    const std::vector<std::string> files = fixture.cache.entries();
+    ASSERT_EQ(files.size(), 1u);
+    const std::string path = fixture.cache.file(files[0]);
+
+    // another model file does not pick up the state
+    {
+        Session session(fixture.otherModel, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        GenerationCallback callback;
+        ASSERT_TRUE(session.generate(kPrompt, 20, callback));
+        EXPECT_EQ(session.stats().restored, 0);
+        EXPECT_EQ(session.stats().reused, 0);
+    }
+
+    // a state llama.cpp rejects (say, a different KV layout) leaves the KV consistent
+    {
+        const size_t saved = kSystemPrompt.size();
+        FILE* file = std::fopen(path.c_str(), "r+b");
+        ASSERT_TRUE(file != nullptr);
+        const uint32_t badMagic = 0xBAD;
+        std::fseek(file, static_cast<long>(32 + saved * sizeof(llama_token)), SEEK_SET);
+        std::fwrite(&badMagic, sizeof(badMagic), 1, file);
+        std::fclose(file);
+
+        Session session(fixture.model, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        GenerationCallback callback;
+        ASSERT_TRUE(session.generate(kPrompt, 20, callback));
+        EXPECT_EQ(callback.text, reference.text);
+        EXPECT_EQ(session.stats().restored, 0);
+        EXPECT_TRUE(session.kvMatchesCache());
+    }
+
+    // a truncated file is not restored
+    {
+        ASSERT_EQ(truncate(path.c_str(), 40), 0);
+        Session session(fixture.model, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        GenerationCallback callback;
+        ASSERT_TRUE(session.generate(kPrompt, 20, callback));
+        EXPECT_EQ(callback.text, reference.text);
+        EXPECT_EQ(session.stats().restored, 0);
+    }
+}
+
+TEST(LlamaSession, PrewarmAndGenerateTakeTurns) {
+    PromptStateFixture fixture;
+    GenerationCallback reference;
+    {
+        Session uncached(fixture.model, 4096, 64);
+        ASSERT_TRUE(uncached.generate(kPrompt, 10, reference));
+    }
+    Session session(fixture.model, 4096, 64);
+    ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+    std::atomic_bool stop {false};
+    std::thread warmer([&] {
+        for (int i = 0; !stop.load(); i++) {
+            std::string prefix = kSystemPrompt;
+            prefix[10] = static_cast<char>('a' + i % 5);
+            session.prewarm(prefix);
+        }
+    });
+    for (int i = 0; i < 50; i++) {
+        GenerationCallback callback;
+        EXPECT_TRUE(session.generate(kPrompt, 10, callback));
+        EXPECT_EQ(callback.text, reference.text);
+    }
+    stop.store(true);
+    warmer.join();
+    EXPECT_TRUE(session.kvMatchesCache());
+}
+
+TEST(LlamaSession, BeginReleaseKeepsRunsCancelled) {
+    PromptStateFixture fixture;
+    {
+        // release starting mid-generation stops it; a held-back partial character may follow
+        Session session(fixture.model, 4096, 64);
+        GenerationCallback callback;
+        callback.onToken = [&]() {
+            if (callback.tokenCalls == 3) {
+                session.beginRelease();
+            }
+        };
+        session.generate(kPrompt, 100, callback);
+        EXPECT_TRUE(callback.tokenCalls >= 3 && callback.tokenCalls <= 4);
+        EXPECT_TRUE(session->cancel.load());
+    }
+    {
+        // once release has begun a queued run neither starts nor clears the cancel
+        Session session(fixture.model, 4096, 64);
+        ASSERT_TRUE(session.setPromptStateCache(fixture.cache.path(), 0));
+        session.beginRelease();
+        GenerationCallback callback;
+        EXPECT_FALSE(session.generate(kPrompt, 10, callback));
+        EXPECT_FALSE(session.prewarm(kSystemPrompt));
+        EXPECT_TRUE(callback.text.empty());
+        EXPECT_TRUE(session->cancel.load());
+        EXPECT_TRUE(fixture.cache.entries().empty());
+    }
+}
+
+TEST(LlamaSession, RandomizedPromptStateMatchesUncached) {
+    PromptStateFixture fixture;
+    std::mt19937 rng(25);
+    for (int trial = 0; trial < 100; trial++) {
+        const int nCtx = 512 + (trial % 3) * 512;
+        Session cached(fixture.model, nCtx, 64);
+        Session uncached(fixture.model, nCtx, 64);
+        ASSERT_TRUE(cached.setPromptStateCache(fixture.cache.path(), trial % 4 == 0 ? 20000 : 0));
+        if (trial % 9 == 4) {
+            cached->ctx->memory.allowPartialRemove = false;
+        }
+        const std::string systemPrompt = "<sys>" + std::to_string(rng() % 4) + std::string(50 * (rng() % 3), 's') + "</sys>";
+        if (rng() % 2 == 0) {
+            cached.prewarm(systemPrompt);
+        }
+        std::string history = systemPrompt;
+        for (int turn = 0; turn < 6; turn++) {
+            history += "<user>q" + std::to_string(rng() % 100) + "<asst>";
+            if (rng() % 6 == 0) {
+                cached.prewarm(systemPrompt);
+            }
+            if (rng() % 8 == 0) {
+                cached.clearPromptCache();
+            }
+            const int maxTokens = 1 + static_cast<int>(rng() % 30);
+            GenerationCallback a;
+            GenerationCallback b;
+            uncached.clearPromptCache();
+            const bool cachedOk = cached.generate(history, maxTokens, a);
+            const bool uncachedOk = uncached.generate(history, maxTokens, b);
+            EXPECT_EQ(cachedOk, uncachedOk);
+            EXPECT_EQ(a.text, b.text);
+            const CacheStats stats = cached.stats();
+            EXPECT_EQ(stats.reused + stats.decoded, stats.promptTokens);
+            EXPECT_TRUE(stats.restored <= stats.reused);
+            if (!cached->cachedTokens.empty()) {
+                EXPECT_TRUE(cached.kvMatchesCache());
+            }
+            history += a.text;
+        }
+    }
+}
@@ -0,0 +1,256 @@
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "llama_prompt_state_cache.h"
+#include "tests/TestUtil.h"
+
+using llamajni::MappedPromptState;
+using llamajni::PromptStateCache;
+using namespace llamajni::host;
+
+namespace {
+
+constexpr uint64_t kModel = 0x1234;
+constexpr uint64_t kOtherModel = 0x5678;
+// FileHeader in llama_prompt_state_cache.cpp
+constexpr size_t kHeaderBytes = 32;
+
+std::vector<int32_t> tokenSequence(size_t count, int32_t seed) {
+    std::vector<int32_t> tokens(count);
+    for (size_t i = 0; i < count; i++) {
+        tokens[i] = seed + static_cast<int32_t>(i * 7 % 101);
+    }
+    return tokens;
+}
+
+// A stand-in llama sequence state that says which prefix it belongs to.
+std::vector<uint8_t> stateFor(size_t count) {
+    const std::string text = "state of " + std::to_string(count) + " tokens";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+bool store(const PromptStateCache& cache, const std::vector<int32_t>& tokens, size_t count) {
+    const std::vector<uint8_t> state = stateFor(count);
+    return cache.store(tokens.data(), count, state.data(), state.size());
+}
+
+size_t fileBytes(size_t count) {
+    return kHeaderBytes + count * sizeof(int32_t) + stateFor(count).size();
+}
+
+// Marks path as last used `age` seconds before now.
+void setUsedAgo(const std::string& path, int age) {
+    timeval now {};
+    gettimeofday(&now, nullptr);
+    const timeval used {now.tv_sec - age, 0};
+    const timeval times[2] = {used, used};
+    utimes(path.c_str(), times);
+}
+
+} // namespace
+
+TEST(PromptStateCache, NeedsAnExistingDirectoryAndAModel) {
+    TempDir dir;
+    PromptStateCache cache;
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_FALSE(cache.configure(dir.file("missing"), 0, kModel));
+    EXPECT_FALSE(cache.configure(dir.path(), 0, 0));
+    EXPECT_FALSE(cache.enabled());
+    const std::vector<int32_t> tokens = tokenSequence(10, 100);
+    EXPECT_FALSE(store(cache, tokens, 10));
+    EXPECT_TRUE(dir.entries().empty());
+
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    EXPECT_TRUE(store(cache, tokens, 10));
+    cache.disable();
+    EXPECT_FALSE(cache.contains(tokens.data(), 10));
+}
+
+TEST(PromptStateCache, FindsTheLongestSavedPrefix) {
+    TempDir dir;
+    PromptStateCache cache;
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    const std::vector<int32_t> tokens = tokenSequence(40, 100);
+    for (size_t count : {10, 20, 30}) {
+        ASSERT_TRUE(store(cache, tokens, count));
+    }
+    EXPECT_EQ(dir.entries().size(), 3u);
+    EXPECT_TRUE(cache.contains(tokens.data(), 20));
+    EXPECT_FALSE(cache.contains(tokens.data(), 25));
+
+    MappedPromptState state;
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 0, state), 30u);
+    ASSERT_EQ(state.tokenCount(), 30u);
+    EXPECT_EQ(std::vector<int32_t>(state.tokens(), state.tokens() + 30), std::vector<int32_t>(tokens.begin(), tokens.begin() + 30));
+    EXPECT_EQ(std::vector<uint8_t>(state.state(), state.state() + state.stateSize()), stateFor(30));
+
+    // capped by maxLength, and only prefixes longer than minLength count
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 25, 0, state), 20u);
+    EXPECT_EQ(std::vector<uint8_t>(state.state(), state.state() + state.stateSize()), stateFor(20));
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 20, state), 30u);
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 30, state), 0u);
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 9, 0, state), 0u);
+
+    // a prompt that diverges at token 15 only shares the 10 token prefix
+    std::vector<int32_t> diverging = tokens;
+    diverging[15] = -1;
+    EXPECT_EQ(cache.findLongestPrefix(diverging.data(), 40, 0, state), 10u);
+    EXPECT_EQ(std::vector<uint8_t>(state.state(), state.state() + state.stateSize()), stateFor(10));
+}
+
+TEST(PromptStateCache, StoringAgainReplacesTheFile) {
+    TempDir dir;
+    PromptStateCache cache;
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    const std::vector<int32_t> tokens = tokenSequence(10, 100);
+    const std::vector<uint8_t> first = {1, 2, 3};
+    const std::vector<uint8_t> second = {4, 5, 6, 7};
+    ASSERT_TRUE(cache.store(tokens.data(), 10, first.data(), first.size()));
+    ASSERT_TRUE(cache.store(tokens.data(), 10, second.data(), second.size()));
+    // no temporary files left behind
+    ASSERT_EQ(dir.entries().size(), 1u);
+
+    MappedPromptState state;
+    ASSERT_EQ(cache.findLongestPrefix(tokens.data(), 10, 0, state), 10u);
+    EXPECT_EQ(std::vector<uint8_t>(state.state(), state.state() + state.stateSize()), second);
+    EXPECT_EQ(dir.file(dir.entries()[0]), cache.pathFor(tokens.data(), 10));
+}
+
+TEST(PromptStateCache, CorruptFilesAreSkipped) {
+    TempDir dir;
+    PromptStateCache cache;
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    const std::vector<int32_t> tokens = tokenSequence(40, 100);
+    for (size_t count : {10, 20, 30}) {
+        ASSERT_TRUE(store(cache, tokens, count));
+    }
+
+    // the 30 token file loses its tail: the 20 token one is the best left
+    ASSERT_EQ(truncate(cache.pathFor(tokens.data(), 30).c_str(), static_cast<off_t>(fileBytes(30) - 1)), 0);
+    MappedPromptState state;
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 0, state), 20u);
+    EXPECT_FALSE(cache.contains(tokens.data(), 30));
+
+    // garbage where the 20 token file was
+    ASSERT_TRUE(writeFile(cache.pathFor(tokens.data(), 20), std::string(fileBytes(20), 'x')));
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 0, state), 10u);
+
+    // a file under the right name holding other tokens (a hash collision) does not match
+    const std::vector<int32_t> other = tokenSequence(10, 500);
+    ASSERT_TRUE(store(cache, other, 10));
+    ASSERT_EQ(std::rename(cache.pathFor(other.data(), 10).c_str(), cache.pathFor(tokens.data(), 10).c_str()), 0);
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 0, state), 0u);
+    EXPECT_FALSE(cache.contains(tokens.data(), 10));
+
+    // an empty file
+    ASSERT_TRUE(writeFile(cache.pathFor(tokens.data(), 10), ""));
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 40, 0, state), 0u);
+}
+
+TEST(PromptStateCache, OtherModelsFilesAreSkipped) {
+    TempDir dir;
+    PromptStateCache cache;
+    PromptStateCache other;
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    ASSERT_TRUE(other.configure(dir.path(), 0, kOtherModel));
+    const std::vector<int32_t> tokens = tokenSequence(20, 100);
+    ASSERT_TRUE(store(other, tokens, 20));
+
+    MappedPromptState state;
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 20, 0, state), 0u);
+    EXPECT_FALSE(cache.contains(tokens.data(), 20));
+    EXPECT_EQ(other.findLongestPrefix(tokens.data(), 20, 0, state), 20u);
+
+    // renamed into this model's name, the header still gives it away
+    ASSERT_EQ(std::rename(other.pathFor(tokens.data(), 20).c_str(), cache.pathFor(tokens.data(), 20).c_str()), 0);
+    EXPECT_EQ(cache.findLongestPrefix(tokens.data(), 20, 0, state), 0u);
+    EXPECT_FALSE(state.open(cache.pathFor(tokens.data(), 20), kModel));
+    EXPECT_TRUE(state.open(cache.pathFor(tokens.data(), 20), kOtherModel));
+}
+
+TEST(PromptStateCache, EvictionKeepsTheBudgetDroppingLeastRecentlyUsed) {
+    TempDir dir;
+    PromptStateCache cache;
+    const int64_t budget = static_cast<int64_t>(fileBytes(10) * 3 + fileBytes(10) / 2);
+    ASSERT_TRUE(cache.configure(dir.path(), budget, kModel));
+    std::vector<std::vector<int32_t>> prompts;
+    for (int32_t i = 0; i < 3; i++) {
+        prompts.push_back(tokenSequence(10, 100 * (i + 1)));
+        ASSERT_TRUE(store(cache, prompts.back(), 10));
+        // distinct use times, oldest first, whatever the file system's timestamp granularity
+        for (size_t j = 0; j < prompts.size(); j++) {
+            setUsedAgo(cache.pathFor(prompts[j].data(), 10), 100 - static_cast<int>(j) * 10);
+        }
+    }
+    EXPECT_EQ(dir.entries().size(), 3u);
+
+    // looking up the oldest makes it the most recently used, so the second goes instead
+    EXPECT_TRUE(cache.contains(prompts[0].data(), 10));
+    prompts.push_back(tokenSequence(10, 400));
+    ASSERT_TRUE(store(cache, prompts.back(), 10));
+    EXPECT_TRUE(dir.bytes() <= budget);
+    EXPECT_EQ(dir.entries().size(), 3u);
+    EXPECT_TRUE(cache.contains(prompts[0].data(), 10));
+    EXPECT_FALSE(cache.contains(prompts[1].data(), 10));
+    EXPECT_TRUE(cache.contains(prompts[2].data(), 10));
+    EXPECT_TRUE(cache.contains(prompts[3].data(), 10));
+
+    // the budget covers other models' files too
+    PromptStateCache other;
+    ASSERT_TRUE(other.configure(dir.path(), budget, kOtherModel));
+    for (size_t j = 0; j < prompts.size(); j++) {
+        setUsedAgo(cache.pathFor(prompts[j].data(), 10), 50);
+    }
+    ASSERT_TRUE(store(other, prompts[0], 10));
+    EXPECT_TRUE(dir.bytes() <= budget);
+    EXPECT_TRUE(other.contains(prompts[0].data(), 10));
+
+    // a smaller budget applies as soon as it is configured
+    ASSERT_TRUE(cache.configure(dir.path(), static_cast<int64_t>(fileBytes(10)), kModel));
+    EXPECT_EQ(dir.entries().size(), 1u);
+}
+
+TEST(PromptStateCache, StateLargerThanTheBudgetIsNotStored) {
+    TempDir dir;
+    PromptStateCache cache;
+    const std::vector<int32_t> tokens = tokenSequence(10, 100);
+    ASSERT_TRUE(cache.configure(dir.path(), static_cast<int64_t>(fileBytes(10) - 1), kModel));
+    EXPECT_FALSE(store(cache, tokens, 10));
+    EXPECT_TRUE(dir.entries().empty());
+    ASSERT_TRUE(cache.configure(dir.path(), static_cast<int64_t>(fileBytes(10)), kModel));
+    EXPECT_TRUE(store(cache, tokens, 10));
+}
+
+TEST(PromptStateCache, StaleTemporaryFilesAreRemoved) {
+    TempDir dir;
+    PromptStateCache cache;
+    ASSERT_TRUE(cache.configure(dir.path(), 0, kModel));
+    const std::string stale = dir.file("0000000000001234-10-0000000000000000.kvstate.tmp.1.0x1");
+    const std::string fresh = dir.file("0000000000001234-10-0000000000000000.kvstate.tmp.2.0x1");
+    ASSERT_TRUE(writeFile(stale, "partial"));
+    ASSERT_TRUE(writeFile(fresh, "partial"));
+    setUsedAgo(stale, 2 * 60 * 60);
+    cache.evict();
+    EXPECT_EQ(dir.entries(), std::vector<std::string>{"0000000000001234-10-0000000000000000.kvstate.tmp.2.0x1"});
+}
+
+TEST(PromptStateCache, ModelKeyFollowsTheFile) {
+    TempDir dir;
+    const std::string path = dir.file("model.gguf");
+    EXPECT_EQ(llamajni::modelFileKey(path), 0u);
+    ASSERT_TRUE(writeFile(path, "weights"));
+    const uint64_t key = llamajni::modelFileKey(path);
+    EXPECT_NE(key, 0u);
+    EXPECT_EQ(llamajni::modelFileKey(path), key);
+    // rewritten with another size
+    ASSERT_TRUE(writeFile(path, "other weights"));
+    EXPECT_NE(llamajni::modelFileKey(path), key);
+}
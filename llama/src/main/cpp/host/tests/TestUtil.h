@@ -0,0 +1,86 @@
+#pragma once
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace llamajni::host {
+
+// A fresh directory under $TMPDIR (or /tmp), removed with its files when destroyed.
+class TempDir {
+public:
+    TempDir() {
+        const char* base = std::getenv("TMPDIR");
+        std::string pattern = std::string(base != nullptr && *base != '\0' ? base : "/tmp") + "/llama_jni_test.XXXXXX";
+        if (mkdtemp(&pattern[0]) == nullptr) {
+            std::perror("mkdtemp");
+            std::abort();
+        }
+        dir = pattern;
+    }
+
+    ~TempDir() {
+        clear();
+        rmdir(dir.c_str());
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return dir; }
+    std::string file(const std::string& name) const { return dir + "/" + name; }
+
+    // Names of the files in the directory, sorted.
+    std::vector<std::string> entries() const {
+        std::vector<std::string> names;
+        if (DIR* handle = opendir(dir.c_str())) {
+            while (const dirent* entry = readdir(handle)) {
+                const std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    names.push_back(name);
+                }
+            }
+            closedir(handle);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    int64_t bytes() const {
+        int64_t total = 0;
+        for (const std::string& name : entries()) {
+            struct stat st {};
+            if (stat(file(name).c_str(), &st) == 0) {
+                total += static_cast<int64_t>(st.st_size);
+            }
+        }
+        return total;
+    }
+
+    void clear() const {
+        for (const std::string& name : entries()) {
+            unlink(file(name).c_str());
+        }
+    }
+
+private:
+    std::string dir;
+};
+
+inline bool writeFile(const std::string& path, const std::string& contents) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+} // namespace llamajni::host
@@ -0,0 +1,52 @@
+#include "llama_incremental_detokenizer.h"
+
+namespace llamajni {
+
+size_t completeUtf8Length(const char * data, size_t length) {
+    const auto * s = reinterpret_cast<const unsigned char *>(data);
+    // A sequence is at most 4 bytes, so only the last 3 can start an unfinished one.
+    const size_t lookBack = length < 3 ? length : 3;
+    for (size_t i = 1; i <= lookBack; i++) {
+        const unsigned char c = s[length - i];
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+
+        size_t expected = 1;
+        if ((c & 0xE0) == 0xC0) {
+            expected = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            expected = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            expected = 4;
+        }
+        return expected > i ? length - i : length;
+    }
+    return length;
+}
+
+void IncrementalDetokenizer::push(const char * piece, size_t length, std::string & out) {
+    out.clear();
+    if (pending.empty()) {
+        const size_t complete = completeUtf8Length(piece, length);
+        out.assign(piece, complete);
+        pending.assign(piece + complete, length - complete);
+        return;
+    }
+
+    pending.append(piece, length);
+    const size_t complete = completeUtf8Length(pending.data(), pending.size());
+    out.assign(pending, 0, complete);
+    pending.erase(0, complete);
+}
+
+void IncrementalDetokenizer::flush(std::string & out) {
+    out.swap(pending);
+    pending.clear();
+}
+
+void IncrementalDetokenizer::reset() {
+    pending.clear();
+}
+
+} // namespace llamajni
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace llamajni {
+
+// Turns the pieces of sampled tokens into text deltas for the stream callback. Each piece is
+// appended once; whatever ends in an incomplete UTF-8 sequence (a multi-byte character split
+// across token pieces) is held back until the bytes that complete it arrive, so the cost per
+// token only depends on the piece length, never on how much was generated before.
+class IncrementalDetokenizer {
+public:
+    // Appends a piece and replaces out with the text that is now complete (possibly empty).
+    void push(const char * piece, size_t length, std::string & out);
+
+    // Replaces out with the bytes still held back, e.g. when generation stops mid-character.
+    void flush(std::string & out);
+
+    void reset();
+
+    size_t pendingBytes() const { return pending.size(); }
+
+private:
+    std::string pending;
+};
+
+// Length of the longest prefix of data that does not end inside a UTF-8 sequence. Invalid
+// bytes count as complete; they are for the UTF-16 conversion to replace.
+size_t completeUtf8Length(const char * data, size_t length);
+
+} // namespace llamajni
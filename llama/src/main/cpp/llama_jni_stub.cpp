@@ -10,9 +10,13 @@
 
 #if defined(OPERIT_HAS_LLAMA_CPP) && OPERIT_HAS_LLAMA_CPP
 #include "llama.h"
+#include "llama_incremental_detokenizer.h"
+#include "llama_prompt_state_cache.h"
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <sstream>
 #endif
@@ -193,15 +197,23 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGetUnavailableReason(JNIEnv * env
 }
 
 extern "C" JNIEXPORT jlong JNICALL
-Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclass clazz, jstring pathModel, jint nThreads, jint nCtx) {
+Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclass clazz, jstring pathModel, jint nThreads, jint nCtx, jint nBatch) {
     (void) env;
     (void) clazz;
     (void) pathModel;
     (void) nThreads;
     (void) nCtx;
+    (void) nBatch;
     return 0;
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeBeginRelease(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_ai_assistance_llama_LlamaNative_nativeReleaseSession(JNIEnv * env, jclass clazz, jlong sessionPtr) {
     (void) env;
@@ -303,6 +315,66 @@ Java_com_ai_assistance_llama_LlamaNative_nativeClearToolCallGrammar(JNIEnv * env
     return JNI_FALSE;
 }
 
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeGetPromptCacheStats(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+    return nullptr;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeClearPromptCache(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeSetDraftModel(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring pathModel, jint nDraft) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+    (void) pathModel;
+    (void) nDraft;
+    return JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeClearDraftModel(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeSetPromptStateCache(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring dir, jlong maxBytes) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+    (void) dir;
+    (void) maxBytes;
+    return JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativePrewarmPromptState(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring prompt) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+    (void) prompt;
+    return JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeGetPromptStatePath(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring prompt) {
+    (void) env;
+    (void) clazz;
+    (void) sessionPtr;
+    (void) prompt;
+    return nullptr;
+}
+
 #else
 
 namespace {
@@ -323,6 +395,27 @@ struct ToolCallGrammarConfigNative {
     std::vector<std::string> triggerPatterns;
 };
 
+struct PromptCacheStatsNative {
+    int64_t lastPromptTokens = 0;
+    int64_t lastReusedTokens = 0;
+    int64_t lastDecodedTokens = 0;
+    int64_t totalReusedTokens = 0;
+    int64_t totalDecodedTokens = 0;
+    // part of lastReusedTokens loaded from the on-disk prompt state cache
+    int64_t lastRestoredTokens = 0;
+};
+
+// Optional small model sharing the target's vocabulary. It greedily drafts a few tokens that the
+// target then checks in one batched decode.
+struct DraftModelNative {
+    llama_model * model = nullptr;
+    llama_context * ctx = nullptr;
+    llama_sampler * sampler = nullptr;
+    int32_t nDraft = 4;
+    // tokens held in the draft KV cache, like LlamaSessionNative::cachedTokens
+    std::vector<llama_token> cachedTokens;
+};
+
 struct LlamaSessionNative {
     llama_model * model = nullptr;
     llama_context * ctx = nullptr;
@@ -330,6 +423,39 @@ struct LlamaSessionNative {
     SamplingParamsNative samplingParams;
     ToolCallGrammarConfigNative toolCallGrammar;
     std::atomic_bool cancel{false};
+    // Set once the session is being released: cancel stays set and no new run starts.
+    std::atomic_bool releasing{false};
+    // Held while ctx or the draft model is in use by a generation or a prompt state prewarm, and
+    // while the draft model is swapped, so these run one at a time.
+    std::mutex generationMutex;
+
+    // Tokens held in the KV cache for sequence 0 (positions 0..n-1): the last prompt plus the
+    // generated tokens decoded after it. The next prompt only decodes what differs from this.
+    std::vector<llama_token> cachedTokens;
+    std::atomic_bool clearPromptCache{false};
+    PromptCacheStatsNative promptCacheStats;
+
+    DraftModelNative * draft = nullptr;
+    // scratch for the draft's context: cachedTokens plus the token about to be verified
+    std::vector<llama_token> draftContext;
+
+    // Saved states of prompt prefixes (system prompt, tool definitions) shared by all sessions
+    // of the app, so a new session does not evaluate them again.
+    uint64_t modelKey = 0;
+    llamajni::PromptStateCache stateCache;
+};
+
+static_assert(sizeof(llama_token) == sizeof(int32_t), "prompt state files store tokens as int32");
+
+// Owns a batch from llama_batch_init.
+struct ScopedBatch {
+    llama_batch batch;
+
+    explicit ScopedBatch(int32_t nTokens) : batch(llama_batch_init(nTokens, 0, 1)) {}
+    ~ScopedBatch() { llama_batch_free(batch); }
+
+    ScopedBatch(const ScopedBatch &) = delete;
+    ScopedBatch & operator=(const ScopedBatch &) = delete;
 };
 
 static std::once_flag gBackendInitOnce;
@@ -419,6 +545,40 @@ static int32_t tokenizeText(const llama_vocab * vocab, const std::string & text,
     return std::max<int32_t>(0, n);
 }
 
+// Tokenizes a prompt the way generation does (special tokens added and parsed) and drops
+// trailing EOG tokens, which some vocabs append when add_special is set.
+static bool tokenizePrompt(const llama_vocab * vocab, const std::string & text, std::vector<llama_token> & out) {
+    int32_t capacity = static_cast<int32_t>(text.size()) + 8;
+    out.resize(std::max(16, capacity));
+    int32_t n = llama_tokenize(
+        vocab,
+        text.c_str(),
+        static_cast<int32_t>(text.size()),
+        out.data(),
+        static_cast<int32_t>(out.size()),
+        true,
+        true
+    );
+    if (n < 0) {
+        out.resize(static_cast<size_t>(-n));
+        n = llama_tokenize(
+            vocab,
+            text.c_str(),
+            static_cast<int32_t>(text.size()),
+            out.data(),
+            static_cast<int32_t>(out.size()),
+            true,
+            true
+        );
+    }
+    out.resize(static_cast<size_t>(std::max<int32_t>(0, n)));
+
+    while (!out.empty() && llama_vocab_is_eog(vocab, out.back())) {
+        out.pop_back();
+    }
+    return !out.empty();
+}
+
 static bool tokenToPiece(const llama_vocab * vocab, llama_token token, std::string & out) {
     if (vocab == nullptr) return false;
     std::vector<char> buf;
@@ -434,6 +594,143 @@ static bool tokenToPiece(const llama_vocab * vocab, llama_token token, std::stri
     return true;
 }
 
+// Piece of one generated token the way llama_detokenize renders it inside the sequence: special
+// tokens are dropped and only the first token gets its leading space stripped.
+static int32_t generatedTokenPiece(const llama_vocab * vocab, llama_token token, bool first, std::vector<char> & buf) {
+    if (buf.size() < 64) buf.resize(64);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const int32_t n = first
+            ? llama_detokenize(vocab, &token, 1, buf.data(), static_cast<int32_t>(buf.size()), true, false)
+            : llama_token_to_piece(vocab, token, buf.data(), static_cast<int32_t>(buf.size()), 0, false);
+        if (n >= 0) return n;
+        buf.resize(static_cast<size_t>(-n));
+    }
+    return 0;
+}
+
+static size_t commonPrefixLength(const std::vector<llama_token> & a, const std::vector<llama_token> & b) {
+    const size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+static void freeDraftModel(DraftModelNative * draft) {
+    if (draft == nullptr) return;
+    if (draft->sampler) llama_sampler_free(draft->sampler);
+    if (draft->ctx) llama_free(draft->ctx);
+    if (draft->model) llama_model_free(draft->model);
+    delete draft;
+}
+
+// Drafted ids are fed to the target as they are, so both vocabularies must give every id the
+// same text. The first ids are special tokens that conversions number differently.
+static bool draftVocabCompatible(const llama_model * target, const llama_model * draft) {
+    const llama_vocab * targetVocab = llama_model_get_vocab(target);
+    const llama_vocab * draftVocab = llama_model_get_vocab(draft);
+    if (llama_vocab_type(targetVocab) != llama_vocab_type(draftVocab)) return false;
+    if (llama_vocab_bos(targetVocab) != llama_vocab_bos(draftVocab)) return false;
+    if (llama_vocab_eos(targetVocab) != llama_vocab_eos(draftVocab)) return false;
+
+    const int32_t nTarget = llama_vocab_n_tokens(targetVocab);
+    const int32_t nDraft = llama_vocab_n_tokens(draftVocab);
+    if (std::abs(nTarget - nDraft) > 128) return false;
+
+    for (int32_t id = 5; id < std::min(nTarget, nDraft); id++) {
+        if (std::strcmp(llama_vocab_get_text(targetVocab, id), llama_vocab_get_text(draftVocab, id)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Brings the draft KV cache to session->draftContext (reusing the shared prefix, as prefill does
+// for the target) and greedily drafts up to maxDraft tokens after it. Returns false when the
+// draft model failed before drafting anything.
+static bool draftTokens(LlamaSessionNative * session, int32_t maxDraft, std::vector<llama_token> & out) {
+    DraftModelNative * draft = session->draft;
+    std::vector<llama_token> & context = session->draftContext;
+    out.clear();
+
+    llama_memory_t mem = llama_get_memory(draft->ctx);
+    if (mem == nullptr || context.empty()) return false;
+
+    size_t keep = std::min(commonPrefixLength(draft->cachedTokens, context), context.size() - 1);
+    if (keep > 0 && !llama_memory_seq_rm(mem, 0, static_cast<llama_pos>(keep), -1)) {
+        keep = 0;
+    }
+    if (keep == 0) {
+        llama_memory_clear(mem, true);
+    }
+    draft->cachedTokens.resize(keep);
+
+    const size_t chunkSize = std::max<size_t>(1, llama_n_batch(draft->ctx));
+    for (size_t done = keep; done < context.size();) {
+        const size_t n = std::min(chunkSize, context.size() - done);
+        if (llama_decode(draft->ctx, llama_batch_get_one(context.data() + done, static_cast<int32_t>(n))) != 0) {
+            draft->cachedTokens.clear();
+            return false;
+        }
+        const auto first = context.begin() + static_cast<std::vector<llama_token>::difference_type>(done);
+        draft->cachedTokens.insert(draft->cachedTokens.end(), first, first + static_cast<std::vector<llama_token>::difference_type>(n));
+        done += n;
+    }
+
+    const llama_vocab * vocab = llama_model_get_vocab(session->model);
+    const int32_t nVocab = llama_vocab_n_tokens(vocab);
+    for (int32_t i = 0; i < maxDraft; i++) {
+        llama_token token = llama_sampler_sample(draft->sampler, draft->ctx, -1);
+        if (token < 0 || token >= nVocab) break;
+        out.push_back(token);
+        if (llama_vocab_is_eog(vocab, token) || i + 1 == maxDraft) break;
+
+        if (llama_decode(draft->ctx, llama_batch_get_one(&token, 1)) != 0) {
+            draft->cachedTokens.clear();
+            break;
+        }
+        draft->cachedTokens.push_back(token);
+    }
+    return true;
+}
+
+// Loads the longest prefix of promptTokens saved on disk into sequence 0 when it is longer than
+// what the KV cache already shares with them. At least the last prompt token is left to decode.
+// Returns the number of restored tokens; on failure the KV cache is left empty.
+static size_t restorePromptState(LlamaSessionNative * session, const std::vector<llama_token> & promptTokens) {
+    if (!session->stateCache.enabled() || promptTokens.size() < 2) return 0;
+
+    const size_t shared = commonPrefixLength(session->cachedTokens, promptTokens);
+    llamajni::MappedPromptState saved;
+    const size_t n = session->stateCache.findLongestPrefix(promptTokens.data(), promptTokens.size() - 1, shared, saved);
+    if (n == 0) return 0;
+
+    llama_memory_t mem = llama_get_memory(session->ctx);
+    llama_memory_seq_rm(mem, 0, -1, -1);
+    session->cachedTokens.clear();
+    if (llama_state_seq_set_data(session->ctx, saved.state(), saved.stateSize(), 0) == 0) {
+        // e.g. saved by a llama.cpp build with another state layout
+        LOGE("Failed to restore prompt state of %zu tokens", n);
+        llama_memory_clear(mem, true);
+        return 0;
+    }
+    const auto count = static_cast<std::vector<llama_token>::difference_type>(n);
+    session->cachedTokens.assign(promptTokens.begin(), promptTokens.begin() + count);
+    LOGI("Restored prompt state: tokens=%zu bytes=%zu", n, saved.stateSize());
+    return n;
+}
+
+// Writes the state of sequence 0, which must hold exactly session->cachedTokens.
+static bool savePromptState(LlamaSessionNative * session) {
+    if (!session->stateCache.enabled() || session->cachedTokens.empty()) return false;
+
+    std::vector<uint8_t> state(llama_state_seq_get_size(session->ctx, 0));
+    const size_t written = llama_state_seq_get_data(session->ctx, state.data(), state.size(), 0);
+    if (written == 0) return false;
+    return session->stateCache.store(session->cachedTokens.data(), session->cachedTokens.size(), state.data(), written);
+}
+
 } // namespace
 
 extern "C" JNIEXPORT jboolean JNICALL
@@ -450,12 +747,12 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGetUnavailableReason(JNIEnv * env
 }
 
 extern "C" JNIEXPORT jlong JNICALL
-Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclass clazz, jstring pathModel, jint nThreads, jint nCtx) {
+Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclass clazz, jstring pathModel, jint nThreads, jint nCtx, jint nBatch) {
     (void) clazz;
     ensureBackendInit();
 
     const std::string modelPath = jstringToString(env, pathModel);
-    LOGI("Creating llama session. model=%s threads=%d n_ctx=%d", modelPath.c_str(), (int) nThreads, (int) nCtx);
+    LOGI("Creating llama session. model=%s threads=%d n_ctx=%d n_batch=%d", modelPath.c_str(), (int) nThreads, (int) nCtx, (int) nBatch);
 
     auto * session = new (std::nothrow) LlamaSessionNative();
     if (!session) {
@@ -480,7 +777,12 @@ Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclas
     if (cparams.n_ctx == 0) {
         cparams.n_ctx = static_cast<uint32_t>(llama_model_n_ctx_train(session->model));
     }
-    cparams.n_batch = cparams.n_ctx;
+    // n_batch is the prefill chunk size and bounds the compute buffers; the encoder of an
+    // encoder-decoder model needs the whole input in one batch.
+    const uint32_t chunk = nBatch > 0 ? static_cast<uint32_t>(nBatch) : 512u;
+    cparams.n_batch = llama_model_has_encoder(session->model)
+        ? cparams.n_ctx
+        : std::min<uint32_t>(cparams.n_ctx, chunk);
     cparams.n_ubatch = std::min<uint32_t>(cparams.n_batch, 512u);
     cparams.abort_callback = abortCallback;
     cparams.abort_callback_data = session;
@@ -507,6 +809,7 @@ Java_com_ai_assistance_llama_LlamaNative_nativeCreateSession(JNIEnv * env, jclas
     }
 
     session->cancel.store(false);
+    session->modelKey = llamajni::modelFileKey(modelPath);
 
     return reinterpret_cast<jlong>(session);
 }
@@ -519,6 +822,14 @@ Java_com_ai_assistance_llama_LlamaNative_nativeReleaseSession(JNIEnv * env, jcla
     if (sessionPtr == 0) return;
     auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
 
+    // let a generation or prewarm still running on another thread stop before freeing
+    session->releasing.store(true);
+    session->cancel.store(true);
+    { std::lock_guard<std::mutex> generationLock(session->generationMutex); }
+
+    freeDraftModel(session->draft);
+    session->draft = nullptr;
+
     if (session->sampler) {
         llama_sampler_free(session->sampler);
         session->sampler = nullptr;
@@ -537,6 +848,16 @@ Java_com_ai_assistance_llama_LlamaNative_nativeReleaseSession(JNIEnv * env, jcla
     delete session;
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeBeginRelease(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    if (sessionPtr == 0) return;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    session->releasing.store(true);
+    session->cancel.store(true);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_ai_assistance_llama_LlamaNative_nativeCancel(JNIEnv * env, jclass clazz, jlong sessionPtr) {
     (void) env;
@@ -743,15 +1064,11 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
     auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
     if (!session->model || !session->ctx || !session->sampler) return JNI_FALSE;
 
+    std::lock_guard<std::mutex> generationLock(session->generationMutex);
+    if (session->releasing.load()) return JNI_FALSE;
     session->cancel.store(false);
 
-    // reset KV + sampler for a clean generation per request
-    if (session->ctx) {
-        llama_memory_t mem = llama_get_memory(session->ctx);
-        if (mem) {
-            llama_memory_clear(mem, true);
-        }
-    }
+    // reset the sampler for a clean generation per request; the KV cache is trimmed below
     if (session->sampler) {
         llama_sampler_reset(session->sampler);
     }
@@ -764,44 +1081,20 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
     if (!cbCls) return JNI_FALSE;
     jmethodID midOnToken = env->GetMethodID(cbCls, "onToken", "(Ljava/lang/String;)Z");
     if (!midOnToken) return JNI_FALSE;
-
-    // Tokenize prompt
-    int32_t capacity = static_cast<int32_t>(promptStr.size()) + 8;
-    std::vector<llama_token> promptTokens;
-    promptTokens.resize(std::max(16, capacity));
-    int32_t nPrompt = llama_tokenize(
-        vocab,
-        promptStr.c_str(),
-        static_cast<int32_t>(promptStr.size()),
-        promptTokens.data(),
-        static_cast<int32_t>(promptTokens.size()),
-        true,
-        true
-    );
-    if (nPrompt < 0) {
-        promptTokens.resize(static_cast<size_t>(-nPrompt));
-        nPrompt = llama_tokenize(
-            vocab,
-            promptStr.c_str(),
-            static_cast<int32_t>(promptStr.size()),
-            promptTokens.data(),
-            static_cast<int32_t>(promptTokens.size()),
-            true,
-            true
-        );
+    // optional; callbacks compiled against an older interface may lack it
+    jmethodID midOnPrefillProgress = env->GetMethodID(cbCls, "onPrefillProgress", "(II)V");
+    if (midOnPrefillProgress == nullptr) {
+        env->ExceptionClear();
     }
-    if (nPrompt <= 0) {
-        LOGE("Tokenize prompt failed");
-        return JNI_FALSE;
+    jmethodID midOnGenerationStats = env->GetMethodID(cbCls, "onGenerationStats", "(IIIJ)V");
+    if (midOnGenerationStats == nullptr) {
+        env->ExceptionClear();
     }
-    promptTokens.resize(static_cast<size_t>(nPrompt));
 
-    // Avoid prompts that end with EOG/EOS tokens (some vocabs add EOS automatically when add_special=true)
-    while (!promptTokens.empty() && llama_vocab_is_eog(vocab, promptTokens.back())) {
-        promptTokens.pop_back();
-    }
-    if (promptTokens.empty()) {
-        LOGE("Prompt tokenization resulted in only EOG/EOS tokens");
+    // Tokenize prompt
+    std::vector<llama_token> promptTokens;
+    if (!tokenizePrompt(vocab, promptStr, promptTokens)) {
+        LOGE("Tokenize prompt failed or resulted in only EOG/EOS tokens");
         return JNI_FALSE;
     }
 
@@ -823,25 +1116,52 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
         return JNI_FALSE;
     }
 
+    // Keep the KV entries of the longest prefix shared with the previous request (system prompt,
+    // tool definitions, earlier turns) and drop only the divergent tail. The last prompt token is
+    // always decoded again so there are logits to sample from.
+    const bool hasEncoder = llama_model_has_encoder(session->model);
+    const bool clearRequested = session->clearPromptCache.exchange(false);
+    llama_memory_t mem = llama_get_memory(session->ctx);
+    size_t nReused = 0;
+    size_t nRestored = 0;
+    if (!hasEncoder && !clearRequested && mem != nullptr) {
+        nRestored = restorePromptState(session, promptTokens);
+        nReused = std::min(commonPrefixLength(session->cachedTokens, promptTokens), promptTokens.size() - 1);
+    }
+    if (nReused > 0 && !llama_memory_seq_rm(mem, 0, static_cast<llama_pos>(nReused), -1)) {
+        // e.g. recurrent memory cannot drop a partial sequence
+        nReused = 0;
+    }
+    if (nReused == 0 && mem != nullptr) {
+        llama_memory_clear(mem, true);
+    }
+    const auto reusedCount = static_cast<std::vector<llama_token>::difference_type>(nReused);
+    session->cachedTokens.assign(promptTokens.begin(), promptTokens.begin() + reusedCount);
+    const size_t nDecode = promptTokens.size() - nReused;
+
     LOGI(
-        "Prefill decode start: prompt_tokens=%zu n_ctx=%d n_batch=%u max_new=%d",
+        "Prefill decode start: prompt_tokens=%zu reused=%zu restored=%zu decode=%zu n_ctx=%d n_batch=%u max_new=%d",
         promptTokens.size(),
+        nReused,
+        std::min(nRestored, nReused),
+        nDecode,
         n_ctx,
         llama_n_batch(session->ctx),
         maxNew
     );
 
     int32_t n_past = 0;
+    int32_t ret = 0;
+
+    if (hasEncoder) {
+        // The encoder sees the whole input in one batch, so it is not chunked.
+        llama_batch batch = llama_batch_get_one(promptTokens.data(), static_cast<int32_t>(promptTokens.size()));
+        // llama_batch_get_one() may leave batch.logits == nullptr (default behavior is: only last token outputs logits)
+        // so never write to it unless it's allocated.
+        if (batch.logits != nullptr && batch.n_tokens > 0) {
+            batch.logits[batch.n_tokens - 1] = 1;
+        }
 
-    // Evaluate prompt
-    llama_batch batch = llama_batch_get_one(promptTokens.data(), static_cast<int32_t>(promptTokens.size()));
-    // llama_batch_get_one() may leave batch.logits == nullptr (default behavior is: only last token outputs logits)
-    // so never write to it unless it's allocated.
-    if (batch.logits != nullptr && batch.n_tokens > 0) {
-        batch.logits[batch.n_tokens - 1] = 1;
-    }
-
-    if (llama_model_has_encoder(session->model)) {
         if (llama_encode(session->ctx, batch) != 0) {
             LOGE("llama_encode failed");
             return JNI_FALSE;
@@ -856,11 +1176,45 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
         if (batch.logits != nullptr) {
             batch.logits[0] = 1;
         }
+        ret = llama_decode(session->ctx, batch);
+    } else {
+        // Evaluate the new part of the prompt in chunks of at most n_batch tokens; positions
+        // continue after the kept prefix. Between chunks the request can be cancelled and the
+        // callback hears how far prefill got.
+        const size_t chunkSize = std::max<size_t>(1, llama_n_batch(session->ctx));
+        size_t done = 0;
+        while (done < nDecode) {
+            if (session->cancel.load()) {
+                ret = 2;
+                break;
+            }
+
+            const size_t n = std::min(chunkSize, nDecode - done);
+            const auto first = promptTokens.begin() + reusedCount + static_cast<std::vector<llama_token>::difference_type>(done);
+            const auto last = first + static_cast<std::vector<llama_token>::difference_type>(n);
+            llama_batch batch = llama_batch_get_one(&*first, static_cast<int32_t>(n));
+            ret = llama_decode(session->ctx, batch);
+            if (ret != 0) {
+                break;
+            }
+            session->cachedTokens.insert(session->cachedTokens.end(), first, last);
+            done += n;
+
+            if (midOnPrefillProgress != nullptr) {
+                env->CallVoidMethod(callback, midOnPrefillProgress, static_cast<jint>(done), static_cast<jint>(nDecode));
+                if (env->ExceptionCheck()) {
+                    env->ExceptionClear();
+                }
+            }
+        }
     }
 
-    int32_t ret = llama_decode(session->ctx, batch);
-    if (ret != 0 && ret != 1) {
-        // 1 is a warning; 2 is aborted
+    if (ret != 0) {
+        // whatever the failed call left in the KV cache no longer matches cachedTokens
+        session->cachedTokens.clear();
+    }
+    if (ret != 0 && (ret != 1 || !hasEncoder)) {
+        // 2 is aborted; 1 (no KV slot) leaves part of a chunked prompt unevaluated
         if (ret == 2) {
             LOGI("decode aborted (prompt)");
         } else {
@@ -869,16 +1223,67 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
         return JNI_FALSE;
     }
 
+    // encoder-decoder models keep no reusable decoder prefix
+    bool cacheValid = ret == 0 && !hasEncoder;
+
+    PromptCacheStatsNative & stats = session->promptCacheStats;
+    stats.lastPromptTokens = static_cast<int64_t>(promptTokens.size());
+    stats.lastReusedTokens = static_cast<int64_t>(nReused);
+    stats.lastDecodedTokens = static_cast<int64_t>(nDecode);
+    stats.totalReusedTokens += static_cast<int64_t>(nReused);
+    stats.totalDecodedTokens += static_cast<int64_t>(nDecode);
+    stats.lastRestoredTokens = static_cast<int64_t>(std::min(nRestored, nReused));
+
     // n_past for subsequent single-token decoding
-    n_past = llama_model_has_encoder(session->model)
+    n_past = hasEncoder
         ? 1
         : static_cast<int32_t>(promptTokens.size());
 
     // Generation loop
-    std::vector<llama_token> generatedTokens;
-    generatedTokens.reserve(static_cast<size_t>(maxNew));
-    std::string prevDecoded;
-    std::vector<char> detokBuf;
+    llamajni::IncrementalDetokenizer detokenizer;
+    std::vector<char> pieceBuf;
+    std::string delta;
+    bool stopped = false;
+
+    // Sends text to the callback; false once the callback asked to stop or threw.
+    auto emitText = [&](const std::string & text) -> bool {
+        jstring jdelta = bytesUtf8ToJstring(env, text);
+        if (jdelta == nullptr || env->ExceptionCheck()) {
+            env->ExceptionClear();
+            return true;
+        }
+        const jboolean keepGoing = env->CallBooleanMethod(callback, midOnToken, jdelta);
+        env->DeleteLocalRef(jdelta);
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            LOGE("Java callback threw exception; stopping generation");
+            return false;
+        }
+        return keepGoing != JNI_FALSE;
+    };
+
+    // Speculative decoding: the draft proposes tokens after newToken, the target decodes newToken
+    // and the drafts in one batch and samples at every position with its own sampler. Drafts are
+    // accepted while they match what the target sampled, so the output is what plain decoding
+    // would give. Accepted tokens (plus the target's token after them) wait in `verified`; all
+    // but the last are already in the KV cache.
+    const bool speculative = session->draft != nullptr && !hasEncoder;
+    std::vector<llama_token> drafted;
+    std::vector<llama_token> verified;
+    size_t verifiedPos = 0;
+    size_t verifiedInKv = 0;
+    // at most n_batch tokens go to one llama_decode, and the batch holds the drafts plus one
+    const int32_t nDraftMax = speculative
+        ? std::min(session->draft->nDraft, static_cast<int32_t>(llama_n_batch(session->ctx)) - 1)
+        : 0;
+    std::unique_ptr<ScopedBatch> verifyBatch;
+    if (nDraftMax > 0) {
+        verifyBatch.reset(new ScopedBatch(nDraftMax + 1));
+    }
+    int32_t nGenerated = 0;
+    int32_t nDrafted = 0;
+    int32_t nAccepted = 0;
+    const auto generationStart = std::chrono::steady_clock::now();
 
     for (int i = 0; i < maxNew; i++) {
         if (session->cancel.load()) {
@@ -886,8 +1291,15 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
             break;
         }
 
-        const llama_token newToken = llama_sampler_sample(session->sampler, session->ctx, -1);
-        llama_sampler_accept(session->sampler, newToken);
+        llama_token newToken;
+        bool inKv = false;
+        if (verifiedPos < verified.size()) {
+            inKv = verifiedPos < verifiedInKv;
+            newToken = verified[verifiedPos++];
+        } else {
+            newToken = llama_sampler_sample(session->sampler, session->ctx, -1);
+            llama_sampler_accept(session->sampler, newToken);
+        }
 
         if (i == 0) {
             LOGI("first sampled token=%d eog=%d", (int) newToken, (int) llama_vocab_is_eog(vocab, newToken));
@@ -897,73 +1309,102 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
             break;
         }
 
-        // Detokenize the generated token sequence to produce valid UTF-8 text.
-        // Token pieces may split multi-byte sequences; emitting per-token pieces often results in mojibake.
-        generatedTokens.push_back(newToken);
+        // Only the new token's piece is converted; a multi-byte character split across pieces
+        // is held back until it is complete, so no delta ends in mojibake.
+        const int32_t nPiece = generatedTokenPiece(vocab, newToken, i == 0, pieceBuf);
+        detokenizer.push(pieceBuf.data(), static_cast<size_t>(std::max<int32_t>(0, nPiece)), delta);
 
-        int32_t detokCap = std::max<int32_t>(64, static_cast<int32_t>(generatedTokens.size() * 8 + 32));
-        detokBuf.resize(static_cast<size_t>(detokCap));
+        nGenerated++;
 
-        int32_t nDetok = llama_detokenize(
-            vocab,
-            generatedTokens.data(),
-            static_cast<int32_t>(generatedTokens.size()),
-            detokBuf.data(),
-            static_cast<int32_t>(detokBuf.size()),
-            true,
-            false
-        );
-        if (nDetok < 0) {
-            detokBuf.resize(static_cast<size_t>(-nDetok));
-            nDetok = llama_detokenize(
-                vocab,
-                generatedTokens.data(),
-                static_cast<int32_t>(generatedTokens.size()),
-                detokBuf.data(),
-                static_cast<int32_t>(detokBuf.size()),
-                true,
-                false
-            );
+        if (!delta.empty() && !emitText(delta)) {
+            stopped = true;
+            break;
         }
 
-        std::string decodedNow;
-        if (nDetok > 0) {
-            decodedNow.assign(detokBuf.data(), detokBuf.data() + nDetok);
+        if (inKv) {
+            continue;
         }
 
-        std::string delta;
-        if (!prevDecoded.empty() && decodedNow.rfind(prevDecoded, 0) == 0) {
-            delta = decodedNow.substr(prevDecoded.size());
+        if (n_ctx > 0 && n_past >= n_ctx) {
+            LOGI("context window reached: n_past=%d n_ctx=%d", n_past, n_ctx);
+            break;
+        }
+
+        int32_t maxDraft = 0;
+        if (nDraftMax > 0 && cacheValid) {
+            maxDraft = std::min(nDraftMax, maxNew - i - 1);
+            if (n_ctx > 0) {
+                maxDraft = std::min(maxDraft, n_ctx - n_past - 1);
+            }
+        }
+        if (maxDraft > 0) {
+            session->draftContext.assign(session->cachedTokens.begin(), session->cachedTokens.end());
+            session->draftContext.push_back(newToken);
+            if (!draftTokens(session, maxDraft, drafted)) {
+                drafted.clear();
+            }
         } else {
-            delta = decodedNow;
+            drafted.clear();
         }
-        prevDecoded = decodedNow;
 
-        if (!delta.empty()) {
-            jstring jdelta = bytesUtf8ToJstring(env, delta);
-            if (jdelta == nullptr || env->ExceptionCheck()) {
-                env->ExceptionClear();
-            } else {
-                const jboolean keepGoing = env->CallBooleanMethod(callback, midOnToken, jdelta);
-                env->DeleteLocalRef(jdelta);
-                if (env->ExceptionCheck()) {
-                    env->ExceptionClear();
-                    LOGE("Java callback threw exception; stopping generation");
+        if (!drafted.empty()) {
+            llama_batch & vbatch = verifyBatch->batch;
+            vbatch.n_tokens = static_cast<int32_t>(drafted.size() + 1);
+            for (int32_t j = 0; j < vbatch.n_tokens; j++) {
+                vbatch.token[j] = j == 0 ? newToken : drafted[static_cast<size_t>(j - 1)];
+                vbatch.pos[j] = n_past + j;
+                vbatch.n_seq_id[j] = 1;
+                vbatch.seq_id[j][0] = 0;
+                vbatch.logits[j] = 1;
+            }
+
+            ret = llama_decode(session->ctx, vbatch);
+            if (ret != 0) {
+                cacheValid = false;
+                session->cachedTokens.clear();
+                if (ret == 2) {
+                    LOGI("decode aborted");
                     break;
                 }
-                if (!keepGoing) {
+                LOGE("llama_decode failed for draft verification ret=%d", ret);
+                return JNI_FALSE;
+            }
+
+            verified.clear();
+            for (size_t j = 0; j <= drafted.size(); j++) {
+                const llama_token token = llama_sampler_sample(session->sampler, session->ctx, static_cast<int32_t>(j));
+                llama_sampler_accept(session->sampler, token);
+                verified.push_back(token);
+                if (llama_vocab_is_eog(vocab, token) || j == drafted.size() || token != drafted[j]) {
                     break;
                 }
             }
-        }
 
-        if (n_ctx > 0 && n_past >= n_ctx) {
-            LOGI("context window reached: n_past=%d n_ctx=%d", n_past, n_ctx);
-            break;
+            // keep newToken and the accepted drafts, drop the rejected ones
+            const size_t nKept = verified.size();
+            if (nKept < drafted.size() + 1
+                    && !llama_memory_seq_rm(mem, 0, static_cast<llama_pos>(n_past + static_cast<int32_t>(nKept)), -1)) {
+                cacheValid = false;
+                session->cachedTokens.clear();
+                LOGE("cannot drop rejected draft tokens from the KV cache");
+                break;
+            }
+            session->cachedTokens.push_back(newToken);
+            session->cachedTokens.insert(
+                session->cachedTokens.end(),
+                drafted.begin(),
+                drafted.begin() + static_cast<std::vector<llama_token>::difference_type>(nKept - 1)
+            );
+            n_past += static_cast<int32_t>(nKept);
+            nDrafted += static_cast<int32_t>(drafted.size());
+            nAccepted += static_cast<int32_t>(nKept - 1);
+            verifiedPos = 0;
+            verifiedInKv = nKept - 1;
+            continue;
         }
 
         llama_token next = newToken;
-        batch = llama_batch_get_one(&next, 1);
+        llama_batch batch = llama_batch_get_one(&next, 1);
         if (batch.pos != nullptr) {
             batch.pos[0] = n_past;
         }
@@ -971,6 +1412,12 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
             batch.logits[0] = 1;
         }
         ret = llama_decode(session->ctx, batch);
+        if (ret == 0 && cacheValid) {
+            session->cachedTokens.push_back(next);
+        } else if (cacheValid) {
+            cacheValid = false;
+            session->cachedTokens.clear();
+        }
         if (ret != 0 && ret != 1) {
             if (ret == 2) {
                 LOGI("decode aborted");
@@ -983,7 +1430,260 @@ Java_com_ai_assistance_llama_LlamaNative_nativeGenerateStream(JNIEnv * env, jcla
         n_past += 1;
     }
 
+    if (!stopped) {
+        detokenizer.flush(delta);
+        if (!delta.empty()) {
+            (void) emitText(delta);
+        }
+    }
+
+    if (midOnGenerationStats != nullptr) {
+        const auto elapsed = std::chrono::steady_clock::now() - generationStart;
+        env->CallVoidMethod(
+            callback,
+            midOnGenerationStats,
+            static_cast<jint>(nGenerated),
+            static_cast<jint>(nDrafted),
+            static_cast<jint>(nAccepted),
+            static_cast<jlong>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+        );
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+    }
+    if (nDrafted > 0) {
+        LOGI("speculative decoding: drafted=%d accepted=%d generated=%d", nDrafted, nAccepted, nGenerated);
+    }
+
     return JNI_TRUE;
 }
 
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeGetPromptCacheStats(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) clazz;
+
+    if (sessionPtr == 0) return nullptr;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    const PromptCacheStatsNative & stats = session->promptCacheStats;
+
+    // [last prompt tokens, last reused, last decoded, total reused, total decoded, last restored]
+    const jlong values[] = {
+        static_cast<jlong>(stats.lastPromptTokens),
+        static_cast<jlong>(stats.lastReusedTokens),
+        static_cast<jlong>(stats.lastDecodedTokens),
+        static_cast<jlong>(stats.totalReusedTokens),
+        static_cast<jlong>(stats.totalDecodedTokens),
+        static_cast<jlong>(stats.lastRestoredTokens)
+    };
+    const jsize count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray out = env->NewLongArray(count);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, count, values);
+    return out;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeClearPromptCache(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    if (sessionPtr == 0) return;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    // applied by the next generation, so this is safe to call while one is running
+    session->clearPromptCache.store(true);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeSetDraftModel(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring pathModel, jint nDraft) {
+    (void) clazz;
+
+    if (sessionPtr == 0 || pathModel == nullptr) return JNI_FALSE;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    if (!session->ctx || !session->model) return JNI_FALSE;
+
+    // Rejected drafts are removed from the middle of the target's sequence, which recurrent
+    // memory cannot do; encoder-decoder models keep their own decoding path.
+    if (llama_model_has_encoder(session->model) || llama_model_is_recurrent(session->model)) {
+        LOGE("Speculative decoding is not supported for this model");
+        return JNI_FALSE;
+    }
+
+    const std::string modelPath = jstringToString(env, pathModel);
+    LOGI("Loading draft model=%s n_draft=%d", modelPath.c_str(), (int) nDraft);
+
+    // the drafts are verified in one batch together with the token before them
+    const int32_t maxDraft = static_cast<int32_t>(llama_n_batch(session->ctx)) - 1;
+    if (maxDraft < 1) {
+        LOGE("Speculative decoding needs n_batch > 1");
+        return JNI_FALSE;
+    }
+
+    auto * draft = new (std::nothrow) DraftModelNative();
+    if (!draft) return JNI_FALSE;
+    draft->nDraft = std::clamp<int32_t>(nDraft > 0 ? static_cast<int32_t>(nDraft) : 4, 1, maxDraft);
+
+    llama_model_params mparams = llama_model_default_params();
+    mparams.n_gpu_layers = 0;
+    mparams.use_mmap = true;
+    mparams.use_mlock = false;
+
+    draft->model = llama_model_load_from_file(modelPath.c_str(), mparams);
+    if (!draft->model) {
+        LOGE("Failed to load draft model from file");
+        freeDraftModel(draft);
+        return JNI_FALSE;
+    }
+    if (!draftVocabCompatible(session->model, draft->model)) {
+        LOGE("Draft model vocabulary does not match the target model");
+        freeDraftModel(draft);
+        return JNI_FALSE;
+    }
+
+    llama_context_params cparams = llama_context_default_params();
+    cparams.n_ctx = llama_n_ctx(session->ctx);
+    cparams.n_batch = llama_n_batch(session->ctx);
+    cparams.n_ubatch = std::min<uint32_t>(cparams.n_batch, 512u);
+    cparams.abort_callback = abortCallback;
+    cparams.abort_callback_data = session;
+
+    draft->ctx = llama_init_from_model(draft->model, cparams);
+    if (!draft->ctx) {
+        LOGE("Failed to create draft context");
+        freeDraftModel(draft);
+        return JNI_FALSE;
+    }
+    llama_set_n_threads(draft->ctx, llama_n_threads(session->ctx), llama_n_threads_batch(session->ctx));
+
+    draft->sampler = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    if (!draft->sampler) {
+        freeDraftModel(draft);
+        return JNI_FALSE;
+    }
+    llama_sampler_chain_add(draft->sampler, llama_sampler_init_greedy());
+
+    DraftModelNative * previous = nullptr;
+    {
+        std::lock_guard<std::mutex> generationLock(session->generationMutex);
+        previous = session->draft;
+        session->draft = draft;
+    }
+    freeDraftModel(previous);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeClearDraftModel(JNIEnv * env, jclass clazz, jlong sessionPtr) {
+    (void) env;
+    (void) clazz;
+    if (sessionPtr == 0) return;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    DraftModelNative * previous = nullptr;
+    {
+        std::lock_guard<std::mutex> generationLock(session->generationMutex);
+        previous = session->draft;
+        session->draft = nullptr;
+    }
+    freeDraftModel(previous);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeSetPromptStateCache(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring dir, jlong maxBytes) {
+    (void) clazz;
+
+    if (sessionPtr == 0) return JNI_FALSE;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+
+    const std::string path = jstringToString(env, dir);
+    if (path.empty()) {
+        session->stateCache.disable();
+        return JNI_TRUE;
+    }
+    if (!session->stateCache.configure(path, static_cast<int64_t>(maxBytes), session->modelKey)) {
+        LOGE("Prompt state cache unavailable: %s", path.c_str());
+        return JNI_FALSE;
+    }
+    LOGI("Prompt state cache: dir=%s max_bytes=%lld", path.c_str(), static_cast<long long>(maxBytes));
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativeGetPromptStatePath(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring prompt) {
+    (void) clazz;
+
+    if (sessionPtr == 0) return nullptr;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    if (!session->model || !session->stateCache.enabled()) return nullptr;
+
+    std::vector<llama_token> tokens;
+    if (!tokenizePrompt(llama_model_get_vocab(session->model), jstringToString(env, prompt), tokens)) {
+        return nullptr;
+    }
+    // the prefix nativePrewarmPromptState saves
+    tokens.pop_back();
+    if (tokens.empty()) return nullptr;
+    return env->NewStringUTF(session->stateCache.pathFor(tokens.data(), tokens.size()).c_str());
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_llama_LlamaNative_nativePrewarmPromptState(JNIEnv * env, jclass clazz, jlong sessionPtr, jstring prompt) {
+    (void) clazz;
+
+    if (sessionPtr == 0) return JNI_FALSE;
+    auto * session = reinterpret_cast<LlamaSessionNative *>(sessionPtr);
+    if (!session->model || !session->ctx || !session->stateCache.enabled()) return JNI_FALSE;
+    if (llama_model_has_encoder(session->model)) return JNI_FALSE;
+
+    std::lock_guard<std::mutex> generationLock(session->generationMutex);
+    std::vector<llama_token> tokens;
+    if (!tokenizePrompt(llama_model_get_vocab(session->model), jstringToString(env, prompt), tokens)) {
+        return JNI_FALSE;
+    }
+    // The last token can merge with whatever text follows this prefix in a real prompt, so the
+    // saved prefix stops before it.
+    tokens.pop_back();
+    if (tokens.empty() || tokens.size() >= llama_n_ctx(session->ctx)) return JNI_FALSE;
+
+    // Already saved: leave the KV cache alone, it may hold a longer conversation.
+    if (session->stateCache.contains(tokens.data(), tokens.size())) return JNI_TRUE;
+
+    if (session->releasing.load()) return JNI_FALSE;
+    session->cancel.store(false);
+    llama_memory_t mem = llama_get_memory(session->ctx);
+    if (mem == nullptr) return JNI_FALSE;
+
+    const bool clearRequested = session->clearPromptCache.exchange(false);
+    if (!clearRequested) {
+        restorePromptState(session, tokens);
+    }
+    size_t keep = clearRequested ? 0 : commonPrefixLength(session->cachedTokens, tokens);
+    if (keep > 0 && !llama_memory_seq_rm(mem, 0, static_cast<llama_pos>(keep), -1)) {
+        keep = 0;
+    }
+    if (keep == 0) {
+        llama_memory_clear(mem, true);
+    }
+    session->cachedTokens.resize(keep);
+
+    const size_t chunkSize = std::max<size_t>(1, llama_n_batch(session->ctx));
+    for (size_t done = keep; done < tokens.size();) {
+        if (session->cancel.load()) {
+            LOGI("Prompt state prewarm cancelled");
+            return JNI_FALSE;
+        }
+        const size_t n = std::min(chunkSize, tokens.size() - done);
+        if (llama_decode(session->ctx, llama_batch_get_one(tokens.data() + done, static_cast<int32_t>(n))) != 0) {
+            LOGE("llama_decode failed while prewarming prompt state");
+            session->cachedTokens.clear();
+            llama_memory_clear(mem, true);
+            return JNI_FALSE;
+        }
+        const auto first = tokens.begin() + static_cast<std::vector<llama_token>::difference_type>(done);
+        session->cachedTokens.insert(session->cachedTokens.end(), first, first + static_cast<std::vector<llama_token>::difference_type>(n));
+        done += n;
+    }
+
+    const bool saved = savePromptState(session);
+    LOGI("Prewarmed prompt state: tokens=%zu decoded=%zu saved=%d", tokens.size(), tokens.size() - keep, saved ? 1 : 0);
+    return saved ? JNI_TRUE : JNI_FALSE;
+}
+
 #endif
@@ -0,0 +1,291 @@
+#include "llama_prompt_state_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <vector>
+
+namespace llamajni {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'P', 'K', 'V', 'S', 'T', 'A', 'T'};
+constexpr uint32_t kVersion = 1;
+constexpr const char * kSuffix = ".kvstate";
+constexpr const char * kTempMarker = ".kvstate.tmp";
+// Temporary files left by a crash mid-write are removed once they are this old.
+constexpr time_t kStaleTempSeconds = 60 * 60;
+
+// Followed by tokenCount int32 token ids, then stateSize bytes of llama sequence state.
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tokenCount;
+    uint64_t modelKey;
+    uint64_t stateSize;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader must not be padded");
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t fnv1a(uint64_t hash, const void * data, size_t length) {
+    const auto * bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+bool endsWith(const std::string & s, const char * suffix) {
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Calls visit(name) for every entry of dir except . and ..
+void forEachEntry(const std::string & dir, const std::function<void(const std::string &)> & visit) {
+    DIR * handle = opendir(dir.c_str());
+    if (handle == nullptr) return;
+    while (const dirent * entry = readdir(handle)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            visit(name);
+        }
+    }
+    closedir(handle);
+}
+
+bool writeAll(FILE * file, const void * data, size_t length) {
+    return length == 0 || std::fwrite(data, 1, length, file) == length;
+}
+
+} // namespace
+
+MappedPromptState::~MappedPromptState() {
+    close();
+}
+
+bool MappedPromptState::open(const std::string & path, uint64_t modelKey) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        return false;
+    }
+
+    const auto fileLength = static_cast<size_t>(st.st_size);
+    void * mapped = mmap(nullptr, fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    base = mapped;
+    length = fileLength;
+
+    FileHeader header {};
+    std::memcpy(&header, base, sizeof(header));
+    const uint64_t tokenBytes = static_cast<uint64_t>(header.tokenCount) * sizeof(int32_t);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion ||
+        header.modelKey != modelKey ||
+        header.tokenCount == 0 ||
+        sizeof(FileHeader) + tokenBytes + header.stateSize != fileLength) {
+        close();
+        return false;
+    }
+
+    const auto * bytes = static_cast<const uint8_t *>(base);
+    tokenData = reinterpret_cast<const int32_t *>(bytes + sizeof(FileHeader));
+    nTokens = header.tokenCount;
+    stateData = bytes + sizeof(FileHeader) + tokenBytes;
+    nStateBytes = static_cast<size_t>(header.stateSize);
+    return true;
+}
+
+void MappedPromptState::close() {
+    if (base != nullptr) {
+        munmap(base, length);
+    }
+    base = nullptr;
+    length = 0;
+    tokenData = nullptr;
+    nTokens = 0;
+    stateData = nullptr;
+    nStateBytes = 0;
+}
+
+bool PromptStateCache::configure(const std::string & cacheDir, int64_t budget, uint64_t key) {
+    struct stat st {};
+    if (cacheDir.empty() || key == 0 || stat(cacheDir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        disable();
+        return false;
+    }
+    dir = cacheDir;
+    if (dir.back() != '/') {
+        dir += '/';
+    }
+    maxBytes = budget;
+    modelKey = key;
+    evict();
+    return true;
+}
+
+void PromptStateCache::disable() {
+    dir.clear();
+    maxBytes = 0;
+    modelKey = 0;
+}
+
+std::string PromptStateCache::pathFor(const int32_t * tokens, size_t count) const {
+    char name[96];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 "-%zu-%016" PRIx64 "%s", modelKey, count, hashTokens(tokens, count), kSuffix);
+    return dir + name;
+}
+
+size_t PromptStateCache::findLongestPrefix(const int32_t * tokens, size_t maxLength, size_t minLength, MappedPromptState & out) const {
+    if (!enabled() || maxLength <= minLength) return 0;
+
+    char prefix[24];
+    std::snprintf(prefix, sizeof(prefix), "%016" PRIx64 "-", modelKey);
+    const size_t prefixLength = std::strlen(prefix);
+
+    std::vector<size_t> lengths;
+    forEachEntry(dir, [&](const std::string & name) {
+        if (!endsWith(name, kSuffix) || name.compare(0, prefixLength, prefix) != 0) return;
+        const size_t count = std::strtoull(name.c_str() + prefixLength, nullptr, 10);
+        if (count > minLength && count <= maxLength) {
+            lengths.push_back(count);
+        }
+    });
+    std::sort(lengths.begin(), lengths.end(), std::greater<size_t>());
+    lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+
+    for (const size_t count : lengths) {
+        const std::string path = pathFor(tokens, count);
+        if (!out.open(path, modelKey)) continue;
+        // the name only carries a hash; the tokens in the file decide
+        if (out.tokenCount() == count && std::memcmp(out.tokens(), tokens, count * sizeof(int32_t)) == 0) {
+            utime(path.c_str(), nullptr);
+            return count;
+        }
+        out.close();
+    }
+    return 0;
+}
+
+bool PromptStateCache::contains(const int32_t * tokens, size_t count) const {
+    if (!enabled() || count == 0) return false;
+    MappedPromptState saved;
+    const std::string path = pathFor(tokens, count);
+    if (!saved.open(path, modelKey) || saved.tokenCount() != count ||
+        std::memcmp(saved.tokens(), tokens, count * sizeof(int32_t)) != 0) {
+        return false;
+    }
+    utime(path.c_str(), nullptr);
+    return true;
+}
+
+bool PromptStateCache::store(const int32_t * tokens, size_t count, const uint8_t * state, size_t stateSize) const {
+    if (!enabled() || count == 0 || count > UINT32_MAX || stateSize == 0) return false;
+    const uint64_t fileLength = sizeof(FileHeader) + count * sizeof(int32_t) + stateSize;
+    if (maxBytes > 0 && fileLength > static_cast<uint64_t>(maxBytes)) return false;
+
+    const std::string path = pathFor(tokens, count);
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".tmp.%d.%p", static_cast<int>(getpid()), static_cast<const void *>(this));
+    const std::string tempPath = path + suffix;
+
+    FileHeader header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.tokenCount = static_cast<uint32_t>(count);
+    header.modelKey = modelKey;
+    header.stateSize = stateSize;
+
+    FILE * file = std::fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool ok = writeAll(file, &header, sizeof(header)) &&
+        writeAll(file, tokens, count * sizeof(int32_t)) &&
+        writeAll(file, state, stateSize);
+    ok = std::fclose(file) == 0 && ok;
+    // readers only ever see complete files
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void PromptStateCache::evict() const {
+    if (!enabled()) return;
+
+    struct Entry {
+        std::string path;
+        int64_t size;
+        timespec usedAt;
+    };
+    std::vector<Entry> entries;
+    int64_t total = 0;
+    const time_t now = std::time(nullptr);
+    forEachEntry(dir, [&](const std::string & name) {
+        const std::string path = dir + name;
+        struct stat st {};
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return;
+        if (name.find(kTempMarker) != std::string::npos) {
+            if (now - st.st_mtime > kStaleTempSeconds) {
+                unlink(path.c_str());
+            }
+            return;
+        }
+        if (!endsWith(name, kSuffix)) return;
+        entries.push_back({path, static_cast<int64_t>(st.st_size), st.st_mtim});
+        total += static_cast<int64_t>(st.st_size);
+    });
+    if (maxBytes <= 0 || total <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry & a, const Entry & b) {
+        if (a.usedAt.tv_sec != b.usedAt.tv_sec) return a.usedAt.tv_sec < b.usedAt.tv_sec;
+        return a.usedAt.tv_nsec < b.usedAt.tv_nsec;
+    });
+    for (const Entry & entry : entries) {
+        if (total <= maxBytes) break;
+        // a state mapped by another session stays readable after unlink
+        if (unlink(entry.path.c_str()) == 0) {
+            total -= entry.size;
+        }
+    }
+}
+
+uint64_t hashTokens(const int32_t * tokens, size_t count) {
+    return fnv1a(kFnvOffset, tokens, count * sizeof(int32_t));
+}
+
+uint64_t modelFileKey(const std::string & path) {
+    struct stat st {};
+    if (path.empty() || stat(path.c_str(), &st) != 0) return 0;
+    uint64_t key = fnv1a(kFnvOffset, path.data(), path.size());
+    const int64_t size = static_cast<int64_t>(st.st_size);
+    const int64_t mtime = static_cast<int64_t>(st.st_mtime);
+    key = fnv1a(key, &size, sizeof(size));
+    key = fnv1a(key, &mtime, sizeof(mtime));
+    return key == 0 ? 1 : key;
+}
+
+} // namespace llamajni
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace llamajni {
+
+// A saved prompt state mapped read-only from its file. The token and state pointers point into
+// the mapping and stay valid until the object is destroyed or reopened.
+class MappedPromptState {
+public:
+    MappedPromptState() = default;
+    ~MappedPromptState();
+
+    MappedPromptState(const MappedPromptState &) = delete;
+    MappedPromptState & operator=(const MappedPromptState &) = delete;
+
+    // Maps path and checks its header against modelKey and the file length.
+    bool open(const std::string & path, uint64_t modelKey);
+    void close();
+
+    const int32_t * tokens() const { return tokenData; }
+    size_t tokenCount() const { return nTokens; }
+    const uint8_t * state() const { return stateData; }
+    size_t stateSize() const { return nStateBytes; }
+
+private:
+    void * base = nullptr;
+    size_t length = 0;
+    const int32_t * tokenData = nullptr;
+    size_t nTokens = 0;
+    const uint8_t * stateData = nullptr;
+    size_t nStateBytes = 0;
+};
+
+// Directory of sequence states (llama_state_seq_get_data) for prompt prefixes, keyed by the
+// model and a hash of the prefix tokens. Files are named <model key>-<token count>-<token hash>,
+// so finding the longest saved prefix of a prompt costs one directory scan and one hash per
+// saved length, without reading any file that cannot match. Once the directory is over its byte
+// budget the least recently used files are deleted; the budget covers every model in it.
+class PromptStateCache {
+public:
+    // dir must exist. maxBytes <= 0 means no limit.
+    bool configure(const std::string & dir, int64_t maxBytes, uint64_t modelKey);
+    void disable();
+    bool enabled() const { return !dir.empty(); }
+
+    // Maps the longest saved prefix of tokens[0, maxLength) that is longer than minLength into
+    // out and returns its length, or 0 when there is none.
+    size_t findLongestPrefix(const int32_t * tokens, size_t maxLength, size_t minLength, MappedPromptState & out) const;
+
+    // Whether tokens[0, count) is saved; marks the file as recently used.
+    bool contains(const int32_t * tokens, size_t count) const;
+
+    // Saves the state for tokens[0, count), replacing any previous file, then evicts.
+    bool store(const int32_t * tokens, size_t count, const uint8_t * state, size_t stateSize) const;
+
+    void evict() const;
+
+    // File the state for tokens[0, count) is saved in, whether or not it exists.
+    std::string pathFor(const int32_t * tokens, size_t count) const;
+
+private:
+    std::string dir;
+    int64_t maxBytes = 0;
+    uint64_t modelKey = 0;
+};
+
+// FNV-1a over the token ids.
+uint64_t hashTokens(const int32_t * tokens, size_t count);
+
+// Identifies a model file by path, size and modification time, so a replaced file does not pick
+// up states saved for the old one. 0 when the file cannot be read.
+uint64_t modelFileKey(const std::string & path);
+
+} // namespace llamajni
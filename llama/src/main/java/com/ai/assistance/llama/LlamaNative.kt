@@ -10,7 +10,14 @@ object LlamaNative {
 
     @JvmStatic external fun nativeGetUnavailableReason(): String
 
-    @JvmStatic external fun nativeCreateSession(pathModel: String, nThreads: Int, nCtx: Int): Long
+    /** @param nBatch prefill chunk size (llama n_batch); <= 0 for the default of 512. */
+    @JvmStatic external fun nativeCreateSession(pathModel: String, nThreads: Int, nCtx: Int, nBatch: Int): Long
+
+    /**
+     * Cancels the running generation or prewarm for good: later ones on this session return
+     * false right away. Called before waiting for them to return and [nativeReleaseSession].
+     */
+    @JvmStatic external fun nativeBeginRelease(sessionPtr: Long)
 
     @JvmStatic external fun nativeReleaseSession(sessionPtr: Long)
 
@@ -56,7 +63,48 @@ object LlamaNative {
     @JvmStatic
     external fun nativeClearToolCallGrammar(sessionPtr: Long): Boolean
 
+    /**
+     * [last prompt tokens, last reused, last decoded, total reused, total decoded, last restored
+     * from disk], or null.
+     */
+    @JvmStatic
+    external fun nativeGetPromptCacheStats(sessionPtr: Long): LongArray?
+
+    @JvmStatic
+    external fun nativeClearPromptCache(sessionPtr: Long)
+
+    @JvmStatic
+    external fun nativeSetDraftModel(sessionPtr: Long, pathModel: String, nDraft: Int): Boolean
+
+    @JvmStatic
+    external fun nativeClearDraftModel(sessionPtr: Long)
+
+    /** @param dir existing directory, or empty to disable; @param maxBytes <= 0 for no limit. */
+    @JvmStatic
+    external fun nativeSetPromptStateCache(sessionPtr: Long, dir: String, maxBytes: Long): Boolean
+
+    @JvmStatic
+    external fun nativePrewarmPromptState(sessionPtr: Long, prompt: String): Boolean
+
+    /** File nativePrewarmPromptState saves [prompt] in, or null when no cache is set. */
+    @JvmStatic
+    external fun nativeGetPromptStatePath(sessionPtr: Long, prompt: String): String?
+
     interface GenerationCallback {
         fun onToken(token: String): Boolean
+
+        /** Called after each prefill chunk with the prompt tokens evaluated so far out of [total]. */
+        fun onPrefillProgress(done: Int, total: Int) {}
+
+        /**
+         * Called once when generation ends. [draftedTokens] and [acceptedDraftTokens] are zero
+         * without a draft model; [elapsedNanos] covers generation after prefill.
+         */
+        fun onGenerationStats(
+            generatedTokens: Int,
+            draftedTokens: Int,
+            acceptedDraftTokens: Int,
+            elapsedNanos: Long
+        ) {}
     }
 }
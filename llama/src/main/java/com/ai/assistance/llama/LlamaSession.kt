@@ -1,22 +1,65 @@
 package com.ai.assistance.llama
 
+import java.io.File
+import java.util.concurrent.locks.ReentrantLock
+import kotlin.concurrent.withLock
+
 class LlamaSession private constructor(
     private var sessionPtr: Long
 ) {
 
+    /**
+     * How much of the prompts was served from the KV cache. Each generation keeps the longest
+     * token prefix shared with the previous prompt and its reply, and decodes only the rest.
+     * [lastRestoredTokens] is the part of [lastReusedTokens] loaded from the prompt state cache.
+     */
+    data class PromptCacheStats(
+        val lastPromptTokens: Long,
+        val lastReusedTokens: Long,
+        val lastDecodedTokens: Long,
+        val totalReusedTokens: Long,
+        val totalDecodedTokens: Long,
+        val lastRestoredTokens: Long = 0
+    )
+
+    data class GenerationStats(
+        val generatedTokens: Int,
+        val draftedTokens: Int,
+        val acceptedDraftTokens: Int,
+        val elapsedNanos: Long
+    ) {
+        /** Share of drafted tokens the target model accepted; 0 without a draft model. */
+        val acceptanceRate: Double
+            get() = if (draftedTokens > 0) acceptedDraftTokens.toDouble() / draftedTokens else 0.0
+
+        val tokensPerSecond: Double
+            get() = if (elapsedNanos > 0) generatedTokens * 1_000_000_000.0 / elapsedNanos else 0.0
+    }
+
     companion object {
+        /** Prompt tokens evaluated per llama_decode during prefill. */
+        const val DEFAULT_PREFILL_CHUNK_SIZE = 512
+
+        /** Disk budget of a prompt state cache directory, shared by all models saved in it. */
+        const val DEFAULT_PROMPT_STATE_CACHE_BYTES = 512L * 1024 * 1024
+
         fun isAvailable(): Boolean = runCatching { LlamaNative.nativeIsAvailable() }.getOrDefault(false)
 
         fun getUnavailableReason(): String = runCatching { LlamaNative.nativeGetUnavailableReason() }
             .getOrDefault("llama.cpp backend unavailable")
 
+        /**
+         * @param prefillChunkSize prompt tokens per decode call; bounds the compute buffers and is
+         * how often a long prefill checks for [cancel] and reports progress.
+         */
         fun create(
             pathModel: String,
             nThreads: Int,
-            nCtx: Int
+            nCtx: Int,
+            prefillChunkSize: Int = DEFAULT_PREFILL_CHUNK_SIZE
         ): LlamaSession? {
             if (!isAvailable()) return null
-            val ptr = LlamaNative.nativeCreateSession(pathModel, nThreads, nCtx)
+            val ptr = LlamaNative.nativeCreateSession(pathModel, nThreads, nCtx, prefillChunkSize)
             if (ptr == 0L) return null
             return LlamaSession(ptr)
         }
@@ -25,7 +68,11 @@ class LlamaSession private constructor(
     @Volatile
     private var released = false
 
-    private val lock = Any()
+    private val lock = ReentrantLock()
+    private val callsDone = lock.newCondition()
+
+    // native calls running outside the lock; release() waits for them before freeing the session
+    private var callsInFlight = 0
 
     private fun checkValid() {
         if (released || sessionPtr == 0L) {
@@ -33,52 +80,78 @@ class LlamaSession private constructor(
         }
     }
 
-    fun countTokens(text: String): Int {
-        synchronized(lock) {
+    /** Runs [block] with the native session, which stays allocated until [block] returns. */
+    private inline fun <T> withSessionPtr(block: (ptr: Long) -> T): T {
+        val ptr: Long
+        lock.withLock {
             checkValid()
-            return LlamaNative.nativeCountTokens(sessionPtr, text)
+            ptr = sessionPtr
+            callsInFlight++
+        }
+        try {
+            return block(ptr)
+        } finally {
+            lock.withLock {
+                if (--callsInFlight == 0) callsDone.signalAll()
+            }
         }
     }
 
-    fun generateStream(prompt: String, maxTokens: Int, onToken: (String) -> Boolean): Boolean {
-        val ptr: Long
-        synchronized(lock) {
+    fun countTokens(text: String): Int {
+        lock.withLock {
             checkValid()
-            ptr = sessionPtr
+            return LlamaNative.nativeCountTokens(sessionPtr, text)
         }
+    }
+
+    /**
+     * @param onPrefillProgress called after each prefill chunk with the prompt tokens evaluated
+     * so far and the number that needed evaluating (the part not reused from the KV cache).
+     * @param onStats called once when generation ends.
+     */
+    fun generateStream(
+        prompt: String,
+        maxTokens: Int,
+        onPrefillProgress: ((done: Int, total: Int) -> Unit)? = null,
+        onStats: ((GenerationStats) -> Unit)? = null,
+        onToken: (String) -> Boolean
+    ): Boolean {
+        val callback = object : LlamaNative.GenerationCallback {
+            override fun onToken(token: String): Boolean = onToken(token)
 
-        return LlamaNative.nativeGenerateStream(
-            ptr,
-            prompt,
-            maxTokens,
-            object : LlamaNative.GenerationCallback {
-                override fun onToken(token: String): Boolean = onToken(token)
+            override fun onPrefillProgress(done: Int, total: Int) {
+                onPrefillProgress?.invoke(done, total)
             }
-        )
-    }
 
-    fun setToolCallGrammar(grammar: String, triggerPatterns: List<String>): Boolean {
-        val ptr: Long
-        synchronized(lock) {
-            checkValid()
-            ptr = sessionPtr
+            override fun onGenerationStats(
+                generatedTokens: Int,
+                draftedTokens: Int,
+                acceptedDraftTokens: Int,
+                elapsedNanos: Long
+            ) {
+                onStats?.invoke(
+                    GenerationStats(generatedTokens, draftedTokens, acceptedDraftTokens, elapsedNanos)
+                )
+            }
         }
 
-        return LlamaNative.nativeSetToolCallGrammar(
-            ptr,
-            grammar,
-            triggerPatterns.toTypedArray()
-        )
+        return withSessionPtr { ptr ->
+            LlamaNative.nativeGenerateStream(ptr, prompt, maxTokens, callback)
+        }
     }
 
-    fun clearToolCallGrammar(): Boolean {
-        val ptr: Long
-        synchronized(lock) {
-            checkValid()
-            ptr = sessionPtr
+    fun setToolCallGrammar(grammar: String, triggerPatterns: List<String>): Boolean {
+        return withSessionPtr { ptr ->
+            LlamaNative.nativeSetToolCallGrammar(
+                ptr,
+                grammar,
+                triggerPatterns.toTypedArray()
+            )
         }
+    }
 
-        return LlamaNative.nativeClearToolCallGrammar(ptr)
+    fun clearToolCallGrammar(): Boolean {
+        return withSessionPtr { ptr -> LlamaNative.nativeClearToolCallGrammar(ptr) }
     }
 
     fun applyChatTemplate(
@@ -86,18 +159,14 @@ class LlamaSession private constructor(
         contents: List<String>,
         addAssistant: Boolean
     ): String? {
-        val ptr: Long
-        synchronized(lock) {
-            checkValid()
-            ptr = sessionPtr
+        return withSessionPtr { ptr ->
+            LlamaNative.nativeApplyChatTemplate(
+                ptr,
+                roles.toTypedArray(),
+                contents.toTypedArray(),
+                addAssistant
+            )
         }
-
-        return LlamaNative.nativeApplyChatTemplate(
-            ptr,
-            roles.toTypedArray(),
-            contents.toTypedArray(),
-            addAssistant
-        )
     }
 
     fun setSamplingParams(
@@ -109,37 +178,116 @@ class LlamaSession private constructor(
         presencePenalty: Float,
         penaltyLastN: Int = 64
     ): Boolean {
-        val ptr: Long
-        synchronized(lock) {
-            checkValid()
-            ptr = sessionPtr
+        return withSessionPtr { ptr ->
+            LlamaNative.nativeSetSamplingParams(
+                ptr,
+                temperature,
+                topP,
+                topK,
+                repetitionPenalty,
+                frequencyPenalty,
+                presencePenalty,
+                penaltyLastN
+            )
         }
+    }
+
+    /**
+     * Enables speculative decoding with a small model that shares this model's vocabulary: it
+     * drafts up to [nDraft] tokens per step and this model verifies them in one batch, keeping
+     * the configured sampling. [nDraft] is capped at the session's batch size minus one. Returns
+     * false (leaving any previous draft model) when the model cannot be loaded, its vocabulary
+     * differs, or this model does not support it. A running generation keeps its draft model;
+     * the swap waits for it to finish.
+     */
+    fun setDraftModel(pathModel: String, nDraft: Int = 4): Boolean {
+        return withSessionPtr { ptr -> LlamaNative.nativeSetDraftModel(ptr, pathModel, nDraft) }
+    }
 
-        return LlamaNative.nativeSetSamplingParams(
-            ptr,
-            temperature,
-            topP,
-            topK,
-            repetitionPenalty,
-            frequencyPenalty,
-            presencePenalty,
-            penaltyLastN
+    fun clearDraftModel() {
+        withSessionPtr { ptr -> LlamaNative.nativeClearDraftModel(ptr) }
+    }
+
+    fun getPromptCacheStats(): PromptCacheStats? {
+        val values = withSessionPtr { ptr -> LlamaNative.nativeGetPromptCacheStats(ptr) } ?: return null
+        if (values.size < 5) return null
+        return PromptCacheStats(
+            lastPromptTokens = values[0],
+            lastReusedTokens = values[1],
+            lastDecodedTokens = values[2],
+            totalReusedTokens = values[3],
+            totalDecodedTokens = values[4],
+            lastRestoredTokens = values.getOrElse(5) { 0L }
         )
     }
 
+    /**
+     * Saves and restores the KV state of prompt prefixes in [dir] (created if missing), keyed by
+     * the model file and the prefix tokens, so prefixes evaluated once (see [prewarmPromptState])
+     * are not evaluated again by later sessions, including after an app restart. Each generation
+     * loads the longest saved prefix of its prompt when that is more than the KV cache already
+     * holds. Least recently used states are deleted once [dir] exceeds [maxBytes].
+     * Pass null to disable.
+     */
+    fun setPromptStateCache(dir: File?, maxBytes: Long = DEFAULT_PROMPT_STATE_CACHE_BYTES): Boolean {
+        if (dir == null) {
+            return withSessionPtr { ptr -> LlamaNative.nativeSetPromptStateCache(ptr, "", 0) }
+        }
+        if (!dir.isDirectory && !dir.mkdirs()) return false
+        return withSessionPtr { ptr -> LlamaNative.nativeSetPromptStateCache(ptr, dir.absolutePath, maxBytes) }
+    }
+
+    /**
+     * Evaluates [prompt] (e.g. the templated system prompt and tool definitions that every chat
+     * starts with) and saves its state to the prompt state cache; does nothing when it is already
+     * saved. The prompt's last token is left out, since it may tokenize differently once the rest
+     * of a conversation follows. Blocks for the prefill; returns false when no cache is set, the
+     * prompt is too long for the context, or the prefill was cancelled or failed.
+     */
+    fun prewarmPromptState(prompt: String): Boolean {
+        return withSessionPtr { ptr -> LlamaNative.nativePrewarmPromptState(ptr, prompt) }
+    }
+
+    /**
+     * File [prewarmPromptState] saves [prompt] in, whether or not it exists yet; null when no
+     * prompt state cache is set. Lets a caller check later, without loading the model, whether
+     * the state is still there.
+     */
+    fun getPromptStateFile(prompt: String): File? {
+        return withSessionPtr { ptr -> LlamaNative.nativeGetPromptStatePath(ptr, prompt) }?.let(::File)
+    }
+
+    /** Makes the next generation decode its whole prompt again instead of reusing the KV cache. */
+    fun clearPromptCache() {
+        lock.withLock {
+            if (released || sessionPtr == 0L) return
+            LlamaNative.nativeClearPromptCache(sessionPtr)
+        }
+    }
+
     fun cancel() {
-        synchronized(lock) {
+        lock.withLock {
             if (released || sessionPtr == 0L) return
             LlamaNative.nativeCancel(sessionPtr)
         }
     }
 
+    /**
+     * Frees the native session. A generation or prewarm still running on another thread is
+     * cancelled, and the session is only freed once every native call made through it returned.
+     */
     fun release() {
         val ptr: Long
-        synchronized(lock) {
+        lock.withLock {
             if (released) return
             released = true
             ptr = sessionPtr
+            if (ptr != 0L) {
+                LlamaNative.nativeBeginRelease(ptr)
+            }
+            while (callsInFlight > 0) {
+                callsDone.awaitUninterruptibly()
+            }
             sessionPtr = 0L
         }
         if (ptr != 0L) {
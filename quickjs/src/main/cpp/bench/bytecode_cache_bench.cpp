@@ -0,0 +1,172 @@
+// Host benchmark for the bytecode cache: per bundled package, the time to parse and compile
+// the source against the time to load cached bytecode, cold (file mapped, checksummed and
+// read) and warm (already in the memory tier).
+//   cmake -S quickjs/src/main/cpp -B build-qjs && cmake --build build-qjs
+//   build-qjs/quickjs_bytecode_bench [package-dir] [iterations]
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../../thirdparty/quickjs/quickjs.h"
+#include "../quickjs_bytecode_cache.h"
+
+#ifndef QUICKJS_BENCH_PACKAGE_DIR
+#define QUICKJS_BENCH_PACKAGE_DIR "."
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MicrosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+double Median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+std::vector<std::string> ListScripts(const std::string& directory) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return names;
+    }
+    while (dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".js") == 0) {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+bool LoadAndFree(JSContext* context, const quickjsjni::BytecodeBlob& blob) {
+    JSValue function = JS_ReadObject(context, blob.data(), blob.size(), JS_READ_OBJ_BYTECODE);
+    if (JS_IsException(function)) {
+        JS_FreeValue(context, JS_GetException(context));
+        return false;
+    }
+    JS_FreeValue(context, function);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::string package_dir = argc > 1 ? argv[1] : QUICKJS_BENCH_PACKAGE_DIR;
+    const int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+
+    char cache_template[] = "/tmp/qjbc_bench_XXXXXX";
+    if (mkdtemp(cache_template) == nullptr) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string cache_dir = cache_template;
+
+    JSRuntime* runtime = JS_NewRuntime();
+    JSContext* context = JS_NewContext(runtime);
+
+    std::printf("%-36s %9s %9s %11s %11s %11s %7s\n",
+                "package", "source", "bytecode", "compile_us", "cold_us", "warm_us", "speedup");
+    double total_compile = 0;
+    double total_cold = 0;
+    double total_warm = 0;
+    for (const std::string& name : ListScripts(package_dir)) {
+        const std::string source = ReadFile(package_dir + "/" + name);
+        const quickjsjni::BytecodeKey key = quickjsjni::ComputeBytecodeKey(source, name);
+
+        std::vector<double> compile_samples;
+        uint8_t* bytecode = nullptr;
+        size_t bytecode_size = 0;
+        bool compiled = true;
+        for (int i = 0; i < iterations && compiled; i += 1) {
+            const Clock::time_point start = Clock::now();
+            JSValue function = JS_Eval(context, source.c_str(), source.size(), name.c_str(),
+                                       JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+            compile_samples.push_back(MicrosSince(start));
+            if (JS_IsException(function)) {
+                JS_FreeValue(context, JS_GetException(context));
+                compiled = false;
+                break;
+            }
+            if (bytecode == nullptr) {
+                bytecode = JS_WriteObject(context, &bytecode_size, function, JS_WRITE_OBJ_BYTECODE);
+            }
+            JS_FreeValue(context, function);
+        }
+        if (!compiled || bytecode == nullptr) {
+            std::printf("%-36s skipped (does not compile as a script)\n", name.c_str());
+            continue;
+        }
+        {
+            quickjsjni::BytecodeCache writer;
+            writer.SetDirectory(cache_dir);
+            writer.Store(key, bytecode, bytecode_size);
+        }
+        js_free(context, bytecode);
+
+        // A fresh cache instance per sample, so every load goes through the file.
+        std::vector<double> cold_samples;
+        for (int i = 0; i < iterations; i += 1) {
+            quickjsjni::BytecodeCache cache;
+            cache.SetDirectory(cache_dir);
+            const Clock::time_point start = Clock::now();
+            auto blob = cache.Find(key);
+            const bool loaded = blob != nullptr && LoadAndFree(context, *blob);
+            cold_samples.push_back(MicrosSince(start));
+            if (!loaded) {
+                std::fprintf(stderr, "%s: cached bytecode did not load\n", name.c_str());
+                return 1;
+            }
+        }
+
+        quickjsjni::BytecodeCache cache;
+        cache.SetDirectory(cache_dir);
+        cache.Find(key);
+        std::vector<double> warm_samples;
+        for (int i = 0; i < iterations; i += 1) {
+            const Clock::time_point start = Clock::now();
+            auto blob = cache.Find(key);
+            LoadAndFree(context, *blob);
+            warm_samples.push_back(MicrosSince(start));
+        }
+
+        const double compile = Median(compile_samples);
+        const double cold = Median(cold_samples);
+        const double warm = Median(warm_samples);
+        total_compile += compile;
+        total_cold += cold;
+        total_warm += warm;
+        std::printf("%-36s %9zu %9zu %11.1f %11.1f %11.1f %6.1fx\n",
+                    name.c_str(), source.size(), bytecode_size, compile, cold, warm, compile / cold);
+        cache.Remove(key);
+    }
+    std::printf("%-36s %9s %9s %11.1f %11.1f %11.1f %6.1fx\n",
+                "total", "", "", total_compile, total_cold, total_warm,
+                total_cold > 0 ? total_compile / total_cold : 0.0);
+
+    JS_FreeContext(context);
+    JS_FreeRuntime(runtime);
+    rmdir(cache_dir.c_str());
+    return 0;
+}
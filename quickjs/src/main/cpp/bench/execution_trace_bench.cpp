@@ -0,0 +1,172 @@
+// Host benchmark for the per-call cost of execution tracing: the previous eager form
+// (preview strings built on every entry point and host call, recent calls kept in a vector
+// erased from the front) against quickjsjni::ExecutionTrace, which only references the
+// entry point's strings and copies bounded prefixes per host call. Each "call" is one
+// CallFunction with JSON arguments of the given size followed by a number of host calls.
+// Formatting (only done for failure envelopes) is timed separately.
+//   build-qjs/quickjs_execution_trace_bench [iterations]
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../quickjs_execution_trace.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The eager tracing QuickJsVm did before ExecutionTrace, kept here for comparison.
+std::string PreviewText(const std::string& input, size_t max_length = 240) {
+    std::string normalized;
+    normalized.reserve(input.size());
+    for (char ch : input) {
+        switch (ch) {
+            case '\r':
+            case '\n':
+            case '\t':
+                normalized += ' ';
+                break;
+            default:
+                normalized += ch;
+                break;
+        }
+    }
+    if (normalized.size() <= max_length) {
+        return normalized;
+    }
+    if (max_length <= 3) {
+        return normalized.substr(0, max_length);
+    }
+    return normalized.substr(0, max_length - 3) + "...";
+}
+
+struct EagerTrace {
+    std::string file_name;
+    size_t script_length = 0;
+    std::string script_preview;
+    std::vector<std::string> recent_host_calls;
+    size_t host_call_counter = 0;
+
+    void BeginCall(const std::string& call_site, const std::string& function_name, const std::string& args_json) {
+        const std::string normalized_args_json = args_json.empty() ? "[]" : args_json;
+        file_name = call_site;
+        script_length = normalized_args_json.size();
+        script_preview = PreviewText(std::string("call ") + function_name + "(" + normalized_args_json + ")");
+        recent_host_calls.clear();
+        host_call_counter = 0;
+    }
+
+    void RecordHostCall(const std::string& method, const std::string& args_json, size_t depth) {
+        host_call_counter += 1;
+        std::string entry =
+            "#" + std::to_string(host_call_counter) +
+            " depth=" + std::to_string(depth) +
+            " method=" + PreviewText(method, 80);
+        if (!args_json.empty()) {
+            entry += " args=" + PreviewText(args_json, 180);
+        }
+        recent_host_calls.push_back(entry);
+        if (recent_host_calls.size() > quickjsjni::ExecutionTrace::kMaxHostCalls) {
+            recent_host_calls.erase(recent_host_calls.begin());
+        }
+    }
+};
+
+std::string ArgsPayload(size_t bytes) {
+    std::string json = "[{\"path\":\"/sdcard/Download/notes.txt\",\"content\":\"";
+    while (json.size() + 4 < bytes) {
+        json += "line\\n";
+    }
+    return json + "\"}]";
+}
+
+double NanosPerCall(Clock::time_point start, int calls) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+}
+
+double Median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 15;
+    constexpr int kCallsPerSample = 2000;
+
+    const std::string call_site = "<tool:read_file>";
+    const std::string function_name = "__operitToolMain";
+    const std::string host_method = "Tools.readFile";
+    const std::string host_args = "{\"path\":\"/sdcard/Download/notes.txt\",\n\t\"encoding\":\"utf-8\",\"offset\":0,"
+        "\"limit\":65536,\"followSymlinks\":true,\"reason\":\"the tool asked for the head of the file\"}";
+
+    std::printf("%-8s %-10s %12s %12s %14s\n", "args", "host_calls", "eager_ns", "ring_ns", "ring_format_ns");
+    for (size_t args_size : {size_t(64), size_t(4) << 10, size_t(256) << 10}) {
+        const std::string args_json = ArgsPayload(args_size);
+        for (int host_calls : {0, 8, 64}) {
+            EagerTrace eager;
+            quickjsjni::ExecutionTrace ring;
+
+            // Both must describe the call identically.
+            eager.BeginCall(call_site, function_name, args_json);
+            ring.Begin(quickjsjni::ExecutionTrace::Kind::kCall, call_site, function_name, args_json, args_json.size());
+            for (int call = 0; call < host_calls; call += 1) {
+                eager.RecordHostCall(host_method, host_args, 1);
+                ring.RecordHostCall(host_method, host_args, 1);
+            }
+            if (ring.FormatScriptPreview() != eager.script_preview ||
+                ring.FormatHostCalls() != eager.recent_host_calls) {
+                std::fprintf(stderr, "args=%zu host_calls=%d: trace text differs\n", args_size, host_calls);
+                return 1;
+            }
+
+            std::vector<double> eager_ns;
+            std::vector<double> ring_ns;
+            std::vector<double> format_ns;
+            size_t sink = 0;
+            for (int i = 0; i < iterations; i += 1) {
+                Clock::time_point start = Clock::now();
+                for (int call = 0; call < kCallsPerSample; call += 1) {
+                    eager.BeginCall(call_site, function_name, args_json);
+                    for (int host_call = 0; host_call < host_calls; host_call += 1) {
+                        eager.RecordHostCall(host_method, host_args, 1);
+                    }
+                    sink += eager.recent_host_calls.size();
+                }
+                eager_ns.push_back(NanosPerCall(start, kCallsPerSample));
+
+                start = Clock::now();
+                for (int call = 0; call < kCallsPerSample; call += 1) {
+                    ring.Begin(quickjsjni::ExecutionTrace::Kind::kCall, call_site, function_name, args_json, args_json.size());
+                    for (int host_call = 0; host_call < host_calls; host_call += 1) {
+                        ring.RecordHostCall(host_method, host_args, 1);
+                    }
+                    ring.End();
+                    sink += ring.ScriptLength();
+                }
+                ring_ns.push_back(NanosPerCall(start, kCallsPerSample));
+
+                ring.Begin(quickjsjni::ExecutionTrace::Kind::kCall, call_site, function_name, args_json, args_json.size());
+                for (int host_call = 0; host_call < host_calls; host_call += 1) {
+                    ring.RecordHostCall(host_method, host_args, 1);
+                }
+                start = Clock::now();
+                sink += ring.FormatScriptPreview().size() + ring.FormatHostCalls().size();
+                format_ns.push_back(NanosPerCall(start, 1));
+                ring.End();
+            }
+            std::printf("%-8zu %-10d %12.0f %12.0f %14.0f\n",
+                        args_size, host_calls, Median(eager_ns), Median(ring_ns), Median(format_ns));
+            if (sink == 0) {
+                std::printf("\n");
+            }
+        }
+    }
+    return 0;
+}
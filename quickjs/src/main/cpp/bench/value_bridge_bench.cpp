@@ -0,0 +1,162 @@
+// Host benchmark for the binary value bridge against the JSON path it replaces, for call
+// arguments going into JS and results coming back, at 1 KB, 100 KB and 10 MB. Two payload
+// shapes: one large string (file contents) and many small records (search results). JNI
+// costs are not included; on device the JSON path additionally pays NewStringUTF /
+// GetStringUTFChars and org.json, the binary path one direct-buffer copy per string.
+//   build-qjs/quickjs_value_bridge_bench [iterations]
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../../../thirdparty/quickjs/quickjs.h"
+#include "../quickjs_value_codec.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MicrosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+double Median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+std::string TextPayload(size_t bytes) {
+    std::string text;
+    text.reserve(bytes);
+    static const char kLine[] = "    const value = compute(input, \\\"option\\\"); // ünïcode\\n";
+    while (text.size() + sizeof(kLine) < bytes) {
+        text += kLine;
+    }
+    return "[{\"path\":\"/sdcard/Download/notes.txt\",\"content\":\"" + text + "\"}]";
+}
+
+std::string RecordsPayload(size_t bytes) {
+    std::string json = "[{\"query\":\"quickjs\",\"results\":[";
+    for (int index = 0; json.size() < bytes; index += 1) {
+        if (index > 0) {
+            json += ",";
+        }
+        json += "{\"file\":\"src/module_" + std::to_string(index) +
+            ".js\",\"line\":" + std::to_string(index * 7) +
+            ",\"score\":0." + std::to_string(index % 97) +
+            ",\"match\":true,\"preview\":\"return JS_Eval(ctx, buf, len)\"}";
+    }
+    return json + "]}]";
+}
+
+std::string Stringify(JSContext* context, JSValueConst value) {
+    JSValue json = JS_JSONStringify(context, value, JS_UNDEFINED, JS_UNDEFINED);
+    size_t length = 0;
+    const char* chars = JS_ToCStringLen(context, &length, json);
+    std::string result(chars, length);
+    JS_FreeCString(context, chars);
+    JS_FreeValue(context, json);
+    return result;
+}
+
+// What CallFunction does with args_json: parse, then take the elements out one by one.
+void JsonArgumentsIn(JSContext* context, const std::string& json) {
+    JSValue parsed = JS_ParseJSON(context, json.c_str(), json.size(), "<bench>");
+    JSValue length_value = JS_GetPropertyStr(context, parsed, "length");
+    uint32_t argc = 0;
+    JS_ToUint32(context, &argc, length_value);
+    JS_FreeValue(context, length_value);
+    for (uint32_t index = 0; index < argc; index += 1) {
+        JS_FreeValue(context, JS_GetPropertyUint32(context, parsed, index));
+    }
+    JS_FreeValue(context, parsed);
+}
+
+void BinaryArgumentsIn(JSContext* context, quickjsjni::ValueCodec* codec, const std::vector<uint8_t>& bytes) {
+    std::vector<JSValue> argv;
+    codec->DecodeArguments(bytes.data(), bytes.size(), &argv);
+    for (JSValue& value : argv) {
+        JS_FreeValue(context, value);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 15;
+
+    JSRuntime* runtime = JS_NewRuntime();
+    JSContext* context = JS_NewContext(runtime);
+    {
+        quickjsjni::ValueCodec codec(context);
+
+        std::printf("%-8s %-7s %10s %10s %12s %12s %12s %12s\n",
+                    "shape", "size", "json_B", "binary_B", "json_in_us", "bin_in_us", "json_out_us", "bin_out_us");
+        const std::pair<const char*, size_t> sizes[] = {
+            {"1KB", 1u << 10},
+            {"100KB", 100u << 10},
+            {"10MB", 10u << 20},
+        };
+        for (const char* shape : {"text", "records"}) {
+            for (const auto& size : sizes) {
+                const std::string json = std::string(shape) == "text"
+                    ? TextPayload(size.second)
+                    : RecordsPayload(size.second);
+                JSValue args = JS_ParseJSON(context, json.c_str(), json.size(), "<bench>");
+                JSValue payload = JS_GetPropertyUint32(context, args, 0);
+
+                std::vector<uint8_t> encoded_args;
+                JSValue first = payload;
+                codec.EncodeArguments(1, &first, &encoded_args);
+
+                // The codec must reproduce the value exactly.
+                std::vector<JSValue> decoded;
+                codec.DecodeArguments(encoded_args.data(), encoded_args.size(), &decoded);
+                if (decoded.size() != 1 || Stringify(context, decoded[0]) != Stringify(context, payload)) {
+                    std::fprintf(stderr, "%s %s: binary round trip differs from JSON\n", shape, size.first);
+                    return 1;
+                }
+                JS_FreeValue(context, decoded[0]);
+
+                std::vector<double> json_in;
+                std::vector<double> binary_in;
+                std::vector<double> json_out;
+                std::vector<double> binary_out;
+                std::vector<uint8_t> encoded_result;
+                for (int i = 0; i < iterations; i += 1) {
+                    Clock::time_point start = Clock::now();
+                    JsonArgumentsIn(context, json);
+                    json_in.push_back(MicrosSince(start));
+
+                    start = Clock::now();
+                    BinaryArgumentsIn(context, &codec, encoded_args);
+                    binary_in.push_back(MicrosSince(start));
+
+                    // Results: SerializeValue's JSON text against an encode into a reused buffer.
+                    start = Clock::now();
+                    std::string text = Stringify(context, payload);
+                    json_out.push_back(MicrosSince(start));
+
+                    start = Clock::now();
+                    encoded_result.clear();
+                    codec.Encode(payload, &encoded_result);
+                    binary_out.push_back(MicrosSince(start));
+                }
+
+                std::printf("%-8s %-7s %10zu %10zu %12.1f %12.1f %12.1f %12.1f\n",
+                            shape, size.first, json.size(), encoded_args.size(),
+                            Median(json_in), Median(binary_in), Median(json_out), Median(binary_out));
+                JS_FreeValue(context, payload);
+                JS_FreeValue(context, args);
+            }
+        }
+    }
+    JS_FreeContext(context);
+    JS_FreeRuntime(runtime);
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include "quickjs_arena_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace quickjsjni {
+
+namespace {
+
+constexpr size_t kAlignment = 16;
+
+// In front of every block; keeps the payload 16-byte aligned.
+struct BlockHeader {
+    size_t usable;
+    size_t large;
+};
+
+static_assert(sizeof(BlockHeader) == kAlignment, "header must preserve alignment");
+
+BlockHeader* HeaderOf(const void* pointer) {
+    return reinterpret_cast<BlockHeader*>(const_cast<uint8_t*>(static_cast<const uint8_t*>(pointer)) - sizeof(BlockHeader));
+}
+
+size_t RoundUp(size_t size) {
+    return (std::max<size_t>(size, 1) + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+size_t ClassOf(size_t usable) {
+    return usable / kAlignment - 1;
+}
+
+}  // namespace
+
+struct ArenaAllocator::LargeBlock {
+    LargeBlock* previous;
+    LargeBlock* next;
+};
+
+ArenaAllocator::ArenaAllocator(size_t chunk_size)
+    : chunk_size_(std::max(chunk_size, kMaxSmallBlock + sizeof(BlockHeader))),
+      free_lists_(ClassOf(kMaxSmallBlock) + 1, nullptr) {}
+
+ArenaAllocator::~ArenaAllocator() {
+    ReleaseAll();
+}
+
+const JSMallocFunctions& ArenaAllocator::MallocFunctions() {
+    static const JSMallocFunctions functions = {
+        &ArenaAllocator::JsMalloc,
+        &ArenaAllocator::JsFree,
+        &ArenaAllocator::JsRealloc,
+        &ArenaAllocator::JsUsableSize,
+    };
+    return functions;
+}
+
+void ArenaAllocator::Reset() {
+    ReleaseAll();
+    const uint64_t peak = stats_.peak_live_bytes;
+    const uint64_t resets = stats_.resets + 1;
+    stats_ = ArenaStats();
+    stats_.peak_live_bytes = peak;
+    stats_.resets = resets;
+}
+
+ArenaStats ArenaAllocator::Stats() const {
+    return stats_;
+}
+
+void* ArenaAllocator::Allocate(size_t size) {
+    const size_t usable = RoundUp(size);
+    if (usable > kMaxSmallBlock) {
+        return AllocateLarge(usable);
+    }
+
+    void*& free_list = free_lists_[ClassOf(usable)];
+    void* pointer = free_list;
+    if (pointer != nullptr) {
+        std::memcpy(&free_list, pointer, sizeof(void*));
+    } else {
+        const size_t needed = sizeof(BlockHeader) + usable;
+        if (cursor_ == nullptr || static_cast<size_t>(chunk_end_ - cursor_) < needed) {
+            // The tail of the old chunk is abandoned; at most kMaxSmallBlock per chunk.
+            void* chunk = std::malloc(chunk_size_);
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+            chunks_.push_back(chunk);
+            stats_.reserved_bytes += chunk_size_;
+            cursor_ = static_cast<uint8_t*>(chunk);
+            chunk_end_ = cursor_ + chunk_size_;
+        }
+        auto* header = reinterpret_cast<BlockHeader*>(cursor_);
+        header->usable = usable;
+        header->large = 0;
+        pointer = cursor_ + sizeof(BlockHeader);
+        cursor_ += needed;
+    }
+    stats_.live_bytes += usable;
+    stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+    return pointer;
+}
+
+void* ArenaAllocator::AllocateLarge(size_t usable) {
+    auto* block = static_cast<LargeBlock*>(std::malloc(sizeof(LargeBlock) + kAlignment + usable));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    block->previous = nullptr;
+    block->next = large_blocks_;
+    if (large_blocks_ != nullptr) {
+        large_blocks_->previous = block;
+    }
+    large_blocks_ = block;
+
+    // LargeBlock is two pointers; pad so the header ends on a 16-byte boundary.
+    auto* header = reinterpret_cast<BlockHeader*>(reinterpret_cast<uint8_t*>(block) + sizeof(LargeBlock) + kAlignment - sizeof(BlockHeader));
+    header->usable = usable;
+    header->large = 1;
+    stats_.large_blocks += 1;
+    stats_.reserved_bytes += usable;
+    stats_.live_bytes += usable;
+    stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+    return reinterpret_cast<uint8_t*>(header) + sizeof(BlockHeader);
+}
+
+void ArenaAllocator::Free(void* pointer) {
+    if (pointer == nullptr) {
+        return;
+    }
+    BlockHeader* header = HeaderOf(pointer);
+    stats_.live_bytes -= header->usable;
+    if (header->large == 0) {
+        void*& free_list = free_lists_[ClassOf(header->usable)];
+        std::memcpy(pointer, &free_list, sizeof(void*));
+        free_list = pointer;
+        return;
+    }
+
+    auto* block = reinterpret_cast<LargeBlock*>(reinterpret_cast<uint8_t*>(header) + sizeof(BlockHeader) - kAlignment - sizeof(LargeBlock));
+    if (block->previous != nullptr) {
+        block->previous->next = block->next;
+    } else {
+        large_blocks_ = block->next;
+    }
+    if (block->next != nullptr) {
+        block->next->previous = block->previous;
+    }
+    stats_.large_blocks -= 1;
+    stats_.reserved_bytes -= header->usable;
+    std::free(block);
+}
+
+void* ArenaAllocator::Reallocate(void* pointer, size_t size) {
+    if (pointer == nullptr) {
+        return Allocate(size);
+    }
+    if (size == 0) {
+        Free(pointer);
+        return nullptr;
+    }
+    const size_t old_usable = HeaderOf(pointer)->usable;
+    if (RoundUp(size) <= old_usable) {
+        return pointer;
+    }
+    void* grown = Allocate(size);
+    if (grown == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(grown, pointer, old_usable);
+    Free(pointer);
+    return grown;
+}
+
+void ArenaAllocator::ReleaseAll() {
+    for (void* chunk : chunks_) {
+        std::free(chunk);
+    }
+    chunks_.clear();
+    cursor_ = nullptr;
+    chunk_end_ = nullptr;
+    std::fill(free_lists_.begin(), free_lists_.end(), nullptr);
+    while (large_blocks_ != nullptr) {
+        LargeBlock* next = large_blocks_->next;
+        std::free(large_blocks_);
+        large_blocks_ = next;
+    }
+}
+
+// The JSMallocFunctions contract: keep the runtime's malloc_count / malloc_size current and
+// refuse allocations past malloc_limit, as QuickJS's default allocator does.
+void* ArenaAllocator::JsMalloc(JSMallocState* state, size_t size) {
+    if (state->malloc_size + size > state->malloc_limit) {
+        return nullptr;
+    }
+    auto* arena = static_cast<ArenaAllocator*>(state->opaque);
+    void* pointer = arena->Allocate(size);
+    if (pointer != nullptr) {
+        state->malloc_count += 1;
+        state->malloc_size += JsUsableSize(pointer) + sizeof(BlockHeader);
+    }
+    return pointer;
+}
+
+void ArenaAllocator::JsFree(JSMallocState* state, void* pointer) {
+    if (pointer == nullptr) {
+        return;
+    }
+    state->malloc_count -= 1;
+    state->malloc_size -= JsUsableSize(pointer) + sizeof(BlockHeader);
+    static_cast<ArenaAllocator*>(state->opaque)->Free(pointer);
+}
+
+void* ArenaAllocator::JsRealloc(JSMallocState* state, void* pointer, size_t size) {
+    if (pointer == nullptr) {
+        return size == 0 ? nullptr : JsMalloc(state, size);
+    }
+    const size_t old_size = JsUsableSize(pointer);
+    if (size == 0) {
+        JsFree(state, pointer);
+        return nullptr;
+    }
+    if (state->malloc_size + size - old_size > state->malloc_limit) {
+        return nullptr;
+    }
+    void* resized = static_cast<ArenaAllocator*>(state->opaque)->Reallocate(pointer, size);
+    if (resized != nullptr) {
+        state->malloc_size += JsUsableSize(resized);
+        state->malloc_size -= old_size;
+    }
+    return resized;
+}
+
+size_t ArenaAllocator::JsUsableSize(const void* pointer) {
+    return pointer == nullptr ? 0 : HeaderOf(pointer)->usable;
+}
+
+}  // namespace quickjsjni
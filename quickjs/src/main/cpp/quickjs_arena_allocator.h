@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../../thirdparty/quickjs/quickjs.h"
+
+namespace quickjsjni {
+
+struct ArenaStats {
+    uint64_t reserved_bytes = 0;
+    uint64_t live_bytes = 0;
+    uint64_t peak_live_bytes = 0;
+    uint64_t large_blocks = 0;
+    uint64_t resets = 0;
+};
+
+// Allocator for one JSRuntime (JS_NewRuntime2 with MallocFunctions() and the arena as
+// opaque). Small blocks are carved from large chunks and recycled through per-size free
+// lists; big ones go to malloc. Reset() drops everything at once, so a runtime that is
+// thrown away between tool runs costs no per-object frees: the caller simply abandons it
+// (never JS_FreeRuntime after Reset) and creates a new one on the same arena. Not
+// thread-safe, like the runtime it serves.
+class ArenaAllocator {
+public:
+    explicit ArenaAllocator(size_t chunk_size = kDefaultChunkSize);
+    ~ArenaAllocator();
+
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    static const JSMallocFunctions& MallocFunctions();
+
+    void Reset();
+
+    ArenaStats Stats() const;
+
+    static constexpr size_t kDefaultChunkSize = 1u << 20;
+    static constexpr size_t kMaxSmallBlock = 4096;
+
+private:
+    struct LargeBlock;
+
+    void* Allocate(size_t size);
+    void Free(void* pointer);
+    void* Reallocate(void* pointer, size_t size);
+    void* AllocateLarge(size_t usable);
+    void ReleaseAll();
+
+    static void* JsMalloc(JSMallocState* state, size_t size);
+    static void JsFree(JSMallocState* state, void* pointer);
+    static void* JsRealloc(JSMallocState* state, void* pointer, size_t size);
+    static size_t JsUsableSize(const void* pointer);
+
+    const size_t chunk_size_;
+    std::vector<void*> chunks_;
+    uint8_t* cursor_ = nullptr;
+    uint8_t* chunk_end_ = nullptr;
+    std::vector<void*> free_lists_;
+    LargeBlock* large_blocks_ = nullptr;
+    ArenaStats stats_;
+};
+
+}  // namespace quickjsjni
@@ -0,0 +1,281 @@
+#include "quickjs_bytecode_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#ifndef CONFIG_VERSION
+#define CONFIG_VERSION "unknown"
+#endif
+
+namespace quickjsjni {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'Q', 'J', 'B', 'C'};
+constexpr uint32_t kFileFormatVersion = 1;
+
+// Fixed-size header in front of the bytecode; the file is only valid on the device and
+// QuickJS build that wrote it.
+struct FileHeader {
+    char magic[4];
+    uint32_t format_version;
+    uint64_t key_hash;
+    uint64_t source_length;
+    uint64_t bytecode_length;
+    uint64_t bytecode_checksum;
+    uint32_t pointer_size;
+    char quickjs_version[28];
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "bytecode must start 8-byte aligned");
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t index = 0; index < size; index += 1) {
+        hash = (hash ^ bytes[index]) * kFnvPrime;
+    }
+    return hash;
+}
+
+void FillVersion(char (&out)[28]) {
+    std::memset(out, 0, sizeof(out));
+    std::strncpy(out, CONFIG_VERSION, sizeof(out) - 1);
+}
+
+class HeapBytecode final : public BytecodeBlob {
+public:
+    HeapBytecode(const uint8_t* bytecode, size_t size) : bytes_(bytecode, bytecode + size) {}
+
+    const uint8_t* data() const override { return bytes_.data(); }
+    size_t size() const override { return bytes_.size(); }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+class MappedBytecode final : public BytecodeBlob {
+public:
+    MappedBytecode(void* mapping, size_t mapping_size)
+        : mapping_(mapping), mapping_size_(mapping_size) {}
+
+    ~MappedBytecode() override {
+        munmap(mapping_, mapping_size_);
+    }
+
+    const uint8_t* data() const override {
+        return static_cast<const uint8_t*>(mapping_) + sizeof(FileHeader);
+    }
+    size_t size() const override { return mapping_size_ - sizeof(FileHeader); }
+
+private:
+    void* mapping_;
+    size_t mapping_size_;
+};
+
+}  // namespace
+
+BytecodeKey ComputeBytecodeKey(const std::string& source, const std::string& file_name) {
+    static constexpr char kVersion[] = CONFIG_VERSION;
+    uint64_t hash = Fnv1a(kFnvOffset, kVersion, sizeof(kVersion));
+    hash = Fnv1a(hash, file_name.c_str(), file_name.size() + 1);
+    hash = Fnv1a(hash, source.data(), source.size());
+    BytecodeKey key;
+    key.hash = hash;
+    key.source_length = source.size();
+    return key;
+}
+
+BytecodeCache& BytecodeCache::Instance() {
+    static BytecodeCache cache;
+    return cache;
+}
+
+BytecodeCache::BytecodeCache(size_t memory_budget_bytes)
+    : memory_budget_(memory_budget_bytes) {}
+
+void BytecodeCache::SetDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> guard(lock_);
+    directory_ = directory;
+    while (!directory_.empty() && directory_.back() == '/') {
+        directory_.pop_back();
+    }
+}
+
+std::shared_ptr<const BytecodeBlob> BytecodeCache::Find(const BytecodeKey& key) {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = index_.find(key.hash);
+        if (it != index_.end() && it->second->key.source_length == key.source_length) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            stats_.memory_hits += 1;
+            return it->second->blob;
+        }
+    }
+
+    std::shared_ptr<const BytecodeBlob> mapped = MapFile(key);
+    std::lock_guard<std::mutex> guard(lock_);
+    if (mapped == nullptr) {
+        stats_.misses += 1;
+        return nullptr;
+    }
+    stats_.disk_hits += 1;
+    Remember(key, mapped);
+    return mapped;
+}
+
+void BytecodeCache::Store(const BytecodeKey& key, const uint8_t* bytecode, size_t size) {
+    if (bytecode == nullptr || size == 0) {
+        return;
+    }
+    WriteFile(key, bytecode, size);
+    std::lock_guard<std::mutex> guard(lock_);
+    stats_.stores += 1;
+    Remember(key, std::make_shared<HeapBytecode>(bytecode, size));
+}
+
+void BytecodeCache::Remove(const BytecodeKey& key) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        Forget(key.hash);
+        path = FilePath(key);
+    }
+    if (!path.empty()) {
+        unlink(path.c_str());
+    }
+}
+
+void BytecodeCache::ClearMemory() {
+    std::lock_guard<std::mutex> guard(lock_);
+    lru_.clear();
+    index_.clear();
+    stats_.memory_bytes = 0;
+}
+
+BytecodeCacheStats BytecodeCache::Stats() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return stats_;
+}
+
+std::string BytecodeCache::FilePath(const BytecodeKey& key) const {
+    if (directory_.empty()) {
+        return "";
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.qjbc", static_cast<unsigned long long>(key.hash));
+    return directory_ + name;
+}
+
+std::shared_ptr<const BytecodeBlob> BytecodeCache::MapFile(const BytecodeKey& key) const {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        path = FilePath(key);
+    }
+    if (path.empty()) {
+        return nullptr;
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= static_cast<off_t>(sizeof(FileHeader))) {
+        close(fd);
+        return nullptr;
+    }
+    const auto mapping_size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto blob = std::make_shared<MappedBytecode>(mapping, mapping_size);
+
+    FileHeader header {};
+    std::memcpy(&header, mapping, sizeof(header));
+    FileHeader expected {};
+    FillVersion(expected.quickjs_version);
+    if (std::memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        header.format_version != kFileFormatVersion ||
+        header.key_hash != key.hash ||
+        header.source_length != key.source_length ||
+        header.bytecode_length != blob->size() ||
+        header.pointer_size != sizeof(void*) ||
+        std::memcmp(header.quickjs_version, expected.quickjs_version, sizeof(header.quickjs_version)) != 0 ||
+        header.bytecode_checksum != Fnv1a(kFnvOffset, blob->data(), blob->size())) {
+        return nullptr;
+    }
+    return blob;
+}
+
+void BytecodeCache::WriteFile(const BytecodeKey& key, const uint8_t* bytecode, size_t size) const {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        path = FilePath(key);
+    }
+    if (path.empty()) {
+        return;
+    }
+
+    FileHeader header {};
+    std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.format_version = kFileFormatVersion;
+    header.key_hash = key.hash;
+    header.source_length = key.source_length;
+    header.bytecode_length = size;
+    header.bytecode_checksum = Fnv1a(kFnvOffset, bytecode, size);
+    header.pointer_size = sizeof(void*);
+    FillVersion(header.quickjs_version);
+
+    // Written under a temporary name and renamed, so readers never map a partial file.
+    const std::string temp_path = path + ".tmp" +
+        std::to_string(static_cast<long long>(getpid())) + "_" +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (file == nullptr) {
+        return;
+    }
+    const bool written =
+        std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(bytecode, 1, size, file) == size;
+    const bool closed = std::fclose(file) == 0;
+    if (!written || !closed || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        unlink(temp_path.c_str());
+    }
+}
+
+void BytecodeCache::Remember(const BytecodeKey& key, std::shared_ptr<const BytecodeBlob> blob) {
+    Forget(key.hash);
+    stats_.memory_bytes += blob->size();
+    lru_.push_front(Entry {key, std::move(blob)});
+    index_[key.hash] = lru_.begin();
+    while (stats_.memory_bytes > memory_budget_ && lru_.size() > 1) {
+        Forget(lru_.back().key.hash);
+    }
+}
+
+void BytecodeCache::Forget(uint64_t hash) {
+    auto it = index_.find(hash);
+    if (it == index_.end()) {
+        return;
+    }
+    stats_.memory_bytes -= it->second->blob->size();
+    lru_.erase(it->second);
+    index_.erase(it);
+}
+
+}  // namespace quickjsjni
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace quickjsjni {
+
+// Identifies compiled bytecode: a hash of the QuickJS version, the file name (it ends up in
+// stack traces) and the source, plus the source length.
+struct BytecodeKey {
+    uint64_t hash = 0;
+    uint64_t source_length = 0;
+};
+
+BytecodeKey ComputeBytecodeKey(const std::string& source, const std::string& file_name);
+
+// Bytecode produced by JS_WriteObject, either held in memory or mapped from a cache file.
+class BytecodeBlob {
+public:
+    virtual ~BytecodeBlob() = default;
+    virtual const uint8_t* data() const = 0;
+    virtual size_t size() const = 0;
+};
+
+struct BytecodeCacheStats {
+    uint64_t memory_hits = 0;
+    uint64_t disk_hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t memory_bytes = 0;
+};
+
+// Process-wide cache of compiled scripts shared by all VMs (bytecode does not depend on the
+// runtime that wrote it). Entries live in memory up to a byte budget and, once a directory
+// is set, in one file per key that later processes map instead of re-parsing the source.
+// Files carry the QuickJS version and a checksum; anything that does not match is ignored
+// and overwritten, since JS_ReadObject trusts its input.
+class BytecodeCache {
+public:
+    static BytecodeCache& Instance();
+
+    explicit BytecodeCache(size_t memory_budget_bytes = kDefaultMemoryBudget);
+
+    BytecodeCache(const BytecodeCache&) = delete;
+    BytecodeCache& operator=(const BytecodeCache&) = delete;
+
+    // Empty disables the disk tier. The directory must exist.
+    void SetDirectory(const std::string& directory);
+
+    std::shared_ptr<const BytecodeBlob> Find(const BytecodeKey& key);
+    void Store(const BytecodeKey& key, const uint8_t* bytecode, size_t size);
+
+    // Drops an entry that failed to load, in memory and on disk.
+    void Remove(const BytecodeKey& key);
+
+    // Forgets the memory tier (files stay).
+    void ClearMemory();
+
+    BytecodeCacheStats Stats() const;
+
+    static constexpr size_t kDefaultMemoryBudget = 16u << 20;
+
+private:
+    struct Entry {
+        BytecodeKey key;
+        std::shared_ptr<const BytecodeBlob> blob;
+    };
+
+    std::string FilePath(const BytecodeKey& key) const;
+    std::shared_ptr<const BytecodeBlob> MapFile(const BytecodeKey& key) const;
+    void WriteFile(const BytecodeKey& key, const uint8_t* bytecode, size_t size) const;
+    void Remember(const BytecodeKey& key, std::shared_ptr<const BytecodeBlob> blob);
+    void Forget(uint64_t hash);
+
+    const size_t memory_budget_;
+    mutable std::mutex lock_;
+    std::string directory_;
+
+    // Most recently used first.
+    std::list<Entry> lru_;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    BytecodeCacheStats stats_;
+};
+
+}  // namespace quickjsjni
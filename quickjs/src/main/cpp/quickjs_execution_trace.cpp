@@ -0,0 +1,147 @@
+#include "quickjs_execution_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace quickjsjni {
+
+namespace {
+
+// Appends up to max_length chars of input with line breaks and tabs turned into spaces;
+// longer input keeps max_length - 3 chars and ends in "...". total_length is the length of
+// the original text when input is only its stored prefix.
+void AppendPreview(std::string* out, std::string_view input, size_t total_length, size_t max_length) {
+    size_t take = total_length;
+    const bool truncated = total_length > max_length;
+    if (truncated) {
+        take = max_length <= 3 ? max_length : max_length - 3;
+    }
+    take = std::min(take, input.size());
+    for (size_t index = 0; index < take; index += 1) {
+        const char ch = input[index];
+        *out += (ch == '\r' || ch == '\n' || ch == '\t') ? ' ' : ch;
+    }
+    if (truncated && max_length > 3) {
+        *out += "...";
+    }
+}
+
+}  // namespace
+
+void ExecutionTrace::Begin(
+    Kind kind,
+    std::string_view file_name,
+    std::string_view subject,
+    std::string_view args,
+    size_t script_length
+) {
+    kind_ = kind;
+    file_name_ = file_name;
+    subject_ = subject;
+    args_ = args;
+    script_length_ = script_length;
+    host_call_count_ = 0;
+}
+
+void ExecutionTrace::End() {
+    kind_ = Kind::kNone;
+    file_name_ = std::string_view();
+    subject_ = std::string_view();
+    args_ = std::string_view();
+}
+
+ExecutionTrace::HostCallRecord& ExecutionTrace::NextRecord(std::string_view method, size_t depth) {
+    host_call_count_ += 1;
+    HostCallRecord& record = host_calls_[(host_call_count_ - 1) % kMaxHostCalls];
+    record.number = host_call_count_;
+    record.depth = static_cast<uint32_t>(depth);
+    record.method_length = method.size();
+    std::memcpy(record.method, method.data(), std::min(method.size(), kMethodPreviewLength));
+    return record;
+}
+
+void ExecutionTrace::RecordHostCall(std::string_view method, std::string_view args_json, size_t depth) {
+    HostCallRecord& record = NextRecord(method, depth);
+    record.binary = false;
+    record.args_length = args_json.size();
+    std::memcpy(record.args, args_json.data(), std::min(args_json.size(), kArgsPreviewLength));
+}
+
+void ExecutionTrace::RecordBinaryHostCall(std::string_view method, size_t args_bytes, size_t depth) {
+    HostCallRecord& record = NextRecord(method, depth);
+    record.binary = true;
+    record.args_length = args_bytes;
+}
+
+std::string ExecutionTrace::FileName() const {
+    return std::string(file_name_);
+}
+
+size_t ExecutionTrace::ScriptLength() const {
+    return script_length_;
+}
+
+std::string ExecutionTrace::FormatScriptPreview() const {
+    std::string preview;
+    switch (kind_) {
+        case Kind::kNone:
+            break;
+        case Kind::kScript:
+            AppendPreview(&preview, subject_, subject_.size(), kScriptPreviewLength);
+            break;
+        case Kind::kCall: {
+            // Only the visible prefix of the arguments is copied.
+            std::string call = "call ";
+            call += subject_;
+            call += "(";
+            call += args_.substr(0, kScriptPreviewLength);
+            call += ")";
+            const size_t total_length = 5 + subject_.size() + 1 + args_.size() + 1;
+            AppendPreview(&preview, call, total_length, kScriptPreviewLength);
+            break;
+        }
+        case Kind::kBinaryCall: {
+            std::string call = "call ";
+            call += subject_;
+            call += "(<" + std::to_string(script_length_) + " bytes>)";
+            AppendPreview(&preview, call, call.size(), kScriptPreviewLength);
+            break;
+        }
+    }
+    return preview;
+}
+
+std::vector<std::string> ExecutionTrace::FormatHostCalls() const {
+    const uint64_t count = std::min<uint64_t>(host_call_count_, kMaxHostCalls);
+    std::vector<std::string> entries;
+    entries.reserve(static_cast<size_t>(count));
+    for (uint64_t number = host_call_count_ - count + 1; number <= host_call_count_; number += 1) {
+        const HostCallRecord& record = host_calls_[(number - 1) % kMaxHostCalls];
+        std::string entry = "#" + std::to_string(record.number) +
+            " depth=" + std::to_string(record.depth) + " method=";
+        AppendPreview(
+            &entry,
+            std::string_view(record.method, std::min<uint64_t>(record.method_length, kMethodPreviewLength)),
+            static_cast<size_t>(record.method_length),
+            kMethodPreviewLength
+        );
+        if (record.binary) {
+            const std::string size = "<" + std::to_string(record.args_length) + " bytes>";
+            entry += " args=";
+            AppendPreview(&entry, size, size.size(), kArgsPreviewLength);
+        } else if (record.args_length > 0) {
+            entry += " args=";
+            AppendPreview(
+                &entry,
+                std::string_view(record.args, std::min<uint64_t>(record.args_length, kArgsPreviewLength)),
+                static_cast<size_t>(record.args_length),
+                kArgsPreviewLength
+            );
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+}  // namespace quickjsjni
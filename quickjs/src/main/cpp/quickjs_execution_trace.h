@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace quickjsjni {
+
+// What a VM entry point is running and the last host calls it made, for the details of a
+// failure envelope. Recording is cheap enough for every call: the entry point's strings are
+// referenced, not copied, and a host call copies bounded prefixes into a fixed ring slot.
+// Text (whitespace flattened, "..." on truncation) is only produced by the Format calls.
+// The VM records and formats under its own lock, so the ring needs no locking or
+// allocation of its own.
+class ExecutionTrace {
+public:
+    enum class Kind {
+        kNone,
+        kScript,
+        kCall,
+        kBinaryCall,
+    };
+
+    // subject is the script, or the function name for calls; args the JSON arguments of a
+    // kCall. All three must stay valid until End(). script_length is what the envelope
+    // reports as scriptLength.
+    void Begin(
+        Kind kind,
+        std::string_view file_name,
+        std::string_view subject,
+        std::string_view args,
+        size_t script_length
+    );
+
+    // Forgets the borrowed strings; the host call ring stays until the next Begin.
+    void End();
+
+    void RecordHostCall(std::string_view method, std::string_view args_json, size_t depth);
+    void RecordBinaryHostCall(std::string_view method, size_t args_bytes, size_t depth);
+
+    std::string FileName() const;
+    size_t ScriptLength() const;
+    std::string FormatScriptPreview() const;
+    // Oldest first, "#<n> depth=<d> method=<m>[ args=<a>]".
+    std::vector<std::string> FormatHostCalls() const;
+
+    static constexpr size_t kMaxHostCalls = 24;
+    static constexpr size_t kScriptPreviewLength = 240;
+    static constexpr size_t kMethodPreviewLength = 80;
+    static constexpr size_t kArgsPreviewLength = 180;
+
+private:
+    struct HostCallRecord {
+        uint64_t number = 0;
+        uint32_t depth = 0;
+        bool binary = false;
+        uint64_t method_length = 0;
+        // Original length of the JSON args, or the buffer size of a binary call.
+        uint64_t args_length = 0;
+        char method[kMethodPreviewLength];
+        char args[kArgsPreviewLength];
+    };
+
+    HostCallRecord& NextRecord(std::string_view method, size_t depth);
+
+    Kind kind_ = Kind::kNone;
+    std::string_view file_name_;
+    std::string_view subject_;
+    std::string_view args_;
+    size_t script_length_ = 0;
+    uint64_t host_call_count_ = 0;
+    HostCallRecord host_calls_[kMaxHostCalls];
+};
+
+}  // namespace quickjsjni
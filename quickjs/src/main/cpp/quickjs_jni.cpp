@@ -1,14 +1,25 @@
 #include <jni.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../../../thirdparty/quickjs/quickjs.h"
+#include "quickjs_arena_allocator.h"
+#include "quickjs_bytecode_cache.h"
+#include "quickjs_execution_trace.h"
+#include "quickjs_lease_scheduler.h"
+#include "quickjs_value_codec.h"
 
 namespace {
 
@@ -56,30 +67,6 @@ std::string QuoteJson(const std::string& input) {
     return "\"" + EscapeJson(input) + "\"";
 }
 
-std::string PreviewText(const std::string& input, size_t max_length = 240) {
-    std::string normalized;
-    normalized.reserve(input.size());
-    for (char ch : input) {
-        switch (ch) {
-            case '\r':
-            case '\n':
-            case '\t':
-                normalized += ' ';
-                break;
-            default:
-                normalized += ch;
-                break;
-        }
-    }
-    if (normalized.size() <= max_length) {
-        return normalized;
-    }
-    if (max_length <= 3) {
-        return normalized.substr(0, max_length);
-    }
-    return normalized.substr(0, max_length - 3) + "...";
-}
-
 std::string BuildJsonStringArray(const std::vector<std::string>& values) {
     std::string json = "[";
     for (size_t index = 0; index < values.size(); index += 1) {
@@ -124,6 +111,52 @@ std::string JsValueToString(JSContext* context, JSValueConst value) {
     return result;
 }
 
+// JS_ToCStringLen of a value, borrowed for the holder's scope instead of copied into a
+// std::string. Empty (and still NUL-terminated) for no value or a failed conversion.
+class ScopedJsCString {
+public:
+    explicit ScopedJsCString(JSContext* context) : context_(context) {}
+
+    ScopedJsCString(JSContext* context, JSValueConst value) : context_(context) {
+        chars_ = JS_ToCStringLen(context, &length_, value);
+        if (chars_ == nullptr) {
+            length_ = 0;
+        }
+    }
+
+    ~ScopedJsCString() {
+        if (chars_ != nullptr) {
+            JS_FreeCString(context_, chars_);
+        }
+    }
+
+    ScopedJsCString(const ScopedJsCString&) = delete;
+    ScopedJsCString& operator=(const ScopedJsCString&) = delete;
+
+    const char* c_str() const {
+        return chars_ != nullptr ? chars_ : "";
+    }
+
+    std::string_view view() const {
+        return std::string_view(c_str(), length_);
+    }
+
+private:
+    JSContext* context_;
+    const char* chars_ = nullptr;
+    size_t length_ = 0;
+};
+
+JSValue ThrowHostCallError(JSContext* context, std::string_view method, const char* reason) {
+    return JS_ThrowInternalError(
+        context,
+        "Host call failed for %.*s: %s",
+        static_cast<int>(method.size()),
+        method.data(),
+        reason
+    );
+}
+
 std::optional<std::string> GetExceptionPropertyString(
     JSContext* context,
     JSValueConst exception,
@@ -262,33 +295,76 @@ std::optional<std::string> TakeJavaExceptionMessage(JNIEnv* env) {
     return DescribeJavaThrowable(env, throwable);
 }
 
-struct HostCallResult {
-    std::optional<std::string> value;
-    std::optional<std::string> error;
-};
+// JNIEnv of the calling thread. A thread the JVM did not start is attached on its first
+// host call and stays attached until it exits, instead of attaching around every call.
+JNIEnv* CurrentJniEnv(JavaVM* java_vm) {
+    struct Attachment {
+        JavaVM* java_vm = nullptr;
+        JNIEnv* env = nullptr;
+        bool attached = false;
 
-class QuickJsVm {
-public:
-    QuickJsVm(JavaVM* java_vm, JNIEnv* env, jobject host_bridge)
-        : java_vm_(java_vm), interrupted_(false) {
-        runtime_ = JS_NewRuntime();
-        if (runtime_ == nullptr) {
-            throw std::runtime_error("JS_NewRuntime failed");
+        ~Attachment() {
+            if (attached) {
+                java_vm->DetachCurrentThread();
+            }
         }
+    };
+    thread_local Attachment attachment;
+    if (attachment.env != nullptr && attachment.java_vm == java_vm) {
+        return attachment.env;
+    }
 
-        context_ = JS_NewContext(runtime_);
-        if (context_ == nullptr) {
-            JS_FreeRuntime(runtime_);
-            runtime_ = nullptr;
-            throw std::runtime_error("JS_NewContext failed");
+    JNIEnv* env = nullptr;
+    bool attached = false;
+    if (java_vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        if (java_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            return nullptr;
         }
+        attached = true;
+    }
+    attachment.java_vm = java_vm;
+    attachment.env = env;
+    attachment.attached = attached;
+    return env;
+}
+
+// Ends an entry point's trace when the entry point returns, since the trace borrows its
+// arguments.
+class ScopedExecutionTrace {
+public:
+    explicit ScopedExecutionTrace(quickjsjni::ExecutionTrace* trace) : trace_(trace) {}
+
+    ~ScopedExecutionTrace() {
+        trace_->End();
+    }
+
+    ScopedExecutionTrace(const ScopedExecutionTrace&) = delete;
+    ScopedExecutionTrace& operator=(const ScopedExecutionTrace&) = delete;
 
+private:
+    quickjsjni::ExecutionTrace* trace_;
+};
+
+// Fixed at creation; zero leaves the QuickJS default.
+struct VmOptions {
+    size_t memory_limit_bytes = 0;
+    size_t gc_threshold_bytes = 0;
+    size_t max_stack_size_bytes = 0;
+    // Allocate from a quickjsjni::ArenaAllocator, which ResetRuntime drops in bulk.
+    bool use_arena = false;
+};
+
+class QuickJsVm {
+public:
+    QuickJsVm(
+        JavaVM* java_vm,
+        JNIEnv* env,
+        jobject host_bridge,
+        const VmOptions& options = VmOptions()
+    )
+        : java_vm_(java_vm), options_(options), interrupted_(false) {
         host_bridge_ = env->NewGlobalRef(host_bridge);
         if (host_bridge_ == nullptr) {
-            JS_FreeContext(context_);
-            JS_FreeRuntime(runtime_);
-            context_ = nullptr;
-            runtime_ = nullptr;
             throw std::runtime_error("NewGlobalRef(host_bridge) failed");
         }
 
@@ -302,37 +378,60 @@ public:
         if (on_call_method_ == nullptr) {
             env->DeleteGlobalRef(host_bridge_);
             host_bridge_ = nullptr;
-            JS_FreeContext(context_);
-            JS_FreeRuntime(runtime_);
-            context_ = nullptr;
-            runtime_ = nullptr;
             throw std::runtime_error("HostBridge.onCall(String, String) not found");
         }
+        host_bridge_class = env->GetObjectClass(host_bridge);
+        on_call_binary_method_ = env->GetMethodID(
+            host_bridge_class,
+            "onCallBinary",
+            "(Ljava/lang/String;Ljava/nio/ByteBuffer;)Ljava/nio/ByteBuffer;"
+        );
+        env->DeleteLocalRef(host_bridge_class);
+        if (on_call_binary_method_ == nullptr && env->ExceptionCheck()) {
+            // Older bridges without it only lose NativeInterface.__callBinary.
+            env->ExceptionClear();
+        }
+        host_bridge_class = env->GetObjectClass(host_bridge);
+        on_call_async_method_ = env->GetMethodID(
+            host_bridge_class,
+            "onCallAsync",
+            "(Ljava/lang/String;Ljava/lang/String;J)Z"
+        );
+        env->DeleteLocalRef(host_bridge_class);
+        if (on_call_async_method_ == nullptr && env->ExceptionCheck()) {
+            // Without it NativeInterface.__callAsync settles its promise synchronously.
+            env->ExceptionClear();
+        }
 
-        JS_SetRuntimeOpaque(runtime_, this);
-        JS_SetInterruptHandler(runtime_, &QuickJsVm::HandleInterrupt, this);
-        InstallNativeInterface();
+        if (options_.use_arena) {
+            arena_ = std::make_unique<quickjsjni::ArenaAllocator>();
+        }
+        if (!OpenRuntime()) {
+            env->DeleteGlobalRef(host_bridge_);
+            host_bridge_ = nullptr;
+            throw std::runtime_error("JS_NewRuntime/JS_NewContext failed");
+        }
     }
 
     ~QuickJsVm() {
-        if (context_ != nullptr) {
-            JS_FreeContext(context_);
-            context_ = nullptr;
-        }
-        if (runtime_ != nullptr) {
-            JS_FreeRuntime(runtime_);
-            runtime_ = nullptr;
-        }
+        CloseRuntime();
         JNIEnv* env = nullptr;
-        if (host_bridge_ != nullptr && java_vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK) {
-            env->DeleteGlobalRef(host_bridge_);
-            host_bridge_ = nullptr;
+        if (java_vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK) {
+            for (auto& entry : method_names_) {
+                env->DeleteGlobalRef(entry.second);
+            }
+            if (host_bridge_ != nullptr) {
+                env->DeleteGlobalRef(host_bridge_);
+                host_bridge_ = nullptr;
+            }
         }
+        method_names_.clear();
     }
 
     std::string Eval(const std::string& script, const std::string& file_name) {
         std::lock_guard<std::mutex> guard(lock_);
-        BeginExecutionTrace(file_name, script.size(), script);
+        const ScopedExecutionTrace trace =
+            BeginExecutionTrace(quickjsjni::ExecutionTrace::Kind::kScript, file_name, script, "", script.size());
 
         JSValue result = JS_Eval(
             context_,
@@ -341,13 +440,37 @@ public:
             file_name.c_str(),
             JS_EVAL_TYPE_GLOBAL
         );
-        if (JS_IsException(result)) {
+        return CompleteEval(result);
+    }
+
+    // Same result as Eval, but the script is compiled once per content hash: later calls (in
+    // any VM, or any process once the cache has a directory) load the bytecode instead.
+    std::string EvalCached(const std::string& script, const std::string& file_name) {
+        std::lock_guard<std::mutex> guard(lock_);
+        const ScopedExecutionTrace trace =
+            BeginExecutionTrace(quickjsjni::ExecutionTrace::Kind::kScript, file_name, script, "", script.size());
+
+        JSValue function = LoadOrCompile(script, file_name);
+        if (JS_IsException(function)) {
             return TakeExceptionEnvelope();
         }
+        return CompleteEval(JS_EvalFunction(context_, function));
+    }
 
-        std::string value_json = SerializeValue(result);
-        JS_FreeValue(context_, result);
-        return BuildEvalEnvelope(true, value_json, std::nullopt, std::nullopt);
+    // Compiles the script into the bytecode cache without running it. The value is the
+    // bytecode size.
+    std::string Precompile(const std::string& script, const std::string& file_name) {
+        std::lock_guard<std::mutex> guard(lock_);
+        const ScopedExecutionTrace trace =
+            BeginExecutionTrace(quickjsjni::ExecutionTrace::Kind::kScript, file_name, script, "", script.size());
+
+        size_t bytecode_size = 0;
+        JSValue function = LoadOrCompile(script, file_name, &bytecode_size);
+        if (JS_IsException(function)) {
+            return TakeExceptionEnvelope();
+        }
+        JS_FreeValue(context_, function);
+        return BuildEvalEnvelope(true, std::to_string(bytecode_size), std::nullopt, std::nullopt);
     }
 
     std::string CallFunction(
@@ -356,11 +479,14 @@ public:
         const std::string& call_site
     ) {
         std::lock_guard<std::mutex> guard(lock_);
-        const std::string normalized_args_json = args_json.empty() ? "[]" : args_json;
-        BeginExecutionTrace(
+        const std::string_view normalized_args_json =
+            args_json.empty() ? std::string_view("[]") : std::string_view(args_json);
+        const ScopedExecutionTrace trace = BeginExecutionTrace(
+            quickjsjni::ExecutionTrace::Kind::kCall,
             call_site,
-            normalized_args_json.size(),
-            std::string("call ") + function_name + "(" + normalized_args_json + ")"
+            function_name,
+            normalized_args_json,
+            normalized_args_json.size()
         );
 
         JSValue global = JS_GetGlobalObject(context_);
@@ -381,9 +507,10 @@ public:
             );
         }
 
+        // Both alternatives are NUL-terminated, as JS_ParseJSON requires.
         JSValue parsed_args = JS_ParseJSON(
             context_,
-            normalized_args_json.c_str(),
+            normalized_args_json.data(),
             normalized_args_json.size(),
             call_site.c_str()
         );
@@ -464,9 +591,82 @@ public:
         return BuildEvalEnvelope(true, value_json, std::nullopt, std::nullopt);
     }
 
+    // CallFunction without JSON: args is an encoded array (see quickjs_value_codec.h) and on
+    // success the encoded result is left in BinaryResult(). Returns the failure envelope
+    // otherwise.
+    std::optional<std::string> CallFunctionBinary(
+        const std::string& function_name,
+        const uint8_t* args,
+        size_t args_size,
+        const std::string& call_site
+    ) {
+        std::lock_guard<std::mutex> guard(lock_);
+        const ScopedExecutionTrace trace = BeginExecutionTrace(
+            quickjsjni::ExecutionTrace::Kind::kBinaryCall,
+            call_site,
+            function_name,
+            "",
+            args_size
+        );
+        binary_result_.clear();
+
+        JSValue global = JS_GetGlobalObject(context_);
+        JSValue function = JS_GetPropertyStr(context_, global, function_name.c_str());
+        if (JS_IsException(function)) {
+            JS_FreeValue(context_, global);
+            return TakeExceptionEnvelope();
+        }
+        if (!JS_IsFunction(context_, function)) {
+            JS_FreeValue(context_, function);
+            JS_FreeValue(context_, global);
+            return BuildEvalEnvelope(
+                false,
+                std::nullopt,
+                std::string("Global function not found or not callable: ") + function_name,
+                std::nullopt
+            );
+        }
+
+        std::vector<JSValue> argv;
+        const bool decoded = codec_->DecodeArguments(args, args_size, &argv);
+        JSValue result = JS_EXCEPTION;
+        if (decoded) {
+            result = JS_Call(
+                context_,
+                function,
+                global,
+                static_cast<int>(argv.size()),
+                argv.empty() ? nullptr : argv.data()
+            );
+        }
+        for (JSValue& value : argv) {
+            JS_FreeValue(context_, value);
+        }
+        JS_FreeValue(context_, function);
+        JS_FreeValue(context_, global);
+
+        if (JS_IsException(result)) {
+            return TakeExceptionEnvelope();
+        }
+        const bool encoded = codec_->Encode(result, &binary_result_);
+        JS_FreeValue(context_, result);
+        if (!encoded) {
+            return TakeExceptionEnvelope();
+        }
+        return std::nullopt;
+    }
+
+    // Valid until the next CallFunctionBinary on this VM.
+    const std::vector<uint8_t>& BinaryResult() const {
+        return binary_result_;
+    }
+
+    // Settles the promises of async host calls completed since the last call, then runs up to
+    // max_jobs pending jobs. Returns both counts together.
     int ExecutePendingJobs(int max_jobs) {
         std::lock_guard<std::mutex> guard(lock_);
-        int executed = 0;
+        JS_UpdateStackTop(runtime_);
+        int executed = SettleAsyncCompletions();
         while (executed < max_jobs) {
             JSContext* current_context = nullptr;
             int status = JS_ExecutePendingJob(runtime_, &current_context);
@@ -482,19 +682,177 @@ public:
         interrupted_.store(true);
     }
 
+    // Called from any thread once the host finished a __callAsync call. Does not take lock_,
+    // so it never waits for running JS; the promise settles in the next ExecutePendingJobs.
+    void CompleteAsyncCall(
+        jlong call_id,
+        bool success,
+        std::optional<std::string> value
+    ) {
+        std::lock_guard<std::mutex> guard(completion_lock_);
+        completions_.push_back(AsyncCompletion {call_id, success, std::move(value)});
+        has_completions_.store(true, std::memory_order_release);
+    }
+
+    // Replaces the runtime with a fresh one: globals, pending jobs and unsettled async calls
+    // are dropped and the host reruns its warm-up. With the arena this is the bulk reset
+    // between tool runs. On false the VM has no runtime left and must only be destroyed.
+    bool ResetRuntime() {
+        std::lock_guard<std::mutex> guard(lock_);
+        CloseRuntime();
+        return OpenRuntime();
+    }
+
+    // Walks the heap, so it waits for running JS like any other entry point.
+    void MemoryUsage(JSMemoryUsage* usage, quickjsjni::ArenaStats* arena_stats) {
+        std::lock_guard<std::mutex> guard(lock_);
+        JS_ComputeMemoryUsage(runtime_, usage);
+        *arena_stats = arena_ != nullptr ? arena_->Stats() : quickjsjni::ArenaStats();
+    }
+
 private:
-    void BeginExecutionTrace(
+    struct PendingAsyncCall {
+        JSValue resolve;
+        JSValue reject;
+        std::string method;
+    };
+
+    struct AsyncCompletion {
+        jlong call_id;
+        bool success;
+        std::optional<std::string> value;
+    };
+
+    // Creates runtime_ and context_ with options_ applied and NativeInterface installed.
+    bool OpenRuntime() {
+        runtime_ = arena_ != nullptr
+            ? JS_NewRuntime2(&quickjsjni::ArenaAllocator::MallocFunctions(), arena_.get())
+            : JS_NewRuntime();
+        if (runtime_ == nullptr) {
+            return false;
+        }
+        if (options_.memory_limit_bytes > 0) {
+            JS_SetMemoryLimit(runtime_, options_.memory_limit_bytes);
+        }
+        if (options_.gc_threshold_bytes > 0) {
+            JS_SetGCThreshold(runtime_, options_.gc_threshold_bytes);
+        }
+        if (options_.max_stack_size_bytes > 0) {
+            JS_SetMaxStackSize(runtime_, options_.max_stack_size_bytes);
+        }
+
+        context_ = JS_NewContext(runtime_);
+        if (context_ == nullptr) {
+            JS_FreeRuntime(runtime_);
+            runtime_ = nullptr;
+            return false;
+        }
+
+        codec_ = std::make_unique<quickjsjni::ValueCodec>(context_);
+
+        JS_SetRuntimeOpaque(runtime_, this);
+        JS_SetInterruptHandler(runtime_, &QuickJsVm::HandleInterrupt, this);
+        InstallNativeInterface();
+        return true;
+    }
+
+    void CloseRuntime() {
+        if (runtime_ == nullptr) {
+            return;
+        }
+        for (auto& entry : pending_async_calls_) {
+            JS_FreeValue(context_, entry.second.resolve);
+            JS_FreeValue(context_, entry.second.reject);
+        }
+        pending_async_calls_.clear();
+        codec_.reset();
+        if (arena_ != nullptr) {
+            // Everything the runtime allocated lives in the arena: skip the per-object
+            // teardown of JS_FreeContext/JS_FreeRuntime and drop it all at once.
+            context_ = nullptr;
+            runtime_ = nullptr;
+            arena_->Reset();
+            return;
+        }
+        JS_FreeContext(context_);
+        context_ = nullptr;
+        JS_FreeRuntime(runtime_);
+        runtime_ = nullptr;
+    }
+
+    std::string CompleteEval(JSValue result) {
+        if (JS_IsException(result)) {
+            return TakeExceptionEnvelope();
+        }
+
+        std::string value_json = SerializeValue(result);
+        JS_FreeValue(context_, result);
+        return BuildEvalEnvelope(true, value_json, std::nullopt, std::nullopt);
+    }
+
+    // Returns the compiled (not yet run) script, from the bytecode cache when possible, or
+    // JS_EXCEPTION for a syntax error. bytecode_size is left at 0 when nothing was cached.
+    JSValue LoadOrCompile(
+        const std::string& script,
         const std::string& file_name,
-        size_t script_length,
-        const std::string& script_preview
+        size_t* bytecode_size = nullptr
+    ) {
+        quickjsjni::BytecodeCache& cache = quickjsjni::BytecodeCache::Instance();
+        const quickjsjni::BytecodeKey key = quickjsjni::ComputeBytecodeKey(script, file_name);
+
+        std::shared_ptr<const quickjsjni::BytecodeBlob> blob = cache.Find(key);
+        if (blob != nullptr) {
+            JSValue function = JS_ReadObject(context_, blob->data(), blob->size(), JS_READ_OBJ_BYTECODE);
+            if (!JS_IsException(function)) {
+                if (bytecode_size != nullptr) {
+                    *bytecode_size = blob->size();
+                }
+                return function;
+            }
+            // Unreadable for this build; recompile and replace it.
+            JS_FreeValue(context_, JS_GetException(context_));
+            cache.Remove(key);
+        }
+
+        JSValue function = JS_Eval(
+            context_,
+            script.c_str(),
+            script.size(),
+            file_name.c_str(),
+            JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY
+        );
+        if (JS_IsException(function)) {
+            return function;
+        }
+
+        size_t size = 0;
+        uint8_t* bytecode = JS_WriteObject(context_, &size, function, JS_WRITE_OBJ_BYTECODE);
+        if (bytecode != nullptr) {
+            cache.Store(key, bytecode, size);
+            js_free(context_, bytecode);
+            if (bytecode_size != nullptr) {
+                *bytecode_size = size;
+            }
+        } else {
+            // Still runnable, just not cached.
+            JS_FreeValue(context_, JS_GetException(context_));
+        }
+        return function;
+    }
+
+    ScopedExecutionTrace BeginExecutionTrace(
+        quickjsjni::ExecutionTrace::Kind kind,
+        std::string_view file_name,
+        std::string_view subject,
+        std::string_view args,
+        size_t script_length
     ) {
         interrupted_.store(false);
-        current_file_name_ = file_name;
-        current_script_length_ = script_length;
-        current_script_preview_ = PreviewText(script_preview);
-        recent_host_calls_.clear();
-        host_call_counter_ = 0;
+        // Entry points run on whichever thread holds lock_; the stack limit must follow it.
+        JS_UpdateStackTop(runtime_);
+        trace_.Begin(kind, file_name, subject, args, script_length);
         active_host_call_depth_ = 0;
+        return ScopedExecutionTrace(&trace_);
     }
 
     static int HandleInterrupt(JSRuntime* runtime, void* opaque) {
@@ -519,49 +877,205 @@ private:
     }
 
     JSValue HostCall(JSContext* context, int argc, JSValueConst* argv) {
-        std::string method = argc > 0 ? JsValueToString(context, argv[0]) : "";
-        std::optional<std::string> args_json;
-        if (argc > 1 && !JS_IsNull(argv[1]) && !JS_IsUndefined(argv[1])) {
-            args_json = JsValueToString(context, argv[1]);
+        const ScopedJsCString method =
+            argc > 0 ? ScopedJsCString(context, argv[0]) : ScopedJsCString(context);
+        const bool has_args = argc > 1 && !JS_IsNull(argv[1]) && !JS_IsUndefined(argv[1]);
+        const ScopedJsCString args_json =
+            has_args ? ScopedJsCString(context, argv[1]) : ScopedJsCString(context);
+
+        trace_.RecordHostCall(method.view(), args_json.view(), active_host_call_depth_ + 1);
+        active_host_call_depth_ += 1;
+        JSValue result = CallHost(context, method.view(), has_args ? args_json.c_str() : nullptr);
+        if (active_host_call_depth_ > 0) {
+            active_host_call_depth_ -= 1;
+        }
+        return result;
+    }
+
+    static JSValue HostCallBinaryEntry(
+        JSContext* context,
+        JSValueConst this_value,
+        int argc,
+        JSValueConst* argv
+    ) {
+        auto* vm = static_cast<QuickJsVm*>(JS_GetRuntimeOpaque(JS_GetRuntime(context)));
+        if (vm == nullptr) {
+            return JS_ThrowInternalError(context, "QuickJsVm missing");
+        }
+        return vm->HostCallBinary(context, argc, argv);
+    }
+
+    // NativeInterface.__callBinary(method, ...args): args and the result cross JNI as one
+    // encoded buffer each instead of JSON strings.
+    JSValue HostCallBinary(JSContext* context, int argc, JSValueConst* argv) {
+        if (on_call_binary_method_ == nullptr) {
+            return JS_ThrowInternalError(context, "HostBridge.onCallBinary is not available");
+        }
+        const ScopedJsCString method =
+            argc > 0 ? ScopedJsCString(context, argv[0]) : ScopedJsCString(context);
+        host_call_buffer_.clear();
+        if (!codec_->EncodeArguments(argc > 0 ? argc - 1 : 0, argv + 1, &host_call_buffer_)) {
+            return JS_EXCEPTION;
         }
 
-        RecordHostCall(method, args_json);
+        trace_.RecordBinaryHostCall(method.view(), host_call_buffer_.size(), active_host_call_depth_ + 1);
         active_host_call_depth_ += 1;
-        HostCallResult result = CallHost(method, args_json);
+        JSValue result = CallHostBinary(context, method.view());
         if (active_host_call_depth_ > 0) {
             active_host_call_depth_ -= 1;
         }
-        if (result.error.has_value()) {
-            return JS_ThrowInternalError(
-                context,
-                "Host call failed for %s: %s",
-                method.c_str(),
-                result.error->c_str()
+        return result;
+    }
+
+    static JSValue HostCallAsyncEntry(
+        JSContext* context,
+        JSValueConst this_value,
+        int argc,
+        JSValueConst* argv
+    ) {
+        auto* vm = static_cast<QuickJsVm*>(JS_GetRuntimeOpaque(JS_GetRuntime(context)));
+        if (vm == nullptr) {
+            return JS_ThrowInternalError(context, "QuickJsVm missing");
+        }
+        return vm->HostCallAsync(context, argc, argv);
+    }
+
+    // NativeInterface.__callAsync(method, argsJson): returns a promise right away and lets the
+    // host finish on its own thread, so slow host operations overlap instead of holding lock_.
+    JSValue HostCallAsync(JSContext* context, int argc, JSValueConst* argv) {
+        const ScopedJsCString method =
+            argc > 0 ? ScopedJsCString(context, argv[0]) : ScopedJsCString(context);
+        const bool has_args = argc > 1 && !JS_IsNull(argv[1]) && !JS_IsUndefined(argv[1]);
+        const ScopedJsCString args_json =
+            has_args ? ScopedJsCString(context, argv[1]) : ScopedJsCString(context);
+        const char* args = has_args ? args_json.c_str() : nullptr;
+
+        JSValue resolving_functions[2];
+        JSValue promise = JS_NewPromiseCapability(context, resolving_functions);
+        if (JS_IsException(promise)) {
+            return promise;
+        }
+
+        trace_.RecordHostCall(method.view(), args_json.view(), active_host_call_depth_ + 1);
+        const jlong call_id = next_async_call_id_++;
+        std::optional<std::string> error;
+        bool accepted = false;
+        if (on_call_async_method_ != nullptr) {
+            // Registered first: the host may complete before onCallAsync returns.
+            pending_async_calls_[call_id] =
+                PendingAsyncCall {resolving_functions[0], resolving_functions[1], std::string(method.view())};
+            accepted = StartHostAsyncCall(method.view(), args, call_id, &error);
+            if (!accepted) {
+                pending_async_calls_.erase(call_id);
+            }
+        }
+        if (!accepted && !error.has_value()) {
+            active_host_call_depth_ += 1;
+            JSValue value = CallHost(context, method.view(), args);
+            if (active_host_call_depth_ > 0) {
+                active_host_call_depth_ -= 1;
+            }
+            const bool failed = JS_IsException(value);
+            SettleWith(
+                resolving_functions[0],
+                resolving_functions[1],
+                !failed,
+                failed ? JS_GetException(context) : value
             );
         }
-        if (!result.value.has_value()) {
-            return JS_NULL;
+        if (!accepted && error.has_value()) {
+            Settle(resolving_functions[0], resolving_functions[1], method.view(), false, error);
         }
-        return JS_NewStringLen(context, result.value->c_str(), result.value->size());
+        if (!accepted) {
+            JS_FreeValue(context, resolving_functions[0]);
+            JS_FreeValue(context, resolving_functions[1]);
+        }
+        return promise;
     }
 
-    void RecordHostCall(
-        const std::string& method,
-        const std::optional<std::string>& args_json
+    // Returns whether the host took the call; false with no error means it wants the call to
+    // run synchronously instead.
+    bool StartHostAsyncCall(
+        std::string_view method,
+        const char* args_json,
+        jlong call_id,
+        std::optional<std::string>* error
     ) {
-        host_call_counter_ += 1;
-        std::string entry =
-            "#" + std::to_string(host_call_counter_) +
-            " depth=" + std::to_string(active_host_call_depth_ + 1) +
-            " method=" + PreviewText(method, 80);
-        if (args_json.has_value() && !args_json->empty()) {
-            entry += " args=" + PreviewText(*args_json, 180);
+        JNIEnv* env = CurrentJniEnv(java_vm_);
+        if (env == nullptr) {
+            *error = "Failed to attach current thread to JVM";
+            return false;
+        }
+
+        bool method_is_local = false;
+        jstring j_method = MethodName(env, method, &method_is_local);
+        jstring j_args = args_json != nullptr ? env->NewStringUTF(args_json) : nullptr;
+        *error = TakeJavaExceptionMessage(env);
+        jboolean accepted = JNI_FALSE;
+        if (!error->has_value()) {
+            accepted = env->CallBooleanMethod(host_bridge_, on_call_async_method_, j_method, j_args, call_id);
+            *error = TakeJavaExceptionMessage(env);
         }
-        recent_host_calls_.push_back(entry);
-        static constexpr size_t kMaxHostCalls = 24;
-        if (recent_host_calls_.size() > kMaxHostCalls) {
-            recent_host_calls_.erase(recent_host_calls_.begin());
+        if (j_args != nullptr) {
+            env->DeleteLocalRef(j_args);
+        }
+        if (method_is_local && j_method != nullptr) {
+            env->DeleteLocalRef(j_method);
+        }
+        return !error->has_value() && accepted == JNI_TRUE;
+    }
+
+    // Resolves with the host's string result (or null), or rejects with an Error worded like
+    // a failed synchronous host call.
+    void Settle(
+        JSValueConst resolve,
+        JSValueConst reject,
+        std::string_view method,
+        bool success,
+        const std::optional<std::string>& value
+    ) {
+        JSValue argument = JS_NULL;
+        if (success && value.has_value()) {
+            argument = JS_NewStringLen(context_, value->c_str(), value->size());
+        } else if (!success) {
+            ThrowHostCallError(context_, method, value.value_or("unknown error").c_str());
+            argument = JS_GetException(context_);
         }
+        SettleWith(resolve, reject, success, argument);
+    }
+
+    // Calls resolve or reject with argument, which it takes ownership of.
+    void SettleWith(JSValueConst resolve, JSValueConst reject, bool success, JSValue argument) {
+        JSValue settled = JS_Call(context_, success ? resolve : reject, JS_UNDEFINED, 1, &argument);
+        JS_FreeValue(context_, argument);
+        JS_FreeValue(context_, settled);
+    }
+
+    int SettleAsyncCompletions() {
+        if (!has_completions_.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        std::vector<AsyncCompletion> completions;
+        {
+            std::lock_guard<std::mutex> guard(completion_lock_);
+            completions.swap(completions_);
+            has_completions_.store(false, std::memory_order_relaxed);
+        }
+
+        int settled = 0;
+        for (AsyncCompletion& completion : completions) {
+            auto it = pending_async_calls_.find(completion.call_id);
+            if (it == pending_async_calls_.end()) {
+                continue;
+            }
+            PendingAsyncCall call = std::move(it->second);
+            pending_async_calls_.erase(it);
+            Settle(call.resolve, call.reject, call.method, completion.success, completion.value);
+            JS_FreeValue(context_, call.resolve);
+            JS_FreeValue(context_, call.reject);
+            settled += 1;
+        }
+        return settled;
     }
 
     void InstallNativeInterface() {
@@ -569,57 +1083,85 @@ private:
         JSValue native_interface = JS_NewObject(context_);
         JSValue host_call = JS_NewCFunction(context_, &QuickJsVm::HostCallEntry, "__call", 2);
         JS_SetPropertyStr(context_, native_interface, "__call", host_call);
+        JSValue host_call_binary =
+            JS_NewCFunction(context_, &QuickJsVm::HostCallBinaryEntry, "__callBinary", 1);
+        JS_SetPropertyStr(context_, native_interface, "__callBinary", host_call_binary);
+        JSValue host_call_async =
+            JS_NewCFunction(context_, &QuickJsVm::HostCallAsyncEntry, "__callAsync", 2);
+        JS_SetPropertyStr(context_, native_interface, "__callAsync", host_call_async);
         JS_SetPropertyStr(context_, global, "NativeInterface", native_interface);
         JS_FreeValue(context_, global);
     }
 
-    HostCallResult CallHost(
-        const std::string& method,
-        const std::optional<std::string>& args_json
-    ) {
-        HostCallResult result;
-        JNIEnv* env = nullptr;
-        bool attached = false;
-        if (java_vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
-            if (java_vm_->AttachCurrentThread(&env, nullptr) != JNI_OK) {
-                result.error = "Failed to attach current thread to JVM";
-                return result;
-            }
-            attached = true;
+    // Host method names come from a small fixed vocabulary, so each gets one global-ref
+    // jstring for the VM's lifetime (the Java side also keeps seeing the same String and its
+    // cached hash). Past kMaxMethodNames a local ref is returned and *is_local set.
+    jstring MethodName(JNIEnv* env, std::string_view method, bool* is_local) {
+        auto it = method_names_.find(method);
+        if (it != method_names_.end()) {
+            *is_local = false;
+            return it->second;
         }
 
-        jstring j_method = env->NewStringUTF(method.c_str());
+        *is_local = true;
+        std::string name(method);
+        jstring j_name = env->NewStringUTF(name.c_str());
+        if (j_name == nullptr || method_names_.size() >= kMaxMethodNames) {
+            return j_name;
+        }
+        auto* global_name = static_cast<jstring>(env->NewGlobalRef(j_name));
+        if (global_name == nullptr) {
+            return j_name;
+        }
+        env->DeleteLocalRef(j_name);
+        method_name_storage_.push_back(std::move(name));
+        method_names_.emplace(method_name_storage_.back(), global_name);
+        *is_local = false;
+        return global_name;
+    }
+
+    // HostBridge.onCall; the result string goes straight from the JNI chars into a JS string.
+    // Throws like a failed host call and returns JS_EXCEPTION on errors.
+    JSValue CallHost(JSContext* context, std::string_view method, const char* args_json) {
+        JNIEnv* env = CurrentJniEnv(java_vm_);
+        if (env == nullptr) {
+            return ThrowHostCallError(context, method, "Failed to attach current thread to JVM");
+        }
+
+        bool method_is_local = false;
+        jstring j_method = MethodName(env, method, &method_is_local);
         jstring j_args = nullptr;
         jobject raw_result = nullptr;
+        JSValue value = JS_NULL;
 
-        result.error = TakeJavaExceptionMessage(env);
-        if (!result.error.has_value() && j_method == nullptr) {
-            result.error = "Failed to create JNI string for host method";
+        std::optional<std::string> error = TakeJavaExceptionMessage(env);
+        if (!error.has_value() && j_method == nullptr) {
+            error = "Failed to create JNI string for host method";
         }
 
-        if (!result.error.has_value() && args_json.has_value()) {
-            j_args = env->NewStringUTF(args_json->c_str());
-            result.error = TakeJavaExceptionMessage(env);
-            if (!result.error.has_value() && j_args == nullptr) {
-                result.error = "Failed to create JNI string for host args";
+        if (!error.has_value() && args_json != nullptr) {
+            j_args = env->NewStringUTF(args_json);
+            error = TakeJavaExceptionMessage(env);
+            if (!error.has_value() && j_args == nullptr) {
+                error = "Failed to create JNI string for host args";
             }
         }
 
-        if (!result.error.has_value()) {
+        if (!error.has_value()) {
             raw_result = env->CallObjectMethod(host_bridge_, on_call_method_, j_method, j_args);
-            result.error = TakeJavaExceptionMessage(env);
+            error = TakeJavaExceptionMessage(env);
         }
 
-        if (!result.error.has_value() && raw_result != nullptr) {
+        if (!error.has_value() && raw_result != nullptr) {
             auto* j_result = static_cast<jstring>(raw_result);
             const char* chars = env->GetStringUTFChars(j_result, nullptr);
             if (chars != nullptr) {
-                result.value = std::string(chars);
+                value = JS_NewStringLen(context, chars, std::strlen(chars));
                 env->ReleaseStringUTFChars(j_result, chars);
             } else {
-                result.error = TakeJavaExceptionMessage(env);
-                if (!result.error.has_value()) {
-                    result.value = std::string();
+                error = TakeJavaExceptionMessage(env);
+                if (!error.has_value()) {
+                    value = JS_NewStringLen(context, "", 0);
                 }
             }
         }
@@ -631,14 +1173,63 @@ private:
         if (j_args != nullptr) {
             env->DeleteLocalRef(j_args);
         }
-        if (j_method != nullptr) {
+        if (method_is_local && j_method != nullptr) {
             env->DeleteLocalRef(j_method);
         }
+        if (error.has_value()) {
+            return ThrowHostCallError(context, method, error->c_str());
+        }
+        return value;
+    }
+
+    JSValue CallHostBinary(JSContext* context, std::string_view method) {
+        JNIEnv* env = CurrentJniEnv(java_vm_);
+        if (env == nullptr) {
+            return JS_ThrowInternalError(context, "Failed to attach current thread to JVM");
+        }
 
-        if (attached) {
-            java_vm_->DetachCurrentThread();
+        std::optional<std::string> error;
+        JSValue value = JS_NULL;
+        bool method_is_local = false;
+        jstring j_method = MethodName(env, method, &method_is_local);
+        jobject j_args = j_method == nullptr
+            ? nullptr
+            : env->NewDirectByteBuffer(host_call_buffer_.data(), static_cast<jlong>(host_call_buffer_.size()));
+        error = TakeJavaExceptionMessage(env);
+        if (!error.has_value() && j_args == nullptr) {
+            error = "Failed to wrap host call args";
         }
-        return result;
+
+        jobject raw_result = nullptr;
+        if (!error.has_value()) {
+            raw_result = env->CallObjectMethod(host_bridge_, on_call_binary_method_, j_method, j_args);
+            error = TakeJavaExceptionMessage(env);
+        }
+        if (!error.has_value() && raw_result != nullptr) {
+            // The bridge returns a direct buffer holding exactly one encoded value.
+            auto* bytes = static_cast<const uint8_t*>(env->GetDirectBufferAddress(raw_result));
+            const jlong size = env->GetDirectBufferCapacity(raw_result);
+            if (bytes == nullptr || size < 0) {
+                error = "onCallBinary must return a direct ByteBuffer";
+            } else {
+                value = codec_->Decode(bytes, static_cast<size_t>(size));
+            }
+        }
+
+        if (raw_result != nullptr) {
+            env->DeleteLocalRef(raw_result);
+        }
+        if (j_args != nullptr) {
+            env->DeleteLocalRef(j_args);
+        }
+        if (method_is_local && j_method != nullptr) {
+            env->DeleteLocalRef(j_method);
+        }
+
+        if (error.has_value()) {
+            return ThrowHostCallError(context, method, error->c_str());
+        }
+        return value;
     }
 
     std::string SerializeValue(JSValueConst value) {
@@ -685,11 +1276,11 @@ private:
         }
         std::string details_json = "{";
         details_json += "\"evalFileName\":";
-        details_json += QuoteJson(current_file_name_);
+        details_json += QuoteJson(trace_.FileName());
         details_json += ",\"scriptLength\":";
-        details_json += std::to_string(current_script_length_);
+        details_json += std::to_string(trace_.ScriptLength());
         details_json += ",\"scriptPreview\":";
-        details_json += QuoteJson(current_script_preview_);
+        details_json += QuoteJson(trace_.FormatScriptPreview());
         details_json += ",\"exceptionName\":";
         details_json += name.has_value() ? QuoteJson(*name) : "null";
         details_json += ",\"exceptionMessage\":";
@@ -705,7 +1296,7 @@ private:
         details_json += ",\"exceptionDump\":";
         details_json += QuoteJson(exception_dump);
         details_json += ",\"recentHostCalls\":";
-        details_json += BuildJsonStringArray(recent_host_calls_);
+        details_json += BuildJsonStringArray(trace_.FormatHostCalls());
         details_json += ",\"activeHostCallDepth\":";
         details_json += std::to_string(active_host_call_depth_);
         details_json += "}";
@@ -713,33 +1304,104 @@ private:
     }
 
     JavaVM* java_vm_ = nullptr;
+    const VmOptions options_;
+    std::unique_ptr<quickjsjni::ArenaAllocator> arena_;
     JSRuntime* runtime_ = nullptr;
     JSContext* context_ = nullptr;
     jobject host_bridge_ = nullptr;
     jmethodID on_call_method_ = nullptr;
+    jmethodID on_call_binary_method_ = nullptr;
+    jmethodID on_call_async_method_ = nullptr;
+    std::unique_ptr<quickjsjni::ValueCodec> codec_;
+    // Interned host method names (JS thread only, under lock_); the views point into
+    // method_name_storage_.
+    static constexpr size_t kMaxMethodNames = 256;
+    std::deque<std::string> method_name_storage_;
+    std::unordered_map<std::string_view, jstring> method_names_;
+    std::vector<uint8_t> binary_result_;
+    std::vector<uint8_t> host_call_buffer_;
     std::mutex lock_;
     std::atomic_bool interrupted_;
-    std::string current_file_name_;
-    size_t current_script_length_ = 0;
-    std::string current_script_preview_;
-    std::vector<std::string> recent_host_calls_;
-    size_t host_call_counter_ = 0;
+    quickjsjni::ExecutionTrace trace_;
     size_t active_host_call_depth_ = 0;
+    // Async host calls: promises waiting for the host (JS thread only, under lock_) and
+    // completions handed in from other threads.
+    std::unordered_map<jlong, PendingAsyncCall> pending_async_calls_;
+    jlong next_async_call_id_ = 1;
+    std::mutex completion_lock_;
+    std::vector<AsyncCompletion> completions_;
+    std::atomic_bool has_completions_ {false};
 };
 
 QuickJsVm* FromHandle(jlong handle) {
     return reinterpret_cast<QuickJsVm*>(handle);
 }
 
+// Several independent VMs so that parallel tool calls do not queue behind one lock_. Each
+// VM has its own host bridge and shares the pool's VmOptions; callers lease one, use it
+// through the usual per-VM entry points and release it. Warm-up (compat layer, preloaded packages) is done by
+// the caller right after creation.
+class QuickJsVmPool {
+public:
+    explicit QuickJsVmPool(std::vector<std::unique_ptr<QuickJsVm>> vms)
+        : vms_(std::move(vms)), scheduler_(vms_.size()) {}
+
+    size_t Size() const {
+        return vms_.size();
+    }
+
+    QuickJsVm* At(jint index) const {
+        if (index < 0 || static_cast<size_t>(index) >= vms_.size()) {
+            return nullptr;
+        }
+        return vms_[static_cast<size_t>(index)].get();
+    }
+
+    quickjsjni::LeaseScheduler& Scheduler() {
+        return scheduler_;
+    }
+
+private:
+    std::vector<std::unique_ptr<QuickJsVm>> vms_;
+    quickjsjni::LeaseScheduler scheduler_;
+};
+
+QuickJsVmPool* PoolFromHandle(jlong handle) {
+    return reinterpret_cast<QuickJsVmPool*>(handle);
+}
+
+std::optional<VmOptions> ReadVmOptions(
+    jlong memory_limit_bytes,
+    jlong gc_threshold_bytes,
+    jlong max_stack_size_bytes,
+    jboolean use_arena
+) {
+    if (memory_limit_bytes < 0 || gc_threshold_bytes < 0 || max_stack_size_bytes < 0) {
+        return std::nullopt;
+    }
+    VmOptions options;
+    options.memory_limit_bytes = static_cast<size_t>(memory_limit_bytes);
+    options.gc_threshold_bytes = static_cast<size_t>(gc_threshold_bytes);
+    options.max_stack_size_bytes = static_cast<size_t>(max_stack_size_bytes);
+    options.use_arena = use_arena == JNI_TRUE;
+    return options;
+}
+
 }  // namespace
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCreate(
     JNIEnv* env,
     jclass,
-    jobject host_bridge
+    jobject host_bridge,
+    jlong memory_limit_bytes,
+    jlong gc_threshold_bytes,
+    jlong max_stack_size_bytes,
+    jboolean use_arena
 ) {
-    if (host_bridge == nullptr) {
+    const std::optional<VmOptions> options =
+        ReadVmOptions(memory_limit_bytes, gc_threshold_bytes, max_stack_size_bytes, use_arena);
+    if (host_bridge == nullptr || !options.has_value()) {
         return 0;
     }
 
@@ -749,7 +1411,7 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCr
     }
 
     try {
-        auto* vm = new QuickJsVm(java_vm, env, host_bridge);
+        auto* vm = new QuickJsVm(java_vm, env, host_bridge, *options);
         return reinterpret_cast<jlong>(vm);
     } catch (...) {
         return 0;
@@ -765,6 +1427,137 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeDe
     delete FromHandle(handle);
 }
 
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCreatePool(
+    JNIEnv* env,
+    jclass,
+    jobjectArray host_bridges,
+    jlong memory_limit_bytes,
+    jlong gc_threshold_bytes,
+    jlong max_stack_size_bytes,
+    jboolean use_arena
+) {
+    const std::optional<VmOptions> options =
+        ReadVmOptions(memory_limit_bytes, gc_threshold_bytes, max_stack_size_bytes, use_arena);
+    if (host_bridges == nullptr || !options.has_value()) {
+        return 0;
+    }
+    const jsize size = env->GetArrayLength(host_bridges);
+    if (size <= 0) {
+        return 0;
+    }
+
+    JavaVM* java_vm = nullptr;
+    if (env->GetJavaVM(&java_vm) != JNI_OK) {
+        return 0;
+    }
+
+    try {
+        std::vector<std::unique_ptr<QuickJsVm>> vms;
+        vms.reserve(static_cast<size_t>(size));
+        for (jsize index = 0; index < size; index += 1) {
+            jobject host_bridge = env->GetObjectArrayElement(host_bridges, index);
+            if (host_bridge == nullptr) {
+                return 0;
+            }
+            vms.push_back(std::make_unique<QuickJsVm>(
+                java_vm,
+                env,
+                host_bridge,
+                *options
+            ));
+            env->DeleteLocalRef(host_bridge);
+        }
+        auto* pool = new QuickJsVmPool(std::move(vms));
+        return reinterpret_cast<jlong>(pool);
+    } catch (...) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeDestroyPool(
+    JNIEnv*,
+    jclass,
+    jlong pool_handle
+) {
+    delete PoolFromHandle(pool_handle);
+}
+
+// Handle of the pool's VM at index, owned by the pool (never pass it to nativeDestroy).
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativePoolRuntime(
+    JNIEnv*,
+    jclass,
+    jlong pool_handle,
+    jint index
+) {
+    auto* pool = PoolFromHandle(pool_handle);
+    if (pool == nullptr) {
+        return 0;
+    }
+    return reinterpret_cast<jlong>(pool->At(index));
+}
+
+// Blocks until a VM is free (the one for affinity_key when it is >= 0) and returns its index,
+// or -1 after timeout_millis (negative waits forever).
+extern "C" JNIEXPORT jint JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativePoolLease(
+    JNIEnv*,
+    jclass,
+    jlong pool_handle,
+    jlong affinity_key,
+    jlong timeout_millis
+) {
+    auto* pool = PoolFromHandle(pool_handle);
+    if (pool == nullptr) {
+        return -1;
+    }
+    return pool->Scheduler().Acquire(affinity_key, std::chrono::milliseconds(timeout_millis));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativePoolRelease(
+    JNIEnv*,
+    jclass,
+    jlong pool_handle,
+    jint index
+) {
+    auto* pool = PoolFromHandle(pool_handle);
+    if (pool != nullptr) {
+        pool->Scheduler().Release(index);
+    }
+}
+
+// [size, busy, waiting, peakWaiting, leases, timeouts, totalWaitNanos, maxWaitNanos]
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativePoolMetrics(
+    JNIEnv* env,
+    jclass,
+    jlong pool_handle
+) {
+    auto* pool = PoolFromHandle(pool_handle);
+    if (pool == nullptr) {
+        return nullptr;
+    }
+    const quickjsjni::LeaseMetrics metrics = pool->Scheduler().Metrics();
+    const jlong values[] = {
+        static_cast<jlong>(metrics.slots),
+        static_cast<jlong>(metrics.busy),
+        static_cast<jlong>(metrics.waiting),
+        static_cast<jlong>(metrics.peak_waiting),
+        static_cast<jlong>(metrics.leases),
+        static_cast<jlong>(metrics.timeouts),
+        static_cast<jlong>(metrics.total_wait_nanos),
+        static_cast<jlong>(metrics.max_wait_nanos),
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeEvaluate(
     JNIEnv* env,
@@ -798,6 +1591,76 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeEv
     return env->NewStringUTF(result.c_str());
 }
 
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeEvaluateCached(
+    JNIEnv* env,
+    jclass,
+    jlong handle,
+    jstring script,
+    jstring file_name
+) {
+    auto* vm = FromHandle(handle);
+    if (vm == nullptr || script == nullptr || file_name == nullptr) {
+        std::string error = BuildEvalEnvelope(false, std::nullopt, std::string("Invalid nativeEvaluateCached arguments"), std::nullopt);
+        return env->NewStringUTF(error.c_str());
+    }
+
+    const std::string script_value = JStringToString(env, script);
+    const std::string file_name_value = JStringToString(env, file_name);
+    std::string result = vm->EvalCached(script_value, file_name_value);
+    return env->NewStringUTF(result.c_str());
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativePrecompile(
+    JNIEnv* env,
+    jclass,
+    jlong handle,
+    jstring script,
+    jstring file_name
+) {
+    auto* vm = FromHandle(handle);
+    if (vm == nullptr || script == nullptr || file_name == nullptr) {
+        std::string error = BuildEvalEnvelope(false, std::nullopt, std::string("Invalid nativePrecompile arguments"), std::nullopt);
+        return env->NewStringUTF(error.c_str());
+    }
+
+    const std::string script_value = JStringToString(env, script);
+    const std::string file_name_value = JStringToString(env, file_name);
+    std::string result = vm->Precompile(script_value, file_name_value);
+    return env->NewStringUTF(result.c_str());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeSetBytecodeCacheDir(
+    JNIEnv* env,
+    jclass,
+    jstring directory
+) {
+    quickjsjni::BytecodeCache::Instance().SetDirectory(JStringToString(env, directory));
+}
+
+// [memoryHits, diskHits, misses, stores, memoryBytes]
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeGetBytecodeCacheStats(
+    JNIEnv* env,
+    jclass
+) {
+    const quickjsjni::BytecodeCacheStats stats = quickjsjni::BytecodeCache::Instance().Stats();
+    const jlong values[] = {
+        static_cast<jlong>(stats.memory_hits),
+        static_cast<jlong>(stats.disk_hits),
+        static_cast<jlong>(stats.misses),
+        static_cast<jlong>(stats.stores),
+        static_cast<jlong>(stats.memory_bytes),
+    };
+    jlongArray result = env->NewLongArray(5);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, 5, values);
+    }
+    return result;
+}
+
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCallFunction(
     JNIEnv* env,
@@ -837,6 +1700,41 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCa
     return env->NewStringUTF(result.c_str());
 }
 
+// Returns a direct ByteBuffer over the encoded result (valid until the next binary call on
+// this VM) on success, or the failure envelope as a String.
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCallFunctionBinary(
+    JNIEnv* env,
+    jclass,
+    jlong handle,
+    jstring function_name,
+    jobject args,
+    jint args_length,
+    jstring call_site
+) {
+    auto* vm = FromHandle(handle);
+    const auto* args_bytes = args == nullptr ? nullptr : static_cast<const uint8_t*>(env->GetDirectBufferAddress(args));
+    if (vm == nullptr || function_name == nullptr || call_site == nullptr || args_bytes == nullptr ||
+        args_length < 0 || args_length > env->GetDirectBufferCapacity(args)) {
+        std::string error = BuildEvalEnvelope(false, std::nullopt, std::string("Invalid nativeCallFunctionBinary arguments"), std::nullopt);
+        return env->NewStringUTF(error.c_str());
+    }
+
+    const std::string function_name_value = JStringToString(env, function_name);
+    const std::string call_site_value = JStringToString(env, call_site);
+    std::optional<std::string> failure = vm->CallFunctionBinary(
+        function_name_value,
+        args_bytes,
+        static_cast<size_t>(args_length),
+        call_site_value
+    );
+    if (failure.has_value()) {
+        return env->NewStringUTF(failure->c_str());
+    }
+    const std::vector<uint8_t>& result = vm->BinaryResult();
+    return env->NewDirectByteBuffer(const_cast<uint8_t*>(result.data()), static_cast<jlong>(result.size()));
+}
+
 extern "C" JNIEXPORT jint JNICALL
 Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeExecutePendingJobs(
     JNIEnv*,
@@ -851,6 +1749,26 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeEx
     return vm->ExecutePendingJobs(max_jobs);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeCompleteAsyncCall(
+    JNIEnv* env,
+    jclass,
+    jlong handle,
+    jlong call_id,
+    jboolean success,
+    jstring value
+) {
+    auto* vm = FromHandle(handle);
+    if (vm == nullptr) {
+        return;
+    }
+    std::optional<std::string> value_string;
+    if (value != nullptr) {
+        value_string = JStringToString(env, value);
+    }
+    vm->CompleteAsyncCall(call_id, success == JNI_TRUE, std::move(value_string));
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeInterrupt(
     JNIEnv*,
@@ -862,3 +1780,69 @@ Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeIn
         vm->Interrupt();
     }
 }
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeResetRuntime(
+    JNIEnv*,
+    jclass,
+    jlong handle
+) {
+    auto* vm = FromHandle(handle);
+    if (vm == nullptr) {
+        return JNI_FALSE;
+    }
+    return vm->ResetRuntime() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_ai_assistance_operit_core_tools_javascript_QuickJsNativeBridge_nativeGetMemoryUsage(
+    JNIEnv* env,
+    jclass,
+    jlong handle
+) {
+    auto* vm = FromHandle(handle);
+    if (vm == nullptr) {
+        return nullptr;
+    }
+    JSMemoryUsage usage {};
+    quickjsjni::ArenaStats arena;
+    vm->MemoryUsage(&usage, &arena);
+    // JSMemoryUsage in declaration order (without the pc2line pair), then the arena's
+    // [reservedBytes, liveBytes, peakLiveBytes, resets].
+    const jlong values[] = {
+        static_cast<jlong>(usage.malloc_size),
+        static_cast<jlong>(usage.malloc_limit),
+        static_cast<jlong>(usage.memory_used_size),
+        static_cast<jlong>(usage.malloc_count),
+        static_cast<jlong>(usage.memory_used_count),
+        static_cast<jlong>(usage.atom_count),
+        static_cast<jlong>(usage.atom_size),
+        static_cast<jlong>(usage.str_count),
+        static_cast<jlong>(usage.str_size),
+        static_cast<jlong>(usage.obj_count),
+        static_cast<jlong>(usage.obj_size),
+        static_cast<jlong>(usage.prop_count),
+        static_cast<jlong>(usage.prop_size),
+        static_cast<jlong>(usage.shape_count),
+        static_cast<jlong>(usage.shape_size),
+        static_cast<jlong>(usage.js_func_count),
+        static_cast<jlong>(usage.js_func_size),
+        static_cast<jlong>(usage.js_func_code_size),
+        static_cast<jlong>(usage.c_func_count),
+        static_cast<jlong>(usage.array_count),
+        static_cast<jlong>(usage.fast_array_count),
+        static_cast<jlong>(usage.fast_array_elements),
+        static_cast<jlong>(usage.binary_object_count),
+        static_cast<jlong>(usage.binary_object_size),
+        static_cast<jlong>(arena.reserved_bytes),
+        static_cast<jlong>(arena.live_bytes),
+        static_cast<jlong>(arena.peak_live_bytes),
+        static_cast<jlong>(arena.resets),
+    };
+    const jsize count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray result = env->NewLongArray(count);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count, values);
+    }
+    return result;
+}
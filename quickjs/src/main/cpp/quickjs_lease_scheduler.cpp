@@ -0,0 +1,88 @@
+#include "quickjs_lease_scheduler.h"
+
+#include <algorithm>
+
+namespace quickjsjni {
+
+LeaseScheduler::LeaseScheduler(size_t slots) : busy_(std::max<size_t>(slots, 1), false) {
+    metrics_.slots = busy_.size();
+}
+
+int LeaseScheduler::Acquire(int64_t affinity_key, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> guard(lock_);
+    int slot = TakeFreeSlotLocked(affinity_key);
+    if (slot >= 0) {
+        metrics_.leases += 1;
+        return slot;
+    }
+
+    metrics_.waiting += 1;
+    metrics_.peak_waiting = std::max(metrics_.peak_waiting, metrics_.waiting);
+    const auto start = std::chrono::steady_clock::now();
+    const auto ready = [&] {
+        slot = TakeFreeSlotLocked(affinity_key);
+        return slot >= 0;
+    };
+    if (timeout.count() < 0) {
+        released_.wait(guard, ready);
+    } else {
+        released_.wait_for(guard, timeout, ready);
+    }
+    const auto waited = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    metrics_.waiting -= 1;
+    metrics_.total_wait_nanos += waited;
+    metrics_.max_wait_nanos = std::max(metrics_.max_wait_nanos, waited);
+    if (slot < 0) {
+        metrics_.timeouts += 1;
+        return -1;
+    }
+    metrics_.leases += 1;
+    return slot;
+}
+
+void LeaseScheduler::Release(int slot) {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (slot < 0 || static_cast<size_t>(slot) >= busy_.size() || !busy_[slot]) {
+            return;
+        }
+        busy_[slot] = false;
+        metrics_.busy -= 1;
+    }
+    // Waiters may be pinned to different slots, so wake them all.
+    released_.notify_all();
+}
+
+LeaseMetrics LeaseScheduler::Metrics() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return metrics_;
+}
+
+int LeaseScheduler::TakeFreeSlotLocked(int64_t affinity_key) {
+    const size_t slots = busy_.size();
+    size_t slot = slots;
+    if (affinity_key >= 0) {
+        const size_t pinned = static_cast<size_t>(affinity_key) % slots;
+        if (!busy_[pinned]) {
+            slot = pinned;
+        }
+    } else {
+        for (size_t offset = 0; offset < slots; offset += 1) {
+            const size_t candidate = (cursor_ + offset) % slots;
+            if (!busy_[candidate]) {
+                slot = candidate;
+                cursor_ = (candidate + 1) % slots;
+                break;
+            }
+        }
+    }
+    if (slot == slots) {
+        return -1;
+    }
+    busy_[slot] = true;
+    metrics_.busy += 1;
+    return static_cast<int>(slot);
+}
+
+}  // namespace quickjsjni
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace quickjsjni {
+
+struct LeaseMetrics {
+    uint64_t slots = 0;
+    uint64_t busy = 0;
+    // Callers currently blocked in Acquire, and the most ever blocked at once.
+    uint64_t waiting = 0;
+    uint64_t peak_waiting = 0;
+    uint64_t leases = 0;
+    uint64_t timeouts = 0;
+    uint64_t total_wait_nanos = 0;
+    uint64_t max_wait_nanos = 0;
+};
+
+// Hands out exclusive use of one of a fixed number of slots. Without an affinity key the next
+// free slot after the last one handed out is taken; with one, always slot key % slots, so
+// callers that keep state in a runtime find it again.
+class LeaseScheduler {
+public:
+    static constexpr int64_t kNoAffinity = -1;
+
+    explicit LeaseScheduler(size_t slots);
+
+    LeaseScheduler(const LeaseScheduler&) = delete;
+    LeaseScheduler& operator=(const LeaseScheduler&) = delete;
+
+    // Returns the leased slot, or -1 if none became free within timeout (negative waits
+    // forever).
+    int Acquire(int64_t affinity_key, std::chrono::milliseconds timeout);
+    void Release(int slot);
+
+    LeaseMetrics Metrics() const;
+
+private:
+    int TakeFreeSlotLocked(int64_t affinity_key);
+
+    mutable std::mutex lock_;
+    std::condition_variable released_;
+    std::vector<bool> busy_;
+    size_t cursor_ = 0;
+    LeaseMetrics metrics_;
+};
+
+}  // namespace quickjsjni
@@ -0,0 +1,450 @@
+#include "quickjs_value_codec.h"
+
+#include <cstring>
+
+namespace quickjsjni {
+
+namespace {
+
+// Android ABIs are all little-endian, so fixed-width fields are copied as they are.
+template <typename T>
+void Put(std::vector<uint8_t>* out, T value) {
+    const size_t at = out->size();
+    out->resize(at + sizeof(T));
+    std::memcpy(out->data() + at, &value, sizeof(T));
+}
+
+void PutTag(std::vector<uint8_t>* out, ValueTag tag) {
+    out->push_back(tag);
+}
+
+void PutBytes(std::vector<uint8_t>* out, ValueTag tag, const void* data, size_t size) {
+    PutTag(out, tag);
+    Put<uint32_t>(out, static_cast<uint32_t>(size));
+    out->insert(out->end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+}
+
+void PatchU32(std::vector<uint8_t>* out, size_t at, uint32_t value) {
+    std::memcpy(out->data() + at, &value, sizeof(value));
+}
+
+// Values that JSON.stringify leaves out of objects.
+bool IsSkipped(JSContext* context, JSValueConst value) {
+    return JS_IsUndefined(value) || JS_IsSymbol(value) || JS_IsFunction(context, value);
+}
+
+}  // namespace
+
+class ValueCodec::Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool AtEnd() const {
+        return position_ == size_;
+    }
+
+    bool Tag(uint8_t* tag) {
+        return Read(tag);
+    }
+
+    template <typename T>
+    bool Read(T* value) {
+        if (size_ - position_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, data_ + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+
+    // Length-prefixed span; the pointer stays valid as long as the input does.
+    bool Span(const char** chars, uint32_t* length) {
+        if (!Read(length) || size_ - position_ < *length) {
+            return false;
+        }
+        *chars = reinterpret_cast<const char*>(data_ + position_);
+        position_ += *length;
+        return true;
+    }
+
+    // A count of values can never exceed the remaining bytes (each is at least a tag).
+    bool Count(uint32_t* count) {
+        return Read(count) && *count <= size_ - position_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_ = 0;
+};
+
+ValueCodec::ValueCodec(JSContext* context) : context_(context) {
+    JSValue global = JS_GetGlobalObject(context_);
+    array_buffer_constructor_ = JS_GetPropertyStr(context_, global, "ArrayBuffer");
+    uint8_array_constructor_ = JS_GetPropertyStr(context_, global, "Uint8Array");
+    // %TypedArray%, the common parent of Uint8Array, Float32Array and the rest.
+    typed_array_constructor_ = JS_GetPropertyStr(context_, uint8_array_constructor_, "__proto__");
+    JS_FreeValue(context_, global);
+    to_json_atom_ = JS_NewAtom(context_, "toJSON");
+    length_atom_ = JS_NewAtom(context_, "length");
+}
+
+ValueCodec::~ValueCodec() {
+    JS_FreeAtom(context_, length_atom_);
+    JS_FreeAtom(context_, to_json_atom_);
+    JS_FreeValue(context_, typed_array_constructor_);
+    JS_FreeValue(context_, uint8_array_constructor_);
+    JS_FreeValue(context_, array_buffer_constructor_);
+}
+
+bool ValueCodec::Encode(JSValueConst value, std::vector<uint8_t>* out) {
+    return EncodeValue(value, out, 0);
+}
+
+bool ValueCodec::EncodeArguments(int argc, JSValueConst* argv, std::vector<uint8_t>* out) {
+    PutTag(out, kArray);
+    Put<uint32_t>(out, static_cast<uint32_t>(argc));
+    for (int index = 0; index < argc; index += 1) {
+        if (IsSkipped(context_, argv[index])) {
+            PutTag(out, JS_IsUndefined(argv[index]) ? kUndefined : kNull);
+        } else if (!EncodeValue(argv[index], out, 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ValueCodec::EncodeValue(JSValueConst value, std::vector<uint8_t>* out, int depth) {
+    if (depth > kMaxDepth) {
+        JS_ThrowRangeError(context_, "value nested deeper than %d levels", kMaxDepth);
+        return false;
+    }
+
+    if (JS_VALUE_GET_TAG(value) == JS_TAG_INT) {
+        PutTag(out, kInt32);
+        Put<int32_t>(out, JS_VALUE_GET_INT(value));
+        return true;
+    }
+    if (JS_IsNumber(value)) {
+        double number = 0;
+        JS_ToFloat64(context_, &number, value);
+        PutTag(out, kFloat64);
+        Put<double>(out, number);
+        return true;
+    }
+    if (JS_IsString(value)) {
+        size_t length = 0;
+        const char* chars = JS_ToCStringLen(context_, &length, value);
+        if (chars == nullptr) {
+            return false;
+        }
+        PutBytes(out, kString, chars, length);
+        JS_FreeCString(context_, chars);
+        return true;
+    }
+    if (JS_IsBool(value)) {
+        PutTag(out, JS_ToBool(context_, value) ? kTrue : kFalse);
+        return true;
+    }
+    if (JS_IsUndefined(value)) {
+        PutTag(out, kUndefined);
+        return true;
+    }
+    if (!JS_IsObject(value) || JS_IsFunction(context_, value)) {
+        // null, symbols, functions and anything JSON has no form for.
+        PutTag(out, kNull);
+        return true;
+    }
+
+    JSValue to_json = JS_GetProperty(context_, value, to_json_atom_);
+    if (JS_IsException(to_json)) {
+        return false;
+    }
+    if (JS_IsFunction(context_, to_json)) {
+        JSValue replaced = JS_Call(context_, to_json, value, 0, nullptr);
+        JS_FreeValue(context_, to_json);
+        if (JS_IsException(replaced)) {
+            return false;
+        }
+        // toJSON may return another object with toJSON; the depth limit ends that.
+        const bool encoded = EncodeValue(replaced, out, depth + 1);
+        JS_FreeValue(context_, replaced);
+        return encoded;
+    }
+    JS_FreeValue(context_, to_json);
+
+    const int binary = EncodeBinaryObject(value, out);
+    if (binary != 0) {
+        return binary > 0;
+    }
+    return EncodeObject(value, out, depth);
+}
+
+bool ValueCodec::EncodeObject(JSValueConst object, std::vector<uint8_t>* out, int depth) {
+    const int is_array = JS_IsArray(context_, object);
+    if (is_array < 0) {
+        return false;
+    }
+    if (is_array > 0) {
+        JSValue length_value = JS_GetProperty(context_, object, length_atom_);
+        uint32_t length = 0;
+        const int status = JS_ToUint32(context_, &length, length_value);
+        JS_FreeValue(context_, length_value);
+        if (status != 0) {
+            return false;
+        }
+        PutTag(out, kArray);
+        Put<uint32_t>(out, length);
+        for (uint32_t index = 0; index < length; index += 1) {
+            JSValue element = JS_GetPropertyUint32(context_, object, index);
+            if (JS_IsException(element)) {
+                return false;
+            }
+            bool encoded = true;
+            if (IsSkipped(context_, element)) {
+                PutTag(out, kNull);
+            } else {
+                encoded = EncodeValue(element, out, depth + 1);
+            }
+            JS_FreeValue(context_, element);
+            if (!encoded) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    JSPropertyEnum* properties = nullptr;
+    uint32_t property_count = 0;
+    if (JS_GetOwnPropertyNames(
+            context_,
+            &properties,
+            &property_count,
+            object,
+            JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY
+        ) != 0) {
+        return false;
+    }
+
+    bool encoded = true;
+    PutTag(out, kObject);
+    const size_t count_at = out->size();
+    Put<uint32_t>(out, 0);
+    uint32_t written = 0;
+    for (uint32_t index = 0; index < property_count && encoded; index += 1) {
+        JSValue property = JS_GetProperty(context_, object, properties[index].atom);
+        if (JS_IsException(property)) {
+            encoded = false;
+            break;
+        }
+        if (!IsSkipped(context_, property)) {
+            const char* key = JS_AtomToCString(context_, properties[index].atom);
+            if (key == nullptr) {
+                encoded = false;
+            } else {
+                const size_t key_length = std::strlen(key);
+                Put<uint32_t>(out, static_cast<uint32_t>(key_length));
+                out->insert(out->end(), key, key + key_length);
+                JS_FreeCString(context_, key);
+                encoded = EncodeValue(property, out, depth + 1);
+                written += 1;
+            }
+        }
+        JS_FreeValue(context_, property);
+    }
+    for (uint32_t index = 0; index < property_count; index += 1) {
+        JS_FreeAtom(context_, properties[index].atom);
+    }
+    js_free(context_, properties);
+    if (encoded) {
+        PatchU32(out, count_at, written);
+    }
+    return encoded;
+}
+
+int ValueCodec::EncodeBinaryObject(JSValueConst object, std::vector<uint8_t>* out) {
+    const int is_buffer = JS_IsInstanceOf(context_, object, array_buffer_constructor_);
+    if (is_buffer < 0) {
+        return -1;
+    }
+    if (is_buffer > 0) {
+        size_t size = 0;
+        uint8_t* bytes = JS_GetArrayBuffer(context_, &size, object);
+        if (bytes == nullptr && size != 0) {
+            return -1;
+        }
+        PutBytes(out, kBytes, bytes, size);
+        return 1;
+    }
+
+    const int is_typed = JS_IsInstanceOf(context_, object, typed_array_constructor_);
+    if (is_typed <= 0) {
+        return is_typed;
+    }
+    size_t byte_offset = 0;
+    size_t byte_length = 0;
+    size_t element_size = 0;
+    JSValue buffer = JS_GetTypedArrayBuffer(context_, object, &byte_offset, &byte_length, &element_size);
+    if (JS_IsException(buffer)) {
+        return -1;
+    }
+    size_t size = 0;
+    uint8_t* bytes = JS_GetArrayBuffer(context_, &size, buffer);
+    JS_FreeValue(context_, buffer);
+    if (bytes == nullptr && byte_length != 0) {
+        return -1;
+    }
+    PutBytes(out, kBytes, bytes == nullptr ? nullptr : bytes + byte_offset, byte_length);
+    return 1;
+}
+
+JSValue ValueCodec::Decode(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    JSValue value = DecodeValue(&reader, 0);
+    if (!JS_IsException(value) && !reader.AtEnd()) {
+        JS_FreeValue(context_, value);
+        return JS_ThrowTypeError(context_, "trailing bytes after binary value");
+    }
+    return value;
+}
+
+bool ValueCodec::DecodeArguments(const uint8_t* data, size_t size, std::vector<JSValue>* argv) {
+    Reader reader(data, size);
+    uint8_t tag = 0;
+    uint32_t count = 0;
+    if (!reader.Tag(&tag) || tag != kArray || !reader.Count(&count)) {
+        JS_ThrowTypeError(context_, "binary arguments must be an array");
+        return false;
+    }
+    argv->reserve(argv->size() + count);
+    for (uint32_t index = 0; index < count; index += 1) {
+        JSValue value = DecodeValue(&reader, 1);
+        if (JS_IsException(value)) {
+            return false;
+        }
+        argv->push_back(value);
+    }
+    if (!reader.AtEnd()) {
+        JS_ThrowTypeError(context_, "trailing bytes after binary arguments");
+        return false;
+    }
+    return true;
+}
+
+JSValue ValueCodec::DecodeValue(Reader* reader, int depth) {
+    if (depth > kMaxDepth) {
+        return JS_ThrowRangeError(context_, "value nested deeper than %d levels", kMaxDepth);
+    }
+
+    uint8_t tag = 0;
+    if (!reader->Tag(&tag)) {
+        return JS_ThrowTypeError(context_, "truncated binary value");
+    }
+    switch (tag) {
+        case kNull:
+            return JS_NULL;
+        case kUndefined:
+            return JS_UNDEFINED;
+        case kFalse:
+            return JS_NewBool(context_, 0);
+        case kTrue:
+            return JS_NewBool(context_, 1);
+        case kInt32: {
+            int32_t number = 0;
+            if (!reader->Read(&number)) {
+                break;
+            }
+            return JS_NewInt32(context_, number);
+        }
+        case kFloat64: {
+            double number = 0;
+            if (!reader->Read(&number)) {
+                break;
+            }
+            return JS_NewFloat64(context_, number);
+        }
+        case kString: {
+            const char* chars = nullptr;
+            uint32_t length = 0;
+            if (!reader->Span(&chars, &length)) {
+                break;
+            }
+            return JS_NewStringLen(context_, chars, length);
+        }
+        case kBytes: {
+            const char* bytes = nullptr;
+            uint32_t length = 0;
+            if (!reader->Span(&bytes, &length)) {
+                break;
+            }
+            JSValue buffer = JS_NewArrayBufferCopy(context_, reinterpret_cast<const uint8_t*>(bytes), length);
+            if (JS_IsException(buffer)) {
+                return buffer;
+            }
+            JSValue view = JS_CallConstructor(context_, uint8_array_constructor_, 1, &buffer);
+            JS_FreeValue(context_, buffer);
+            return view;
+        }
+        case kArray: {
+            uint32_t count = 0;
+            if (!reader->Count(&count)) {
+                break;
+            }
+            JSValue array = JS_NewArray(context_);
+            if (JS_IsException(array)) {
+                return array;
+            }
+            for (uint32_t index = 0; index < count; index += 1) {
+                JSValue element = DecodeValue(reader, depth + 1);
+                if (JS_IsException(element) ||
+                    JS_DefinePropertyValueUint32(context_, array, index, element, JS_PROP_C_W_E) < 0) {
+                    JS_FreeValue(context_, array);
+                    return JS_EXCEPTION;
+                }
+            }
+            return array;
+        }
+        case kObject: {
+            uint32_t count = 0;
+            if (!reader->Count(&count)) {
+                break;
+            }
+            JSValue object = JS_NewObject(context_);
+            if (JS_IsException(object)) {
+                return object;
+            }
+            for (uint32_t index = 0; index < count; index += 1) {
+                const char* key = nullptr;
+                uint32_t key_length = 0;
+                if (!reader->Span(&key, &key_length)) {
+                    JS_FreeValue(context_, object);
+                    return JS_ThrowTypeError(context_, "truncated binary value");
+                }
+                JSValue property = DecodeValue(reader, depth + 1);
+                if (JS_IsException(property)) {
+                    JS_FreeValue(context_, object);
+                    return property;
+                }
+                JSAtom atom = JS_NewAtomLen(context_, key, key_length);
+                const int defined = atom == JS_ATOM_NULL
+                    ? -1
+                    : JS_DefinePropertyValue(context_, object, atom, property, JS_PROP_C_W_E);
+                if (atom == JS_ATOM_NULL) {
+                    JS_FreeValue(context_, property);
+                } else {
+                    JS_FreeAtom(context_, atom);
+                }
+                if (defined < 0) {
+                    JS_FreeValue(context_, object);
+                    return JS_EXCEPTION;
+                }
+            }
+            return object;
+        }
+        default:
+            return JS_ThrowTypeError(context_, "unknown binary value tag %d", tag);
+    }
+    return JS_ThrowTypeError(context_, "truncated binary value");
+}
+
+}  // namespace quickjsjni
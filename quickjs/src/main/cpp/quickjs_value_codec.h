@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../../thirdparty/quickjs/quickjs.h"
+
+namespace quickjsjni {
+
+// Compact binary form of plain JS data, shared with QuickJsBinaryValues.kt so that values
+// cross JNI as one buffer instead of a JSON string. Little-endian; each value is a tag byte
+// followed by its payload:
+//   kNull, kUndefined, kFalse, kTrue      no payload
+//   kInt32                                int32
+//   kFloat64                              float64
+//   kString, kBytes                       uint32 byte length, UTF-8 / raw bytes
+//   kArray                                uint32 count, count values
+//   kObject                               uint32 count, count x (uint32 length, UTF-8 key, value)
+// Like JSON.stringify, toJSON() is honoured, and functions and symbols are dropped from
+// objects and become null elsewhere. ArrayBuffers and typed arrays travel as kBytes, and
+// kBytes decodes to a Uint8Array.
+enum ValueTag : uint8_t {
+    kNull = 0,
+    kUndefined = 1,
+    kFalse = 2,
+    kTrue = 3,
+    kInt32 = 4,
+    kFloat64 = 5,
+    kString = 6,
+    kArray = 7,
+    kObject = 8,
+    kBytes = 9,
+};
+
+// Converts between JSValues and the binary form for one context; not thread-safe.
+class ValueCodec {
+public:
+    explicit ValueCodec(JSContext* context);
+    ~ValueCodec();
+
+    ValueCodec(const ValueCodec&) = delete;
+    ValueCodec& operator=(const ValueCodec&) = delete;
+
+    // Appends the encoding of value to out. Returns false with a pending JS exception
+    // (nesting too deep, or a throwing getter / toJSON).
+    bool Encode(JSValueConst value, std::vector<uint8_t>* out);
+
+    // Appends argv as one kArray value.
+    bool EncodeArguments(int argc, JSValueConst* argv, std::vector<uint8_t>* out);
+
+    // Returns JS_EXCEPTION with a pending TypeError if data is not exactly one valid value.
+    JSValue Decode(const uint8_t* data, size_t size);
+
+    // Decodes a top-level kArray into separate values (owned by the caller) without
+    // materialising the array itself.
+    bool DecodeArguments(const uint8_t* data, size_t size, std::vector<JSValue>* argv);
+
+    static constexpr int kMaxDepth = 256;
+
+private:
+    class Reader;
+
+    bool EncodeValue(JSValueConst value, std::vector<uint8_t>* out, int depth);
+    bool EncodeObject(JSValueConst object, std::vector<uint8_t>* out, int depth);
+    // 1 if value is an ArrayBuffer or typed array (bytes written), 0 if not, -1 on exception.
+    int EncodeBinaryObject(JSValueConst object, std::vector<uint8_t>* out);
+    JSValue DecodeValue(Reader* reader, int depth);
+
+    JSContext* context_;
+    JSValue array_buffer_constructor_;
+    JSValue typed_array_constructor_;
+    JSValue uint8_array_constructor_;
+    JSAtom to_json_atom_;
+    JSAtom length_atom_;
+};
+
+}  // namespace quickjsjni
@@ -8,28 +8,69 @@ import org.json.JSONArray
 import org.json.JSONObject
 import org.json.JSONTokener
 
-class OperitQuickJsEngine : Closeable {
+/**
+ * QuickJS runtimes behind one native interface. With [runtimeCount] > 1 the runtimes form a
+ * [QuickJsRuntimePool]: callers lease one with [withRuntime] so independent calls run in
+ * parallel, and address it by index afterwards, since timers, promises and callbacks belong to
+ * the runtime that created them. Every runtime gets the compat layer; anything else (bootstrap
+ * scripts) has to be evaluated on each index.
+ */
+class OperitQuickJsEngine(
+    options: QuickJsNativeRuntime.Options = QuickJsNativeRuntime.Options(),
+    runtimeCount: Int = 1
+) : Closeable {
 
-    private val runtimeRef = AtomicReference<QuickJsNativeRuntime?>()
     private val nativeInterfaceRef = AtomicReference<Any?>()
     private val methodCache = ConcurrentHashMap<String, Method>()
-    private val hostDispatcher = QuickJsNativeHostDispatcher(
-        runtimeProvider = { runtimeRef.get() ?: error("QuickJS runtime is not ready") },
-        forwardCall = ::dispatchNativeCall
-    )
-    private val runtime = QuickJsNativeRuntime.create(hostDispatcher).also { quickJs ->
-        runtimeRef.set(quickJs)
-        quickJs.installCompatLayerOrThrow()
+    private val callingRuntime = ThreadLocal<Int>()
+    private val pool = QuickJsRuntimePool.create(runtimeCount, options) { index, runtimeProvider ->
+        QuickJsNativeHostDispatcher(
+            runtimeProvider = runtimeProvider,
+            forwardCall = { methodName, argsJson -> dispatchNativeCall(index, methodName, argsJson) }
+        )
     }
 
+    val runtimeCount: Int
+        get() = pool.size
+
     fun bindNativeInterface(instance: Any) {
         nativeInterfaceRef.set(instance)
         methodCache.clear()
     }
 
+    /**
+     * Index of the runtime whose script is calling into the native interface on this thread,
+     * or -1 outside such a call. Lets the interface send a later callback to that runtime.
+     */
+    fun callingRuntimeIndex(): Int = callingRuntime.get() ?: -1
+
+    /**
+     * Runs [block] with the index of a leased runtime; see [QuickJsRuntimePool.withRuntime]. The
+     * lease only keeps other [withRuntime] callers off the runtime, so [block] should cover the
+     * synchronous part of a call and leave its asynchronous tail to the runtime.
+     */
+    fun <T> withRuntime(
+        affinityKey: Long = QuickJsRuntimePool.NO_AFFINITY,
+        timeoutMillis: Long = -1L,
+        block: (runtimeIndex: Int) -> T
+    ): T {
+        return pool.withRuntime(affinityKey, timeoutMillis) { runtime -> block(pool.indexOf(runtime)) }
+    }
+
     @Suppress("UNCHECKED_CAST")
-    fun <T> evaluate(script: String, fileName: String = "<eval>"): T? {
-        val result = runtime.eval(script, fileName)
+    fun <T> evaluate(
+        script: String,
+        fileName: String = "<eval>",
+        useBytecodeCache: Boolean = false,
+        runtimeIndex: Int = 0
+    ): T? {
+        val runtime = pool.runtime(runtimeIndex)
+        val result =
+            if (useBytecodeCache) {
+                runtime.evalCached(script, fileName)
+            } else {
+                runtime.eval(script, fileName)
+            }
         runtime.executePendingJobs()
         if (!result.success) {
             error(result.describeFailure("QuickJS evaluation failed"))
@@ -41,8 +82,10 @@ class OperitQuickJsEngine : Closeable {
     fun <T> callFunction(
         functionName: String,
         argsJson: String,
-        callSite: String = "<call:$functionName>"
+        callSite: String = "<call:$functionName>",
+        runtimeIndex: Int = 0
     ): T? {
+        val runtime = pool.runtime(runtimeIndex)
         val result = runtime.callFunction(functionName, argsJson, callSite)
         runtime.executePendingJobs()
         if (!result.success) {
@@ -51,27 +94,59 @@ class OperitQuickJsEngine : Closeable {
         return decodeJsonValue(result.valueJson) as T?
     }
 
+    /**
+     * Like [callFunction], but [args] and the result cross JNI in [QuickJsBinaryValues] form; see
+     * [QuickJsNativeRuntime.callFunctionValue]. Objects come back as Map, not as JSON text.
+     */
+    fun callFunctionValue(
+        functionName: String,
+        args: List<Any?>,
+        callSite: String = "<call:$functionName>",
+        runtimeIndex: Int = 0
+    ): Any? {
+        val runtime = pool.runtime(runtimeIndex)
+        val result = runtime.callFunctionValue(functionName, args, callSite)
+        runtime.executePendingJobs()
+        val failure = result.failure
+        if (failure != null) {
+            error(failure.describeFailure("QuickJS function call failed"))
+        }
+        return result.value
+    }
+
+    /** Interrupts whatever each runtime is currently running. */
     fun interrupt() {
-        runtime.interrupt()
+        pool.interruptAll()
     }
 
+    fun memoryUsage(runtimeIndex: Int = 0): QuickJsNativeRuntime.MemoryUsage =
+        pool.runtime(runtimeIndex).memoryUsage()
+
+    fun metrics(): QuickJsRuntimePool.Metrics = pool.metrics()
+
     override fun close() {
-        runCatching { runtime.clearAllTimers() }
-        hostDispatcher.close()
-        runtime.close()
-        runtimeRef.set(null)
+        repeat(pool.size) { index ->
+            runCatching { pool.runtime(index).clearAllTimers() }
+        }
+        pool.close()
         nativeInterfaceRef.set(null)
         methodCache.clear()
     }
 
-    private fun dispatchNativeCall(methodName: String, argsJson: String?): String? {
+    private fun dispatchNativeCall(runtimeIndex: Int, methodName: String, argsJson: String?): String? {
         val target = nativeInterfaceRef.get() ?: error("NativeInterface is not bound")
         val args = decodeArgs(argsJson)
         val method = resolveMethod(target, methodName, args.size)
         val convertedArgs = method.parameterTypes.mapIndexed { index, type ->
             convertArg(args[index], type)
         }.toTypedArray()
-        return method.invoke(target, *convertedArgs)?.toString()
+        val outer = callingRuntime.get()
+        callingRuntime.set(runtimeIndex)
+        try {
+            return method.invoke(target, *convertedArgs)?.toString()
+        } finally {
+            if (outer == null) callingRuntime.remove() else callingRuntime.set(outer)
+        }
     }
 
     private fun resolveMethod(target: Any, methodName: String, argCount: Int): Method {
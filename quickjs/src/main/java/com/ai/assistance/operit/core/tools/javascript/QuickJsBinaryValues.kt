@@ -0,0 +1,239 @@
+package com.ai.assistance.operit.core.tools.javascript
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.CharBuffer
+import java.nio.charset.CharsetEncoder
+import java.nio.charset.CoderResult
+import java.nio.charset.CodingErrorAction
+import java.nio.charset.StandardCharsets
+import org.json.JSONArray
+import org.json.JSONObject
+
+/**
+ * Kotlin side of the binary value form in quickjs_value_codec.h, used by
+ * [QuickJsNativeRuntime.callFunctionValue] and [QuickJsNativeRuntime.HostBridge.onCallBinary]
+ * to pass values without going through JSON strings.
+ *
+ * Encodes null, booleans, numbers, CharSequence, ByteArray (a Uint8Array in JS), List, Array,
+ * Map and org.json values; anything else as its toString(). Decodes to null, Boolean, Int,
+ * Double, String, ByteArray, List<Any?> and Map<String, Any?>.
+ */
+object QuickJsBinaryValues {
+    private const val TAG_NULL = 0
+    private const val TAG_UNDEFINED = 1
+    private const val TAG_FALSE = 2
+    private const val TAG_TRUE = 3
+    private const val TAG_INT32 = 4
+    private const val TAG_FLOAT64 = 5
+    private const val TAG_STRING = 6
+    private const val TAG_ARRAY = 7
+    private const val TAG_OBJECT = 8
+    private const val TAG_BYTES = 9
+
+    private const val MAX_DEPTH = 256
+
+    /** Encodes [value] into a new direct buffer holding exactly the encoding. */
+    fun encode(value: Any?): ByteBuffer = Encoder().encode(value)
+
+    /** Decodes the bytes between [buffer]'s position and limit; the position is not moved. */
+    fun decode(buffer: ByteBuffer): Any? = Decoder().decode(buffer)
+
+    /**
+     * Reusable encoder; the returned buffer is a view of its storage and is overwritten by the
+     * next [encode]. Not thread-safe.
+     */
+    class Encoder(initialCapacity: Int = 4096) {
+        private var buffer = allocate(initialCapacity)
+        private val utf8: CharsetEncoder = StandardCharsets.UTF_8.newEncoder()
+            .onMalformedInput(CodingErrorAction.REPLACE)
+            .onUnmappableCharacter(CodingErrorAction.REPLACE)
+
+        fun encode(value: Any?): ByteBuffer {
+            buffer.clear()
+            write(value, 0)
+            val view = buffer.duplicate()
+            view.flip()
+            return view.slice().order(ByteOrder.LITTLE_ENDIAN)
+        }
+
+        /** Encodes [values] as one array, the form native code expects for call arguments. */
+        fun encodeArguments(values: List<Any?>): ByteBuffer = encode(values)
+
+        private fun write(value: Any?, depth: Int) {
+            require(depth <= MAX_DEPTH) { "value nested deeper than $MAX_DEPTH levels" }
+            when (value) {
+                null, JSONObject.NULL, Unit -> putTag(TAG_NULL)
+                is Boolean -> putTag(if (value) TAG_TRUE else TAG_FALSE)
+                is Int, is Short, is Byte -> putInt((value as Number).toInt())
+                is Long ->
+                    if (value in Int.MIN_VALUE..Int.MAX_VALUE) {
+                        putInt(value.toInt())
+                    } else {
+                        putDouble(value.toDouble())
+                    }
+                is Number -> putDouble(value.toDouble())
+                is CharSequence -> putString(value)
+                is Char -> putString(value.toString())
+                is ByteArray -> {
+                    ensure(5 + value.size)
+                    buffer.put(TAG_BYTES.toByte()).putInt(value.size).put(value)
+                }
+                is Map<*, *> -> {
+                    putCount(TAG_OBJECT, value.size)
+                    value.forEach { (key, item) ->
+                        putUtf8(key.toString())
+                        write(item, depth + 1)
+                    }
+                }
+                is JSONObject -> {
+                    putCount(TAG_OBJECT, value.length())
+                    value.keys().forEach { key ->
+                        putUtf8(key)
+                        write(value.opt(key), depth + 1)
+                    }
+                }
+                is Collection<*> -> {
+                    putCount(TAG_ARRAY, value.size)
+                    value.forEach { write(it, depth + 1) }
+                }
+                is Array<*> -> {
+                    putCount(TAG_ARRAY, value.size)
+                    value.forEach { write(it, depth + 1) }
+                }
+                is JSONArray -> {
+                    putCount(TAG_ARRAY, value.length())
+                    for (index in 0 until value.length()) {
+                        write(value.opt(index), depth + 1)
+                    }
+                }
+                else -> putString(value.toString())
+            }
+        }
+
+        private fun putTag(tag: Int) {
+            ensure(1)
+            buffer.put(tag.toByte())
+        }
+
+        private fun putInt(value: Int) {
+            ensure(5)
+            buffer.put(TAG_INT32.toByte()).putInt(value)
+        }
+
+        private fun putDouble(value: Double) {
+            ensure(9)
+            buffer.put(TAG_FLOAT64.toByte()).putDouble(value)
+        }
+
+        private fun putCount(tag: Int, count: Int) {
+            ensure(5)
+            buffer.put(tag.toByte()).putInt(count)
+        }
+
+        private fun putString(value: CharSequence) {
+            putTag(TAG_STRING)
+            putUtf8(value)
+        }
+
+        /** Length-prefixed UTF-8, encoded straight into the buffer. */
+        private fun putUtf8(value: CharSequence) {
+            ensure(4 + value.length)
+            val lengthAt = buffer.position()
+            buffer.position(lengthAt + 4)
+            val chars = CharBuffer.wrap(value)
+            utf8.reset()
+            while (true) {
+                val result = utf8.encode(chars, buffer, true)
+                if (result == CoderResult.OVERFLOW) {
+                    grow(maxOf(16L, chars.remaining() * 3L))
+                    continue
+                }
+                if (utf8.flush(buffer) == CoderResult.OVERFLOW) {
+                    grow(16)
+                    continue
+                }
+                break
+            }
+            buffer.putInt(lengthAt, buffer.position() - lengthAt - 4)
+        }
+
+        private fun ensure(bytes: Int) {
+            if (buffer.remaining() < bytes) {
+                grow(bytes.toLong())
+            }
+        }
+
+        private fun grow(extra: Long) {
+            val needed = buffer.position() + extra
+            require(needed <= Int.MAX_VALUE) { "encoded value exceeds 2 GB" }
+            var capacity = buffer.capacity().toLong()
+            while (capacity < needed) {
+                capacity *= 2
+            }
+            val grown = allocate(minOf(capacity, Int.MAX_VALUE.toLong()).toInt())
+            buffer.flip()
+            grown.put(buffer)
+            buffer = grown
+        }
+
+        private fun allocate(capacity: Int): ByteBuffer =
+            ByteBuffer.allocateDirect(maxOf(capacity, 16)).order(ByteOrder.LITTLE_ENDIAN)
+    }
+
+    /** Reusable decoder; keeps a scratch array for string bytes. Not thread-safe. */
+    class Decoder {
+        private var scratch = ByteArray(256)
+
+        fun decode(buffer: ByteBuffer): Any? {
+            val input = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+            val value = read(input, 0)
+            require(!input.hasRemaining()) { "trailing bytes after binary value" }
+            return value
+        }
+
+        private fun read(input: ByteBuffer, depth: Int): Any? {
+            require(depth <= MAX_DEPTH) { "value nested deeper than $MAX_DEPTH levels" }
+            return when (val tag = input.get().toInt()) {
+                TAG_NULL, TAG_UNDEFINED -> null
+                TAG_FALSE -> false
+                TAG_TRUE -> true
+                TAG_INT32 -> input.getInt()
+                TAG_FLOAT64 -> input.getDouble()
+                TAG_STRING -> readUtf8(input)
+                TAG_BYTES -> ByteArray(readLength(input)).also { input.get(it) }
+                TAG_ARRAY -> {
+                    val count = readLength(input)
+                    ArrayList<Any?>(count).apply {
+                        repeat(count) { add(read(input, depth + 1)) }
+                    }
+                }
+                TAG_OBJECT -> {
+                    val count = readLength(input)
+                    LinkedHashMap<String, Any?>(maxOf(16, count * 2)).apply {
+                        repeat(count) {
+                            val key = readUtf8(input)
+                            put(key, read(input, depth + 1))
+                        }
+                    }
+                }
+                else -> throw IllegalArgumentException("unknown binary value tag $tag")
+            }
+        }
+
+        private fun readLength(input: ByteBuffer): Int {
+            val length = input.getInt()
+            require(length >= 0 && length <= input.remaining()) { "truncated binary value" }
+            return length
+        }
+
+        private fun readUtf8(input: ByteBuffer): String {
+            val length = readLength(input)
+            if (scratch.size < length) {
+                scratch = ByteArray(maxOf(length, scratch.size * 2))
+            }
+            input.get(scratch, 0, length)
+            return String(scratch, 0, length, StandardCharsets.UTF_8)
+        }
+    }
+}
@@ -17,10 +17,13 @@ internal fun buildQuickJsCompatScript(): String =
                 return nativeBridge.__call(method, args == null ? null : JSON.stringify(args));
             }
 
+            // Native entry points; every other name, __-prefixed ones included, is a host method.
+            var nativeEntryPoints = { __call: true, __callBinary: true, __callAsync: true };
             root.NativeInterface = new Proxy({}, {
                 get: function(_, property) {
-                    if (property === '__call') {
-                        return nativeBridge && nativeBridge.__call;
+                    if (typeof property === 'string' &&
+                        Object.prototype.hasOwnProperty.call(nativeEntryPoints, property)) {
+                        return nativeBridge && nativeBridge[property];
                     }
                     return function() {
                         return callHost(String(property), Array.prototype.slice.call(arguments));
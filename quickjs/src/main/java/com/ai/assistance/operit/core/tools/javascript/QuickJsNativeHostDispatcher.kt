@@ -3,6 +3,7 @@ package com.ai.assistance.operit.core.tools.javascript
 import java.io.Closeable
 import java.util.concurrent.ConcurrentHashMap
 import java.util.concurrent.Executors
+import java.util.concurrent.RejectedExecutionException
 import java.util.concurrent.ScheduledFuture
 import java.util.concurrent.TimeUnit
 import kotlin.math.max
@@ -17,6 +18,9 @@ class QuickJsNativeHostDispatcher(
         Thread(runnable, "QuickJsNativeTimer").apply { isDaemon = true }
     }
     private val timerTasks = ConcurrentHashMap<Int, ScheduledFuture<*>>()
+    private val asyncExecutor = Executors.newCachedThreadPool { runnable ->
+        Thread(runnable, "QuickJsNativeAsync").apply { isDaemon = true }
+    }
 
     override fun onCall(method: String, argsJson: String?): String? {
         return when {
@@ -33,10 +37,35 @@ class QuickJsNativeHostDispatcher(
         }
     }
 
+    /**
+     * Runs [forwardCall] on a worker thread so that NativeInterface.__callAsync calls overlap,
+     * then settles the promise from the timer thread. Console and timer calls stay synchronous.
+     */
+    override fun onCallAsync(method: String, argsJson: String?, callId: Long): Boolean {
+        if (method.startsWith("console.") || method == "scheduleTimer" || method == "cancelTimer") {
+            return false
+        }
+        asyncExecutor.execute {
+            val runtime = runtimeProvider()
+            try {
+                runtime.resolveAsyncCall(callId, forwardCall(method, argsJson))
+            } catch (e: Exception) {
+                runtime.rejectAsyncCall(callId, e.message ?: e.toString())
+            }
+            try {
+                scheduler.execute { runtime.executePendingJobsIfOpen() }
+            } catch (_: RejectedExecutionException) {
+                // closed meanwhile; the runtime is going away with its pending jobs
+            }
+        }
+        return true
+    }
+
     override fun close() {
         timerTasks.values.forEach { it.cancel(false) }
         timerTasks.clear()
         scheduler.shutdownNow()
+        asyncExecutor.shutdownNow()
     }
 
     private fun schedule(argsJson: String?) {
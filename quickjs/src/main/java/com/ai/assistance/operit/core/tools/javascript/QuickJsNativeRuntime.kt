@@ -1,7 +1,13 @@
 package com.ai.assistance.operit.core.tools.javascript
 
 import java.io.Closeable
+import java.io.File
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+import org.json.JSONArray
 import org.json.JSONObject
 
 internal object QuickJsNativeBridge {
@@ -10,14 +16,56 @@ internal object QuickJsNativeBridge {
     }
 
     @JvmStatic
-    external fun nativeCreate(hostBridge: QuickJsNativeRuntime.HostBridge): Long
+    external fun nativeCreate(
+        hostBridge: QuickJsNativeRuntime.HostBridge,
+        memoryLimitBytes: Long,
+        gcThresholdBytes: Long,
+        maxStackSizeBytes: Long,
+        useArena: Boolean
+    ): Long
 
     @JvmStatic
     external fun nativeDestroy(handle: Long)
 
+    @JvmStatic
+    external fun nativeCreatePool(
+        hostBridges: Array<QuickJsNativeRuntime.HostBridge>,
+        memoryLimitBytes: Long,
+        gcThresholdBytes: Long,
+        maxStackSizeBytes: Long,
+        useArena: Boolean
+    ): Long
+
+    @JvmStatic
+    external fun nativeDestroyPool(poolHandle: Long)
+
+    @JvmStatic
+    external fun nativePoolRuntime(poolHandle: Long, index: Int): Long
+
+    @JvmStatic
+    external fun nativePoolLease(poolHandle: Long, affinityKey: Long, timeoutMillis: Long): Int
+
+    @JvmStatic
+    external fun nativePoolRelease(poolHandle: Long, index: Int)
+
+    @JvmStatic
+    external fun nativePoolMetrics(poolHandle: Long): LongArray
+
     @JvmStatic
     external fun nativeEvaluate(handle: Long, script: String, fileName: String): String
 
+    @JvmStatic
+    external fun nativeEvaluateCached(handle: Long, script: String, fileName: String): String
+
+    @JvmStatic
+    external fun nativePrecompile(handle: Long, script: String, fileName: String): String
+
+    @JvmStatic
+    external fun nativeSetBytecodeCacheDir(directory: String)
+
+    @JvmStatic
+    external fun nativeGetBytecodeCacheStats(): LongArray
+
     @JvmStatic
     external fun nativeCallFunction(
         handle: Long,
@@ -26,20 +74,70 @@ internal object QuickJsNativeBridge {
         callSite: String
     ): String
 
+    /** Returns a direct ByteBuffer with the encoded result, or the failure envelope as a String. */
+    @JvmStatic
+    external fun nativeCallFunctionBinary(
+        handle: Long,
+        functionName: String,
+        args: ByteBuffer,
+        argsLength: Int,
+        callSite: String
+    ): Any?
+
     @JvmStatic
     external fun nativeExecutePendingJobs(handle: Long, maxJobs: Int): Int
 
+    @JvmStatic
+    external fun nativeCompleteAsyncCall(handle: Long, callId: Long, success: Boolean, value: String?)
+
     @JvmStatic
     external fun nativeInterrupt(handle: Long)
+
+    @JvmStatic
+    external fun nativeResetRuntime(handle: Long): Boolean
+
+    @JvmStatic
+    external fun nativeGetMemoryUsage(handle: Long): LongArray
 }
 
 class QuickJsNativeRuntime private constructor(
     private val handle: Long,
-    @Suppress("unused") private val hostBridge: HostBridge
+    @Suppress("unused") private val hostBridge: HostBridge,
+    private val ownsHandle: Boolean = true
 ) : Closeable {
 
     interface HostBridge {
         fun onCall(method: String, argsJson: String?): String?
+
+        /**
+         * Handles NativeInterface.__callBinary(method, ...args). [args] is the argument list in
+         * [QuickJsBinaryValues] form and is only valid during the call; the result must be a
+         * direct buffer holding exactly one encoded value, or null for JS null. The default
+         * forwards to [onCall] with JSON arguments and returns its result as a string.
+         */
+        fun onCallBinary(method: String, args: ByteBuffer): ByteBuffer? {
+            val decoded = QuickJsBinaryValues.decode(args) as List<*>
+            val result = onCall(method, JSONArray(decoded).toString()) ?: return null
+            return QuickJsBinaryValues.encode(result)
+        }
+
+        /**
+         * Handles NativeInterface.__callAsync(method, argsJson), which returns a promise. Return
+         * true to take the call and finish it later, from any thread, with
+         * [resolveAsyncCall]/[rejectAsyncCall] for [callId]; the promise settles on the next
+         * [executePendingJobs]. Returning false (the default) runs [onCall] synchronously and
+         * settles the promise right away.
+         */
+        fun onCallAsync(method: String, argsJson: String?, callId: Long): Boolean = false
+    }
+
+    /** Result of [callFunctionValue]: the decoded value, or [failure] when the call threw. */
+    data class ValueResult(
+        val value: Any?,
+        val failure: EvalResult?
+    ) {
+        val success: Boolean
+            get() = failure == null
     }
 
     data class EvalResult(
@@ -50,18 +148,136 @@ class QuickJsNativeRuntime private constructor(
         val errorDetailsJson: String?
     )
 
+    data class BytecodeCacheStats(
+        val memoryHits: Long,
+        val diskHits: Long,
+        val misses: Long,
+        val stores: Long,
+        val memoryBytes: Long
+    )
+
+    /**
+     * Fixed at creation; 0 keeps the QuickJS default (no heap limit, 256 KB GC threshold, 1 MB
+     * stack). Past [memoryLimitBytes] allocations fail and the script gets an out-of-memory
+     * error instead of growing the process.
+     *
+     * @param useArena allocate from a native arena that [resetRuntime] drops in one go instead
+     * of freeing every object; meant for runtimes reset between tool runs.
+     */
+    data class Options(
+        val memoryLimitBytes: Long = 0L,
+        val gcThresholdBytes: Long = 0L,
+        val maxStackSizeBytes: Long = 0L,
+        val useArena: Boolean = false
+    ) {
+        init {
+            require(memoryLimitBytes >= 0L) { "memoryLimitBytes must be >= 0" }
+            require(gcThresholdBytes >= 0L) { "gcThresholdBytes must be >= 0" }
+            require(maxStackSizeBytes >= 0L) { "maxStackSizeBytes must be >= 0" }
+        }
+    }
+
+    /**
+     * JS_ComputeMemoryUsage of the runtime; the arena fields are 0 without [Options.useArena].
+     * [mallocLimit] is -1 when there is no limit.
+     */
+    data class MemoryUsage(
+        val mallocSize: Long,
+        val mallocLimit: Long,
+        val memoryUsedSize: Long,
+        val mallocCount: Long,
+        val memoryUsedCount: Long,
+        val atomCount: Long,
+        val atomSize: Long,
+        val stringCount: Long,
+        val stringSize: Long,
+        val objectCount: Long,
+        val objectSize: Long,
+        val propertyCount: Long,
+        val propertySize: Long,
+        val shapeCount: Long,
+        val shapeSize: Long,
+        val jsFunctionCount: Long,
+        val jsFunctionSize: Long,
+        val jsFunctionCodeSize: Long,
+        val cFunctionCount: Long,
+        val arrayCount: Long,
+        val fastArrayCount: Long,
+        val fastArrayElements: Long,
+        val binaryObjectCount: Long,
+        val binaryObjectSize: Long,
+        val arenaReservedBytes: Long,
+        val arenaLiveBytes: Long,
+        val arenaPeakLiveBytes: Long,
+        val arenaResets: Long
+    )
+
     companion object {
-        fun create(hostBridge: HostBridge): QuickJsNativeRuntime {
-            val handle = QuickJsNativeBridge.nativeCreate(hostBridge)
+        fun create(hostBridge: HostBridge, options: Options = Options()): QuickJsNativeRuntime {
+            val handle = QuickJsNativeBridge.nativeCreate(
+                hostBridge,
+                options.memoryLimitBytes,
+                options.gcThresholdBytes,
+                options.maxStackSizeBytes,
+                options.useArena
+            )
             require(handle != 0L) { "Failed to create QuickJS runtime" }
             return QuickJsNativeRuntime(handle, hostBridge)
         }
+
+        /** Wraps a VM owned by a [QuickJsRuntimePool]; closing the wrapper does not destroy it. */
+        internal fun pooled(handle: Long, hostBridge: HostBridge): QuickJsNativeRuntime {
+            require(handle != 0L) { "Invalid pooled QuickJS runtime" }
+            return QuickJsNativeRuntime(handle, hostBridge, ownsHandle = false)
+        }
+
+        /**
+         * Lets [evalCached] keep compiled bytecode in [directory] across process restarts. Files
+         * from another QuickJS build are ignored and replaced.
+         */
+        fun setBytecodeCacheDirectory(directory: File) {
+            directory.mkdirs()
+            QuickJsNativeBridge.nativeSetBytecodeCacheDir(directory.absolutePath)
+        }
+
+        fun bytecodeCacheStats(): BytecodeCacheStats {
+            val values = QuickJsNativeBridge.nativeGetBytecodeCacheStats()
+            return BytecodeCacheStats(
+                memoryHits = values[0],
+                diskHits = values[1],
+                misses = values[2],
+                stores = values[3],
+                memoryBytes = values[4]
+            )
+        }
     }
 
     private val closed = AtomicBoolean(false)
+    // Every native call holds the read lock and close() the write lock, so the handle is not
+    // destroyed under a call made from another thread (async host call workers, timers).
+    private val handleLock = ReentrantReadWriteLock()
+    private val binaryLock = Any()
+    private val argumentEncoder by lazy { QuickJsBinaryValues.Encoder() }
+    private val resultDecoder by lazy { QuickJsBinaryValues.Decoder() }
 
     fun eval(script: String, fileName: String = "<eval>"): EvalResult {
-        val resultJson = QuickJsNativeBridge.nativeEvaluate(requireHandle(), script, fileName)
+        val resultJson = withHandle { handle -> QuickJsNativeBridge.nativeEvaluate(handle, script, fileName) }
+        return parseEvalResult(resultJson)
+    }
+
+    /**
+     * Same result as [eval], but compiles [script] at most once per (script, fileName): later
+     * calls, from any runtime, run the cached bytecode. Meant for large scripts that do not
+     * change, such as bundled packages and bootstrap modules.
+     */
+    fun evalCached(script: String, fileName: String = "<eval>"): EvalResult {
+        val resultJson = withHandle { handle -> QuickJsNativeBridge.nativeEvaluateCached(handle, script, fileName) }
+        return parseEvalResult(resultJson)
+    }
+
+    /** Compiles [script] into the bytecode cache without running it; valueJson is the bytecode size. */
+    fun precompile(script: String, fileName: String = "<eval>"): EvalResult {
+        val resultJson = withHandle { handle -> QuickJsNativeBridge.nativePrecompile(handle, script, fileName) }
         return parseEvalResult(resultJson)
     }
 
@@ -70,16 +286,47 @@ class QuickJsNativeRuntime private constructor(
         argsJson: String,
         callSite: String = "<call:$functionName>"
     ): EvalResult {
-        val resultJson =
+        val resultJson = withHandle { handle ->
             QuickJsNativeBridge.nativeCallFunction(
-                requireHandle(),
+                handle,
                 functionName,
                 argsJson,
                 callSite
             )
+        }
         return parseEvalResult(resultJson)
     }
 
+    /**
+     * Like [callFunction], but [args] and the result cross JNI in [QuickJsBinaryValues] form
+     * instead of JSON text, which avoids several full copies for large payloads such as file
+     * contents. ArrayBuffers and typed arrays come back as ByteArray.
+     */
+    fun callFunctionValue(
+        functionName: String,
+        args: List<Any?>,
+        callSite: String = "<call:$functionName>"
+    ): ValueResult {
+        return withHandle { handle ->
+            synchronized(binaryLock) {
+                val encoded = argumentEncoder.encodeArguments(args)
+                when (
+                    val result = QuickJsNativeBridge.nativeCallFunctionBinary(
+                        handle,
+                        functionName,
+                        encoded,
+                        encoded.remaining(),
+                        callSite
+                    )
+                ) {
+                    is ByteBuffer -> ValueResult(resultDecoder.decode(result), null)
+                    is String -> ValueResult(null, parseEvalResult(result))
+                    else -> error("Unexpected nativeCallFunctionBinary result: $result")
+                }
+            }
+        }
+    }
+
     fun installCompatLayerOrThrow() {
         val result = eval(
             script = buildQuickJsCompatScript(),
@@ -93,7 +340,7 @@ class QuickJsNativeRuntime private constructor(
 
     fun executePendingJobs(maxJobs: Int = 128): Int {
         require(maxJobs > 0) { "maxJobs must be > 0" }
-        return QuickJsNativeBridge.nativeExecutePendingJobs(requireHandle(), maxJobs)
+        return withHandle { handle -> QuickJsNativeBridge.nativeExecutePendingJobs(handle, maxJobs) }
     }
 
     fun dispatchTimer(timerId: Int): EvalResult {
@@ -110,21 +357,111 @@ class QuickJsNativeRuntime private constructor(
         )
     }
 
+    /** Completes an async host call taken by [HostBridge.onCallAsync]; safe from any thread. */
+    fun resolveAsyncCall(callId: Long, value: String?) {
+        handleLock.read {
+            if (!closed.get()) {
+                QuickJsNativeBridge.nativeCompleteAsyncCall(handle, callId, true, value)
+            }
+        }
+    }
+
+    fun rejectAsyncCall(callId: Long, message: String) {
+        handleLock.read {
+            if (!closed.get()) {
+                QuickJsNativeBridge.nativeCompleteAsyncCall(handle, callId, false, message)
+            }
+        }
+    }
+
+    internal fun executePendingJobsIfOpen() {
+        handleLock.read {
+            if (!closed.get()) {
+                QuickJsNativeBridge.nativeExecutePendingJobs(handle, 128)
+            }
+        }
+    }
+
     fun interrupt() {
-        if (!closed.get()) {
-            QuickJsNativeBridge.nativeInterrupt(handle)
+        // tryLock: does not queue behind a close() that waits for the JS being interrupted
+        val readLock = handleLock.readLock()
+        if (!readLock.tryLock()) return
+        try {
+            if (!closed.get()) {
+                QuickJsNativeBridge.nativeInterrupt(handle)
+            }
+        } finally {
+            readLock.unlock()
         }
     }
 
+    /** Waits for running JS, since the heap is walked under the runtime's lock. */
+    fun memoryUsage(): MemoryUsage {
+        val values = withHandle { handle -> QuickJsNativeBridge.nativeGetMemoryUsage(handle) }
+        return MemoryUsage(
+            mallocSize = values[0],
+            mallocLimit = values[1],
+            memoryUsedSize = values[2],
+            mallocCount = values[3],
+            memoryUsedCount = values[4],
+            atomCount = values[5],
+            atomSize = values[6],
+            stringCount = values[7],
+            stringSize = values[8],
+            objectCount = values[9],
+            objectSize = values[10],
+            propertyCount = values[11],
+            propertySize = values[12],
+            shapeCount = values[13],
+            shapeSize = values[14],
+            jsFunctionCount = values[15],
+            jsFunctionSize = values[16],
+            jsFunctionCodeSize = values[17],
+            cFunctionCount = values[18],
+            arrayCount = values[19],
+            fastArrayCount = values[20],
+            fastArrayElements = values[21],
+            binaryObjectCount = values[22],
+            binaryObjectSize = values[23],
+            arenaReservedBytes = values[24],
+            arenaLiveBytes = values[25],
+            arenaPeakLiveBytes = values[26],
+            arenaResets = values[27]
+        )
+    }
+
+    /**
+     * Replaces the JS heap with a fresh one, keeping the handle and host bridge: globals,
+     * timers' JS state, pending jobs and unsettled async calls are gone, so the compat layer
+     * and any preloads must be installed again. With [Options.useArena] the old heap is
+     * released in bulk. If no new heap can be created the runtime is closed and this throws.
+     */
+    fun resetRuntime() {
+        if (!withHandle { handle -> QuickJsNativeBridge.nativeResetRuntime(handle) }) {
+            close()
+            error("Failed to recreate QuickJS runtime")
+        }
+    }
+
+    /**
+     * Interrupts running JS, then waits for native calls from other threads to return. Must not
+     * be called from inside a call on this runtime (a host callback).
+     */
     override fun close() {
-        if (closed.compareAndSet(false, true)) {
-            QuickJsNativeBridge.nativeDestroy(handle)
+        if (closed.get()) return
+        interrupt()
+        handleLock.write {
+            if (closed.compareAndSet(false, true) && ownsHandle) {
+                QuickJsNativeBridge.nativeDestroy(handle)
+            }
         }
     }
 
-    private fun requireHandle(): Long {
-        check(!closed.get()) { "QuickJS runtime already closed" }
-        return handle
+    private inline fun <T> withHandle(block: (handle: Long) -> T): T {
+        handleLock.read {
+            check(!closed.get()) { "QuickJS runtime already closed" }
+            return block(handle)
+        }
     }
 
     private fun parseEvalResult(resultJson: String): EvalResult {
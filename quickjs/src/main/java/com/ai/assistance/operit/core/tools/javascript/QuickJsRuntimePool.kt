@@ -0,0 +1,183 @@
+package com.ai.assistance.operit.core.tools.javascript
+
+import java.io.Closeable
+import java.util.concurrent.TimeoutException
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * Fixed set of warmed-up QuickJS runtimes for running tool calls in parallel; a single
+ * [QuickJsNativeRuntime] serializes every call. Each runtime gets its own host bridge, the
+ * compat layer and [preloads] (evaluated through the bytecode cache, so only the first
+ * runtime parses them), and the same [QuickJsNativeRuntime.Options].
+ */
+class QuickJsRuntimePool private constructor(
+    private val handle: Long,
+    private val runtimes: List<QuickJsNativeRuntime>,
+    private val hostBridges: List<QuickJsNativeRuntime.HostBridge>,
+    private val preloads: List<Preload>
+) : Closeable {
+
+    data class Preload(val fileName: String, val script: String)
+
+    data class Metrics(
+        val size: Int,
+        val busy: Int,
+        /** Callers currently waiting for a runtime. */
+        val queueDepth: Int,
+        val peakQueueDepth: Int,
+        val leases: Long,
+        val timeouts: Long,
+        val totalWaitNanos: Long,
+        val maxWaitNanos: Long
+    ) {
+        val averageWaitNanos: Long
+            get() = if (leases + timeouts > 0) totalWaitNanos / (leases + timeouts) else 0L
+    }
+
+    companion object {
+        const val NO_AFFINITY = -1L
+
+        /**
+         * @param hostBridgeFactory creates the bridge of one runtime; it gets the runtime's index
+         * and a provider for it (valid once the pool is created), e.g. for
+         * [QuickJsNativeHostDispatcher]. Bridges that are [Closeable] are closed with the pool.
+         * @param options limits of every runtime.
+         */
+        fun create(
+            size: Int,
+            options: QuickJsNativeRuntime.Options = QuickJsNativeRuntime.Options(),
+            preloads: List<Preload> = emptyList(),
+            hostBridgeFactory: (index: Int, runtimeProvider: () -> QuickJsNativeRuntime) -> QuickJsNativeRuntime.HostBridge
+        ): QuickJsRuntimePool {
+            require(size > 0) { "size must be > 0" }
+
+            val runtimeSlots = arrayOfNulls<QuickJsNativeRuntime>(size)
+            val hostBridges = List(size) { index ->
+                hostBridgeFactory(index) { runtimeSlots[index] ?: error("QuickJS runtime is not ready") }
+            }
+            val handle = QuickJsNativeBridge.nativeCreatePool(
+                hostBridges.toTypedArray(),
+                options.memoryLimitBytes,
+                options.gcThresholdBytes,
+                options.maxStackSizeBytes,
+                options.useArena
+            )
+            if (handle == 0L) {
+                hostBridges.forEach { (it as? Closeable)?.close() }
+                error("Failed to create QuickJS runtime pool")
+            }
+
+            val runtimes = List(size) { index ->
+                QuickJsNativeRuntime.pooled(
+                    QuickJsNativeBridge.nativePoolRuntime(handle, index),
+                    hostBridges[index]
+                ).also { runtimeSlots[index] = it }
+            }
+            val pool = QuickJsRuntimePool(handle, runtimes, hostBridges, preloads)
+            try {
+                runtimes.forEach { pool.warmUp(it) }
+            } catch (e: Exception) {
+                pool.close()
+                throw e
+            }
+            return pool
+        }
+    }
+
+    private val closed = AtomicBoolean(false)
+
+    val size: Int
+        get() = runtimes.size
+
+    /**
+     * Runs [block] with exclusive use of one runtime. Calls with the same non-negative
+     * [affinityKey] always get the same runtime (and wait for it), so state a package keeps in
+     * globals is found again; otherwise the next free runtime is used.
+     *
+     * @param timeoutMillis how long to wait for a runtime, negative for no limit.
+     * @param resetAfterUse give the runtime a fresh heap (see
+     * [QuickJsNativeRuntime.resetRuntime]) and warm it up again before the next caller gets it,
+     * so nothing [block] left behind leaks into later tool runs.
+     * @throws TimeoutException when no runtime became free in time.
+     */
+    fun <T> withRuntime(
+        affinityKey: Long = NO_AFFINITY,
+        timeoutMillis: Long = -1L,
+        resetAfterUse: Boolean = false,
+        block: (QuickJsNativeRuntime) -> T
+    ): T {
+        check(!closed.get()) { "QuickJS runtime pool already closed" }
+        val index = QuickJsNativeBridge.nativePoolLease(handle, affinityKey, timeoutMillis)
+        if (index < 0) {
+            throw TimeoutException("No QuickJS runtime became free within ${timeoutMillis}ms")
+        }
+        try {
+            val result = block(runtimes[index])
+            if (resetAfterUse) {
+                runtimes[index].resetRuntime()
+                warmUp(runtimes[index])
+            }
+            return result
+        } finally {
+            QuickJsNativeBridge.nativePoolRelease(handle, index)
+        }
+    }
+
+    /** Index of [runtime] in the pool, the affinity key that always leases it; -1 if not pooled here. */
+    fun indexOf(runtime: QuickJsNativeRuntime): Int = runtimes.indexOfFirst { it === runtime }
+
+    /**
+     * The runtime at [index] without leasing it, for work that has to reach the runtime holding
+     * some state (settling a callback, cancelling a call) even while another caller leases it.
+     * Calls still serialize on the runtime's own lock.
+     */
+    fun runtime(index: Int): QuickJsNativeRuntime {
+        check(!closed.get()) { "QuickJS runtime pool already closed" }
+        return runtimes[index]
+    }
+
+    fun metrics(): Metrics {
+        check(!closed.get()) { "QuickJS runtime pool already closed" }
+        val values = QuickJsNativeBridge.nativePoolMetrics(handle)
+        return Metrics(
+            size = values[0].toInt(),
+            busy = values[1].toInt(),
+            queueDepth = values[2].toInt(),
+            peakQueueDepth = values[3].toInt(),
+            leases = values[4],
+            timeouts = values[5],
+            totalWaitNanos = values[6],
+            maxWaitNanos = values[7]
+        )
+    }
+
+    /** Interrupts whatever each runtime is currently running. */
+    fun interruptAll() {
+        if (!closed.get()) {
+            runtimes.forEach { it.interrupt() }
+        }
+    }
+
+    private fun warmUp(runtime: QuickJsNativeRuntime) {
+        runtime.installCompatLayerOrThrow()
+        preloads.forEach { preload ->
+            val result = runtime.evalCached(preload.script, preload.fileName)
+            runtime.executePendingJobs()
+            check(result.success) {
+                result.describeFailure("Failed to preload ${preload.fileName}")
+            }
+        }
+    }
+
+    /**
+     * Must not race with [withRuntime]; leased runtimes are destroyed with the pool. The host
+     * bridges stop first, then each runtime waits for calls still coming in from their threads.
+     */
+    override fun close() {
+        if (closed.compareAndSet(false, true)) {
+            hostBridges.forEach { (it as? Closeable)?.close() }
+            runtimes.forEach { it.close() }
+            QuickJsNativeBridge.nativeDestroyPool(handle)
+        }
+    }
+}